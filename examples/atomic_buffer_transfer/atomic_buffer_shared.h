@@ -1,16 +1,16 @@
 #ifndef ATOMIC_BUFFER_SHARED_H
 #define ATOMIC_BUFFER_SHARED_H
 
-#include <stdatomic.h>
+#include "shm_seqlock.h"
 
 #define ATOMIC_BUFFER_SHM_NAME "/atomic_buf_shared_mem"
 #define MAX_STRING_LENGTH 256 // Maximum length of the string we can store
 
-// Structure to hold a variable-length string and an atomic version counter
-typedef struct
+// The latest string sits in a seqlock cell at the start of the segment,
+// stored with its length and without the terminating null
+static inline shm_seqlock_t *latest_string(void *addr)
 {
-    char string_data[MAX_STRING_LENGTH]; // Buffer for the string
-    atomic_uint version;                 // Atomic counter for tracking updates
-} atomic_string_data_t;
+    return (shm_seqlock_t *)addr;
+}
 
-#endif // ATOMIC_BUFFER_SHARED_H
\ No newline at end of file
+#endif // ATOMIC_BUFFER_SHARED_H
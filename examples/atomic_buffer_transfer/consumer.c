@@ -21,11 +21,11 @@ int main()
     printf("Shared memory opened at address %p\n", shm.addr);
     fflush(stdout);
 
-    // Access the data structure in shared memory
-    atomic_string_data_t *string_data = (atomic_string_data_t *)shm.addr;
+    // Access the latest-value cell in shared memory
+    shm_seqlock_t *latest = latest_string(shm.addr);
 
     // Keep track of the last version we processed
-    unsigned int last_version = 0;
+    uint64_t last_version = 0;
     unsigned int frames_processed = 0;
     unsigned int updates_received = 0;
 
@@ -44,17 +44,17 @@ int main()
     while (1)
     {
         // Check if there's a new version available (non-blocking)
-        unsigned int current_version = atomic_load(&string_data->version);
-
-        if (current_version != last_version)
+        if (shm_seqlock_version(latest) != last_version)
         {
-            // Memory barrier to ensure we read fresh values
-            atomic_thread_fence(memory_order_acquire);
-
-            // Read the string
+            // Copy out a consistent snapshot; this retries if the producer was mid-write
             char string_copy[MAX_STRING_LENGTH];
-            strcpy(string_copy, string_data->string_data);
-            size_t string_length = strlen(string_copy);
+            uint64_t current_version;
+            size_t string_length = shm_seqlock_read(latest, string_copy, MAX_STRING_LENGTH - 1, &current_version);
+            if (string_length > MAX_STRING_LENGTH - 1)
+            {
+                string_length = MAX_STRING_LENGTH - 1;
+            }
+            string_copy[string_length] = '\0';
 
             // Update our last processed version
             last_version = current_version;
@@ -44,14 +44,9 @@ int main()
     printf("Shared memory created at address %p\n", shm.addr);
     fflush(stdout);
 
-    // Initialize the data structure in shared memory
-    atomic_string_data_t *string_data = (atomic_string_data_t *)shm.addr;
-
-    // Initialize string to empty
-    string_data->string_data[0] = '\0';
-
-    // Initialize version counter to 0
-    atomic_store(&string_data->version, 0);
+    // Initialize the latest-value cell in shared memory (empty string, version 0)
+    shm_seqlock_t *latest = latest_string(shm.addr);
+    shm_seqlock_init(latest, MAX_STRING_LENGTH);
 
     printf("Shared memory initialized, ready to generate data\n");
     printf("Press Ctrl+C to exit\n");
@@ -66,14 +61,9 @@ int main()
         char temp_buffer[MAX_STRING_LENGTH];
         generate_random_string(temp_buffer, 32);
 
-        // Copy the string to shared memory
-        strcpy(string_data->string_data, temp_buffer);
-
-        // Memory barrier to ensure all writes are visible before updating version
-        atomic_thread_fence(memory_order_release);
-
-        // Update version counter atomically
-        atomic_fetch_add(&string_data->version, 1);
+        // Publish it; readers never see a half-written string
+        size_t length = strlen(temp_buffer);
+        shm_seqlock_write(latest, temp_buffer, length);
 
         update_count++;
 
@@ -81,9 +71,7 @@ int main()
         if (update_count % 10 == 0)
         {
             printf("Generated string (length %zu): \"%s\" (update #%u)\n",
-                   strlen(string_data->string_data),
-                   string_data->string_data,
-                   update_count);
+                   length, temp_buffer, update_count);
             fflush(stdout);
         }
 
@@ -0,0 +1,271 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <sys/wait.h>
+#include "shared_memory.h"
+#include "ring_buffer_shared.h"
+#include "broadcast_ring_shared.h"
+
+// Test configuration
+#define BENCH_SHM_NAME "/bench_broadcast_ring_shared_memory"
+#define BENCH_SPSC_SHM_NAME "/bench_broadcast_spsc_%d"
+#define MESSAGES 2000000
+#define MESSAGE_SIZE 16
+#define RING_SLOTS 1024
+#define MAX_CONSUMERS 8
+
+static const int consumer_counts[] = {1, 2, 4, 8};
+#define NUM_COUNTS (int)(sizeof(consumer_counts) / sizeof(consumer_counts[0]))
+
+// ===== RESULTS ===== //
+typedef struct
+{
+    double elapsed_ms;      // Until every consumer has seen every message
+    double producer_ns;     // Producer time per message, waiting included
+    uint64_t bytes_written; // Payload bytes the producer wrote
+    uint64_t lost;          // Messages consumers reported as overrun, summed
+} run_result_t;
+
+typedef struct
+{
+    int consumers;
+    run_result_t spsc;         // One SPSC ring per consumer, producer copies N times
+    run_result_t backpressure; // Broadcast ring, producer waits for the slowest consumer
+    run_result_t overwrite;    // Broadcast ring, producer never waits
+} broadcast_result_t;
+
+// ===== TIMING UTILITY ===== //
+uint64_t get_time_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void wait_all(pid_t *pids, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        int status;
+        waitpid(pids[i], &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            printf("Consumer %d saw a corrupt message!\n", i);
+        }
+    }
+}
+
+// ===== ONE SPSC RING PER CONSUMER ===== //
+run_result_t benchmark_spsc(int consumers)
+{
+    run_result_t result = {0};
+    size_t capacity = RING_SLOTS * MESSAGE_SIZE;
+
+    shared_memory_t shms[MAX_CONSUMERS] = {0};
+    ring_buffer_t *rings[MAX_CONSUMERS];
+    char names[MAX_CONSUMERS][64];
+    for (int c = 0; c < consumers; c++)
+    {
+        snprintf(names[c], sizeof(names[c]), BENCH_SPSC_SHM_NAME, c);
+        if (shared_memory_create(&shms[c], names[c], ring_buffer_shm_size(capacity)) != 0)
+        {
+            printf("Failed to create shared memory\n");
+            exit(1);
+        }
+        rings[c] = (ring_buffer_t *)shms[c].addr;
+        ring_buffer_init(rings[c], capacity);
+    }
+
+    uint64_t start = get_time_ns();
+
+    pid_t pids[MAX_CONSUMERS];
+    for (int c = 0; c < consumers; c++)
+    {
+        pids[c] = fork();
+        if (pids[c] == 0)
+        {
+            ring_span_t spans[2];
+            for (uint64_t expected = 0; expected < MESSAGES; expected++)
+            {
+                while (ring_peek(rings[c], MESSAGE_SIZE, spans) == 0)
+                {
+                    sched_yield();
+                }
+                uint64_t value;
+                memcpy(&value, spans[0].data, sizeof(value));
+                ring_release(rings[c], MESSAGE_SIZE);
+                if (value != expected)
+                {
+                    _exit(1);
+                }
+            }
+            _exit(0);
+        }
+    }
+
+    // The producer has to write every message into every consumer's ring
+    uint8_t message[MESSAGE_SIZE] = {0};
+    for (uint64_t i = 0; i < MESSAGES; i++)
+    {
+        memcpy(message, &i, sizeof(i));
+        for (int c = 0; c < consumers; c++)
+        {
+            ring_span_t spans[2];
+            while (!ring_reserve(rings[c], MESSAGE_SIZE, spans))
+            {
+                sched_yield();
+            }
+            memcpy(spans[0].data, message, MESSAGE_SIZE);
+            ring_commit(rings[c], MESSAGE_SIZE);
+        }
+    }
+    result.producer_ns = (double)(get_time_ns() - start) / MESSAGES;
+    result.bytes_written = (uint64_t)MESSAGES * MESSAGE_SIZE * consumers;
+
+    wait_all(pids, consumers);
+    result.elapsed_ms = (get_time_ns() - start) / 1e6;
+
+    for (int c = 0; c < consumers; c++)
+    {
+        shared_memory_destroy(&shms[c], 1);
+    }
+    return result;
+}
+
+// ===== BROADCAST RING ===== //
+run_result_t benchmark_broadcast(int consumers, broadcast_mode_t mode)
+{
+    run_result_t result = {0};
+
+    shared_memory_t shm = {0};
+    if (shared_memory_create(&shm, BENCH_SHM_NAME, broadcast_ring_shm_size(RING_SLOTS)) != 0)
+    {
+        printf("Failed to create shared memory\n");
+        exit(1);
+    }
+    broadcast_ring_t *ring = (broadcast_ring_t *)shm.addr;
+    broadcast_ring_init(ring, RING_SLOTS, mode);
+
+    // Consumers report their overrun counts here
+    uint64_t *lost_counts = mmap(NULL, MAX_CONSUMERS * sizeof(uint64_t), PROT_READ | PROT_WRITE,
+                                 MAP_SHARED | MAP_ANON, -1, 0);
+    if (lost_counts == MAP_FAILED)
+    {
+        perror("mmap");
+        exit(1);
+    }
+
+    // Register every consumer before the first message so none starts late
+    int ids[MAX_CONSUMERS];
+    for (int c = 0; c < consumers; c++)
+    {
+        ids[c] = broadcast_ring_subscribe(ring);
+    }
+
+    uint64_t start = get_time_ns();
+
+    pid_t pids[MAX_CONSUMERS];
+    for (int c = 0; c < consumers; c++)
+    {
+        pids[c] = fork();
+        if (pids[c] == 0)
+        {
+            uint64_t received = 0;
+            uint64_t lost = 0;
+            uint64_t last = 0;
+            while (received + lost < MESSAGES)
+            {
+                uint8_t message[BROADCAST_SLOT_DATA_SIZE];
+                uint32_t length;
+                if (!broadcast_ring_receive(ring, ids[c], message, &length, &lost))
+                {
+                    sched_yield();
+                    continue;
+                }
+
+                // Messages must arrive in order, gaps only where overruns were counted
+                uint64_t value;
+                memcpy(&value, message, sizeof(value));
+                if (received > 0 && value <= last)
+                {
+                    _exit(1);
+                }
+                last = value;
+                received++;
+            }
+            lost_counts[c] = lost;
+            _exit(0);
+        }
+    }
+
+    // The producer writes each message once, whatever the consumer count
+    uint8_t message[MESSAGE_SIZE] = {0};
+    for (uint64_t i = 0; i < MESSAGES; i++)
+    {
+        memcpy(message, &i, sizeof(i));
+        while (!broadcast_ring_send(ring, message, MESSAGE_SIZE))
+        {
+            sched_yield();
+        }
+    }
+    result.producer_ns = (double)(get_time_ns() - start) / MESSAGES;
+    result.bytes_written = (uint64_t)MESSAGES * MESSAGE_SIZE;
+
+    wait_all(pids, consumers);
+    result.elapsed_ms = (get_time_ns() - start) / 1e6;
+    for (int c = 0; c < consumers; c++)
+    {
+        result.lost += lost_counts[c];
+    }
+
+    munmap(lost_counts, MAX_CONSUMERS * sizeof(uint64_t));
+    shared_memory_destroy(&shm, 1);
+    return result;
+}
+
+void print_results(broadcast_result_t *results)
+{
+    printf("\n========================================================================\n");
+    printf("              PRODUCER COST PER MESSAGE VS CONSUMER COUNT               \n");
+    printf("========================================================================\n");
+    printf("Consumers | SPSC per consumer | Broadcast (backpressure) | Broadcast (overwrite)\n");
+    printf("          |  ns/msg | MB out  |  ns/msg | MB out | total ms |  ns/msg |     lost\n");
+    printf("----------|---------|---------|---------|--------|----------|---------|----------\n");
+    for (int i = 0; i < NUM_COUNTS; i++)
+    {
+        broadcast_result_t *r = &results[i];
+        printf("%9d | %7.1f | %7.1f | %7.1f | %6.1f | %8.1f | %7.1f | %8llu\n",
+               r->consumers, r->spsc.producer_ns, r->spsc.bytes_written / 1e6,
+               r->backpressure.producer_ns, r->backpressure.bytes_written / 1e6, r->backpressure.elapsed_ms,
+               r->overwrite.producer_ns, (unsigned long long)r->overwrite.lost);
+    }
+    printf("========================================================================\n");
+    printf("MB out is payload the producer wrote. Overwrite-mode losses depend on scheduling.\n");
+}
+
+int main()
+{
+    printf("===== BROADCAST RING BENCHMARK =====\n");
+    printf("%d messages of %d bytes fanned out to N consumer processes\n", MESSAGES, MESSAGE_SIZE);
+    printf("Online CPUs: %ld\n", sysconf(_SC_NPROCESSORS_ONLN));
+    printf("--------------------------------------------\n");
+
+    broadcast_result_t results[NUM_COUNTS];
+    for (int i = 0; i < NUM_COUNTS; i++)
+    {
+        int consumers = consumer_counts[i];
+        printf("Testing %d consumer(s)...\n", consumers);
+
+        results[i].consumers = consumers;
+        results[i].spsc = benchmark_spsc(consumers);
+        results[i].backpressure = benchmark_broadcast(consumers, BROADCAST_BACKPRESSURE);
+        results[i].overwrite = benchmark_broadcast(consumers, BROADCAST_OVERWRITE);
+    }
+
+    print_results(results);
+
+    printf("=== BENCHMARK COMPLETE ===\n");
+    return 0;
+}
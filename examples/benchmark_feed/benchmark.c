@@ -0,0 +1,216 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "mmap_shared.h"
+
+// Test configuration
+#define BENCH_DB_PATH "/tmp/benchmark_feed.dat"
+#define NUM_RECORDS 1000
+#define NUM_CHANGES 2000 // Updates per run, one at a time
+#define GAP_US 500       // Pause between updates, so each change is waited for
+
+// How the reader learns about a change
+typedef struct
+{
+    const char *name;
+    int blocking;                 // Wait on the feed, or sleep and poll it
+    shm_wait_strategy_t strategy; // For blocking waits
+    unsigned poll_us;             // For polling
+} feed_method_t;
+
+static const feed_method_t methods[] = {
+    {"spin", 1, SHM_WAIT_SPIN, 0},
+    {"hybrid", 1, SHM_WAIT_HYBRID, 0},
+    {"futex", 1, SHM_WAIT_FUTEX, 0},
+    {"poll 1ms", 0, 0, 1000},
+    {"poll 10ms", 0, 0, 10000},
+};
+#define NUM_METHODS (int)(sizeof(methods) / sizeof(methods[0]))
+
+// ===== RESULTS ===== //
+typedef struct
+{
+    double median_us; // Update started to reader holding the change
+    double p99_us;
+    double max_us;
+    uint64_t wakeups; // Times the reader woke up, changes or not
+} feed_result_t;
+
+// Shared between the writer and the reader process
+typedef struct
+{
+    atomic_int ready;
+    uint64_t sent_ns[NUM_CHANGES]; // When the writer started each update
+    feed_result_t result;
+} bench_shared_t;
+
+// ===== TIMING UTILITY ===== //
+uint64_t get_time_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int compare_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Reader: take NUM_CHANGES changes off the feed, noting how late each one was
+static void run_reader(bench_shared_t *shared, const feed_method_t *method)
+{
+    mmap_db_t handle;
+    if (mmap_db_open(&handle, BENCH_DB_PATH, NULL, 0) != 0)
+    {
+        _exit(1);
+    }
+    mmap_db_feed_t feed;
+    mmap_db_feed_init(&feed, handle.db);
+
+    uint64_t *latency = malloc(NUM_CHANGES * sizeof(uint64_t));
+    uint64_t wakeups = 0;
+    int received = 0;
+    atomic_store(&shared->ready, 1);
+
+    while (received < NUM_CHANGES)
+    {
+        if (method->blocking)
+        {
+            if (mmap_db_feed_wait(&feed, method->strategy, 1000) < 0)
+            {
+                _exit(1);
+            }
+        }
+        else
+        {
+            usleep(method->poll_us);
+        }
+        wakeups++;
+
+        // Everything that arrived, stamped as soon as it is seen
+        db_change_t change;
+        int status;
+        while (received < NUM_CHANGES && (status = mmap_db_feed_next(&feed, &change)) != 0)
+        {
+            if (status < 0)
+            {
+                _exit(1); // Never this far behind
+            }
+            latency[received] = get_time_ns() - shared->sent_ns[received];
+            received++;
+        }
+    }
+
+    qsort(latency, NUM_CHANGES, sizeof(uint64_t), compare_u64);
+    shared->result.median_us = latency[NUM_CHANGES / 2] / 1e3;
+    shared->result.p99_us = latency[NUM_CHANGES * 99 / 100] / 1e3;
+    shared->result.max_us = latency[NUM_CHANGES - 1] / 1e3;
+    shared->result.wakeups = wakeups;
+
+    free(latency);
+    mmap_db_close(&handle);
+    _exit(0);
+}
+
+feed_result_t benchmark_method(mmap_db_t *handle, bench_shared_t *shared, const feed_method_t *method)
+{
+    memset(shared, 0, sizeof(bench_shared_t));
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        run_reader(shared, method);
+    }
+    while (!atomic_load(&shared->ready))
+    {
+        usleep(100);
+    }
+    usleep(10000); // Let the reader settle into its wait
+
+    // Writer: one update at a time, stamped just before it starts
+    srand(42);
+    for (int i = 0; i < NUM_CHANGES; i++)
+    {
+        shared->sent_ns[i] = get_time_ns();
+        if (mmap_db_update_record(handle, rand() % NUM_RECORDS + 1, rand() % 10000 / 100.0, true, NULL) != 0)
+        {
+            printf("Update failed\n");
+            exit(1);
+        }
+        usleep(GAP_US);
+    }
+
+    int status;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        printf("Reader failed\n");
+        exit(1);
+    }
+    return shared->result;
+}
+
+int main()
+{
+    printf("===== CHANGE FEED BENCHMARK =====\n");
+    printf("%d updates, %dus apart, one reader tailing the feed\n", NUM_CHANGES, GAP_US);
+    printf("Online CPUs: %ld\n", sysconf(_SC_NPROCESSORS_ONLN));
+    printf("---------------------------------\n");
+
+    mmap_db_t handle;
+    if (mmap_db_create(&handle, BENCH_DB_PATH, mmap_db_file_size(NUM_RECORDS), NULL, 0) != 0)
+    {
+        printf("Failed to create the database\n");
+        return 1;
+    }
+    for (uint32_t i = 0; i < NUM_RECORDS; i++)
+    {
+        if (mmap_db_add_record(&handle, "Feed Record", i, NULL) != 0)
+        {
+            printf("Insert failed\n");
+            return 1;
+        }
+    }
+
+    bench_shared_t *shared = mmap(NULL, sizeof(bench_shared_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS,
+                                  -1, 0);
+    if (shared == MAP_FAILED)
+    {
+        perror("Failed to map counters");
+        return 1;
+    }
+
+    feed_result_t results[NUM_METHODS];
+    for (int i = 0; i < NUM_METHODS; i++)
+    {
+        printf("Testing %s...\n", methods[i].name);
+        results[i] = benchmark_method(&handle, shared, &methods[i]);
+    }
+
+    printf("\n=====================================================================\n");
+    printf("              CHANGE NOTIFICATION LATENCY (microseconds)\n");
+    printf("=====================================================================\n");
+    printf("Method     |     Median |        p99 |        Max | Wake-ups\n");
+    printf("-----------|------------|------------|------------|---------\n");
+    for (int i = 0; i < NUM_METHODS; i++)
+    {
+        feed_result_t *r = &results[i];
+        printf("%-10s | %10.1f | %10.1f | %10.1f | %8llu\n", methods[i].name, r->median_us, r->p99_us, r->max_us,
+               (unsigned long long)r->wakeups);
+    }
+    printf("=====================================================================\n");
+    printf("Latency runs from the start of the update to the reader seeing it.\n");
+    printf("Spinning only pays off with a core to spare for the reader.\n");
+
+    munmap(shared, sizeof(bench_shared_t));
+    mmap_db_close(&handle);
+    unlink(BENCH_DB_PATH);
+    printf("=== BENCHMARK COMPLETE ===\n");
+    return 0;
+}
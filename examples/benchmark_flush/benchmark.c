@@ -0,0 +1,118 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "mmap_shared.h"
+
+// Test configuration
+#define BENCH_DB_PATH "/tmp/benchmark_flush.dat"
+#define RUN_MS 500 // Inserts per configuration run for this long, or until the file is full
+
+static const size_t file_sizes[] = {1024 * 1024, 64 * 1024 * 1024, 256 * 1024 * 1024};
+#define NUM_SIZES (int)(sizeof(file_sizes) / sizeof(file_sizes[0]))
+
+static const mmap_db_sync_mode_t modes[] = {MMAP_DB_SYNC_FILE, MMAP_DB_SYNC_RANGE, MMAP_DB_SYNC_ASYNC,
+                                            MMAP_DB_SYNC_BACKGROUND};
+#define NUM_MODES (int)(sizeof(modes) / sizeof(modes[0]))
+
+// ===== RESULTS ===== //
+typedef struct
+{
+    double inserts_per_sec;
+    double bytes_per_insert; // Bytes handed to msync per insert
+    double flush_us;         // Average time in one flush
+} flush_result_t;
+
+// ===== TIMING UTILITY ===== //
+uint64_t get_time_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+flush_result_t benchmark_mode(size_t file_size, mmap_db_sync_mode_t mode)
+{
+    mmap_db_t handle;
+    if (mmap_db_create(&handle, BENCH_DB_PATH, file_size, NULL, 0) != 0 ||
+        mmap_db_set_sync_mode(&handle, mode, MMAP_FLUSH_INTERVAL_MS) != 0)
+    {
+        printf("Failed to create the database\n");
+        exit(1);
+    }
+
+    // Start from a clean file, so each mode only pays for its own inserts
+    shm_dirty_sync_all(&handle.dirty);
+    shm_dirty_stats_t before = shm_dirty_stats(&handle.dirty);
+
+    char name[64];
+    uint64_t inserts = 0;
+    uint64_t start = get_time_ns();
+    uint64_t end = start + RUN_MS * 1000000ULL;
+    while (get_time_ns() < end && mmap_db_record_count(handle.db) < handle.db->max_records)
+    {
+        snprintf(name, sizeof(name), "Benchmark Record %llu", (unsigned long long)inserts);
+        if (mmap_db_add_record(&handle, name, inserts * 0.5, NULL) != 0 || mmap_db_commit(&handle, 0) != 0)
+        {
+            printf("Insert failed\n");
+            exit(1);
+        }
+        inserts++;
+    }
+    uint64_t elapsed = get_time_ns() - start;
+
+    // Let the background flusher finish what it owes
+    mmap_db_set_sync_mode(&handle, MMAP_DB_SYNC_RANGE, 0);
+    shm_dirty_stats_t after = shm_dirty_stats(&handle.dirty);
+
+    flush_result_t result;
+    uint64_t flushes = after.flushes - before.flushes;
+    result.inserts_per_sec = inserts / (elapsed / 1e9);
+    result.bytes_per_insert = (double)(after.bytes - before.bytes) / inserts;
+    result.flush_us = flushes > 0 ? (after.total_ns - before.total_ns) / 1e3 / flushes : 0;
+
+    mmap_db_close(&handle);
+    unlink(BENCH_DB_PATH);
+    return result;
+}
+
+int main()
+{
+    printf("===== RECORD FILE FLUSH BENCHMARK =====\n");
+    printf("One writer, each insert committed before the next, %dms per run\n", RUN_MS);
+    printf("Background flusher runs every %dms\n", MMAP_FLUSH_INTERVAL_MS);
+    printf("Online CPUs: %ld\n", sysconf(_SC_NPROCESSORS_ONLN));
+    printf("---------------------------------------\n");
+
+    flush_result_t results[NUM_SIZES][NUM_MODES];
+    for (int i = 0; i < NUM_SIZES; i++)
+    {
+        printf("Testing a %zu MB file...\n", file_sizes[i] / (1024 * 1024));
+        for (int m = 0; m < NUM_MODES; m++)
+        {
+            results[i][m] = benchmark_mode(file_sizes[i], modes[m]);
+        }
+    }
+
+    printf("\n=====================================================================\n");
+    printf("                 INSERTS PER SECOND AND FLUSH COST\n");
+    printf("=====================================================================\n");
+    printf("File (MB) | Mode       |  Inserts/s | Flushed/insert |   Avg flush\n");
+    printf("----------|------------|------------|----------------|------------\n");
+    for (int i = 0; i < NUM_SIZES; i++)
+    {
+        for (int m = 0; m < NUM_MODES; m++)
+        {
+            flush_result_t *r = &results[i][m];
+            printf("%9zu | %-10s | %10.0f | %11.1f KB | %8.1f us\n", file_sizes[i] / (1024 * 1024),
+                   mmap_db_sync_mode_name(modes[m]), r->inserts_per_sec, r->bytes_per_insert / 1024,
+                   r->flush_us);
+        }
+    }
+    printf("=====================================================================\n");
+    printf("async and background return before the data is on disk.\n");
+
+    printf("=== BENCHMARK COMPLETE ===\n");
+    return 0;
+}
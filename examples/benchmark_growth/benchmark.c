@@ -0,0 +1,133 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "mmap_shared.h"
+
+// Test configuration
+#define BENCH_DB_PATH "/tmp/benchmark_growth.dat"
+#define INITIAL_SIZE MMAP_FILE_SIZE // The file starts here and doubles at each step
+#define GROWTH_STEPS 8
+
+// ===== RESULTS ===== //
+typedef struct
+{
+    uint32_t records;       // Records in the file when it grew
+    size_t size;            // File size after growing
+    double inserts_per_sec; // Inserts filling the file up to this step
+    double grow_ms;         // The insert that grew the file: relayout and sync
+} step_result_t;
+
+// ===== TIMING UTILITY ===== //
+uint64_t get_time_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void insert_record(mmap_db_t *handle, uint32_t i)
+{
+    char name[64];
+    snprintf(name, sizeof(name), "Growing Record %u", i);
+    if (mmap_db_add_record(handle, name, i % 1000, NULL) != 0)
+    {
+        printf("Insert failed\n");
+        exit(1);
+    }
+}
+
+// Start small and insert through GROWTH_STEPS growths, timing each
+static uint32_t benchmark_growing(step_result_t *steps, double *overall_per_sec)
+{
+    mmap_db_t handle;
+    if (mmap_db_create(&handle, BENCH_DB_PATH, INITIAL_SIZE, NULL, 0) != 0)
+    {
+        printf("Failed to create the database\n");
+        exit(1);
+    }
+    mmap_database_t *db = handle.db;
+
+    uint32_t count = 0;
+    uint64_t total_start = get_time_ns();
+    for (int step = 0; step < GROWTH_STEPS; step++)
+    {
+        // Fill the file...
+        uint32_t first = count;
+        uint64_t start = get_time_ns();
+        while (count < db->max_records)
+        {
+            insert_record(&handle, count++);
+        }
+        uint64_t elapsed = get_time_ns() - start;
+
+        // ...then one more insert makes it grow
+        start = get_time_ns();
+        insert_record(&handle, count++);
+        steps[step].grow_ms = (get_time_ns() - start) / 1e6;
+        steps[step].records = count - 1;
+        steps[step].size = handle.size;
+        steps[step].inserts_per_sec = elapsed > 0 ? (count - 1 - first) / (elapsed / 1e9) : 0;
+    }
+    *overall_per_sec = count / ((get_time_ns() - total_start) / 1e9);
+
+    mmap_db_close(&handle);
+    unlink(BENCH_DB_PATH);
+    return count;
+}
+
+// The same inserts into a file created big enough from the start
+static double benchmark_presized(uint32_t count)
+{
+    mmap_db_t handle;
+    if (mmap_db_create(&handle, BENCH_DB_PATH, mmap_db_file_size(count), NULL, 0) != 0)
+    {
+        printf("Failed to create the database\n");
+        exit(1);
+    }
+
+    uint64_t start = get_time_ns();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        insert_record(&handle, i);
+    }
+    double per_sec = count / ((get_time_ns() - start) / 1e9);
+
+    mmap_db_close(&handle);
+    unlink(BENCH_DB_PATH);
+    return per_sec;
+}
+
+int main()
+{
+    printf("===== FILE GROWTH BENCHMARK =====\n");
+    printf("Inserts into a %d KB file that doubles %d times, vs a file sized up front\n", INITIAL_SIZE / 1024,
+           GROWTH_STEPS);
+    printf("---------------------------------\n");
+
+    step_result_t steps[GROWTH_STEPS];
+    double growing_per_sec;
+    printf("Testing a growing file...\n");
+    uint32_t count = benchmark_growing(steps, &growing_per_sec);
+    printf("Testing a presized file...\n");
+    double presized_per_sec = benchmark_presized(count);
+
+    printf("\n=====================================================================\n");
+    printf("                  INSERTS PER SECOND ACROSS GROWTH STEPS\n");
+    printf("=====================================================================\n");
+    printf("Step |    Records |  Grown to (MB) | Inserts/s before |  Growth (ms)\n");
+    printf("-----|------------|----------------|------------------|-------------\n");
+    for (int i = 0; i < GROWTH_STEPS; i++)
+    {
+        step_result_t *s = &steps[i];
+        printf("%4d | %10u | %14.1f | %16.0f | %12.2f\n", i + 1, s->records, s->size / (1024.0 * 1024.0),
+               s->inserts_per_sec, s->grow_ms);
+    }
+    printf("=====================================================================\n");
+    printf("%u inserts overall: %.0f/s growing, %.0f/s presized\n", count, growing_per_sec, presized_per_sec);
+    printf("Growth copies everything after the records and syncs the file.\n");
+
+    printf("=== BENCHMARK COMPLETE ===\n");
+    return 0;
+}
@@ -0,0 +1,173 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "mmap_shared.h"
+
+// Test configuration
+#define BENCH_DB_PATH "/tmp/benchmark_index.dat"
+#define INDEX_LOOKUPS 1000000 // Random lookups through each index
+#define SCAN_MS 500           // Linear scans run for this long
+
+static const uint32_t record_counts[] = {10000, 100000, 1000000};
+#define NUM_COUNTS (int)(sizeof(record_counts) / sizeof(record_counts[0]))
+
+// ===== RESULTS ===== //
+typedef struct
+{
+    uint32_t records;
+    double by_id;      // Lookups per second through the id index
+    double by_name;    // Lookups per second through the name index
+    double scan_id;    // Lookups per second comparing ids from the first record on
+    double scan_name;  // Lookups per second comparing names from the first record on
+} index_result_t;
+
+// ===== TIMING UTILITY ===== //
+uint64_t get_time_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Keeps the lookup loops from being optimized away
+static volatile uint64_t sink;
+
+static void record_name(char *name, uint32_t i)
+{
+    snprintf(name, 64, "Indexed Record %u", i);
+}
+
+// The old way: walk the records until one matches
+static const record_t *scan_by_id(const mmap_database_t *db, uint32_t id)
+{
+    uint32_t count = mmap_db_record_count(db);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (db->records[i].id == id)
+        {
+            return &db->records[i];
+        }
+    }
+    return NULL;
+}
+
+static const record_t *scan_by_name(const mmap_database_t *db, const char *name)
+{
+    uint32_t count = mmap_db_record_count(db);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (strcmp(db->records[i].name, name) == 0)
+        {
+            return &db->records[i];
+        }
+    }
+    return NULL;
+}
+
+index_result_t benchmark_records(uint32_t count)
+{
+    mmap_db_t handle;
+    if (mmap_db_create(&handle, BENCH_DB_PATH, mmap_db_file_size(count), NULL, 0) != 0)
+    {
+        printf("Failed to create the database\n");
+        exit(1);
+    }
+    mmap_database_t *db = handle.db;
+
+    char name[64];
+    for (uint32_t i = 0; i < count; i++)
+    {
+        record_name(name, i);
+        if (mmap_db_add_record(&handle, name, i, NULL) != 0)
+        {
+            printf("Insert failed\n");
+            exit(1);
+        }
+    }
+
+    // The same random keys for every method
+    uint32_t *keys = malloc(INDEX_LOOKUPS * sizeof(uint32_t));
+    srand(42);
+    for (int i = 0; i < INDEX_LOOKUPS; i++)
+    {
+        keys[i] = (uint32_t)(((uint64_t)rand() * RAND_MAX + rand()) % count);
+    }
+
+    index_result_t result;
+    result.records = count;
+    uint64_t found = 0;
+
+    uint64_t start = get_time_ns();
+    for (int i = 0; i < INDEX_LOOKUPS; i++)
+    {
+        found += mmap_db_find_by_id(db, keys[i] + 1) != NULL;
+    }
+    result.by_id = INDEX_LOOKUPS / ((get_time_ns() - start) / 1e9);
+
+    start = get_time_ns();
+    for (int i = 0; i < INDEX_LOOKUPS; i++)
+    {
+        record_name(name, keys[i]);
+        found += mmap_db_find_by_name(db, name) != NULL;
+    }
+    result.by_name = INDEX_LOOKUPS / ((get_time_ns() - start) / 1e9);
+
+    // Scans are too slow for the full key set at large sizes; run them for a while
+    uint64_t lookups = 0;
+    start = get_time_ns();
+    uint64_t end = start + SCAN_MS * 1000000ULL;
+    while (get_time_ns() < end && lookups < INDEX_LOOKUPS)
+    {
+        found += scan_by_id(db, keys[lookups++] + 1) != NULL;
+    }
+    result.scan_id = lookups / ((get_time_ns() - start) / 1e9);
+
+    lookups = 0;
+    start = get_time_ns();
+    end = start + SCAN_MS * 1000000ULL;
+    while (get_time_ns() < end && lookups < INDEX_LOOKUPS)
+    {
+        record_name(name, keys[lookups++]);
+        found += scan_by_name(db, name) != NULL;
+    }
+    result.scan_name = lookups / ((get_time_ns() - start) / 1e9);
+    sink = found;
+
+    free(keys);
+    mmap_db_close(&handle);
+    unlink(BENCH_DB_PATH);
+    return result;
+}
+
+int main()
+{
+    printf("===== HASH INDEX BENCHMARK =====\n");
+    printf("%d random lookups per index, linear scans for up to %dms\n", INDEX_LOOKUPS, SCAN_MS);
+    printf("--------------------------------\n");
+
+    index_result_t results[NUM_COUNTS];
+    for (int i = 0; i < NUM_COUNTS; i++)
+    {
+        printf("Testing %u records...\n", record_counts[i]);
+        results[i] = benchmark_records(record_counts[i]);
+    }
+
+    printf("\n=====================================================================\n");
+    printf("                 LOOKUPS PER SECOND: INDEX VS LINEAR SCAN\n");
+    printf("=====================================================================\n");
+    printf("   Records |   Index id | Index name |    Scan id |  Scan name\n");
+    printf("-----------|------------|------------|------------|-----------\n");
+    for (int i = 0; i < NUM_COUNTS; i++)
+    {
+        index_result_t *r = &results[i];
+        printf("%10u | %10.0f | %10.0f | %10.0f | %10.0f\n", r->records, r->by_id, r->by_name, r->scan_id,
+               r->scan_name);
+    }
+    printf("=====================================================================\n");
+    printf("Name lookups include formatting the key.\n");
+
+    printf("=== BENCHMARK COMPLETE ===\n");
+    return 0;
+}
@@ -0,0 +1,238 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/wait.h>
+#include "shared_memory.h"
+#include "mpmc_queue_shared.h"
+
+// Test configuration
+#define BENCH_SHM_NAME "/bench_mpmc_queue_shared_memory"
+#define QUEUE_CELLS 4096
+#define RUN_MS 250 // Each configuration runs for this long
+#define MAX_PROCESSES 16
+#define BATCH_SIZE 8
+
+static const int process_counts[] = {1, 2, 4, 8, 16};
+#define NUM_COUNTS (int)(sizeof(process_counts) / sizeof(process_counts[0]))
+
+// ===== RESULTS ===== //
+typedef struct
+{
+    double ops_per_sec;       // Items moved from producers to consumers
+    double consumer_fairness; // Jain's index over items each consumer got (1 = perfectly even)
+    double producer_fairness; // Jain's index over items each producer got in
+} mpmc_result_t;
+
+// Per-process counters, written once by each child on exit
+typedef struct
+{
+    atomic_bool go;
+    uint64_t pushed[MAX_PROCESSES];
+    uint64_t popped[MAX_PROCESSES];
+} run_stats_t;
+
+// ===== TIMING UTILITY ===== //
+uint64_t get_time_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Jain's fairness index: (sum x)^2 / (n * sum x^2)
+static double jain_index(const uint64_t *counts, int n)
+{
+    double sum = 0, sum_sq = 0;
+    for (int i = 0; i < n; i++)
+    {
+        sum += counts[i];
+        sum_sq += (double)counts[i] * counts[i];
+    }
+    return sum_sq > 0 ? (sum * sum) / (n * sum_sq) : 0;
+}
+
+// Sleep rather than spin until the start signal, so no process has been
+// deprioritized by the scheduler for yielding before the run begins
+static void wait_for_start(run_stats_t *stats)
+{
+    while (!atomic_load_explicit(&stats->go, memory_order_acquire))
+    {
+        usleep(100);
+    }
+}
+
+// Back off when the queue is full or empty. A short sleep rather than
+// sched_yield, which the scheduler answers by pushing the yielding process
+// to the back, starving it next to peers that rarely have to wait.
+static void backoff(void)
+{
+    usleep(1);
+}
+
+// ===== PROCESSES ===== //
+static void run_producer(mpmc_queue_t *queue, run_stats_t *stats, int id)
+{
+    wait_for_start(stats);
+
+    uint64_t pushed = 0;
+    uint64_t item[2] = {(uint64_t)id, 0};
+    while (!atomic_load_explicit(&queue->shutdown_flag, memory_order_relaxed))
+    {
+        if (mpmc_queue_push(queue, item, sizeof(item)))
+        {
+            item[1]++;
+            pushed++;
+        }
+        else
+        {
+            backoff();
+        }
+    }
+    stats->pushed[id] = pushed;
+    _exit(0);
+}
+
+static void run_consumer(mpmc_queue_t *queue, run_stats_t *stats, int id)
+{
+    wait_for_start(stats);
+
+    uint8_t batch[BATCH_SIZE][MPMC_CELL_DATA_SIZE];
+    uint32_t lengths[BATCH_SIZE];
+    uint64_t popped = 0;
+    while (!atomic_load_explicit(&queue->shutdown_flag, memory_order_relaxed))
+    {
+        size_t count = mpmc_queue_pop_batch(queue, batch, lengths, BATCH_SIZE);
+        if (count == 0)
+        {
+            backoff();
+        }
+        popped += count;
+    }
+    stats->popped[id] = popped;
+    _exit(0);
+}
+
+// ===== BENCHMARK ===== //
+mpmc_result_t benchmark_config(mpmc_queue_t *queue, run_stats_t *stats, int producers, int consumers)
+{
+    mpmc_queue_init(queue, QUEUE_CELLS);
+    memset(stats, 0, sizeof(*stats));
+
+    pid_t pids[2 * MAX_PROCESSES];
+    int count = 0;
+    for (int p = 0; p < producers; p++)
+    {
+        if ((pids[count++] = fork()) == 0)
+        {
+            run_producer(queue, stats, p);
+        }
+    }
+    for (int c = 0; c < consumers; c++)
+    {
+        if ((pids[count++] = fork()) == 0)
+        {
+            run_consumer(queue, stats, c);
+        }
+    }
+
+    // Start everyone together, let them contend, then stop them
+    uint64_t start = get_time_ns();
+    atomic_store_explicit(&stats->go, true, memory_order_release);
+    usleep(RUN_MS * 1000);
+    atomic_store(&queue->shutdown_flag, true);
+    uint64_t elapsed = get_time_ns() - start;
+
+    for (int i = 0; i < count; i++)
+    {
+        waitpid(pids[i], NULL, 0);
+    }
+
+    uint64_t total = 0;
+    for (int c = 0; c < consumers; c++)
+    {
+        total += stats->popped[c];
+    }
+
+    mpmc_result_t result;
+    result.ops_per_sec = total / (elapsed / 1e9);
+    result.consumer_fairness = jain_index(stats->popped, consumers);
+    result.producer_fairness = jain_index(stats->pushed, producers);
+    return result;
+}
+
+static void print_grid(const char *title, mpmc_result_t results[NUM_COUNTS][NUM_COUNTS], int which)
+{
+    printf("\n================================================================\n");
+    printf("%s\n", title);
+    printf("================================================================\n");
+    printf("Prod \\ Cons |");
+    for (int c = 0; c < NUM_COUNTS; c++)
+    {
+        printf(" %8d |", process_counts[c]);
+    }
+    printf("\n------------|");
+    for (int c = 0; c < NUM_COUNTS; c++)
+    {
+        printf("----------|");
+    }
+    printf("\n");
+    for (int p = 0; p < NUM_COUNTS; p++)
+    {
+        printf("%11d |", process_counts[p]);
+        for (int c = 0; c < NUM_COUNTS; c++)
+        {
+            mpmc_result_t *r = &results[p][c];
+            double value = which == 0 ? r->ops_per_sec / 1e6 : which == 1 ? r->consumer_fairness : r->producer_fairness;
+            printf(" %8.2f |", value);
+        }
+        printf("\n");
+    }
+    printf("================================================================\n");
+}
+
+int main()
+{
+    printf("===== MPMC QUEUE CONTENTION BENCHMARK =====\n");
+    printf("%d-cell queue, %dms per configuration, consumers pull batches of up to %d\n",
+           QUEUE_CELLS, RUN_MS, BATCH_SIZE);
+    printf("Online CPUs: %ld\n", sysconf(_SC_NPROCESSORS_ONLN));
+    printf("--------------------------------------------\n");
+
+    shared_memory_t shm = {0};
+    if (shared_memory_create(&shm, BENCH_SHM_NAME, mpmc_queue_shm_size(QUEUE_CELLS)) != 0)
+    {
+        printf("Failed to create shared memory\n");
+        return 1;
+    }
+    mpmc_queue_t *queue = (mpmc_queue_t *)shm.addr;
+
+    // The children report their counts here
+    run_stats_t *stats = mmap(NULL, sizeof(run_stats_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANON, -1, 0);
+    if (stats == MAP_FAILED)
+    {
+        perror("mmap");
+        shared_memory_destroy(&shm, 1);
+        return 1;
+    }
+
+    static mpmc_result_t results[NUM_COUNTS][NUM_COUNTS];
+    for (int p = 0; p < NUM_COUNTS; p++)
+    {
+        for (int c = 0; c < NUM_COUNTS; c++)
+        {
+            printf("Testing %d producer(s) x %d consumer(s)...\n", process_counts[p], process_counts[c]);
+            results[p][c] = benchmark_config(queue, stats, process_counts[p], process_counts[c]);
+        }
+    }
+
+    print_grid("              THROUGHPUT (MILLION ITEMS/S)", results, 0);
+    print_grid("       CONSUMER FAIRNESS (JAIN'S INDEX, 1.00 = EVEN)", results, 1);
+    print_grid("       PRODUCER FAIRNESS (JAIN'S INDEX, 1.00 = EVEN)", results, 2);
+
+    munmap(stats, sizeof(run_stats_t));
+    shared_memory_destroy(&shm, 1);
+
+    printf("=== BENCHMARK COMPLETE ===\n");
+    return 0;
+}
@@ -0,0 +1,147 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <sys/wait.h>
+#include "shared_memory.h"
+#include "mpsc_ring_shared.h"
+
+// Test configuration
+#define BENCH_SHM_NAME "/bench_mpsc_ring_shared_memory"
+#define TOTAL_MESSAGES 4000000 // Split evenly between the producers
+#define RING_SLOTS 4096
+#define MAX_PRODUCERS 16
+
+static const int producer_counts[] = {1, 2, 4, 8, 16};
+#define NUM_COUNTS (int)(sizeof(producer_counts) / sizeof(producer_counts[0]))
+
+// ===== RESULTS ===== //
+typedef struct
+{
+    int producers;
+    double messages_per_sec;
+    int out_of_order; // Messages that arrived out of order for their producer
+} mpsc_result_t;
+
+// ===== TIMING UTILITY ===== //
+uint64_t get_time_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// ===== PRODUCER PROCESS ===== //
+static void run_producer(mpsc_ring_t *ring, uint32_t id, uint64_t count)
+{
+    for (uint64_t i = 0; i < count; i++)
+    {
+        while (!mpsc_ring_send(ring, id, &i, sizeof(i)))
+        {
+            sched_yield();
+        }
+    }
+    _exit(0);
+}
+
+// ===== BENCHMARK ===== //
+mpsc_result_t benchmark_producers(mpsc_ring_t *ring, int producers)
+{
+    mpsc_result_t result = {.producers = producers};
+    uint64_t per_producer = TOTAL_MESSAGES / producers;
+    uint64_t total = per_producer * producers;
+
+    mpsc_ring_init(ring, RING_SLOTS);
+
+    uint64_t start = get_time_ns();
+
+    pid_t pids[MAX_PRODUCERS];
+    for (int p = 0; p < producers; p++)
+    {
+        pids[p] = fork();
+        if (pids[p] == 0)
+        {
+            run_producer(ring, p, per_producer);
+        }
+    }
+
+    // Consume everything, checking each producer's messages stay in order
+    uint64_t next[MAX_PRODUCERS] = {0};
+    for (uint64_t received = 0; received < total;)
+    {
+        mpsc_slot_t *slot = mpsc_ring_peek(ring);
+        if (slot == NULL)
+        {
+            sched_yield();
+            continue;
+        }
+
+        uint64_t value;
+        memcpy(&value, slot->data, sizeof(value));
+        if (value != next[slot->producer])
+        {
+            result.out_of_order++;
+        }
+        next[slot->producer] = value + 1;
+        mpsc_ring_release(ring, slot);
+        received++;
+    }
+
+    uint64_t elapsed = get_time_ns() - start;
+    for (int p = 0; p < producers; p++)
+    {
+        waitpid(pids[p], NULL, 0);
+    }
+
+    result.messages_per_sec = total / (elapsed / 1e9);
+    return result;
+}
+
+void print_results(mpsc_result_t *results)
+{
+    printf("\n================================================================\n");
+    printf("             MPSC RING THROUGHPUT VS PRODUCER PROCESSES            \n");
+    printf("================================================================\n");
+    printf("Producers | Million msgs/s | Scaling vs 1 | Out of order\n");
+    printf("----------|----------------|--------------|-------------\n");
+    for (int i = 0; i < NUM_COUNTS; i++)
+    {
+        printf("%9d | %14.2f | %11.2fx | %12d\n",
+               results[i].producers, results[i].messages_per_sec / 1e6,
+               results[i].messages_per_sec / results[0].messages_per_sec, results[i].out_of_order);
+    }
+    printf("================================================================\n");
+    printf("One consumer drains all producers; it is the ceiling once producers outrun it.\n");
+}
+
+int main()
+{
+    printf("===== MPSC RING BENCHMARK =====\n");
+    printf("%d messages of %zu bytes through a %d-slot ring, split across N producer processes\n",
+           TOTAL_MESSAGES, sizeof(mpsc_slot_t), RING_SLOTS);
+    printf("Online CPUs: %ld\n", sysconf(_SC_NPROCESSORS_ONLN));
+    printf("--------------------------------------------\n");
+
+    shared_memory_t shm = {0};
+    if (shared_memory_create(&shm, BENCH_SHM_NAME, mpsc_ring_shm_size(RING_SLOTS)) != 0)
+    {
+        printf("Failed to create shared memory\n");
+        return 1;
+    }
+    mpsc_ring_t *ring = (mpsc_ring_t *)shm.addr;
+
+    mpsc_result_t results[NUM_COUNTS];
+    for (int i = 0; i < NUM_COUNTS; i++)
+    {
+        printf("Testing %d producer(s)...\n", producer_counts[i]);
+        results[i] = benchmark_producers(ring, producer_counts[i]);
+    }
+
+    print_results(results);
+
+    shared_memory_destroy(&shm, 1);
+
+    printf("=== BENCHMARK COMPLETE ===\n");
+    return 0;
+}
@@ -0,0 +1,215 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "mmap_shared.h"
+
+// Test configuration
+#define BENCH_DB_PATH "/tmp/benchmark_mvcc.dat"
+#define NUM_RECORDS 100000
+#define READS_PER_QUERY 16 // Records read under one snapshot or one lock
+#define RUN_MS 1000        // Readers run for this long while the writer keeps updating
+
+static const int reader_counts[] = {1, 2, 4, 8};
+#define NUM_READER_COUNTS (int)(sizeof(reader_counts) / sizeof(reader_counts[0]))
+
+// ===== RESULTS ===== //
+typedef struct
+{
+    double reads_per_sec;   // All readers together
+    double updates_per_sec; // The writer, meanwhile
+} mvcc_result_t;
+
+typedef struct
+{
+    int readers;
+    mvcc_result_t snapshot; // Pin an epoch, copy records out, never block
+    mvcc_result_t mutex;    // Take the database mutex around the reads
+} reader_result_t;
+
+// Counters shared between the benchmark's processes
+typedef struct
+{
+    atomic_int stop_writer;
+    atomic_uint_least64_t updates;
+    atomic_uint_least64_t reads;
+} bench_shared_t;
+
+// ===== TIMING UTILITY ===== //
+uint64_t get_time_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Writer: update random records until told to stop
+static void run_writer(bench_shared_t *shared)
+{
+    mmap_db_t handle;
+    if (mmap_db_open(&handle, BENCH_DB_PATH, NULL, 0) != 0)
+    {
+        _exit(1);
+    }
+    uint64_t updates = 0;
+    srand(getpid());
+    while (!atomic_load(&shared->stop_writer))
+    {
+        uint32_t id = rand() % NUM_RECORDS + 1;
+        updates += mmap_db_update_record(&handle, id, rand() % 10000 / 100.0, true, NULL) == 0;
+    }
+    atomic_store(&shared->updates, updates);
+    mmap_db_close(&handle);
+    _exit(0);
+}
+
+// Reader: read random records for RUN_MS, with snapshots or under the mutex
+static void run_reader(bench_shared_t *shared, int use_snapshot)
+{
+    mmap_db_t handle;
+    if (mmap_db_open(&handle, BENCH_DB_PATH, NULL, 0) != 0)
+    {
+        _exit(1);
+    }
+    mmap_database_t *db = handle.db;
+
+    uint64_t reads = 0;
+    double checksum = 0;
+    srand(getpid());
+    uint64_t end = get_time_ns() + RUN_MS * 1000000ULL;
+    while (get_time_ns() < end)
+    {
+        record_t record;
+        if (use_snapshot)
+        {
+            mmap_db_snapshot_t snapshot;
+            if (mmap_db_snapshot_begin(&handle, &snapshot) != 0)
+            {
+                _exit(1);
+            }
+            for (int i = 0; i < READS_PER_QUERY; i++)
+            {
+                mmap_db_snapshot_read(&snapshot, rand() % NUM_RECORDS, &record);
+                checksum += record.value;
+            }
+            mmap_db_snapshot_end(&snapshot);
+        }
+        else
+        {
+            pthread_mutex_lock(&db->mutex);
+            for (int i = 0; i < READS_PER_QUERY; i++)
+            {
+                record = db->records[rand() % NUM_RECORDS];
+                checksum += record.value;
+            }
+            pthread_mutex_unlock(&db->mutex);
+        }
+        reads += READS_PER_QUERY;
+    }
+
+    atomic_fetch_add(&shared->reads, reads + (checksum < 0)); // Keep the reads
+    mmap_db_close(&handle);
+    _exit(0);
+}
+
+mvcc_result_t benchmark_readers(bench_shared_t *shared, int readers, int use_snapshot)
+{
+    atomic_store(&shared->stop_writer, 0);
+    atomic_store(&shared->updates, 0);
+    atomic_store(&shared->reads, 0);
+
+    pid_t writer = fork();
+    if (writer == 0)
+    {
+        run_writer(shared);
+    }
+
+    uint64_t start = get_time_ns();
+    pid_t pids[8];
+    for (int r = 0; r < readers; r++)
+    {
+        pids[r] = fork();
+        if (pids[r] == 0)
+        {
+            run_reader(shared, use_snapshot);
+        }
+    }
+    for (int r = 0; r < readers; r++)
+    {
+        waitpid(pids[r], NULL, 0);
+    }
+    uint64_t elapsed = get_time_ns() - start;
+
+    atomic_store(&shared->stop_writer, 1);
+    waitpid(writer, NULL, 0);
+
+    mvcc_result_t result;
+    result.reads_per_sec = atomic_load(&shared->reads) / (elapsed / 1e9);
+    result.updates_per_sec = atomic_load(&shared->updates) / (elapsed / 1e9);
+    return result;
+}
+
+int main()
+{
+    printf("===== MVCC READ SCALING BENCHMARK =====\n");
+    printf("%d records, %d random reads per query, one writer updating flat out, %dms per run\n", NUM_RECORDS,
+           READS_PER_QUERY, RUN_MS);
+    printf("Online CPUs: %ld\n", sysconf(_SC_NPROCESSORS_ONLN));
+    printf("---------------------------------------\n");
+
+    // Fill the database once; every run updates the same records
+    mmap_db_t handle;
+    if (mmap_db_create(&handle, BENCH_DB_PATH, mmap_db_file_size(NUM_RECORDS), NULL, 0) != 0)
+    {
+        printf("Failed to create the database\n");
+        return 1;
+    }
+    for (uint32_t i = 0; i < NUM_RECORDS; i++)
+    {
+        if (mmap_db_add_record(&handle, "MVCC Record", i, NULL) != 0)
+        {
+            printf("Insert failed\n");
+            return 1;
+        }
+    }
+    mmap_db_close(&handle);
+
+    bench_shared_t *shared = mmap(NULL, sizeof(bench_shared_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS,
+                                  -1, 0);
+    if (shared == MAP_FAILED)
+    {
+        perror("Failed to map counters");
+        return 1;
+    }
+
+    reader_result_t results[NUM_READER_COUNTS];
+    for (int i = 0; i < NUM_READER_COUNTS; i++)
+    {
+        printf("Testing %d readers...\n", reader_counts[i]);
+        results[i].readers = reader_counts[i];
+        results[i].snapshot = benchmark_readers(shared, reader_counts[i], 1);
+        results[i].mutex = benchmark_readers(shared, reader_counts[i], 0);
+    }
+
+    printf("\n=====================================================================\n");
+    printf("              READS PER SECOND WHILE A WRITER UPDATES\n");
+    printf("=====================================================================\n");
+    printf("Readers | Snapshot reads/s | Updates/s | Mutex reads/s | Updates/s\n");
+    printf("--------|------------------|-----------|---------------|----------\n");
+    for (int i = 0; i < NUM_READER_COUNTS; i++)
+    {
+        reader_result_t *r = &results[i];
+        printf("%7d | %16.0f | %9.0f | %13.0f | %9.0f\n", r->readers, r->snapshot.reads_per_sec,
+               r->snapshot.updates_per_sec, r->mutex.reads_per_sec, r->mutex.updates_per_sec);
+    }
+    printf("=====================================================================\n");
+    printf("Snapshot reads only scale with readers given a core for each.\n");
+
+    munmap(shared, sizeof(bench_shared_t));
+    unlink(BENCH_DB_PATH);
+    printf("=== BENCHMARK COMPLETE ===\n");
+    return 0;
+}
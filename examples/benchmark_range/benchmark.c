@@ -0,0 +1,176 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "mmap_shared.h"
+
+// Test configuration
+#define BENCH_DB_PATH "/tmp/benchmark_range.dat"
+#define VALUE_RANGE 1000000.0 // Values are uniform in [0, VALUE_RANGE)
+#define MAX_QUERIES 100000    // Queries per method and width, at most
+#define RUN_MS 500            // ...or for this long, at least one query
+
+static const uint32_t record_counts[] = {1000000, 10000000};
+#define NUM_COUNTS (int)(sizeof(record_counts) / sizeof(record_counts[0]))
+
+// Width of each query range, as a fraction of all values
+static const double widths[] = {0.00001, 0.001, 0.1};
+#define NUM_WIDTHS (int)(sizeof(widths) / sizeof(widths[0]))
+
+// ===== RESULTS ===== //
+typedef struct
+{
+    double tree_per_sec; // Queries per second through the value tree
+    double scan_per_sec; // Queries per second scanning every record
+    double matches;      // Active records per query
+} range_result_t;
+
+typedef struct
+{
+    uint32_t records;
+    double inserts_per_sec; // Inserts, hash indexes and tree included
+    range_result_t widths[NUM_WIDTHS];
+} count_result_t;
+
+// ===== TIMING UTILITY ===== //
+uint64_t get_time_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Keeps the query loops from being optimized away
+static volatile uint64_t sink;
+
+static double random_value()
+{
+    return (double)rand() / ((double)RAND_MAX + 1) * VALUE_RANGE;
+}
+
+// Active records with value in [low, high], through the tree
+static uint64_t tree_query(const mmap_database_t *db, double low, double high)
+{
+    mmap_db_range_t range;
+    mmap_db_range_begin(&range, db, low, high);
+    const record_t *record;
+    uint64_t matches = 0;
+    while ((record = mmap_db_range_next(&range)) != NULL)
+    {
+        matches += record->is_active;
+    }
+    return matches;
+}
+
+// The old way: look at every record
+static uint64_t scan_query(const mmap_database_t *db, double low, double high)
+{
+    uint64_t matches = 0;
+    uint32_t count = mmap_db_record_count(db);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const record_t *record = &db->records[i];
+        matches += record->is_active && record->value >= low && record->value <= high;
+    }
+    return matches;
+}
+
+// Run query on random ranges of width for RUN_MS; returns queries per second
+static double run_queries(const mmap_database_t *db, double width,
+                          uint64_t (*query)(const mmap_database_t *, double, double), double *matches)
+{
+    uint64_t queries = 0, total = 0;
+    uint64_t start = get_time_ns();
+    uint64_t end = start + RUN_MS * 1000000ULL;
+    srand(42);
+    do
+    {
+        double low = random_value() * (1 - width);
+        total += query(db, low, low + width * VALUE_RANGE);
+        queries++;
+    } while (get_time_ns() < end && queries < MAX_QUERIES);
+    uint64_t elapsed = get_time_ns() - start;
+
+    sink = total;
+    *matches = (double)total / queries;
+    return queries / (elapsed / 1e9);
+}
+
+count_result_t benchmark_records(uint32_t count)
+{
+    mmap_db_t handle;
+    if (mmap_db_create(&handle, BENCH_DB_PATH, mmap_db_file_size(count), NULL, 0) != 0)
+    {
+        printf("Failed to create the database\n");
+        exit(1);
+    }
+    mmap_database_t *db = handle.db;
+
+    count_result_t result;
+    result.records = count;
+
+    srand(7);
+    uint64_t start = get_time_ns();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (mmap_db_add_record(&handle, "Ranged Record", random_value(), NULL) != 0)
+        {
+            printf("Insert failed\n");
+            exit(1);
+        }
+    }
+    result.inserts_per_sec = count / ((get_time_ns() - start) / 1e9);
+
+    for (int w = 0; w < NUM_WIDTHS; w++)
+    {
+        range_result_t *r = &result.widths[w];
+        double scan_matches;
+        r->tree_per_sec = run_queries(db, widths[w], tree_query, &r->matches);
+        r->scan_per_sec = run_queries(db, widths[w], scan_query, &scan_matches);
+    }
+
+    mmap_db_close(&handle);
+    unlink(BENCH_DB_PATH);
+    return result;
+}
+
+int main()
+{
+    printf("===== RANGE QUERY BENCHMARK =====\n");
+    printf("Active records with value in a random range, up to %d queries or %dms per run\n", MAX_QUERIES,
+           RUN_MS);
+    printf("---------------------------------\n");
+
+    count_result_t results[NUM_COUNTS];
+    for (int i = 0; i < NUM_COUNTS; i++)
+    {
+        printf("Testing %u records (%zu MB file)...\n", record_counts[i],
+               mmap_db_file_size(record_counts[i]) / (1024 * 1024));
+        results[i] = benchmark_records(record_counts[i]);
+    }
+
+    printf("\n=====================================================================\n");
+    printf("                 RANGE QUERIES PER SECOND: TREE VS SCAN\n");
+    printf("=====================================================================\n");
+    printf("   Records | Width (%%) | Matches |   Tree queries/s |   Scan queries/s\n");
+    printf("-----------|-----------|---------|------------------|-----------------\n");
+    for (int i = 0; i < NUM_COUNTS; i++)
+    {
+        for (int w = 0; w < NUM_WIDTHS; w++)
+        {
+            range_result_t *r = &results[i].widths[w];
+            printf("%10u | %9.3f | %7.0f | %16.0f | %16.2f\n", results[i].records, widths[w] * 100, r->matches,
+                   r->tree_per_sec, r->scan_per_sec);
+        }
+    }
+    printf("=====================================================================\n");
+    for (int i = 0; i < NUM_COUNTS; i++)
+    {
+        printf("%u inserts: %.0f/s with both hash indexes and the tree\n", results[i].records,
+               results[i].inserts_per_sec);
+    }
+
+    printf("=== BENCHMARK COMPLETE ===\n");
+    return 0;
+}
@@ -0,0 +1,198 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include "shared_memory.h"
+#include "shm_registry.h"
+
+// Test configuration
+#define CHANNEL_SIZE 4096 // Bytes of storage per channel
+#define REPEATS 5         // Attach passes per channel count, best one is reported
+#define MAX_CHANNELS 1024
+
+static const int channel_counts[] = {1, 16, 64, 256, 1024};
+#define NUM_COUNTS (int)(sizeof(channel_counts) / sizeof(channel_counts[0]))
+
+// ===== RESULTS ===== //
+typedef struct
+{
+    int channels;
+    double separate_us; // One shm_open + mmap per channel
+    double registry_us; // One registry mapping + a lookup per channel
+    int separate_fds;
+    int registry_fds;
+} attach_result_t;
+
+// ===== TIMING UTILITY ===== //
+uint64_t get_time_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void channel_name(char *buf, size_t len, int i)
+{
+    snprintf(buf, len, "/bench_channel_%d", i);
+}
+
+// ===== SEPARATE SEGMENTS ===== //
+double benchmark_separate(int count)
+{
+    static shared_memory_t owners[MAX_CHANNELS];
+    static shared_memory_t peers[MAX_CHANNELS];
+    static char names[MAX_CHANNELS][SHM_CHANNEL_NAME_LENGTH];
+
+    for (int i = 0; i < count; i++)
+    {
+        channel_name(names[i], sizeof(names[i]), i);
+        if (shared_memory_create(&owners[i], names[i], CHANNEL_SIZE) != 0)
+        {
+            printf("Failed to create channel %d\n", i);
+            exit(1);
+        }
+    }
+
+    double best_us = 0;
+    for (int repeat = 0; repeat < REPEATS; repeat++)
+    {
+        // Attach the way the examples do: open, map and touch every channel
+        uint64_t start_time = get_time_ns();
+        for (int i = 0; i < count; i++)
+        {
+            if (shared_memory_open(&peers[i], names[i]) != 0)
+            {
+                exit(1);
+            }
+            ((volatile char *)peers[i].addr)[0];
+        }
+        double elapsed_us = (get_time_ns() - start_time) / 1e3;
+
+        for (int i = 0; i < count; i++)
+        {
+            shared_memory_destroy(&peers[i], 0);
+        }
+        if (repeat == 0 || elapsed_us < best_us)
+        {
+            best_us = elapsed_us;
+        }
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        shared_memory_destroy(&owners[i], 1);
+    }
+
+    return best_us;
+}
+
+// ===== REGISTRY ===== //
+double benchmark_registry(int count)
+{
+    char name[SHM_CHANNEL_NAME_LENGTH];
+    size_t registry_size = (size_t)MAX_CHANNELS * CHANNEL_SIZE * 2 + 1024 * 1024;
+
+    shm_registry_t owner = {0};
+    if (shm_registry_create(&owner, SHM_REGISTRY_NAME, registry_size, MAX_CHANNELS) != 0)
+    {
+        printf("Failed to create registry\n");
+        exit(1);
+    }
+    for (int i = 0; i < count; i++)
+    {
+        channel_name(name, sizeof(name), i);
+        if (shm_registry_add(&owner, name, 0, CHANNEL_SIZE) == NULL)
+        {
+            printf("Failed to add channel %d\n", i);
+            exit(1);
+        }
+    }
+
+    double best_us = 0;
+    for (int repeat = 0; repeat < REPEATS; repeat++)
+    {
+        // One mapping for everything, then a directory lookup per channel
+        uint64_t start_time = get_time_ns();
+        shm_registry_t peer = {0};
+        if (shm_registry_open(&peer, SHM_REGISTRY_NAME) != 0)
+        {
+            exit(1);
+        }
+        for (int i = 0; i < count; i++)
+        {
+            channel_name(name, sizeof(name), i);
+            const shm_channel_desc_t *desc = shm_registry_lookup(&peer, name, NULL);
+            if (desc == NULL)
+            {
+                exit(1);
+            }
+            ((volatile char *)shm_registry_channel(&peer, desc))[0];
+        }
+        double elapsed_us = (get_time_ns() - start_time) / 1e3;
+
+        shm_registry_close(&peer, 0);
+        if (repeat == 0 || elapsed_us < best_us)
+        {
+            best_us = elapsed_us;
+        }
+    }
+
+    shm_registry_close(&owner, 1);
+
+    return best_us;
+}
+
+// ===== PRINT RESULTS ===== //
+void print_results(attach_result_t *results, int count)
+{
+    printf("\n================================================================\n");
+    printf("                   ATTACH TIME VS CHANNEL COUNT                   \n");
+    printf("================================================================\n");
+    printf("Channels | Separate (µs) | Registry (µs) | Speedup | fds (sep/reg)\n");
+    printf("---------|---------------|---------------|---------|--------------\n");
+    for (int i = 0; i < count; i++)
+    {
+        printf("%8d | %13.1f | %13.1f | %6.1fx | %6d/%d\n",
+               results[i].channels, results[i].separate_us, results[i].registry_us,
+               results[i].registry_us > 0 ? results[i].separate_us / results[i].registry_us : 0,
+               results[i].separate_fds, results[i].registry_fds);
+    }
+    printf("================================================================\n");
+}
+
+// ===== MAIN ===== //
+int main(void)
+{
+    // Separate segments keep two fds per channel open at the largest count
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < 2 * MAX_CHANNELS + 64)
+    {
+        limit.rlim_cur = limit.rlim_max < 2 * MAX_CHANNELS + 64 ? limit.rlim_max : 2 * MAX_CHANNELS + 64;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    printf("===== CHANNEL REGISTRY BENCHMARK =====\n");
+    printf("Attaching to N channels of %d bytes: one segment per channel vs one registry\n",
+           CHANNEL_SIZE);
+    printf("--------------------------------------------\n");
+
+    attach_result_t results[NUM_COUNTS];
+    for (int i = 0; i < NUM_COUNTS; i++)
+    {
+        int count = channel_counts[i];
+        printf("Attaching to %d channels...\n", count);
+
+        results[i].channels = count;
+        results[i].separate_us = benchmark_separate(count);
+        results[i].registry_us = benchmark_registry(count);
+        results[i].separate_fds = count;
+        results[i].registry_fds = 1;
+    }
+
+    print_results(results, NUM_COUNTS);
+
+    printf("=== BENCHMARK COMPLETE ===\n");
+    return 0;
+}
@@ -0,0 +1,480 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <sys/wait.h>
+#include "shared_memory.h"
+#include "ring_buffer_shared.h"
+#include "magic_ring_shared.h"
+
+// Test configuration
+#define BENCH_RING_SHM_NAME "/bench_ring_shared_memory"
+#define BENCH_MAGIC_SHM_NAME "/bench_magic_ring_shared_memory"
+#define MESSAGES_PER_RUN 2000000
+#define MAX_MESSAGE_SIZE 1000
+#define SPSC_MESSAGES 20000000
+#define SPSC_MESSAGE_SIZE 8
+#define SPSC_BATCH 64 // Messages per reserve/commit and peek/release in the batched runs
+
+// Odd sizes so messages keep landing across the end of the buffer
+static const size_t message_sizes[] = {16, 100, 250, 1000};
+#define NUM_SIZES (int)(sizeof(message_sizes) / sizeof(message_sizes[0]))
+
+// Ring capacities for the cross-process throughput runs
+static const size_t spsc_capacities[] = {4096, 64 * 1024, 1024 * 1024, 16 * 1024 * 1024};
+#define NUM_CAPACITIES (int)(sizeof(spsc_capacities) / sizeof(spsc_capacities[0]))
+
+// ===== RESULTS ===== //
+typedef struct
+{
+    size_t message_size;
+    double masked_ns; // ring_buffer_t, byte-at-a-time copy with index masking
+    double spans_ns;  // ring_buffer_t, reserve/peek spans, split messages copied to scratch
+    double mirror_ns; // magic ring, one memcpy in and a contiguous pointer out
+} ring_result_t;
+
+typedef struct
+{
+    size_t capacity;
+    double shared_mps; // Both indices loaded with acquire on every operation
+    double cached_mps;  // Remote index only reloaded when the ring looks full or empty
+    double batched_mps; // Cached indices, one commit/release per run of up to SPSC_BATCH messages
+} spsc_result_t;
+
+typedef enum
+{
+    SPSC_SHARED,
+    SPSC_CACHED,
+    SPSC_BATCHED,
+} spsc_mode_t;
+
+// ===== TIMING UTILITY ===== //
+uint64_t get_time_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Stand-in for a parser: it needs the whole message in one piece
+static uint64_t parse_message(const uint8_t *bytes, size_t size)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < size; i++)
+    {
+        sum += bytes[i];
+    }
+    return sum;
+}
+
+// ===== CURRENT LAYOUT, MASKED BYTE LOOP ===== //
+// Each run fills the ring with whole messages, then drains it, so the
+// producer and consumer paths are both timed without scheduler noise.
+double benchmark_masked(ring_buffer_t *rb, const uint8_t *message, size_t size, uint64_t *checksum)
+{
+    uint8_t scratch[MAX_MESSAGE_SIZE];
+    uint64_t start = get_time_ns();
+
+    int sent = 0;
+    int received = 0;
+    while (received < MESSAGES_PER_RUN)
+    {
+        while (sent < MESSAGES_PER_RUN && buffer_free_space(rb) >= size)
+        {
+            uint64_t write_idx = atomic_load_explicit(&rb->write_index, memory_order_relaxed);
+            for (size_t i = 0; i < size; i++)
+            {
+                rb->data[buffer_mask(rb, write_idx + i)] = message[i];
+            }
+            atomic_store_explicit(&rb->write_index, write_idx + size, memory_order_release);
+            sent++;
+        }
+
+        while (buffer_size(rb) >= size)
+        {
+            uint64_t read_idx = atomic_load_explicit(&rb->read_index, memory_order_relaxed);
+            for (size_t i = 0; i < size; i++)
+            {
+                scratch[i] = rb->data[buffer_mask(rb, read_idx + i)];
+            }
+            atomic_store_explicit(&rb->read_index, read_idx + size, memory_order_release);
+            *checksum += parse_message(scratch, size);
+            received++;
+        }
+    }
+
+    return (double)(get_time_ns() - start) / MESSAGES_PER_RUN;
+}
+
+// ===== CURRENT LAYOUT, RESERVE/PEEK SPANS ===== //
+double benchmark_spans(ring_buffer_t *rb, const uint8_t *message, size_t size, uint64_t *checksum)
+{
+    uint8_t scratch[MAX_MESSAGE_SIZE];
+    uint64_t start = get_time_ns();
+
+    int sent = 0;
+    int received = 0;
+    ring_span_t spans[2];
+    while (received < MESSAGES_PER_RUN)
+    {
+        while (sent < MESSAGES_PER_RUN && ring_reserve(rb, size, spans))
+        {
+            memcpy(spans[0].data, message, spans[0].length);
+            memcpy(spans[1].data, message + spans[0].length, spans[1].length);
+            ring_commit(rb, size);
+            sent++;
+        }
+
+        while (ring_peek(rb, size, spans) == size)
+        {
+            // A message split by the wrap has to be stitched together first
+            const uint8_t *bytes = spans[0].data;
+            if (spans[1].length > 0)
+            {
+                memcpy(scratch, spans[0].data, spans[0].length);
+                memcpy(scratch + spans[0].length, spans[1].data, spans[1].length);
+                bytes = scratch;
+            }
+            *checksum += parse_message(bytes, size);
+            ring_release(rb, size);
+            received++;
+        }
+    }
+
+    return (double)(get_time_ns() - start) / MESSAGES_PER_RUN;
+}
+
+// ===== MIRRORED LAYOUT ===== //
+double benchmark_mirror(magic_ring_t *ring, const uint8_t *message, size_t size, uint64_t *checksum)
+{
+    uint64_t start = get_time_ns();
+
+    int sent = 0;
+    int received = 0;
+    while (received < MESSAGES_PER_RUN)
+    {
+        uint8_t *slot;
+        while (sent < MESSAGES_PER_RUN && (slot = magic_ring_reserve(ring, size)) != NULL)
+        {
+            memcpy(slot, message, size);
+            magic_ring_commit(ring, size);
+            sent++;
+        }
+
+        size_t available;
+        const uint8_t *bytes = magic_ring_peek(ring, &available);
+        while (available >= size)
+        {
+            *checksum += parse_message(bytes, size);
+            magic_ring_release(ring, size);
+            bytes = magic_ring_peek(ring, &available);
+            received++;
+        }
+    }
+
+    return (double)(get_time_ns() - start) / MESSAGES_PER_RUN;
+}
+
+// ===== CROSS-PROCESS SPSC THROUGHPUT ===== //
+// Producer side of one message: the shared read index is read every time
+static bool send_shared(ring_buffer_t *rb, uint64_t value)
+{
+    uint64_t write_idx = atomic_load_explicit(&rb->write_index, memory_order_relaxed);
+    uint64_t read_idx = atomic_load_explicit(&rb->read_index, memory_order_acquire);
+    if (rb->capacity - (write_idx - read_idx) < SPSC_MESSAGE_SIZE)
+    {
+        return false;
+    }
+
+    memcpy(&rb->data[buffer_mask(rb, write_idx)], &value, SPSC_MESSAGE_SIZE);
+    atomic_store_explicit(&rb->write_index, write_idx + SPSC_MESSAGE_SIZE, memory_order_release);
+    shm_notify(&rb->data_ready); // Same wake-up check as ring_commit
+    return true;
+}
+
+// Consumer side of one message: the shared write index is read every time
+static bool receive_shared(ring_buffer_t *rb, uint64_t *value)
+{
+    uint64_t read_idx = atomic_load_explicit(&rb->read_index, memory_order_relaxed);
+    uint64_t write_idx = atomic_load_explicit(&rb->write_index, memory_order_acquire);
+    if (write_idx == read_idx)
+    {
+        return false;
+    }
+
+    memcpy(value, &rb->data[buffer_mask(rb, read_idx)], SPSC_MESSAGE_SIZE);
+    atomic_store_explicit(&rb->read_index, read_idx + SPSC_MESSAGE_SIZE, memory_order_release);
+    shm_notify(&rb->space_ready); // Same wake-up check as ring_release
+    return true;
+}
+
+static bool send_cached(ring_buffer_t *rb, uint64_t value)
+{
+    ring_span_t spans[2];
+    if (!ring_reserve(rb, SPSC_MESSAGE_SIZE, spans))
+    {
+        return false;
+    }
+
+    // Messages divide the capacity evenly, so they are never split
+    memcpy(spans[0].data, &value, SPSC_MESSAGE_SIZE);
+    ring_commit(rb, SPSC_MESSAGE_SIZE);
+    return true;
+}
+
+static bool receive_cached(ring_buffer_t *rb, uint64_t *value)
+{
+    ring_span_t spans[2];
+    if (ring_peek(rb, SPSC_MESSAGE_SIZE, spans) == 0)
+    {
+        return false;
+    }
+
+    memcpy(value, spans[0].data, SPSC_MESSAGE_SIZE);
+    ring_release(rb, SPSC_MESSAGE_SIZE);
+    return true;
+}
+
+// Producer side of a burst: as many of the values next.. end as fit, up to
+// SPSC_BATCH, published with one commit. Returns how many were sent.
+static uint64_t send_batched(ring_buffer_t *rb, uint64_t next, uint64_t end)
+{
+    uint64_t want = end - next < SPSC_BATCH ? end - next : SPSC_BATCH;
+    ring_span_t spans[2];
+    size_t bytes = ring_reserve_up_to(rb, want * SPSC_MESSAGE_SIZE, spans);
+
+    // Messages divide the capacity evenly, so each sits whole in one span
+    for (int s = 0; s < 2; s++)
+    {
+        for (size_t offset = 0; offset < spans[s].length; offset += SPSC_MESSAGE_SIZE)
+        {
+            uint64_t value = next++;
+            memcpy(spans[s].data + offset, &value, SPSC_MESSAGE_SIZE);
+        }
+    }
+    ring_commit(rb, bytes);
+    return bytes / SPSC_MESSAGE_SIZE;
+}
+
+// Consumer side of a burst: everything ready, up to SPSC_BATCH, freed with
+// one release. Returns how many arrived, or -1 if one was out of order.
+static int64_t receive_batched(ring_buffer_t *rb, uint64_t expected)
+{
+    ring_span_t spans[2];
+    size_t bytes = ring_peek(rb, SPSC_BATCH * SPSC_MESSAGE_SIZE, spans);
+
+    for (int s = 0; s < 2; s++)
+    {
+        for (size_t offset = 0; offset < spans[s].length; offset += SPSC_MESSAGE_SIZE)
+        {
+            uint64_t value;
+            memcpy(&value, spans[s].data + offset, SPSC_MESSAGE_SIZE);
+            if (value != expected++)
+            {
+                return -1;
+            }
+        }
+    }
+    ring_release(rb, bytes);
+    return bytes / SPSC_MESSAGE_SIZE;
+}
+
+// Stream SPSC_MESSAGES sequence numbers to a forked consumer, in messages per second
+double benchmark_spsc(size_t capacity, spsc_mode_t mode)
+{
+    shared_memory_t shm = {0};
+    if (shared_memory_create(&shm, BENCH_RING_SHM_NAME, ring_buffer_shm_size(capacity)) != 0)
+    {
+        printf("Failed to create shared memory\n");
+        exit(1);
+    }
+    ring_buffer_t *rb = (ring_buffer_t *)shm.addr;
+    ring_buffer_init(rb, capacity);
+
+    uint64_t start = get_time_ns();
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        // Consumer: check every message arrives in order
+        bool cached = mode == SPSC_CACHED;
+        for (uint64_t expected = 0; expected < SPSC_MESSAGES;)
+        {
+            if (mode == SPSC_BATCHED)
+            {
+                int64_t received = receive_batched(rb, expected);
+                if (received < 0)
+                {
+                    _exit(1);
+                }
+                if (received == 0)
+                {
+                    sched_yield();
+                }
+                expected += received;
+                continue;
+            }
+
+            uint64_t value;
+            while (!(cached ? receive_cached(rb, &value) : receive_shared(rb, &value)))
+            {
+                sched_yield();
+            }
+            if (value != expected++)
+            {
+                _exit(1);
+            }
+        }
+        _exit(0);
+    }
+
+    // Producer
+    bool cached = mode == SPSC_CACHED;
+    for (uint64_t i = 0; i < SPSC_MESSAGES;)
+    {
+        if (mode == SPSC_BATCHED)
+        {
+            uint64_t sent = send_batched(rb, i, SPSC_MESSAGES);
+            if (sent == 0)
+            {
+                sched_yield();
+            }
+            i += sent;
+            continue;
+        }
+
+        while (!(cached ? send_cached(rb, i) : send_shared(rb, i)))
+        {
+            sched_yield();
+        }
+        i++;
+    }
+
+    int status;
+    waitpid(pid, &status, 0);
+    uint64_t elapsed = get_time_ns() - start;
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        printf("Consumer saw messages out of order!\n");
+    }
+
+    shared_memory_destroy(&shm, 1);
+    return SPSC_MESSAGES / (elapsed / 1e9);
+}
+
+void print_spsc_results(spsc_result_t *results)
+{
+    printf("\n================================================================\n");
+    printf("       SPSC THROUGHPUT, %d-BYTE MESSAGES (MILLION MSGS/S)          \n", SPSC_MESSAGE_SIZE);
+    printf("================================================================\n");
+    printf("Capacity (KB) | Shared indices | Cached indices |   Batched | Speedup\n");
+    printf("--------------|----------------|----------------|-----------|--------\n");
+    for (int i = 0; i < NUM_CAPACITIES; i++)
+    {
+        printf("%13zu | %14.1f | %14.1f | %9.1f | %6.1fx\n",
+               results[i].capacity / 1024, results[i].shared_mps / 1e6, results[i].cached_mps / 1e6,
+               results[i].batched_mps / 1e6, results[i].batched_mps / results[i].shared_mps);
+    }
+    printf("================================================================\n");
+}
+
+void print_results(ring_result_t *results, size_t capacity)
+{
+    printf("\n================================================================\n");
+    printf("          RING LAYOUT: TIME PER MESSAGE (WRITE + PARSE)           \n");
+    printf("================================================================\n");
+    printf("Size (B) | Masked loop (ns) | Spans (ns) | Mirrored (ns) | Speedup\n");
+    printf("---------|------------------|------------|---------------|--------\n");
+    for (int i = 0; i < NUM_SIZES; i++)
+    {
+        printf("%8zu | %16.1f | %10.1f | %13.1f | %6.1fx\n",
+               results[i].message_size, results[i].masked_ns, results[i].spans_ns,
+               results[i].mirror_ns, results[i].masked_ns / results[i].mirror_ns);
+    }
+    printf("================================================================\n");
+    printf("Speedup is the masked byte loop over the mirrored ring.\n");
+    printf("Both rings hold %zu bytes (one page, the mirrored ring's minimum).\n", capacity);
+}
+
+int main()
+{
+    printf("===== RING BUFFER LAYOUT BENCHMARK =====\n");
+    printf("[1/2] %d messages per run through ring_buffer_t and a double-mapped ring\n", MESSAGES_PER_RUN);
+    printf("--------------------------------------------\n");
+
+    // Both layouts as small as the page size allows the mirrored one to be
+    size_t capacity = magic_ring_header_size();
+
+    // The current layout
+    shared_memory_t ring_shm = {0};
+    if (shared_memory_create(&ring_shm, BENCH_RING_SHM_NAME, ring_buffer_shm_size(capacity)) != 0)
+    {
+        printf("Failed to create shared memory\n");
+        return 1;
+    }
+    ring_buffer_t *rb = (ring_buffer_t *)ring_shm.addr;
+    ring_buffer_init(rb, capacity);
+
+    // The mirrored layout
+    shared_memory_t magic_shm = {0};
+    magic_ring_t ring;
+    if (magic_ring_create(&ring, &magic_shm, BENCH_MAGIC_SHM_NAME, capacity) != 0)
+    {
+        printf("Failed to create mirrored ring\n");
+        shared_memory_destroy(&ring_shm, 1);
+        return 1;
+    }
+
+    uint8_t message[MAX_MESSAGE_SIZE];
+    for (int i = 0; i < MAX_MESSAGE_SIZE; i++)
+    {
+        message[i] = rand() % 256;
+    }
+
+    ring_result_t results[NUM_SIZES];
+    uint64_t checksums[3] = {0};
+    for (int i = 0; i < NUM_SIZES; i++)
+    {
+        size_t size = message_sizes[i];
+        printf("Testing %zu byte messages...\n", size);
+
+        results[i].message_size = size;
+        results[i].masked_ns = benchmark_masked(rb, message, size, &checksums[0]);
+
+        // The byte loop bypasses the cached indices, start the spans run afresh
+        ring_buffer_init(rb, capacity);
+        results[i].spans_ns = benchmark_spans(rb, message, size, &checksums[1]);
+        results[i].mirror_ns = benchmark_mirror(&ring, message, size, &checksums[2]);
+    }
+
+    // All three must have seen exactly the same bytes
+    if (checksums[0] != checksums[1] || checksums[1] != checksums[2])
+    {
+        printf("Checksum mismatch between layouts!\n");
+    }
+
+    print_results(results, capacity);
+
+    shared_memory_destroy(&magic_shm, 1);
+    shared_memory_destroy(&ring_shm, 1);
+
+    printf("\n[2/2] Streaming %d messages to a second process\n", SPSC_MESSAGES);
+    printf("--------------------------------------------\n");
+
+    spsc_result_t spsc_results[NUM_CAPACITIES];
+    for (int i = 0; i < NUM_CAPACITIES; i++)
+    {
+        printf("Testing %zu KB ring...\n", spsc_capacities[i] / 1024);
+        spsc_results[i].capacity = spsc_capacities[i];
+        spsc_results[i].shared_mps = benchmark_spsc(spsc_capacities[i], SPSC_SHARED);
+        spsc_results[i].cached_mps = benchmark_spsc(spsc_capacities[i], SPSC_CACHED);
+        spsc_results[i].batched_mps = benchmark_spsc(spsc_capacities[i], SPSC_BATCHED);
+    }
+
+    print_spsc_results(spsc_results);
+    printf("Speedup is batched over shared indices; batches hold up to %d messages.\n", SPSC_BATCH);
+
+    printf("=== BENCHMARK COMPLETE ===\n");
+    return 0;
+}
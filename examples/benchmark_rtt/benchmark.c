@@ -0,0 +1,519 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <semaphore.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include "shared_memory.h"
+#include "shm_sem.h"
+#include "shm_wait.h"
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
+// Test configuration
+#define RTT_SEM_PING_NAME "/rtt_sem_ping"
+#define RTT_SEM_PONG_NAME "/rtt_sem_pong"
+#define MESSAGE_SIZE 64     // Bytes sent each way per round trip
+#define WARMUP_ROUNDS 1000  // Round trips before measuring...
+#define MAX_WARMUP_MS 200   // ...or for this long, whichever comes first
+#define MAX_ROUNDS 100000   // Round trips measured per primitive...
+#define MAX_RUN_MS 2000     // ...unless this runs out first (pure spin on one CPU)
+#define HISTOGRAM_BUCKETS 12 // Powers of two from <1us to >=1ms
+
+typedef enum
+{
+    RTT_NAMED_SEM = 0, // sem_open, the countdown example's original handshake
+    RTT_UNNAMED_SEM,   // sem_init(pshared = 1) inside the shared segment
+    RTT_FUTEX,         // shm_sem_t: userspace fast path, futex to sleep
+    RTT_SPIN,          // Sequence number polled in a tight loop
+    RTT_EVENTFD,       // Linux eventfd counter
+    RTT_PIPE,          // One pipe each way
+    RTT_SOCKET,        // Unix-domain socket pair
+    NUM_PRIMITIVES
+} rtt_primitive_t;
+
+static const char *primitive_names[NUM_PRIMITIVES] = {
+    "named sem", "unnamed sem", "futex", "spin", "eventfd", "pipe", "socket"};
+
+// Directions of a round trip
+#define PING 0
+#define PONG 1
+
+// A message; seq 0 tells the other side to stop
+typedef struct
+{
+    uint64_t seq;
+    uint8_t payload[MESSAGE_SIZE - sizeof(uint64_t)];
+} rtt_message_t;
+
+// Shared between both processes
+typedef struct
+{
+    sem_t unnamed[2];
+    shm_sem_t futex[2];
+    _Alignas(SHM_CACHE_LINE) atomic_uint_least64_t spin[2][SHM_CACHE_LINE / sizeof(uint64_t)];
+    _Alignas(SHM_CACHE_LINE) rtt_message_t message[2]; // Sent through memory by the in-segment primitives
+} rtt_shared_t;
+
+// One process's view of the link
+typedef struct
+{
+    rtt_primitive_t primitive;
+    rtt_shared_t *shared;
+    sem_t *named[2];
+    int fds[2][2];           // Per direction: {read end, write end}
+    uint64_t spin_seen[2];   // Last sequence picked up per direction
+} rtt_link_t;
+
+// ===== RESULTS ===== //
+typedef struct
+{
+    int supported;
+    uint64_t rounds;
+    double min_us;
+    double p50_us;
+    double p99_us;
+    double p999_us;
+    double max_us;
+    uint64_t histogram[HISTOGRAM_BUCKETS];
+} rtt_result_t;
+
+// ===== TIMING UTILITY ===== //
+uint64_t get_time_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int compare_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// ===== LINK SETUP ===== //
+static int open_link(rtt_link_t *link, rtt_primitive_t primitive, rtt_shared_t *shared)
+{
+    memset(link, 0, sizeof(*link));
+    memset(shared, 0, sizeof(*shared));
+    link->primitive = primitive;
+    link->shared = shared;
+
+    switch (primitive)
+    {
+    case RTT_NAMED_SEM:
+        sem_unlink(RTT_SEM_PING_NAME);
+        sem_unlink(RTT_SEM_PONG_NAME);
+        link->named[PING] = sem_open(RTT_SEM_PING_NAME, O_CREAT, S_IRUSR | S_IWUSR, 0);
+        link->named[PONG] = sem_open(RTT_SEM_PONG_NAME, O_CREAT, S_IRUSR | S_IWUSR, 0);
+        if (link->named[PING] == SEM_FAILED || link->named[PONG] == SEM_FAILED)
+        {
+            perror("sem_open");
+            return -1;
+        }
+        return 0;
+
+    case RTT_UNNAMED_SEM:
+        // macOS declares sem_init but fails it with ENOSYS
+        if (sem_init(&shared->unnamed[PING], 1, 0) != 0 || sem_init(&shared->unnamed[PONG], 1, 0) != 0)
+        {
+            return -1;
+        }
+        return 0;
+
+    case RTT_FUTEX:
+        shm_sem_init(&shared->futex[PING], 0);
+        shm_sem_init(&shared->futex[PONG], 0);
+        return 0;
+
+    case RTT_SPIN:
+        return 0;
+
+    case RTT_EVENTFD:
+#ifdef __linux__
+        for (int dir = PING; dir <= PONG; dir++)
+        {
+            int fd = eventfd(0, 0);
+            if (fd == -1)
+            {
+                perror("eventfd");
+                return -1;
+            }
+            link->fds[dir][0] = fd;
+            link->fds[dir][1] = fd;
+        }
+        return 0;
+#else
+        return -1;
+#endif
+
+    case RTT_PIPE:
+        if (pipe(link->fds[PING]) != 0 || pipe(link->fds[PONG]) != 0)
+        {
+            perror("pipe");
+            return -1;
+        }
+        return 0;
+
+    case RTT_SOCKET:
+    {
+        int sv[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0)
+        {
+            perror("socketpair");
+            return -1;
+        }
+        // Ping writes sv[0] and pong reads sv[1], and the other way round
+        link->fds[PING][0] = sv[1];
+        link->fds[PING][1] = sv[0];
+        link->fds[PONG][0] = sv[0];
+        link->fds[PONG][1] = sv[1];
+        return 0;
+    }
+
+    default:
+        return -1;
+    }
+}
+
+static void close_link(rtt_link_t *link)
+{
+    switch (link->primitive)
+    {
+    case RTT_NAMED_SEM:
+        sem_close(link->named[PING]);
+        sem_close(link->named[PONG]);
+        sem_unlink(RTT_SEM_PING_NAME);
+        sem_unlink(RTT_SEM_PONG_NAME);
+        break;
+    case RTT_UNNAMED_SEM:
+        sem_destroy(&link->shared->unnamed[PING]);
+        sem_destroy(&link->shared->unnamed[PONG]);
+        break;
+    case RTT_EVENTFD:
+        close(link->fds[PING][0]);
+        close(link->fds[PONG][0]);
+        break;
+    case RTT_PIPE:
+        for (int dir = PING; dir <= PONG; dir++)
+        {
+            close(link->fds[dir][0]);
+            close(link->fds[dir][1]);
+        }
+        break;
+    case RTT_SOCKET:
+        close(link->fds[PING][0]);
+        close(link->fds[PING][1]);
+        break;
+    default:
+        break;
+    }
+}
+
+// ===== MESSAGING ===== //
+
+// Read or write exactly size bytes
+static void read_full(int fd, void *buffer, size_t size)
+{
+    size_t done = 0;
+    while (done < size)
+    {
+        ssize_t n = read(fd, (char *)buffer + done, size - done);
+        if (n <= 0)
+        {
+            if (n == -1 && errno == EINTR)
+            {
+                continue;
+            }
+            perror("read");
+            exit(1);
+        }
+        done += n;
+    }
+}
+
+static void write_full(int fd, const void *buffer, size_t size)
+{
+    size_t done = 0;
+    while (done < size)
+    {
+        ssize_t n = write(fd, (const char *)buffer + done, size - done);
+        if (n <= 0)
+        {
+            if (n == -1 && errno == EINTR)
+            {
+                continue;
+            }
+            perror("write");
+            exit(1);
+        }
+        done += n;
+    }
+}
+
+static void send_message(rtt_link_t *link, int dir, const rtt_message_t *message)
+{
+    rtt_shared_t *shared = link->shared;
+
+    // The byte-stream primitives carry the message, the rest signal after it is in memory
+    switch (link->primitive)
+    {
+    case RTT_PIPE:
+    case RTT_SOCKET:
+        write_full(link->fds[dir][1], message, sizeof(*message));
+        return;
+    default:
+        memcpy(&shared->message[dir], message, sizeof(*message));
+        break;
+    }
+
+    switch (link->primitive)
+    {
+    case RTT_NAMED_SEM:
+        sem_post(link->named[dir]);
+        break;
+    case RTT_UNNAMED_SEM:
+        sem_post(&shared->unnamed[dir]);
+        break;
+    case RTT_FUTEX:
+        shm_sem_post(&shared->futex[dir]);
+        break;
+    case RTT_SPIN:
+        atomic_fetch_add_explicit(&shared->spin[dir][0], 1, memory_order_release);
+        break;
+    case RTT_EVENTFD:
+    {
+        uint64_t one = 1;
+        write_full(link->fds[dir][1], &one, sizeof(one));
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+static void receive_message(rtt_link_t *link, int dir, rtt_message_t *message)
+{
+    rtt_shared_t *shared = link->shared;
+
+    switch (link->primitive)
+    {
+    case RTT_PIPE:
+    case RTT_SOCKET:
+        read_full(link->fds[dir][0], message, sizeof(*message));
+        return;
+    case RTT_NAMED_SEM:
+        while (sem_wait(link->named[dir]) != 0)
+        {
+        }
+        break;
+    case RTT_UNNAMED_SEM:
+        while (sem_wait(&shared->unnamed[dir]) != 0)
+        {
+        }
+        break;
+    case RTT_FUTEX:
+        shm_sem_wait(&shared->futex[dir], -1);
+        break;
+    case RTT_SPIN:
+        while (atomic_load_explicit(&shared->spin[dir][0], memory_order_acquire) == link->spin_seen[dir])
+        {
+            shm_cpu_relax();
+        }
+        link->spin_seen[dir]++;
+        break;
+    case RTT_EVENTFD:
+    {
+        uint64_t count;
+        read_full(link->fds[dir][0], &count, sizeof(count));
+        break;
+    }
+    default:
+        break;
+    }
+
+    memcpy(message, &shared->message[dir], sizeof(*message));
+}
+
+// ===== BENCHMARK ===== //
+
+// Pong: echo every message back until told to stop
+static void run_pong(rtt_link_t *link)
+{
+    rtt_message_t message;
+    for (;;)
+    {
+        receive_message(link, PING, &message);
+        if (message.seq == 0)
+        {
+            break;
+        }
+        send_message(link, PONG, &message);
+    }
+    _exit(0);
+}
+
+// Bucket for a round trip: <1us, then powers of two up to >=1ms
+static int histogram_bucket(uint64_t ns)
+{
+    int bucket = 0;
+    for (uint64_t limit = 1000; ns >= limit && bucket < HISTOGRAM_BUCKETS - 1; limit *= 2)
+    {
+        bucket++;
+    }
+    return bucket;
+}
+
+rtt_result_t benchmark_primitive(rtt_primitive_t primitive, rtt_shared_t *shared, uint64_t *latency_ns)
+{
+    rtt_result_t result;
+    memset(&result, 0, sizeof(result));
+
+    rtt_link_t link;
+    if (open_link(&link, primitive, shared) != 0)
+    {
+        return result;
+    }
+    result.supported = 1;
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        run_pong(&link);
+    }
+
+    rtt_message_t message;
+    memset(&message, 0xab, sizeof(message));
+
+    // Fault everything in and let both sides settle into the exchange
+    uint64_t seq = 1;
+    uint64_t warmup_end = get_time_ns() + MAX_WARMUP_MS * 1000000ULL;
+    for (int i = 0; i < WARMUP_ROUNDS && get_time_ns() < warmup_end; i++, seq++)
+    {
+        message.seq = seq;
+        send_message(&link, PING, &message);
+        receive_message(&link, PONG, &message);
+    }
+
+    uint64_t deadline = get_time_ns() + MAX_RUN_MS * 1000000ULL;
+    uint64_t rounds = 0;
+    while (rounds < MAX_ROUNDS)
+    {
+        uint64_t start = get_time_ns();
+        message.seq = seq;
+        send_message(&link, PING, &message);
+        receive_message(&link, PONG, &message);
+        uint64_t end = get_time_ns();
+
+        if (message.seq != seq)
+        {
+            fprintf(stderr, "%s: got reply %llu to %llu\n", primitive_names[primitive],
+                    (unsigned long long)message.seq, (unsigned long long)seq);
+            exit(1);
+        }
+        latency_ns[rounds++] = end - start;
+        seq++;
+
+        if (end > deadline)
+        {
+            break;
+        }
+    }
+
+    // Tell pong to stop
+    message.seq = 0;
+    send_message(&link, PING, &message);
+    waitpid(pid, NULL, 0);
+    close_link(&link);
+
+    for (uint64_t i = 0; i < rounds; i++)
+    {
+        result.histogram[histogram_bucket(latency_ns[i])]++;
+    }
+
+    qsort(latency_ns, rounds, sizeof(uint64_t), compare_u64);
+    result.rounds = rounds;
+    result.min_us = latency_ns[0] / 1e3;
+    result.p50_us = latency_ns[rounds / 2] / 1e3;
+    result.p99_us = latency_ns[rounds * 99 / 100] / 1e3;
+    result.p999_us = latency_ns[rounds * 999 / 1000] / 1e3;
+    result.max_us = latency_ns[rounds - 1] / 1e3;
+    return result;
+}
+
+void print_results(rtt_result_t *results)
+{
+    printf("\n==========================================================================\n");
+    printf("                 ROUND-TRIP LATENCY (US), %d-BYTE MESSAGES\n", MESSAGE_SIZE);
+    printf("==========================================================================\n");
+    printf("Primitive   |  Rounds |     min |     p50 |     p99 |   p99.9 |       max |\n");
+    printf("------------|---------|---------|---------|---------|---------|-----------|\n");
+    for (int p = 0; p < NUM_PRIMITIVES; p++)
+    {
+        rtt_result_t *r = &results[p];
+        if (!r->supported)
+        {
+            printf("%-11s | not supported on this platform\n", primitive_names[p]);
+            continue;
+        }
+        printf("%-11s | %7llu | %7.2f | %7.2f | %7.2f | %7.2f | %9.2f |\n", primitive_names[p],
+               (unsigned long long)r->rounds, r->min_us, r->p50_us, r->p99_us, r->p999_us, r->max_us);
+    }
+
+    printf("\nHistogram (%% of round trips)\n");
+    printf("Primitive   |   <1us |  1-2us |  2-4us |  4-8us | 8-16us |  16-32 |  32-64 | 64-128 |128-256 |256-512 |512-1ms |  >=1ms |\n");
+    printf("------------|--------|--------|--------|--------|--------|--------|--------|--------|--------|--------|--------|--------|\n");
+    for (int p = 0; p < NUM_PRIMITIVES; p++)
+    {
+        rtt_result_t *r = &results[p];
+        if (!r->supported)
+        {
+            continue;
+        }
+        printf("%-11s |", primitive_names[p]);
+        for (int b = 0; b < HISTOGRAM_BUCKETS; b++)
+        {
+            printf(" %6.2f |", 100.0 * r->histogram[b] / r->rounds);
+        }
+        printf("\n");
+    }
+    printf("==========================================================================\n");
+}
+
+int main()
+{
+    printf("===== ROUND-TRIP LATENCY BENCHMARK =====\n");
+    printf("Ping-pong of %d-byte messages, up to %d round trips or %dms per primitive\n",
+           MESSAGE_SIZE, MAX_ROUNDS, MAX_RUN_MS);
+    printf("Online CPUs: %ld\n", sysconf(_SC_NPROCESSORS_ONLN));
+    printf("----------------------------------------\n");
+
+    // The in-segment primitives and messages live in memory shared by both processes
+    rtt_shared_t *shared = mmap(NULL, sizeof(rtt_shared_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANON, -1, 0);
+    if (shared == MAP_FAILED)
+    {
+        perror("mmap");
+        return 1;
+    }
+    uint64_t *latency_ns = malloc(MAX_ROUNDS * sizeof(uint64_t));
+
+    rtt_result_t results[NUM_PRIMITIVES];
+    for (int p = 0; p < NUM_PRIMITIVES; p++)
+    {
+        printf("Testing %s...\n", primitive_names[p]);
+        results[p] = benchmark_primitive((rtt_primitive_t)p, shared, latency_ns);
+    }
+
+    print_results(results);
+
+    free(latency_ns);
+    munmap(shared, sizeof(rtt_shared_t));
+
+    printf("=== BENCHMARK COMPLETE ===\n");
+    return 0;
+}
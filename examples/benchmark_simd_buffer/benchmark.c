@@ -24,11 +24,16 @@
 #define DATA_SIZE 1024 // Number of floats
 
 // Semaphore names for normal and SIMD benchmarks
-#define NORMAL_SEM_READY_NAME BUFFER_SEM_READY_NAME
-#define NORMAL_SEM_DONE_NAME BUFFER_SEM_DONE_NAME
+#define NORMAL_SEM_READY_NAME "/normal_sem_ready"
+#define NORMAL_SEM_DONE_NAME "/normal_sem_done"
 #define SIMD_SEM_READY_NAME "/simd_sem_ready"
 #define SIMD_SEM_DONE_NAME "/simd_sem_done"
 
+// Page size benchmark: a multi-MB batch ring visited in random order
+#define PAGE_SHM_NAME "/page_size_bench_shm"
+#define PAGE_BENCH_SIZE (64 * 1024 * 1024)
+#define PAGE_BENCH_ACCESSES 4000000
+
 // If not defined in simd_shared.h
 #ifndef SIMD_SHM_NAME
 #define SIMD_SHM_NAME "/simd_shm"
@@ -90,6 +95,12 @@ typedef struct
     double simd_ops_per_second;
 } simd_buffer_result_t;
 
+typedef struct
+{
+    shm_backing_t backing;
+    double ns_per_access;
+} page_size_result_t;
+
 // ===== TIMING UTILITY ===== //
 uint64_t get_time_ns()
 {
@@ -521,6 +532,52 @@ simd_buffer_result_t benchmark_simd_buffer(float *random_data)
     return result;
 }
 
+// ===== PAGE SIZE BENCHMARK ===== //
+page_size_result_t benchmark_page_size(unsigned flags)
+{
+    page_size_result_t result = {0};
+
+    shared_memory_t shm = {0};
+    if (shared_memory_create_ex(&shm, PAGE_SHM_NAME, PAGE_BENCH_SIZE, flags) != 0)
+    {
+        printf("Failed to create shared memory\n");
+        return result;
+    }
+    result.backing = shm.backing;
+    printf("Segment of %zu MB backed by %s\n",
+           shm.size / (1024 * 1024), shared_memory_backing_name(shm.backing));
+
+    // Fault every page in up front so only TLB reach is measured
+    memset(shm.addr, 0, shm.size);
+
+    simd_batch_t *batches = (simd_batch_t *)shm.addr;
+    size_t batch_count = shm.size / sizeof(simd_batch_t);
+
+    // Read one float from a random batch per access; with 4KB pages nearly
+    // every access needs a fresh dTLB entry, with 2MB pages they mostly hit
+    uint64_t x = 88172645463325252ULL;
+    float sum = 0.0f;
+    uint64_t start_time = get_time_ns();
+    for (int i = 0; i < PAGE_BENCH_ACCESSES; i++)
+    {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        sum += batches[x % batch_count].data[(x >> 32) % DATA_SIZE];
+    }
+    uint64_t end_time = get_time_ns();
+
+    // Keep the loop from being optimized away
+    volatile float sink = sum;
+    (void)sink;
+
+    result.ns_per_access = (double)(end_time - start_time) / PAGE_BENCH_ACCESSES;
+    printf("Random batch access: %.2f ns/access\n", result.ns_per_access);
+
+    shared_memory_destroy(&shm, 1);
+    return result;
+}
+
 // ===== PRINT COMPARISON ===== //
 void print_comparison_results(double normal_total, double normal_producer, double normal_consumer,
                               double simd_total, double simd_producer, double simd_consumer,
@@ -547,6 +604,18 @@ void print_comparison_results(double normal_total, double normal_producer, doubl
     printf("================================================\n");
 }
 
+void print_page_size_results(page_size_result_t regular, page_size_result_t huge)
+{
+    printf("\n================================================\n");
+    printf("              PAGE SIZE RESULTS                  \n");
+    printf("================================================\n");
+    printf("Backing                  | ns/access\n");
+    printf("--------------------------|----------\n");
+    printf("%-25s | %9.2f\n", shared_memory_backing_name(regular.backing), regular.ns_per_access);
+    printf("%-25s | %9.2f\n", shared_memory_backing_name(huge.backing), huge.ns_per_access);
+    printf("================================================\n");
+}
+
 // ===== MAIN ===== //
 int main(void)
 {
@@ -571,14 +640,14 @@ int main(void)
            TEST_ITERATIONS, DATA_SIZE);
     printf("--------------------------------------------\n");
 
-    printf("\n[1/2] NORMAL BUFFER BENCHMARK\n");
+    printf("\n[1/3] NORMAL BUFFER BENCHMARK\n");
     normal_buffer_result_t normal_result =
         benchmark_normal_buffer(random_data);
 
     printf("Cleaning up resources...");
     sleep(1);
 
-    printf("\n[2/2] SIMD BUFFER BENCHMARK\n");
+    printf("\n[2/3] SIMD BUFFER BENCHMARK\n");
     simd_buffer_result_t simd_result =
         benchmark_simd_buffer(random_data);
 
@@ -587,6 +656,11 @@ int main(void)
         simd_result.total_ms, simd_result.producer_ms, simd_result.consumer_ms,
         normal_result.throughput, simd_result.throughput);
 
+    printf("\n[3/3] PAGE SIZE BENCHMARK\n");
+    page_size_result_t regular_result = benchmark_page_size(0);
+    page_size_result_t huge_result = benchmark_page_size(SHM_HUGE_PAGES);
+    print_page_size_results(regular_result, huge_result);
+
     printf("=== BENCHMARK COMPLETE ===");
     return 0;
 }
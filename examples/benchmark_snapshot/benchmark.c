@@ -0,0 +1,193 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/wait.h>
+#include "shared_memory.h"
+#include "shm_seqlock.h"
+#include "shm_triple.h"
+
+// Test configuration
+#define BENCH_SEQLOCK_SHM_NAME "/bench_snapshot_seqlock"
+#define BENCH_TRIPLE_SHM_NAME "/bench_snapshot_triple"
+#define RUN_MS 500 // The writer publishes flat out for this long
+
+static const size_t frame_sizes[] = {4 * 1024, 64 * 1024, 1024 * 1024, 4 * 1024 * 1024};
+#define NUM_SIZES (int)(sizeof(frame_sizes) / sizeof(frame_sizes[0]))
+
+// ===== RESULTS ===== //
+typedef struct
+{
+    double frames_per_sec;   // Complete frames the reader got through
+    double distinct_percent; // Of the writer's frames, how many the reader saw
+} snapshot_result_t;
+
+typedef struct
+{
+    size_t frame_size;
+    snapshot_result_t seqlock; // Copy out, retry if the writer moved
+    snapshot_result_t triple;  // Swap in the newest frame, read it in place
+} frame_result_t;
+
+// ===== TIMING UTILITY ===== //
+uint64_t get_time_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Keeps the rendering loops from being optimized away
+static volatile uint64_t sink;
+
+// Stand-in for rendering: touch every 64th byte of the frame
+static uint64_t consume_frame(const uint8_t *frame, size_t size)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < size; i += 64)
+    {
+        sum += frame[i];
+    }
+    return sum;
+}
+
+// ===== SEQLOCK ===== //
+snapshot_result_t benchmark_seqlock(size_t frame_size)
+{
+    shared_memory_t shm = {0};
+    if (shared_memory_create_ex(&shm, BENCH_SEQLOCK_SHM_NAME, shm_seqlock_size(frame_size), SHM_PREFAULT) != 0)
+    {
+        printf("Failed to create shared memory\n");
+        exit(1);
+    }
+    shm_seqlock_t *lock = (shm_seqlock_t *)shm.addr;
+    shm_seqlock_init(lock, frame_size);
+
+    uint8_t *frame = malloc(frame_size);
+    memset(frame, 1, frame_size);
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        // Writer: build each frame locally, then copy it into the cell
+        uint64_t end = get_time_ns() + RUN_MS * 1000000ULL;
+        while (get_time_ns() < end)
+        {
+            frame[0]++;
+            shm_seqlock_write(lock, frame, frame_size);
+        }
+        _exit(0);
+    }
+
+    // Reader: copy out the newest value and render from the copy
+    uint64_t frames = 0, distinct = 0, last_version = 0;
+    uint64_t checksum = 0;
+    uint64_t start = get_time_ns();
+    while (waitpid(pid, NULL, WNOHANG) == 0)
+    {
+        uint64_t version;
+        shm_seqlock_read(lock, frame, frame_size, &version);
+        checksum += consume_frame(frame, frame_size);
+        frames++;
+        distinct += version != last_version;
+        last_version = version;
+    }
+    uint64_t elapsed = get_time_ns() - start;
+    sink = checksum;
+
+    snapshot_result_t result;
+    result.frames_per_sec = frames / (elapsed / 1e9);
+    result.distinct_percent = last_version > 0 ? 100.0 * distinct / last_version : 0;
+
+    free(frame);
+    shared_memory_destroy(&shm, 1);
+    return result;
+}
+
+// ===== TRIPLE BUFFER ===== //
+snapshot_result_t benchmark_triple(size_t frame_size)
+{
+    shm_triple_t tb = {0};
+    if (shm_triple_create(&tb, BENCH_TRIPLE_SHM_NAME, frame_size, SHM_PREFAULT) != 0)
+    {
+        printf("Failed to create shared memory\n");
+        exit(1);
+    }
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        // Writer: build each frame directly in the back buffer
+        uint64_t end = get_time_ns() + RUN_MS * 1000000ULL;
+        uint8_t value = 0;
+        while (get_time_ns() < end)
+        {
+            memset(shm_triple_back(&tb), ++value, frame_size);
+            shm_triple_publish(&tb);
+        }
+        _exit(0);
+    }
+
+    // Reader: swap in the newest frame and render from it in place
+    uint64_t frames = 0, distinct = 0, last_sequence = 0;
+    uint64_t checksum = 0;
+    uint64_t start = get_time_ns();
+    while (waitpid(pid, NULL, WNOHANG) == 0)
+    {
+        uint64_t sequence;
+        const uint8_t *frame = shm_triple_acquire(&tb, &sequence);
+        checksum += consume_frame(frame, frame_size);
+        frames++;
+        distinct += sequence != last_sequence;
+        last_sequence = sequence;
+    }
+    uint64_t elapsed = get_time_ns() - start;
+    sink = checksum;
+
+    snapshot_result_t result;
+    result.frames_per_sec = frames / (elapsed / 1e9);
+    result.distinct_percent = last_sequence > 0 ? 100.0 * distinct / last_sequence : 0;
+
+    shm_triple_close(&tb, 1);
+    return result;
+}
+
+void print_results(frame_result_t *results)
+{
+    printf("\n================================================================\n");
+    printf("        LATEST-FRAME READS WHILE THE WRITER RUNS FLAT OUT\n");
+    printf("================================================================\n");
+    printf("Frame (KB) | Seqlock reads/s | Seen (%%) | Triple reads/s | Seen (%%)\n");
+    printf("-----------|-----------------|----------|----------------|---------\n");
+    for (int i = 0; i < NUM_SIZES; i++)
+    {
+        frame_result_t *r = &results[i];
+        printf("%10zu | %15.0f | %8.1f | %14.0f | %7.1f\n", r->frame_size / 1024,
+               r->seqlock.frames_per_sec, r->seqlock.distinct_percent,
+               r->triple.frames_per_sec, r->triple.distinct_percent);
+    }
+    printf("================================================================\n");
+    printf("Seen is the share of the writer's frames the reader got to.\n");
+}
+
+int main()
+{
+    printf("===== SNAPSHOT CHANNEL BENCHMARK =====\n");
+    printf("Seqlock cell vs triple buffer, %dms per run\n", RUN_MS);
+    printf("Online CPUs: %ld\n", sysconf(_SC_NPROCESSORS_ONLN));
+    printf("--------------------------------------------\n");
+
+    frame_result_t results[NUM_SIZES];
+    for (int i = 0; i < NUM_SIZES; i++)
+    {
+        printf("Testing %zu KB frames...\n", frame_sizes[i] / 1024);
+        results[i].frame_size = frame_sizes[i];
+        results[i].seqlock = benchmark_seqlock(frame_sizes[i]);
+        results[i].triple = benchmark_triple(frame_sizes[i]);
+    }
+
+    print_results(results);
+
+    printf("=== BENCHMARK COMPLETE ===\n");
+    return 0;
+}
@@ -0,0 +1,175 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/wait.h>
+#include "shared_memory.h"
+#include "shm_wait.h"
+
+// Test configuration
+#define ROUNDS 200          // Wake-ups measured per strategy
+#define IDLE_GAP_US 1000    // Quiet time before each wake-up
+#define IDLE_MS 500         // Quiet time the idle CPU cost is measured over
+
+static const shm_wait_strategy_t strategies[] = {SHM_WAIT_SPIN, SHM_WAIT_PAUSE, SHM_WAIT_HYBRID, SHM_WAIT_FUTEX};
+#define NUM_STRATEGIES (int)(sizeof(strategies) / sizeof(strategies[0]))
+
+// ===== RESULTS ===== //
+typedef struct
+{
+    double min_us; // Wake-up latency, post to the waiter seeing it
+    double p50_us;
+    double p99_us;
+    double idle_cpu; // Fraction of a core the waiter used while nothing happened
+} wait_result_t;
+
+// Shared between the poster and the waiter
+typedef struct
+{
+    shm_waitpoint_t point;
+    atomic_uint_least64_t posted;  // Last round the poster published
+    atomic_uint_least64_t seen;    // Last round the waiter picked up
+    atomic_uint_least64_t post_ns; // When the last round was published
+    uint64_t latency_ns[ROUNDS];
+    uint64_t idle_cpu_ns; // Waiter's CPU time over the idle period
+} wait_bench_t;
+
+// ===== TIMING UTILITY ===== //
+uint64_t get_time_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint64_t get_cpu_time_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int compare_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// ===== PROCESSES ===== //
+
+// Wait for round to be posted using the strategy under test
+static void wait_for_round(wait_bench_t *bench, shm_wait_strategy_t strategy, uint64_t round)
+{
+    shm_waiter_t waiter;
+    shm_waiter_init(&waiter, &bench->point, strategy);
+    while (atomic_load_explicit(&bench->posted, memory_order_acquire) < round)
+    {
+        shm_wait(&waiter, -1);
+    }
+    shm_wait_done(&waiter);
+}
+
+static void run_waiter(wait_bench_t *bench, shm_wait_strategy_t strategy)
+{
+    for (uint64_t round = 1; round <= ROUNDS; round++)
+    {
+        wait_for_round(bench, strategy, round);
+        bench->latency_ns[round - 1] = get_time_ns() - atomic_load_explicit(&bench->post_ns, memory_order_relaxed);
+        atomic_store_explicit(&bench->seen, round, memory_order_release);
+    }
+
+    // One long quiet period, to see what waiting costs when nothing happens
+    uint64_t cpu_start = get_cpu_time_ns();
+    wait_for_round(bench, strategy, ROUNDS + 1);
+    bench->idle_cpu_ns = get_cpu_time_ns() - cpu_start;
+    _exit(0);
+}
+
+static void post_round(wait_bench_t *bench, uint64_t round)
+{
+    atomic_store_explicit(&bench->post_ns, get_time_ns(), memory_order_relaxed);
+    atomic_store_explicit(&bench->posted, round, memory_order_release);
+    shm_notify(&bench->point);
+}
+
+// ===== BENCHMARK ===== //
+wait_result_t benchmark_strategy(wait_bench_t *bench, shm_wait_strategy_t strategy)
+{
+    memset(bench, 0, sizeof(*bench));
+    shm_waitpoint_init(&bench->point);
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        run_waiter(bench, strategy);
+    }
+
+    for (uint64_t round = 1; round <= ROUNDS; round++)
+    {
+        // Let the waiter go idle (and a sleeping one fall asleep) first
+        usleep(IDLE_GAP_US);
+        post_round(bench, round);
+
+        while (atomic_load_explicit(&bench->seen, memory_order_acquire) < round)
+        {
+            usleep(10);
+        }
+    }
+
+    uint64_t idle_start = get_time_ns();
+    usleep(IDLE_MS * 1000);
+    uint64_t idle_elapsed = get_time_ns() - idle_start;
+    post_round(bench, ROUNDS + 1);
+    waitpid(pid, NULL, 0);
+
+    qsort(bench->latency_ns, ROUNDS, sizeof(uint64_t), compare_u64);
+
+    wait_result_t result;
+    result.min_us = bench->latency_ns[0] / 1e3;
+    result.p50_us = bench->latency_ns[ROUNDS / 2] / 1e3;
+    result.p99_us = bench->latency_ns[ROUNDS * 99 / 100] / 1e3;
+    result.idle_cpu = (double)bench->idle_cpu_ns / idle_elapsed;
+    return result;
+}
+
+int main()
+{
+    printf("===== WAIT STRATEGY BENCHMARK =====\n");
+    printf("%d wake-ups after %dus idle gaps, idle CPU over %dms\n", ROUNDS, IDLE_GAP_US, IDLE_MS);
+    printf("Hybrid spins %d polls before sleeping\n", SHM_WAIT_SPIN_LIMIT);
+    printf("Online CPUs: %ld\n", sysconf(_SC_NPROCESSORS_ONLN));
+    printf("-----------------------------------\n");
+
+    // The waitpoint lives in memory shared by both processes, like a channel's
+    wait_bench_t *bench = mmap(NULL, sizeof(wait_bench_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANON, -1, 0);
+    if (bench == MAP_FAILED)
+    {
+        perror("mmap");
+        return 1;
+    }
+
+    wait_result_t results[NUM_STRATEGIES];
+    for (int s = 0; s < NUM_STRATEGIES; s++)
+    {
+        printf("Testing %s...\n", shm_wait_strategy_name(strategies[s]));
+        results[s] = benchmark_strategy(bench, strategies[s]);
+    }
+
+    printf("\n================================================================\n");
+    printf("          WAKE-UP LATENCY (US) AND IDLE CPU COST\n");
+    printf("================================================================\n");
+    printf("Strategy |      min |      p50 |      p99 | Idle CPU |\n");
+    printf("---------|----------|----------|----------|----------|\n");
+    for (int s = 0; s < NUM_STRATEGIES; s++)
+    {
+        wait_result_t *r = &results[s];
+        printf("%-8s | %8.2f | %8.2f | %8.2f | %7.1f%% |\n", shm_wait_strategy_name(strategies[s]),
+               r->min_us, r->p50_us, r->p99_us, r->idle_cpu * 100);
+    }
+    printf("================================================================\n");
+
+    munmap(bench, sizeof(wait_bench_t));
+
+    printf("=== BENCHMARK COMPLETE ===\n");
+    return 0;
+}
@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "mmap_shared.h"
+
+// Test configuration
+#define BENCH_DB_PATH "/tmp/benchmark_wal.dat"
+#define BENCH_WAL_PATH "/tmp/benchmark_wal.wal"
+#define BENCH_DB_SIZE (64 * 1024 * 1024) // Room for every insert of a run
+#define RUN_MS 1000                      // Each configuration inserts for this long
+#define GROUP_DELAY_US 200               // Latency bound for the delayed group commit
+
+static const int writer_counts[] = {1, 2, 4, 8, 16, 32};
+#define NUM_WRITER_COUNTS (int)(sizeof(writer_counts) / sizeof(writer_counts[0]))
+
+typedef enum
+{
+    COMMIT_MSYNC = 0, // No log: msync the whole file after every insert
+    COMMIT_GROUP,     // Log, fsync whatever accumulated during the last fsync
+    COMMIT_DELAYED,   // Log, also wait up to GROUP_DELAY_US for company
+    NUM_MODES
+} commit_mode_t;
+
+// ===== RESULTS ===== //
+typedef struct
+{
+    double inserts_per_sec; // Durable inserts
+    double per_commit;      // Inserts sharing each fsync
+} wal_result_t;
+
+typedef struct
+{
+    mmap_db_t *handle;
+    uint64_t end_ns;
+    uint64_t inserts;
+} writer_args_t;
+
+// ===== TIMING UTILITY ===== //
+uint64_t get_time_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// ===== WRITERS ===== //
+
+// Insert records one at a time, each durable before the next
+static void *writer_thread(void *arg)
+{
+    writer_args_t *args = arg;
+    char name[64];
+    while (get_time_ns() < args->end_ns)
+    {
+        snprintf(name, sizeof(name), "Benchmark Record %llu", (unsigned long long)args->inserts);
+        uint64_t lsn = 0;
+        if (mmap_db_add_record(args->handle, name, args->inserts * 0.5, &lsn) != 0 ||
+            mmap_db_commit(args->handle, lsn) != 0)
+        {
+            fprintf(stderr, "Insert failed\n");
+            exit(1);
+        }
+        args->inserts++;
+    }
+    return NULL;
+}
+
+wal_result_t benchmark_mode(commit_mode_t mode, int writers)
+{
+    mmap_db_t handle;
+    const char *wal_path = mode == COMMIT_MSYNC ? NULL : BENCH_WAL_PATH;
+    unsigned delay_us = mode == COMMIT_DELAYED ? GROUP_DELAY_US : 0;
+    if (mmap_db_create(&handle, BENCH_DB_PATH, BENCH_DB_SIZE, wal_path, delay_us) != 0)
+    {
+        printf("Failed to create the database\n");
+        exit(1);
+    }
+
+    pthread_t threads[writers];
+    writer_args_t args[writers];
+    uint64_t start = get_time_ns();
+    for (int t = 0; t < writers; t++)
+    {
+        args[t].handle = &handle;
+        args[t].end_ns = start + RUN_MS * 1000000ULL;
+        args[t].inserts = 0;
+        pthread_create(&threads[t], NULL, writer_thread, &args[t]);
+    }
+
+    uint64_t inserts = 0;
+    for (int t = 0; t < writers; t++)
+    {
+        pthread_join(threads[t], NULL);
+        inserts += args[t].inserts;
+    }
+    uint64_t elapsed = get_time_ns() - start;
+
+    wal_result_t result;
+    result.inserts_per_sec = inserts / (elapsed / 1e9);
+    result.per_commit = 1;
+    if (mode != COMMIT_MSYNC)
+    {
+        shm_wal_stats_t stats = shm_wal_stats(&handle.wal);
+        result.per_commit = stats.commits > 0 ? (double)stats.records / stats.commits : 0;
+    }
+
+    mmap_db_close(&handle);
+    unlink(BENCH_DB_PATH);
+    unlink(BENCH_WAL_PATH);
+    return result;
+}
+
+int main()
+{
+    printf("===== DURABLE INSERT BENCHMARK =====\n");
+    printf("Each writer thread commits every insert before the next, %dms per run\n", RUN_MS);
+    printf("Database file %s (%d MB)\n", BENCH_DB_PATH, BENCH_DB_SIZE / (1024 * 1024));
+    printf("Online CPUs: %ld\n", sysconf(_SC_NPROCESSORS_ONLN));
+    printf("------------------------------------\n");
+
+    wal_result_t results[NUM_WRITER_COUNTS][NUM_MODES];
+    for (int i = 0; i < NUM_WRITER_COUNTS; i++)
+    {
+        printf("Testing %d writers...\n", writer_counts[i]);
+        for (int m = 0; m < NUM_MODES; m++)
+        {
+            results[i][m] = benchmark_mode((commit_mode_t)m, writer_counts[i]);
+        }
+    }
+
+    printf("\n==========================================================================\n");
+    printf("                     DURABLE INSERTS PER SECOND\n");
+    printf("==========================================================================\n");
+    printf("Writers | msync file | Group commit | Per fsync | Delayed (%dus) | Per fsync\n", GROUP_DELAY_US);
+    printf("--------|------------|--------------|-----------|-----------------|----------\n");
+    for (int i = 0; i < NUM_WRITER_COUNTS; i++)
+    {
+        wal_result_t *r = results[i];
+        printf("%7d | %10.0f | %12.0f | %9.1f | %15.0f | %8.1f\n", writer_counts[i],
+               r[COMMIT_MSYNC].inserts_per_sec,
+               r[COMMIT_GROUP].inserts_per_sec, r[COMMIT_GROUP].per_commit,
+               r[COMMIT_DELAYED].inserts_per_sec, r[COMMIT_DELAYED].per_commit);
+    }
+    printf("==========================================================================\n");
+
+    printf("=== BENCHMARK COMPLETE ===\n");
+    return 0;
+}
@@ -0,0 +1,369 @@
+#ifndef BROADCAST_RING_SHARED_H
+#define BROADCAST_RING_SHARED_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include "shared_memory.h"
+#include "shm_wait.h"
+
+#define BROADCAST_RING_SHM_NAME "/broadcast_ring_shared_memory"
+#define BROADCAST_RING_DEFAULT_SLOTS 1024 // Any power of 2 works, set at creation
+#define BROADCAST_MAX_CONSUMERS 16
+#define BROADCAST_SLOT_DATA_SIZE 48
+
+// What the producer does when the slowest consumer is a full ring behind
+typedef enum
+{
+    BROADCAST_BACKPRESSURE = 0, // Wait for it; nobody ever misses a message
+    BROADCAST_OVERWRITE,        // Keep going; the laggard detects the overrun and skips ahead
+} broadcast_mode_t;
+
+// Consumer cursor states
+enum
+{
+    BROADCAST_CONSUMER_FREE = 0,
+    BROADCAST_CONSUMER_JOINING, // Claimed, cursor not set yet
+    BROADCAST_CONSUMER_ACTIVE,
+};
+
+// Each consumer's cursor lives alone on its cache line, only it writes there
+typedef struct
+{
+    _Alignas(SHM_CACHE_LINE) atomic_uint_least64_t cursor; // Next position this consumer reads
+    atomic_uint state;
+} broadcast_cursor_t;
+
+// One message. The sequence works like a seqlock: 2 * (position + 1) once
+// the message for position is complete, odd while it is being written.
+typedef struct
+{
+    atomic_uint_least64_t sequence;
+    uint32_t length; // Bytes used in data
+    uint32_t reserved;
+    uint8_t data[BROADCAST_SLOT_DATA_SIZE];
+} broadcast_slot_t;
+
+// Single-producer ring that every registered consumer reads in full
+typedef struct
+{
+    // Producer's line
+    _Alignas(SHM_CACHE_LINE) atomic_uint_least64_t published; // Messages published so far
+    uint64_t cached_min_cursor;                               // Producer's last view of the slowest consumer
+
+    _Alignas(SHM_CACHE_LINE) shm_waitpoint_t data_ready; // Consumers wait here once caught up
+    shm_waitpoint_t space_ready;                         // Producer waits here for the slowest consumer
+
+    // Read-only after creation
+    _Alignas(SHM_CACHE_LINE) uint64_t capacity;
+    uint64_t mask;
+    uint32_t mode;
+    atomic_bool shutdown_flag;
+
+    broadcast_cursor_t consumers[BROADCAST_MAX_CONSUMERS];
+
+    _Alignas(SHM_CACHE_LINE) broadcast_slot_t slots[];
+} broadcast_ring_t;
+
+// Bytes of shared memory needed for a ring of the given number of slots
+static inline size_t broadcast_ring_shm_size(size_t capacity)
+{
+    return sizeof(broadcast_ring_t) + capacity * sizeof(broadcast_slot_t);
+}
+
+// Set up an empty ring; capacity must be a power of 2
+static inline int broadcast_ring_init(broadcast_ring_t *ring, size_t capacity, broadcast_mode_t mode)
+{
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0)
+    {
+        return -1;
+    }
+
+    atomic_init(&ring->published, 0);
+    ring->cached_min_cursor = 0;
+    shm_waitpoint_init(&ring->data_ready);
+    shm_waitpoint_init(&ring->space_ready);
+    ring->capacity = capacity;
+    ring->mask = capacity - 1;
+    ring->mode = mode;
+    atomic_init(&ring->shutdown_flag, false);
+    for (int i = 0; i < BROADCAST_MAX_CONSUMERS; i++)
+    {
+        atomic_init(&ring->consumers[i].cursor, 0);
+        atomic_init(&ring->consumers[i].state, BROADCAST_CONSUMER_FREE);
+    }
+    for (size_t i = 0; i < capacity; i++)
+    {
+        atomic_init(&ring->slots[i].sequence, 0);
+    }
+    return 0;
+}
+
+// ===== CONSUMER REGISTRATION ===== //
+
+// Join the ring at the newest message. Returns the consumer's id, or -1 if
+// all BROADCAST_MAX_CONSUMERS cursors are taken.
+static inline int broadcast_ring_subscribe(broadcast_ring_t *ring)
+{
+    for (int i = 0; i < BROADCAST_MAX_CONSUMERS; i++)
+    {
+        unsigned expected = BROADCAST_CONSUMER_FREE;
+        if (atomic_compare_exchange_strong(&ring->consumers[i].state, &expected, BROADCAST_CONSUMER_JOINING))
+        {
+            // Start from what is published now
+            atomic_store_explicit(&ring->consumers[i].cursor,
+                                  atomic_load_explicit(&ring->published, memory_order_acquire),
+                                  memory_order_relaxed);
+            atomic_store_explicit(&ring->consumers[i].state, BROADCAST_CONSUMER_ACTIVE, memory_order_relaxed);
+
+            // Pairs with the fence in broadcast_ring_claim: either the producer's
+            // next scan sees us, or we see everything it published before that
+            // scan and never start behind what it may overwrite
+            atomic_thread_fence(memory_order_seq_cst);
+            atomic_store_explicit(&ring->consumers[i].cursor,
+                                  atomic_load_explicit(&ring->published, memory_order_acquire),
+                                  memory_order_release);
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Leave the ring so the producer stops waiting on this consumer
+static inline void broadcast_ring_unsubscribe(broadcast_ring_t *ring, int id)
+{
+    atomic_store_explicit(&ring->consumers[id].state, BROADCAST_CONSUMER_FREE, memory_order_release);
+    shm_notify(&ring->space_ready);
+}
+
+// ===== PRODUCER ===== //
+
+// Position of the slowest active consumer (published if there are none)
+static inline uint64_t broadcast_ring_min_cursor(broadcast_ring_t *ring, uint64_t published)
+{
+    uint64_t min = published;
+    for (int i = 0; i < BROADCAST_MAX_CONSUMERS; i++)
+    {
+        if (atomic_load_explicit(&ring->consumers[i].state, memory_order_acquire) != BROADCAST_CONSUMER_ACTIVE)
+        {
+            continue;
+        }
+        uint64_t cursor = atomic_load_explicit(&ring->consumers[i].cursor, memory_order_acquire);
+        if (cursor < min)
+        {
+            min = cursor;
+        }
+    }
+    return min;
+}
+
+// Claim the next slot to fill in place. With BROADCAST_BACKPRESSURE this
+// returns NULL while the slowest consumer is a full ring behind; with
+// BROADCAST_OVERWRITE it always succeeds. Finish with broadcast_ring_publish.
+static inline broadcast_slot_t *broadcast_ring_claim(broadcast_ring_t *ring)
+{
+    uint64_t pos = atomic_load_explicit(&ring->published, memory_order_relaxed);
+
+    // Only scan the consumer cursors when the cached view says we're full
+    if (ring->mode == BROADCAST_BACKPRESSURE && pos - ring->cached_min_cursor >= ring->capacity)
+    {
+        atomic_thread_fence(memory_order_seq_cst); // See broadcast_ring_subscribe
+        ring->cached_min_cursor = broadcast_ring_min_cursor(ring, pos);
+        if (pos - ring->cached_min_cursor >= ring->capacity)
+        {
+            return NULL;
+        }
+    }
+
+    // Mark the slot as being written before touching its payload
+    broadcast_slot_t *slot = &ring->slots[pos & ring->mask];
+    atomic_store_explicit(&slot->sequence, 2 * pos + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    return slot;
+}
+
+// Make the claimed slot visible to every consumer
+static inline void broadcast_ring_publish(broadcast_ring_t *ring, broadcast_slot_t *slot)
+{
+    uint64_t pos = atomic_load_explicit(&ring->published, memory_order_relaxed);
+
+    // The release stores order the payload writes before the slot turns ready
+    atomic_store_explicit(&slot->sequence, 2 * (pos + 1), memory_order_release);
+    atomic_store_explicit(&ring->published, pos + 1, memory_order_release);
+    shm_notify(&ring->data_ready);
+}
+
+// Slot for a position, for walking a run claimed or peeked in one call
+static inline broadcast_slot_t *broadcast_ring_slot(broadcast_ring_t *ring, uint64_t position)
+{
+    return &ring->slots[position & ring->mask];
+}
+
+// Claim up to max slots to fill in place, starting at *first. Backpressure
+// is checked once for the whole run. Returns how many (0 if the slowest
+// consumer is a full ring behind); finish with broadcast_ring_publish_batch.
+static inline size_t broadcast_ring_claim_batch(broadcast_ring_t *ring, size_t max, uint64_t *first)
+{
+    uint64_t pos = atomic_load_explicit(&ring->published, memory_order_relaxed);
+
+    size_t count = max;
+    if (ring->mode == BROADCAST_BACKPRESSURE)
+    {
+        uint64_t free_slots = ring->capacity - (pos - ring->cached_min_cursor);
+        if (free_slots < max)
+        {
+            atomic_thread_fence(memory_order_seq_cst); // See broadcast_ring_subscribe
+            ring->cached_min_cursor = broadcast_ring_min_cursor(ring, pos);
+            free_slots = ring->capacity - (pos - ring->cached_min_cursor);
+        }
+        if (free_slots < count)
+        {
+            count = free_slots;
+        }
+    }
+    else if (count > ring->capacity)
+    {
+        count = ring->capacity;
+    }
+
+    // Mark the slots as being written before touching their payloads
+    for (size_t i = 0; i < count; i++)
+    {
+        atomic_store_explicit(&broadcast_ring_slot(ring, pos + i)->sequence, 2 * (pos + i) + 1, memory_order_relaxed);
+    }
+    atomic_thread_fence(memory_order_release);
+
+    *first = pos;
+    return count;
+}
+
+// Make count slots from broadcast_ring_claim_batch visible with one update of published
+static inline void broadcast_ring_publish_batch(broadcast_ring_t *ring, size_t count)
+{
+    uint64_t pos = atomic_load_explicit(&ring->published, memory_order_relaxed);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        atomic_store_explicit(&broadcast_ring_slot(ring, pos + i)->sequence, 2 * (pos + i + 1), memory_order_release);
+    }
+    atomic_store_explicit(&ring->published, pos + count, memory_order_release);
+    shm_notify(&ring->data_ready);
+}
+
+// Copy a message into the ring once, for all consumers. Returns false if
+// backpressure from the slowest consumer stopped it.
+static inline bool broadcast_ring_send(broadcast_ring_t *ring, const void *data, uint32_t length)
+{
+    broadcast_slot_t *slot = broadcast_ring_claim(ring);
+    if (slot == NULL)
+    {
+        return false;
+    }
+
+    slot->length = length < BROADCAST_SLOT_DATA_SIZE ? length : BROADCAST_SLOT_DATA_SIZE;
+    memcpy(slot->data, data, slot->length);
+    broadcast_ring_publish(ring, slot);
+    return true;
+}
+
+// ===== CONSUMERS ===== //
+
+// Zero-copy read for BROADCAST_BACKPRESSURE rings: the consumer's next
+// message in place, or NULL if there is none yet. Free it with broadcast_ring_release.
+static inline const broadcast_slot_t *broadcast_ring_peek(broadcast_ring_t *ring, int id)
+{
+    uint64_t cursor = atomic_load_explicit(&ring->consumers[id].cursor, memory_order_relaxed);
+    broadcast_slot_t *slot = &ring->slots[cursor & ring->mask];
+    if (atomic_load_explicit(&slot->sequence, memory_order_acquire) != 2 * (cursor + 1))
+    {
+        return NULL;
+    }
+    return slot;
+}
+
+// Move the consumer past the message returned by broadcast_ring_peek
+static inline void broadcast_ring_release(broadcast_ring_t *ring, int id)
+{
+    uint64_t cursor = atomic_load_explicit(&ring->consumers[id].cursor, memory_order_relaxed);
+
+    // The release store keeps our reads of the payload before the producer reuses the slot
+    atomic_store_explicit(&ring->consumers[id].cursor, cursor + 1, memory_order_release);
+    shm_notify(&ring->space_ready);
+}
+
+// Zero-copy read of everything published for this consumer, for
+// BROADCAST_BACKPRESSURE rings: returns how many messages in a row (up to
+// max) start at *first. Read them through broadcast_ring_slot and free them
+// with broadcast_ring_release_batch.
+static inline size_t broadcast_ring_peek_batch(broadcast_ring_t *ring, int id, size_t max, uint64_t *first)
+{
+    uint64_t cursor = atomic_load_explicit(&ring->consumers[id].cursor, memory_order_relaxed);
+
+    // One load of published covers the whole run
+    uint64_t available = atomic_load_explicit(&ring->published, memory_order_acquire) - cursor;
+    *first = cursor;
+    return available < max ? available : max;
+}
+
+// Move the consumer past count messages returned by broadcast_ring_peek_batch
+static inline void broadcast_ring_release_batch(broadcast_ring_t *ring, int id, size_t count)
+{
+    uint64_t cursor = atomic_load_explicit(&ring->consumers[id].cursor, memory_order_relaxed);
+    atomic_store_explicit(&ring->consumers[id].cursor, cursor + count, memory_order_release);
+    shm_notify(&ring->space_ready);
+}
+
+// Copy the consumer's next message out; works in either mode. Returns 1 with
+// a message, 0 if there is none yet. Messages overwritten before this
+// consumer got to them are skipped and added to *lost.
+static inline int broadcast_ring_receive(broadcast_ring_t *ring, int id, void *data, uint32_t *length, uint64_t *lost)
+{
+    uint64_t cursor = atomic_load_explicit(&ring->consumers[id].cursor, memory_order_relaxed);
+    for (;;)
+    {
+        broadcast_slot_t *slot = &ring->slots[cursor & ring->mask];
+        uint64_t expected = 2 * (cursor + 1);
+
+        uint64_t seq = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        if (seq < expected)
+        {
+            return 0; // Not published yet
+        }
+        if (seq == expected)
+        {
+            uint32_t n = slot->length;
+            if (n > BROADCAST_SLOT_DATA_SIZE)
+            {
+                n = BROADCAST_SLOT_DATA_SIZE;
+            }
+            memcpy(data, slot->data, n);
+
+            // If the slot didn't change while we copied, the copy is intact
+            atomic_thread_fence(memory_order_acquire);
+            if (atomic_load_explicit(&slot->sequence, memory_order_relaxed) == expected)
+            {
+                *length = n;
+                atomic_store_explicit(&ring->consumers[id].cursor, cursor + 1, memory_order_release);
+                shm_notify(&ring->space_ready);
+                return 1;
+            }
+        }
+
+        // The producer lapped us: skip to the oldest message still in the ring
+        uint64_t published = atomic_load_explicit(&ring->published, memory_order_acquire);
+        uint64_t oldest = published > ring->capacity ? published - ring->capacity + 1 : 0;
+        if (oldest > cursor)
+        {
+            *lost += oldest - cursor;
+            cursor = oldest;
+        }
+        else
+        {
+            *lost += 1;
+            cursor++;
+        }
+    }
+}
+
+#endif // BROADCAST_RING_SHARED_H
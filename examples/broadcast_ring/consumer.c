@@ -0,0 +1,108 @@
+#include "shared_memory.h"
+#include "broadcast_ring_shared.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+
+// The message every consumer receives
+typedef struct
+{
+    uint64_t sequence;
+    float x;
+    float y;
+} sample_t;
+
+#define WAIT_TIMEOUT_MS 100 // Wake at least this often to notice Ctrl+C
+
+// Flag for clean shutdown
+volatile sig_atomic_t running = 1;
+
+// Signal handler for Ctrl+C
+void handle_sigint(int sig)
+{
+    (void)sig; // Suppress unused parameter warning
+    running = 0;
+}
+
+int main(int argc, char *argv[])
+{
+    // A name for the output, and an optional per-message delay to play a slow consumer
+    const char *role = argc > 1 ? argv[1] : "consumer";
+    int delay_us = argc > 2 ? atoi(argv[2]) : 0;
+    printf("Starting broadcast ring %s\n", role);
+
+    // How to wait once caught up with the producer
+    shm_wait_strategy_t strategy = SHM_WAIT_HYBRID;
+    if (argc > 3 && shm_wait_parse_strategy(argv[3], &strategy) != 0)
+    {
+        printf("Usage: %s [name] [delay_us] [spin|pause|hybrid|futex]\n", argv[0]);
+        return 1;
+    }
+
+    // Set up signal handler for clean shutdown
+    signal(SIGINT, handle_sigint);
+
+    // Open shared memory
+    shared_memory_t shm = {0};
+    if (shared_memory_open(&shm, BROADCAST_RING_SHM_NAME) != 0)
+    {
+        printf("Failed to open shared memory. Make sure producer is running first.\n");
+        return 1;
+    }
+
+    broadcast_ring_t *ring = (broadcast_ring_t *)shm.addr;
+
+    // Register our own cursor
+    int id = broadcast_ring_subscribe(ring);
+    if (id < 0)
+    {
+        printf("All %d consumer cursors are taken\n", BROADCAST_MAX_CONSUMERS);
+        shared_memory_destroy(&shm, 0);
+        return 1;
+    }
+
+    printf("Subscribed as consumer %d (%s wait)\n", id, shm_wait_strategy_name(strategy));
+    printf("Press Ctrl+C to exit\n");
+
+    uint64_t received = 0;
+    uint64_t lost = 0;
+    shm_waiter_t waiter;
+    shm_waiter_init(&waiter, &ring->data_ready, strategy);
+    while (running && !atomic_load(&ring->shutdown_flag))
+    {
+        sample_t sample;
+        uint32_t length;
+        if (!broadcast_ring_receive(ring, id, &sample, &length, &lost))
+        {
+            // No data available, wait for the producer to publish some
+            shm_wait(&waiter, WAIT_TIMEOUT_MS);
+            continue;
+        }
+        shm_wait_done(&waiter);
+        received++;
+
+        printf("\r[%s] sample %llu: (%.3f, %.3f), received %llu, lost %llu", role,
+               (unsigned long long)sample.sequence, sample.x, sample.y,
+               (unsigned long long)received, (unsigned long long)lost);
+        fflush(stdout);
+
+        if (delay_us > 0)
+        {
+            usleep(delay_us);
+        }
+    }
+
+    printf("\nShutting down...\n");
+
+    // Stop the producer from waiting on us
+    broadcast_ring_unsubscribe(ring, id);
+
+    // Clean up
+    shared_memory_destroy(&shm, 0); // Don't unlink, let producer do it
+
+    printf("Consumer process completed\n");
+
+    return 0;
+}
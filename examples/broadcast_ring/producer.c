@@ -0,0 +1,94 @@
+#include "shared_memory.h"
+#include "broadcast_ring_shared.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+
+#define WAIT_TIMEOUT_MS 100 // Wake at least this often to notice Ctrl+C
+
+// The message every consumer receives
+typedef struct
+{
+    uint64_t sequence;
+    float x;
+    float y;
+} sample_t;
+
+// Flag for clean shutdown
+volatile sig_atomic_t running = 1;
+
+// Signal handler for Ctrl+C
+void handle_sigint(int sig)
+{
+    (void)sig; // Suppress unused parameter warning
+    running = 0;
+}
+
+int main(int argc, char *argv[])
+{
+    // Backpressure by default; "overwrite" never waits for slow consumers
+    broadcast_mode_t mode = (argc > 1 && strcmp(argv[1], "overwrite") == 0) ? BROADCAST_OVERWRITE : BROADCAST_BACKPRESSURE;
+    printf("Starting broadcast ring producer (%s mode)\n", mode == BROADCAST_OVERWRITE ? "overwrite" : "backpressure");
+
+    // Set up signal handler for clean shutdown
+    signal(SIGINT, handle_sigint);
+
+    // Create shared memory
+    shared_memory_t shm = {0};
+    if (shared_memory_create(&shm, BROADCAST_RING_SHM_NAME, broadcast_ring_shm_size(BROADCAST_RING_DEFAULT_SLOTS)) != 0)
+    {
+        printf("Failed to create shared memory\n");
+        return 1;
+    }
+
+    broadcast_ring_t *ring = (broadcast_ring_t *)shm.addr;
+    broadcast_ring_init(ring, BROADCAST_RING_DEFAULT_SLOTS, mode);
+
+    printf("Ring of %d slots ready for up to %d consumers\n", BROADCAST_RING_DEFAULT_SLOTS, BROADCAST_MAX_CONSUMERS);
+    printf("Press Ctrl+C to exit\n");
+
+    // Seed random number generator
+    srand(time(NULL));
+
+    sample_t sample = {0};
+    shm_waiter_t waiter;
+    shm_waiter_init(&waiter, &ring->space_ready, SHM_WAIT_HYBRID);
+    while (running)
+    {
+        sample.x = (float)rand() / RAND_MAX;
+        sample.y = (float)rand() / RAND_MAX;
+
+        // Publish once, no matter how many consumers are reading
+        if (!broadcast_ring_send(ring, &sample, sizeof(sample)))
+        {
+            // The slowest consumer is a full ring behind, wait for it to move
+            shm_wait(&waiter, WAIT_TIMEOUT_MS);
+            continue;
+        }
+        shm_wait_done(&waiter);
+        sample.sequence++;
+
+        printf("\rPublished %llu samples", (unsigned long long)sample.sequence);
+        fflush(stdout);
+
+        // Slow down a bit to make it easier to observe
+        usleep(1000); // 1ms
+    }
+
+    printf("\nShutting down...\n");
+
+    // Tell the consumers we're done
+    atomic_store(&ring->shutdown_flag, true);
+    shm_notify(&ring->data_ready);
+    usleep(100000); // Give the consumers time to notice
+
+    // Clean up
+    shared_memory_destroy(&shm, 1);
+
+    printf("Producer process completed\n");
+
+    return 0;
+}
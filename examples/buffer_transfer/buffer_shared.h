@@ -1,15 +1,17 @@
 #ifndef BUFFER_SHARED_H
 #define BUFFER_SHARED_H
 
+#include "shm_sem.h"
+
 #define BUFFER_SHM_NAME "/buffer_example_shared_memory"
-#define BUFFER_SEM_READY_NAME "/buffer_example_sem_ready"
-#define BUFFER_SEM_DONE_NAME "/buffer_example_sem_done"
 
 typedef struct
 {
     float x;
     float y;
     int update_count;
+    shm_sem_t ready; // Posted by the consumer when it wants the next point
+    shm_sem_t done;  // Posted by the producer when a new point is written
 } point_data_t;
 
 #endif
\ No newline at end of file
@@ -6,25 +6,12 @@ int main()
     printf("Starting consumer (point receiver)\n");
     fflush(stdout);
 
-    // Open semaphores
-    sem_t *sem_ready = sem_open(BUFFER_SEM_READY_NAME, 0);
-    sem_t *sem_done = sem_open(BUFFER_SEM_DONE_NAME, 0);
-
-    if (sem_ready == SEM_FAILED || sem_done == SEM_FAILED)
-    {
-        perror("sem_open");
-        printf("Make sure producer is running first\n");
-        return 1;
-    }
-
-    printf("Semaphores opened\n");
-    fflush(stdout);
-
     // Open shared memory
     shared_memory_t shm = {0};
     if (shared_memory_open(&shm, BUFFER_SHM_NAME) != 0)
     {
         printf("Failed to open shared memory\n");
+        printf("Make sure producer is running first\n");
         return 1;
     }
 
@@ -38,7 +25,7 @@ int main()
     fflush(stdout);
 
     // Signal initial connection
-    sem_post(sem_ready);
+    shm_sem_post(&point_data->ready);
 
     // Continuously receive and print points
     printf("Ready to receive points. Press Ctrl+C to exit.\n");
@@ -52,7 +39,7 @@ int main()
     while (1)
     {
         // Wait for new data
-        sem_wait(sem_done);
+        shm_sem_wait(&point_data->done, -1);
 
         // Check if we have a new update
         if (point_data->update_count != last_update_count)
@@ -66,13 +53,11 @@ int main()
         }
 
         // Signal that we're ready for more data
-        sem_post(sem_ready);
+        shm_sem_post(&point_data->ready);
     }
 
     // This code will never be reached unless interrupted
     shared_memory_destroy(&shm, 0);
-    sem_close(sem_ready);
-    sem_close(sem_done);
 
     return 0;
 }
\ No newline at end of file
@@ -10,23 +10,6 @@ int main()
     // Seed random number generator
     srand(time(NULL));
 
-    // Remove any existing semaphores with these names
-    sem_unlink(BUFFER_SEM_READY_NAME);
-    sem_unlink(BUFFER_SEM_DONE_NAME);
-
-    // Create semaphores
-    sem_t *sem_ready = sem_open(BUFFER_SEM_READY_NAME, O_CREAT, S_IRUSR | S_IWUSR, 0);
-    sem_t *sem_done = sem_open(BUFFER_SEM_DONE_NAME, O_CREAT, S_IRUSR | S_IWUSR, 0);
-
-    if (sem_ready == SEM_FAILED || sem_done == SEM_FAILED)
-    {
-        perror("sem_open");
-        return 1;
-    }
-
-    printf("Semaphores created\n");
-    fflush(stdout);
-
     // Remove any existing shared memory with this name
     shm_unlink(BUFFER_SHM_NAME);
 
@@ -46,6 +29,8 @@ int main()
     point_data->x = 0.0f;
     point_data->y = 0.0f;
     point_data->update_count = 0;
+    shm_sem_init(&point_data->ready, 0);
+    shm_sem_init(&point_data->done, 0);
 
     printf("Shared memory initialized, waiting for consumer...\n");
     fflush(stdout);
@@ -53,7 +38,7 @@ int main()
     // Wait for consumer to connect
     printf("Waiting for consumer to connect...\n");
     fflush(stdout);
-    sem_wait(sem_ready);
+    shm_sem_wait(&point_data->ready, -1);
 
     printf("Consumer connected, beginning to generate random points\n");
     fflush(stdout);
@@ -71,10 +56,10 @@ int main()
         fflush(stdout);
 
         // Signal that new data is available
-        sem_post(sem_done);
+        shm_sem_post(&point_data->done);
 
         // Wait for consumer to process the data
-        sem_wait(sem_ready);
+        shm_sem_wait(&point_data->ready, -1);
 
         // Sleep a short time to control update rate (100ms)
         usleep(100000);
@@ -82,10 +67,6 @@ int main()
 
     // This code will never be reached unless interrupted
     shared_memory_destroy(&shm, 1);
-    sem_close(sem_ready);
-    sem_close(sem_done);
-    sem_unlink(BUFFER_SEM_READY_NAME);
-    sem_unlink(BUFFER_SEM_DONE_NAME);
 
     return 0;
 }
\ No newline at end of file
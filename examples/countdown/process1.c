@@ -1,22 +1,10 @@
 #include "shared_memory.h"
+#include "shm_sem.h"
 
 int main()
 {
     printf("Starting shared memory reader (process1)\n");
 
-    // Create semaphores
-    sem_unlink(SEM_READY_NAME);
-    sem_unlink(SEM_DONE_NAME);
-
-    sem_t *sem_ready = sem_open(SEM_READY_NAME, O_CREAT, S_IRUSR | S_IWUSR, 0);
-    sem_t *sem_done = sem_open(SEM_DONE_NAME, O_CREAT, S_IRUSR | S_IWUSR, 0);
-
-    if (sem_ready == SEM_FAILED || sem_done == SEM_FAILED)
-    {
-        perror("sem_open");
-        return 1;
-    }
-
     // Create shared memory
     shared_memory_t shm = {0};
     if (shared_memory_create(&shm, SHM_NAME, SHARED_MEM_SIZE) != 0)
@@ -25,19 +13,24 @@ int main()
         return 1;
     }
 
-    // Initialize the shared memory with a counter structure
+    // Initialize the shared memory with a counter structure and the
+    // semaphores for the handshake, which live right next to it
     typedef struct
     {
         int counter;
+        shm_sem_t ready;
+        shm_sem_t done;
     } shared_counter_t;
 
     shared_counter_t *counter_data = (shared_counter_t *)shm.addr;
     counter_data->counter = -1; // Initialize to an invalid value
+    shm_sem_init(&counter_data->ready, 0);
+    shm_sem_init(&counter_data->done, 0);
 
     printf("Shared memory created, waiting for writer...\n");
 
     // Wait for writer to connect
-    sem_wait(sem_ready);
+    shm_sem_wait(&counter_data->ready, -1);
 
     printf("Connection established, processing numbers...\n");
 
@@ -45,7 +38,7 @@ int main()
     while (1)
     {
         // Wait for the signal that a new number is available
-        sem_wait(sem_done);
+        shm_sem_wait(&counter_data->done, -1);
 
         // Read the number directly from shared memory
         int number = counter_data->counter;
@@ -58,16 +51,12 @@ int main()
         }
 
         // Signal that we're ready for the next number
-        sem_post(sem_ready);
+        shm_sem_post(&counter_data->ready);
     }
 
     // Clean up
     printf("Cleaning up resources\n");
     shared_memory_destroy(&shm, 1);
-    sem_close(sem_ready);
-    sem_close(sem_done);
-    sem_unlink(SEM_READY_NAME);
-    sem_unlink(SEM_DONE_NAME);
 
     printf("Reader process completed\n");
 
@@ -1,32 +1,25 @@
 #include "shared_memory.h"
+#include "shm_sem.h"
 
 int main()
 {
     printf("Starting shared memory writer (process2)\n");
 
-    // Open semaphores
-    sem_t *sem_ready = sem_open(SEM_READY_NAME, 0);
-    sem_t *sem_done = sem_open(SEM_DONE_NAME, 0);
-
-    if (sem_ready == SEM_FAILED || sem_done == SEM_FAILED)
-    {
-        perror("sem_open");
-        printf("Make sure process1 is running first\n");
-        return 1;
-    }
-
     // Open shared memory
     shared_memory_t shm = {0};
     if (shared_memory_open(&shm, SHM_NAME) != 0)
     {
         printf("Failed to open shared memory\n");
+        printf("Make sure process1 is running first\n");
         return 1;
     }
 
-    // Access the counter structure in shared memory
+    // Access the counter structure and handshake semaphores in shared memory
     typedef struct
     {
         int counter;
+        shm_sem_t ready;
+        shm_sem_t done;
     } shared_counter_t;
 
     shared_counter_t *counter_data = (shared_counter_t *)shm.addr;
@@ -34,7 +27,7 @@ int main()
     printf("Connected to shared memory\n");
 
     // Signal initial connection
-    sem_post(sem_ready);
+    shm_sem_post(&counter_data->ready);
 
     // Countdown from 10 to 0, sending each number to process1
     printf("Starting countdown from 10 to 0:\n");
@@ -46,12 +39,12 @@ int main()
         counter_data->counter = i;
 
         // Signal that a new number is available
-        sem_post(sem_done);
+        shm_sem_post(&counter_data->done);
 
         if (i > 0)
         {
             // Wait for process1 to process the number
-            sem_wait(sem_ready);
+            shm_sem_wait(&counter_data->ready, -1);
             sleep(1);
         }
         else
@@ -63,8 +56,6 @@ int main()
 
     // Clean up our resources
     shared_memory_destroy(&shm, 0); // Don't unlink, let process1 do it
-    sem_close(sem_ready);
-    sem_close(sem_done);
 
     printf("Writer process completed\n");
 
@@ -0,0 +1,97 @@
+#include "shared_memory.h"
+#include "magic_ring_shared.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <signal.h>
+
+// Flag for clean shutdown
+volatile sig_atomic_t running = 1;
+
+// Signal handler for Ctrl+C
+void handle_sigint(int sig)
+{
+    (void)sig; // Suppress unused parameter warning
+    running = 0;
+}
+
+#define WAIT_TIMEOUT_MS 100 // Wake at least this often to notice Ctrl+C
+
+int main(int argc, char *argv[])
+{
+    printf("Starting magic ring buffer consumer\n");
+
+    // How to wait when the ring is empty
+    shm_wait_strategy_t strategy = SHM_WAIT_HYBRID;
+    if (argc > 1 && shm_wait_parse_strategy(argv[1], &strategy) != 0)
+    {
+        printf("Usage: %s [spin|pause|hybrid|futex]\n", argv[0]);
+        return 1;
+    }
+
+    // Set up signal handler for clean shutdown
+    signal(SIGINT, handle_sigint);
+
+    // Open the ring, mapping its data region twice just like the producer
+    shared_memory_t shm = {0};
+    magic_ring_t ring;
+    if (magic_ring_open(&ring, &shm, MAGIC_RING_SHM_NAME) != 0)
+    {
+        printf("Failed to open shared memory. Make sure producer is running first.\n");
+        return 1;
+    }
+
+    printf("Connected to ring of %llu bytes (%s wait)\n", (unsigned long long)ring.header->capacity,
+           shm_wait_strategy_name(strategy));
+    printf("Press Ctrl+C to exit\n");
+
+    uint32_t expected = 0;
+    uint32_t errors = 0;
+    shm_waiter_t waiter;
+    shm_waiter_init(&waiter, &ring.header->data_ready, strategy);
+    while (running && !atomic_load(&ring.header->shutdown_flag))
+    {
+        // Everything readable is one contiguous run of bytes
+        size_t available;
+        const uint8_t *bytes = magic_ring_peek(&ring, &available);
+        if (available == 0)
+        {
+            // No data available, wait for the producer to commit some
+            shm_wait(&waiter, WAIT_TIMEOUT_MS);
+            continue;
+        }
+        shm_wait_done(&waiter);
+
+        // Parse frames in place, straight out of the ring
+        size_t offset = 0;
+        while (offset < available)
+        {
+            const frame_t *frame = (const frame_t *)(bytes + offset);
+            if (frame->sequence != expected)
+            {
+                errors++;
+            }
+            expected = frame->sequence + 1;
+
+            if (expected % 1000 == 0)
+            {
+                printf("\nMessage %u (%u bytes): %.*s...\n", frame->sequence, frame->length,
+                       (int)(frame->length < 16 ? frame->length : 16), frame->text);
+            }
+            offset += frame_size(frame->length);
+        }
+        magic_ring_release(&ring, offset);
+
+        printf("\rConsumed %u messages, %u sequence errors", expected, errors);
+        fflush(stdout);
+    }
+
+    printf("\nShutting down...\n");
+
+    // Clean up
+    shared_memory_destroy(&shm, 0); // Don't unlink, let producer do it
+
+    printf("Consumer process completed\n");
+
+    return 0;
+}
@@ -0,0 +1,139 @@
+#ifndef MAGIC_RING_SHARED_H
+#define MAGIC_RING_SHARED_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include "shared_memory.h"
+#include "shm_wait.h"
+
+#define MAGIC_RING_SHM_NAME "/magic_ring_shared_memory"
+#define MAGIC_RING_CAPACITY (64 * 1024) // Power of 2 and a multiple of the page size
+
+// Each message is a frame header followed by its text, padded to 8 bytes
+typedef struct
+{
+    uint32_t length;   // Bytes of text
+    uint32_t sequence; // Message number
+    char text[];
+} frame_t;
+
+static inline size_t frame_size(uint32_t length)
+{
+    return (sizeof(frame_t) + length + 7) & ~(size_t)7;
+}
+
+// Lives in the first page of the segment, the data region follows
+typedef struct
+{
+    _Alignas(SHM_CACHE_LINE) atomic_uint_least64_t write_index; // Producer writes here
+    _Alignas(SHM_CACHE_LINE) atomic_uint_least64_t read_index;  // Consumer reads here
+
+    // Where each side sleeps, away from the index lines
+    _Alignas(SHM_CACHE_LINE) shm_waitpoint_t data_ready; // Consumer waits here when empty
+    shm_waitpoint_t space_ready;                         // Producer waits here when full
+
+    // Read-only after creation
+    _Alignas(SHM_CACHE_LINE) uint64_t capacity;
+    atomic_bool shutdown_flag;
+} magic_ring_header_t;
+
+// A process's view of the ring. The data region is mapped twice in a row,
+// so any run of up to capacity bytes at data + (index & mask) is contiguous.
+typedef struct
+{
+    magic_ring_header_t *header;
+    uint8_t *data;
+    uint64_t mask;
+} magic_ring_t;
+
+// The header takes a whole page so the data region starts page aligned
+static inline size_t magic_ring_header_size(void)
+{
+    return (size_t)sysconf(_SC_PAGESIZE);
+}
+
+static inline void magic_ring_attach(magic_ring_t *ring, shared_memory_t *shm)
+{
+    ring->header = (magic_ring_header_t *)shm->addr;
+    ring->data = (uint8_t *)shm->addr + magic_ring_header_size();
+    ring->mask = shm->mirror_size - 1;
+}
+
+// Create the ring segment; capacity must be a power of 2 and a page multiple
+static inline int magic_ring_create(magic_ring_t *ring, shared_memory_t *shm, const char *name, size_t capacity)
+{
+    if ((capacity & (capacity - 1)) != 0)
+    {
+        fprintf(stderr, "magic_ring_create: capacity %zu is not a power of 2\n", capacity);
+        return -1;
+    }
+    if (shared_memory_create_mirrored(shm, name, magic_ring_header_size(), capacity) != 0)
+    {
+        return -1;
+    }
+
+    magic_ring_attach(ring, shm);
+    atomic_init(&ring->header->write_index, 0);
+    atomic_init(&ring->header->read_index, 0);
+    shm_waitpoint_init(&ring->header->data_ready);
+    shm_waitpoint_init(&ring->header->space_ready);
+    atomic_init(&ring->header->shutdown_flag, false);
+    ring->header->capacity = capacity;
+    return 0;
+}
+
+static inline int magic_ring_open(magic_ring_t *ring, shared_memory_t *shm, const char *name)
+{
+    if (shared_memory_open_mirrored(shm, name, magic_ring_header_size()) != 0)
+    {
+        return -1;
+    }
+
+    magic_ring_attach(ring, shm);
+    return 0;
+}
+
+// Producer: get n contiguous bytes to write in place, or NULL if they don't fit.
+// Publish them with magic_ring_commit.
+static inline uint8_t *magic_ring_reserve(magic_ring_t *ring, size_t n)
+{
+    uint64_t write_idx = atomic_load_explicit(&ring->header->write_index, memory_order_relaxed);
+    uint64_t read_idx = atomic_load_explicit(&ring->header->read_index, memory_order_acquire);
+    if (ring->mask + 1 - (write_idx - read_idx) < n)
+    {
+        return NULL;
+    }
+
+    return ring->data + (write_idx & ring->mask);
+}
+
+// Producer: make the first n reserved bytes visible to the consumer
+static inline void magic_ring_commit(magic_ring_t *ring, size_t n)
+{
+    uint64_t write_idx = atomic_load_explicit(&ring->header->write_index, memory_order_relaxed);
+    atomic_store_explicit(&ring->header->write_index, write_idx + n, memory_order_release);
+    shm_notify(&ring->header->data_ready);
+}
+
+// Consumer: a single contiguous pointer to all readable bytes, their count in *length
+static inline const uint8_t *magic_ring_peek(magic_ring_t *ring, size_t *length)
+{
+    uint64_t read_idx = atomic_load_explicit(&ring->header->read_index, memory_order_relaxed);
+    uint64_t write_idx = atomic_load_explicit(&ring->header->write_index, memory_order_acquire);
+
+    *length = write_idx - read_idx;
+    return ring->data + (read_idx & ring->mask);
+}
+
+// Consumer: hand n peeked bytes back to the producer
+static inline void magic_ring_release(magic_ring_t *ring, size_t n)
+{
+    uint64_t read_idx = atomic_load_explicit(&ring->header->read_index, memory_order_relaxed);
+    atomic_store_explicit(&ring->header->read_index, read_idx + n, memory_order_release);
+    shm_notify(&ring->header->space_ready);
+}
+
+#endif // MAGIC_RING_SHARED_H
@@ -0,0 +1,92 @@
+#include "shared_memory.h"
+#include "magic_ring_shared.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+
+#define MAX_TEXT_LENGTH 200
+#define WAIT_TIMEOUT_MS 100 // Wake at least this often to notice Ctrl+C
+
+// Flag for clean shutdown
+volatile sig_atomic_t running = 1;
+
+// Signal handler for Ctrl+C
+void handle_sigint(int sig)
+{
+    (void)sig; // Suppress unused parameter warning
+    running = 0;
+}
+
+int main()
+{
+    printf("Starting magic ring buffer producer\n");
+
+    // Set up signal handler for clean shutdown
+    signal(SIGINT, handle_sigint);
+
+    // Create the ring with its data region mapped twice
+    shared_memory_t shm = {0};
+    magic_ring_t ring;
+    if (magic_ring_create(&ring, &shm, MAGIC_RING_SHM_NAME, MAGIC_RING_CAPACITY) != 0)
+    {
+        printf("Failed to create shared memory\n");
+        return 1;
+    }
+
+    printf("Ring of %llu bytes mapped at %p and mirrored at %p\n",
+           (unsigned long long)ring.header->capacity, (void *)ring.data, (void *)(ring.data + ring.header->capacity));
+    printf("Waiting for consumer...\n");
+    printf("Press Ctrl+C to exit\n");
+
+    // Seed random number generator
+    srand(time(NULL));
+
+    uint32_t sequence = 0;
+    shm_waiter_t waiter;
+    shm_waiter_init(&waiter, &ring.header->space_ready, SHM_WAIT_HYBRID);
+    while (running)
+    {
+        // Reserve a whole frame; it is contiguous even across the end of the ring
+        uint32_t length = 1 + rand() % MAX_TEXT_LENGTH;
+        frame_t *frame = (frame_t *)magic_ring_reserve(&ring, frame_size(length));
+        if (frame == NULL)
+        {
+            // Ring full, wait for the consumer to release bytes
+            shm_wait(&waiter, WAIT_TIMEOUT_MS);
+            continue;
+        }
+        shm_wait_done(&waiter);
+
+        // Serialize straight into the ring, no split handling needed
+        frame->length = length;
+        frame->sequence = sequence;
+        for (uint32_t i = 0; i < length; i++)
+        {
+            frame->text[i] = 'a' + (sequence + i) % 26;
+        }
+        magic_ring_commit(&ring, frame_size(length));
+
+        sequence++;
+        printf("\rProduced %u messages", sequence);
+        fflush(stdout);
+
+        // Slow down a bit to make it easier to observe
+        usleep(1000); // 1ms
+    }
+
+    printf("\nShutting down...\n");
+
+    // Tell the consumer we're done
+    atomic_store(&ring.header->shutdown_flag, true);
+    shm_notify(&ring.header->data_ready);
+    usleep(100000); // Give the consumer time to notice
+
+    // Clean up
+    shared_memory_destroy(&shm, 1);
+
+    printf("Producer process completed\n");
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include "shared_memory.h"
+#include "handoff_shared.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// Flag for clean shutdown
+volatile sig_atomic_t running = 1;
+
+// Signal handler for Ctrl+C
+void handle_sigint(int sig)
+{
+    (void)sig; // Suppress unused parameter warning
+    running = 0;
+}
+
+int main()
+{
+    printf("Starting anonymous segment consumer\n");
+
+    // Set up signal handler for clean shutdown
+    signal(SIGINT, handle_sigint);
+
+    // Connect to the producer
+    int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock == -1)
+    {
+        perror("socket");
+        return 1;
+    }
+
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, HANDOFF_SOCKET_PATH, sizeof(addr.sun_path) - 1);
+
+    if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) == -1)
+    {
+        perror("connect");
+        printf("Make sure producer is running first\n");
+        close(sock);
+        return 1;
+    }
+
+    // The segment arrives as an fd; no name lookup, no size re-check if sealed
+    shared_memory_t shm = {0};
+    if (shared_memory_receive(&shm, sock, 0) != 0)
+    {
+        printf("Failed to receive shared memory\n");
+        close(sock);
+        return 1;
+    }
+    close(sock);
+
+    printf("Received %zu byte segment (%s)\n", shm.size, shm.sealed ? "sealed" : "not sealed");
+    printf("Press Ctrl+C to exit\n");
+
+    handoff_data_t *data = (handoff_data_t *)shm.addr;
+    uint64_t last_sequence = 0;
+
+    while (running)
+    {
+        uint64_t sequence = atomic_load_explicit(&data->sequence, memory_order_acquire);
+        if (sequence != last_sequence)
+        {
+            printf("\rUpdate #%llu: (%.2f, %.2f)   ", (unsigned long long)sequence, data->x, data->y);
+            fflush(stdout);
+            last_sequence = sequence;
+        }
+        else if (atomic_load_explicit(&data->shutdown_flag, memory_order_acquire))
+        {
+            printf("\nProducer has shut down, exiting...\n");
+            break;
+        }
+
+        usleep(10000); // 10ms
+    }
+
+    printf("\nShutting down...\n");
+
+    // The last mapping going away frees the segment
+    shared_memory_destroy(&shm, 0);
+
+    printf("Consumer process completed\n");
+
+    return 0;
+}
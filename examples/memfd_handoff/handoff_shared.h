@@ -0,0 +1,21 @@
+#ifndef HANDOFF_SHARED_H
+#define HANDOFF_SHARED_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+// Consumers connect here to be handed the segment's fd; the segment itself
+// never has a name, so there is nothing to clean up in /dev/shm
+#define HANDOFF_SOCKET_PATH "/tmp/memfd_handoff.sock"
+#define HANDOFF_SHM_SIZE 4096
+
+typedef struct
+{
+    atomic_uint_least64_t sequence; // Bumped after every update
+    atomic_bool shutdown_flag;
+    float x;
+    float y;
+} handoff_data_t;
+
+#endif // HANDOFF_SHARED_H
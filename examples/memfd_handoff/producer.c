@@ -0,0 +1,107 @@
+#include "shared_memory.h"
+#include "handoff_shared.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// Flag for clean shutdown
+volatile sig_atomic_t running = 1;
+
+// Signal handler for Ctrl+C
+void handle_sigint(int sig)
+{
+    (void)sig; // Suppress unused parameter warning
+    running = 0;
+}
+
+int main()
+{
+    printf("Starting anonymous segment producer\n");
+
+    // Set up signal handler for clean shutdown
+    signal(SIGINT, handle_sigint);
+
+    // Create an anonymous segment, sealed so consumers can trust its size
+    shared_memory_t shm = {0};
+    if (shared_memory_create_anonymous(&shm, HANDOFF_SHM_SIZE, SHM_SEALED) != 0)
+    {
+        printf("Failed to create shared memory\n");
+        return 1;
+    }
+
+    handoff_data_t *data = (handoff_data_t *)shm.addr;
+    atomic_init(&data->sequence, 0);
+    atomic_init(&data->shutdown_flag, false);
+
+    printf("Anonymous segment created (fd %d, %s)\n", shm.fd, shm.sealed ? "sealed" : "not sealed");
+
+    // Listen for consumers on a Unix-domain socket
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener == -1)
+    {
+        perror("socket");
+        shared_memory_destroy(&shm, 0);
+        return 1;
+    }
+
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, HANDOFF_SOCKET_PATH, sizeof(addr.sun_path) - 1);
+    unlink(HANDOFF_SOCKET_PATH);
+
+    if (bind(listener, (struct sockaddr *)&addr, sizeof(addr)) == -1 || listen(listener, 16) == -1)
+    {
+        perror("bind/listen");
+        close(listener);
+        shared_memory_destroy(&shm, 0);
+        return 1;
+    }
+
+    // Poll for new consumers between updates
+    fcntl(listener, F_SETFL, O_NONBLOCK);
+
+    printf("Listening on %s. Press Ctrl+C to exit.\n", HANDOFF_SOCKET_PATH);
+
+    // Seed random number generator
+    srand(time(NULL));
+
+    int consumers = 0;
+    while (running)
+    {
+        // Hand the segment to every consumer that connected
+        int client;
+        while ((client = accept(listener, NULL, NULL)) != -1)
+        {
+            if (shared_memory_send(client, &shm) == 0)
+            {
+                consumers++;
+                printf("\nHanded segment to consumer #%d\n", consumers);
+            }
+            close(client);
+        }
+
+        // Publish a new point
+        data->x = (float)(rand() % 10000) / 100.0f;
+        data->y = (float)(rand() % 10000) / 100.0f;
+        uint64_t sequence = atomic_fetch_add_explicit(&data->sequence, 1, memory_order_release) + 1;
+
+        printf("\rPublished update #%llu", (unsigned long long)sequence);
+        fflush(stdout);
+
+        usleep(100000); // 100ms
+    }
+
+    printf("\nShutting down...\n");
+
+    // Consumers keep the segment alive until they unmap it; nothing to unlink
+    atomic_store_explicit(&data->shutdown_flag, true, memory_order_release);
+    close(listener);
+    unlink(HANDOFF_SOCKET_PATH);
+    shared_memory_destroy(&shm, 0);
+
+    return 0;
+}
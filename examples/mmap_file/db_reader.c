@@ -1,14 +1,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <fcntl.h>
-#include <unistd.h>
-#include <sys/mman.h>
-#include <sys/stat.h>
-#include <errno.h>
 #include <signal.h>
 #include "mmap_shared.h"
 
+// Changes printed per snapshot
+#define READ_BATCH 64
+
 // Flag for clean shutdown
 volatile sig_atomic_t running = 1;
 
@@ -19,80 +17,80 @@ void handle_sigint(int sig)
     running = 0;
 }
 
-int main()
+int main(int argc, char *argv[])
 {
     printf("Starting memory-mapped database reader\n");
 
-    // Set up signal handler for clean shutdown
-    signal(SIGINT, handle_sigint);
-
-    // Open the file
-    int fd = open(MMAP_FILE_PATH, O_RDONLY);
-    if (fd == -1)
+    // How to wait for new records
+    shm_wait_strategy_t strategy = SHM_WAIT_FUTEX;
+    if (argc > 1 && shm_wait_parse_strategy(argv[1], &strategy) != 0)
     {
-        perror("Failed to open file");
-        printf("Make sure to run db_creator first\n");
+        printf("Usage: %s [spin|pause|hybrid|futex]\n", argv[0]);
         return 1;
     }
 
-    // Get file size
-    struct stat sb;
-    if (fstat(fd, &sb) == -1)
-    {
-        perror("Failed to get file size");
-        close(fd);
-        return 1;
-    }
+    // Set up signal handler for clean shutdown
+    signal(SIGINT, handle_sigint);
 
-    // Map the file into memory (read-only)
-    void *addr = mmap(NULL, sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
-    if (addr == MAP_FAILED)
+    // Map the database (writable, since waiting registers us in the header)
+    mmap_db_t handle;
+    if (mmap_db_open(&handle, MMAP_FILE_PATH, NULL, 0) != 0)
     {
-        perror("Failed to map file");
-        close(fd);
+        printf("Make sure to run db_creator first\n");
         return 1;
     }
-
-    // Get database pointer
-    mmap_database_t *db = (mmap_database_t *)addr;
+    mmap_database_t *db = handle.db;
 
     printf("Connected to database with %u/%u records\n",
-           db->record_count, db->max_records);
+           mmap_db_record_count(db), db->max_records);
     printf("Press Ctrl+C to exit\n\n");
 
-    // Monitor for changes
-    uint32_t last_count = db->record_count;
+    // Tail the change feed from here on
+    mmap_db_feed_t feed;
+    mmap_db_feed_init(&feed, db);
 
     while (running)
     {
-        // Check if record count has changed
-        if (db->record_count != last_count)
+        // Sleep until a writer publishes a change, waking now and then to see Ctrl+C
+        if (mmap_db_feed_wait(&feed, strategy, 100) != 0)
         {
-            printf("Database updated: %u records (added %u)\n",
-                   db->record_count, db->record_count - last_count);
+            continue;
+        }
 
-            // Print the new records
-            for (uint32_t i = last_count; i < db->record_count; i++)
+        // Take a batch of changes, then a snapshot that includes all of them
+        db_change_t changes[READ_BATCH];
+        int count = 0;
+        int result;
+        while (count < READ_BATCH && (result = mmap_db_feed_next(&feed, &changes[count])) != 0)
+        {
+            if (result < 0)
             {
-                record_t *record = &db->records[i];
-                printf("  Record #%u: ID=%u, Name='%s', Value=%.2f, Active=%s\n",
-                       i, record->id, record->name, record->value,
-                       record->is_active ? "true" : "false");
+                printf("Fell behind the change feed, some changes were missed\n");
+                continue;
             }
-
-            last_count = db->record_count;
-            printf("\n");
+            count++;
         }
 
-        // Sleep to avoid busy waiting
-        usleep(500000); // 500ms
+        mmap_db_snapshot_t snapshot;
+        if (mmap_db_snapshot_begin(&handle, &snapshot) != 0)
+        {
+            break;
+        }
+        for (int i = 0; i < count; i++)
+        {
+            record_t record;
+            mmap_db_snapshot_read(&snapshot, changes[i].index, &record);
+            printf("%s record #%u: ID=%u, Name='%s', Value=%.2f, Active=%s\n",
+                   mmap_db_change_kind_name(changes[i].kind), changes[i].index, record.id, record.name,
+                   record.value, record.is_active ? "true" : "false");
+        }
+        mmap_db_snapshot_end(&snapshot);
     }
 
     printf("\nShutting down...\n");
 
     // Clean up
-    munmap(addr, sb.st_size);
-    close(fd);
+    mmap_db_close(&handle);
 
     printf("Reader process completed\n");
 
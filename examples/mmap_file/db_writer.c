@@ -1,80 +1,158 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <fcntl.h>
-#include <unistd.h>
-#include <sys/mman.h>
-#include <sys/stat.h>
-#include <errno.h>
 #include <time.h>
+#include <pthread.h>
 #include "mmap_shared.h"
 
-// Function to add a record to the database
-int add_record(mmap_database_t *db, const char *name, double value)
+// Add a record and wait until it is durable
+int add_record(mmap_db_t *handle, const char *name, double value)
 {
-    // Check if database is full
-    if (db->record_count >= db->max_records)
+    uint64_t lsn = 0;
+    if (mmap_db_add_record(handle, name, value, &lsn) != 0)
     {
-        printf("Error: Database is full\n");
+        printf("Error: Database is full and can't grow any further\n");
         return -1;
     }
 
-    // Lock the mutex
-    pthread_mutex_lock(&db->mutex);
+    // Group commit: this fsyncs the log once for every insert waiting on it,
+    // instead of syncing the whole record file per insert
+    if (mmap_db_commit(handle, lsn) != 0)
+    {
+        printf("Error: Failed to commit the record to the log\n");
+        return -1;
+    }
 
-    // Create a new record
-    record_t *record = &db->records[db->record_count];
-    record->id = db->record_count + 1;
-    strncpy(record->name, name, sizeof(record->name) - 1);
-    record->name[sizeof(record->name) - 1] = '\0'; // Ensure null termination
-    record->value = value;
-    record->is_active = true;
+    return 0;
+}
+
+// Change a record and wait until the change is durable
+int update_record(mmap_db_t *handle, uint32_t id, double value, bool is_active)
+{
+    uint64_t lsn = 0;
+    if (mmap_db_update_record(handle, id, value, is_active, &lsn) != 0)
+    {
+        printf("Error: No record %u, or too many old versions held by readers\n", id);
+        return -1;
+    }
+    if (mmap_db_commit(handle, lsn) != 0)
+    {
+        printf("Error: Failed to commit the update to the log\n");
+        return -1;
+    }
 
-    // Increment record count
-    db->record_count++;
+    printf("Updated record %u: value %.2f, %s\n", id, value, is_active ? "active" : "inactive");
+    return 0;
+}
 
-    // Unlock the mutex
-    pthread_mutex_unlock(&db->mutex);
+// Mark a record deleted and wait until that is durable
+int delete_record(mmap_db_t *handle, uint32_t id)
+{
+    uint64_t lsn = 0;
+    if (mmap_db_delete_record(handle, id, &lsn) != 0)
+    {
+        printf("Error: No record %u, or too many old versions held by readers\n", id);
+        return -1;
+    }
+    if (mmap_db_commit(handle, lsn) != 0)
+    {
+        printf("Error: Failed to commit the delete to the log\n");
+        return -1;
+    }
 
+    printf("Deleted record %u\n", id);
     return 0;
 }
 
-int main()
+// Look a record up by id if the key is a number, by name otherwise
+void find_record(const mmap_database_t *db, const char *key)
+{
+    char *end;
+    unsigned long id = strtoul(key, &end, 10);
+    const record_t *record = *end == '\0' ? mmap_db_find_by_id(db, (uint32_t)id) : mmap_db_find_by_name(db, key);
+
+    if (record == NULL)
+    {
+        printf("No record '%s'\n", key);
+        return;
+    }
+    printf("Record %u: '%s' with value %.2f\n", record->id, record->name, record->value);
+}
+
+// List the records with value in [low, high] in value order
+void list_range(mmap_database_t *db, double low, double high)
+{
+    pthread_mutex_lock(&db->mutex);
+
+    mmap_db_range_t range;
+    mmap_db_range_begin(&range, db, low, high);
+    const record_t *record;
+    uint32_t matches = 0;
+    while ((record = mmap_db_range_next(&range)) != NULL)
+    {
+        if (record->is_active)
+        {
+            printf("  Record %u: '%s' with value %.2f\n", record->id, record->name, record->value);
+            matches++;
+        }
+    }
+
+    pthread_mutex_unlock(&db->mutex);
+    printf("%u records with value in [%.2f, %.2f]\n", matches, low, high);
+}
+
+// Print how much flushing and logging the inserts have cost so far
+void show_flush_stats(mmap_db_t *handle)
+{
+    shm_dirty_stats_t flush = shm_dirty_stats(&handle->dirty);
+    printf("Record file: %llu flushes, %llu ranges, %llu KB, avg %.1f us, max %.1f us\n",
+           (unsigned long long)flush.flushes, (unsigned long long)flush.ranges,
+           (unsigned long long)(flush.bytes / 1024),
+           flush.flushes > 0 ? flush.total_ns / 1e3 / flush.flushes : 0, flush.max_ns / 1e3);
+
+    if (handle->logging)
+    {
+        shm_wal_stats_t log = shm_wal_stats(&handle->wal);
+        printf("Log: %llu records in %llu commits, %llu KB, avg %.1f us per commit\n",
+               (unsigned long long)log.records, (unsigned long long)log.commits,
+               (unsigned long long)(log.bytes / 1024),
+               log.commits > 0 ? log.sync_ns / 1e3 / log.commits : 0);
+    }
+}
+
+int main(int argc, char *argv[])
 {
     printf("Starting memory-mapped database writer\n");
 
-    // Open the file
-    int fd = open(MMAP_FILE_PATH, O_RDWR);
-    if (fd == -1)
+    // Commit through the log by default, or flush the record file directly
+    const char *mode_name = argc > 1 ? argv[1] : "log";
+    int use_log = strcmp(mode_name, "log") == 0;
+    mmap_db_sync_mode_t sync_mode = MMAP_DB_SYNC_RANGE;
+    if (!use_log && mmap_db_parse_sync_mode(mode_name, &sync_mode) != 0)
     {
-        perror("Failed to open file");
-        printf("Make sure to run db_creator first\n");
+        printf("Usage: %s [log|file|range|async|background]\n", argv[0]);
         return 1;
     }
 
-    // Get file size
-    struct stat sb;
-    if (fstat(fd, &sb) == -1)
+    // Map the database, replaying any inserts left in the log
+    mmap_db_t handle;
+    if (mmap_db_open(&handle, MMAP_FILE_PATH, use_log ? MMAP_WAL_PATH : NULL, MMAP_COMMIT_DELAY_US) != 0)
     {
-        perror("Failed to get file size");
-        close(fd);
+        printf("Make sure to run db_creator first\n");
         return 1;
     }
-
-    // Map the file into memory
-    void *addr = mmap(NULL, sb.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-    if (addr == MAP_FAILED)
+    if (!use_log && mmap_db_set_sync_mode(&handle, sync_mode, MMAP_FLUSH_INTERVAL_MS) != 0)
     {
-        perror("Failed to map file");
-        close(fd);
+        mmap_db_close(&handle);
         return 1;
     }
+    printf("Committing inserts with %s\n", use_log ? "the write-ahead log" : mmap_db_sync_mode_name(sync_mode));
 
     // Get database pointer
-    mmap_database_t *db = (mmap_database_t *)addr;
+    mmap_database_t *db = handle.db;
 
     printf("Connected to database with %u/%u records\n",
-           db->record_count, db->max_records);
+           mmap_db_record_count(db), db->max_records);
 
     // Seed random number generator
     srand(time(NULL));
@@ -82,7 +160,9 @@ int main()
     // Interactive menu
     char choice;
     char name[64];
-    double value;
+    double value, high;
+    uint32_t id;
+    int active;
 
     do
     {
@@ -90,6 +170,11 @@ int main()
         printf("1. Add random record\n");
         printf("2. Add custom record\n");
         printf("3. Show record count\n");
+        printf("4. Show flush stats\n");
+        printf("5. Find record by id or name\n");
+        printf("6. List records in a value range\n");
+        printf("7. Update record\n");
+        printf("8. Delete record\n");
         printf("q. Quit\n");
         printf("Choice: ");
 
@@ -102,15 +187,9 @@ int main()
             snprintf(name, sizeof(name), "Random Record %d", rand() % 1000);
             value = (rand() % 10000) / 100.0;
 
-            if (add_record(db, name, value) == 0)
+            if (add_record(&handle, name, value) == 0)
             {
                 printf("Added random record: '%s' with value %.2f\n", name, value);
-
-                // Sync changes to disk
-                if (msync(addr, sb.st_size, MS_SYNC) == -1)
-                {
-                    perror("Failed to sync memory to disk");
-                }
             }
             break;
 
@@ -122,20 +201,48 @@ int main()
             printf("Enter record value: ");
             scanf("%lf", &value);
 
-            if (add_record(db, name, value) == 0)
+            if (add_record(&handle, name, value) == 0)
             {
                 printf("Added custom record: '%s' with value %.2f\n", name, value);
-
-                // Sync changes to disk
-                if (msync(addr, sb.st_size, MS_SYNC) == -1)
-                {
-                    perror("Failed to sync memory to disk");
-                }
             }
             break;
 
         case '3':
-            printf("Current record count: %u/%u\n", db->record_count, db->max_records);
+            printf("Current record count: %u/%u\n", mmap_db_record_count(db), db->max_records);
+            break;
+
+        case '4':
+            show_flush_stats(&handle);
+            break;
+
+        case '5':
+            printf("Enter record id or name: ");
+            scanf(" %63s", name);
+            find_record(db, name);
+            break;
+
+        case '6':
+            printf("Enter lowest and highest value: ");
+            if (scanf("%lf %lf", &value, &high) == 2)
+            {
+                list_range(db, value, high);
+            }
+            break;
+
+        case '7':
+            printf("Enter record id, new value and active (1/0): ");
+            if (scanf("%u %lf %d", &id, &value, &active) == 3)
+            {
+                update_record(&handle, id, value, active != 0);
+            }
+            break;
+
+        case '8':
+            printf("Enter record id: ");
+            if (scanf("%u", &id) == 1)
+            {
+                delete_record(&handle, id);
+            }
             break;
 
         case 'q':
@@ -149,9 +256,12 @@ int main()
 
     } while (choice != 'q' && choice != 'Q');
 
-    // Clean up
-    munmap(addr, sb.st_size);
-    close(fd);
+    // Write the records back so the log can start over, then clean up
+    if (mmap_db_checkpoint(&handle) != 0)
+    {
+        printf("Failed to checkpoint the database\n");
+    }
+    mmap_db_close(&handle);
 
     printf("Writer process completed\n");
 
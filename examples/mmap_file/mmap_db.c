@@ -0,0 +1,1669 @@
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <signal.h>
+#include <sched.h>
+#include <time.h>
+#ifdef __APPLE__
+#include <sys/sysctl.h>
+#endif
+#include "mmap_shared.h"
+
+// Hash of a record id (murmur3 finalizer), never 0
+static uint32_t hash_id(uint32_t id)
+{
+    uint32_t h = id;
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h != 0 ? h : 1;
+}
+
+// FNV-1a hash of a record name, never 0
+static uint32_t hash_name(const char *name)
+{
+    uint32_t hash = 2166136261u;
+    for (const char *p = name; *p != '\0'; p++)
+    {
+        hash ^= (uint8_t)*p;
+        hash *= 16777619u;
+    }
+    return hash != 0 ? hash : 1;
+}
+
+// Point the first free bucket along hash's probe sequence at record,
+// unless one already does (replay indexes some records twice) or, for the
+// name index, a record with the same name got there first: lookups only
+// ever return the first, and a run of equal keys would make every probe
+// through it slower. Called under the mutex; the version makes the change
+// atomic to readers.
+static void index_insert(mmap_db_t *handle, db_index_bucket_t *table, uint32_t hash, uint32_t record,
+                         const char *name)
+{
+    mmap_database_t *db = handle->db;
+    uint32_t mask = db->index_slots - 1;
+    for (uint32_t i = hash & mask;; i = (i + 1) & mask)
+    {
+        db_index_bucket_t *bucket = &table[i];
+        if (bucket->record == record + 1)
+        {
+            return;
+        }
+        if (bucket->record != 0)
+        {
+            if (name != NULL && bucket->hash == hash && strcmp(db->records[bucket->record - 1].name, name) == 0)
+            {
+                return;
+            }
+            continue;
+        }
+
+        uint32_t version = atomic_load_explicit(&bucket->version, memory_order_relaxed);
+        atomic_store_explicit(&bucket->version, version + 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        bucket->hash = hash;
+        bucket->record = record + 1;
+        atomic_store_explicit(&bucket->version, version + 2, memory_order_release);
+
+        shm_dirty_mark(&handle->dirty, bucket, sizeof(*bucket));
+        return;
+    }
+}
+
+// Add records[index] to both indexes
+static void index_record(mmap_db_t *handle, uint32_t index)
+{
+    mmap_database_t *db = handle->db;
+    const record_t *record = &db->records[index];
+    index_insert(handle, db_id_index(db), hash_id(record->id), index, NULL);
+    index_insert(handle, db_name_index(db), hash_name(record->name), index, record->name);
+}
+
+// Wait out a growth in progress and return the layout sequence the
+// reads that follow are checked against
+static uint32_t layout_begin(const mmap_database_t *db)
+{
+    for (;;)
+    {
+        uint32_t sequence = atomic_load_explicit(&db->layout, memory_order_acquire);
+        if (!(sequence & 1))
+        {
+            return sequence;
+        }
+        sched_yield(); // Growth copies most of the file; let the writer run
+    }
+}
+
+// Whether the file grew since layout_begin returned sequence, in which
+// case whatever was read since may come from regions half moved
+static int layout_moved(const mmap_database_t *db, uint32_t sequence)
+{
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&db->layout, memory_order_relaxed) != sequence;
+}
+
+// Read a bucket without the mutex. Returns its record index + 1, or 0 if
+// it is empty or the layout moved; its key hash goes to *hash.
+static uint32_t read_bucket(const mmap_database_t *db, const db_index_bucket_t *bucket, uint32_t *hash,
+                            uint32_t layout)
+{
+    for (;;)
+    {
+        uint32_t before = atomic_load_explicit(&bucket->version, memory_order_acquire);
+        if (before & 1)
+        {
+            if (layout_moved(db, layout))
+            {
+                return 0;
+            }
+            shm_cpu_relax();
+            continue;
+        }
+
+        uint32_t record = bucket->record;
+        *hash = bucket->hash;
+
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&bucket->version, memory_order_relaxed) == before)
+        {
+            return record;
+        }
+    }
+}
+
+// Probe an index until an empty bucket, where the key would have gone,
+// for the record with this id, or this name if name isn't NULL. While the
+// file grows the table may be half rebuilt, so the probe is bounded and
+// checks what it finds; the caller retries if the layout moved.
+static const record_t *index_lookup(const mmap_database_t *db, uint32_t hash, uint32_t id, const char *name,
+                                    uint32_t layout)
+{
+    const db_index_bucket_t *table = name != NULL ? db_name_index(db) : db_id_index(db);
+    uint32_t mask = db->index_slots - 1;
+    uint32_t max_records = db->max_records;
+
+    uint32_t i = hash & mask;
+    for (uint32_t probes = 0; probes <= mask; probes++, i = (i + 1) & mask)
+    {
+        uint32_t bucket_hash;
+        uint32_t record = read_bucket(db, &table[i], &bucket_hash, layout);
+        if (record == 0 || record > max_records)
+        {
+            return NULL;
+        }
+
+        const record_t *candidate = &db->records[record - 1];
+        if (bucket_hash == hash &&
+            (name != NULL ? strncmp(candidate->name, name, sizeof(candidate->name)) == 0 : candidate->id == id))
+        {
+            return candidate;
+        }
+    }
+    return NULL;
+}
+
+const record_t *mmap_db_find_by_id(const mmap_database_t *db, uint32_t id)
+{
+    for (;;)
+    {
+        uint32_t layout = layout_begin(db);
+        const record_t *record = index_lookup(db, hash_id(id), id, NULL, layout);
+        if (!layout_moved(db, layout))
+        {
+            return record;
+        }
+    }
+}
+
+const record_t *mmap_db_find_by_name(const mmap_database_t *db, const char *name)
+{
+    uint32_t hash = hash_name(name);
+    for (;;)
+    {
+        uint32_t layout = layout_begin(db);
+        const record_t *record = index_lookup(db, hash, 0, name, layout);
+        if (!layout_moved(db, layout))
+        {
+            return record;
+        }
+    }
+}
+
+// Most tree nodes records can need, node 0 included: leaves and inner
+// nodes other than the root are at least half full
+static uint64_t tree_nodes_for(uint64_t records)
+{
+    uint64_t level = (records + DB_TREE_ORDER / 2 - 1) / (DB_TREE_ORDER / 2);
+    uint64_t nodes = 2 + level; // Node 0 and a root
+    while (level > 1)
+    {
+        level = (level + DB_TREE_ORDER / 2) / (DB_TREE_ORDER / 2 + 1);
+        nodes += level;
+    }
+    return nodes;
+}
+
+// Place the record slots, the indexes, the tree and the version pool
+// after records records; returns the end of the pool
+static uint64_t place_layout(mmap_database_t *db, uint64_t records, uint64_t slots)
+{
+    db->max_records = (uint32_t)records;
+    db->index_slots = (uint32_t)slots;
+    db->slots_offset = shm_round_up(sizeof(mmap_database_t) + records * sizeof(record_t), SHM_CACHE_LINE);
+    db->index_offset = shm_round_up(db->slots_offset + records * sizeof(db_record_slot_t), SHM_CACHE_LINE);
+    db->tree_offset = shm_round_up(db->index_offset + 2 * slots * sizeof(db_index_bucket_t), sizeof(db_tree_node_t));
+    db->tree_capacity = (uint32_t)tree_nodes_for(records);
+    db->versions_offset = db->tree_offset + (uint64_t)db->tree_capacity * sizeof(db_tree_node_t);
+    db->version_capacity = (uint32_t)(records / DB_RECORDS_PER_VERSION + DB_MIN_VERSIONS);
+    return db->versions_offset + (uint64_t)db->version_capacity * sizeof(db_version_t);
+}
+
+// Split size bytes between the header, the records, the two indexes and
+// the tree: the bucket count that lets the most records in at most 3/4 load
+static void plan_layout(mmap_database_t *db, size_t size)
+{
+    uint64_t best_records = 0, best_slots = 4;
+    for (uint64_t slots = 4; 2 * slots * sizeof(db_index_bucket_t) < size; slots <<= 1)
+    {
+        // Binary search for the most records that fit with this many buckets
+        uint64_t low = 0, high = slots * DB_INDEX_MAX_LOAD / 4;
+        while (low < high)
+        {
+            uint64_t middle = (low + high + 1) / 2;
+            if (place_layout(db, middle, slots) <= size)
+            {
+                low = middle;
+            }
+            else
+            {
+                high = middle - 1;
+            }
+        }
+        if (low > best_records)
+        {
+            best_records = low;
+            best_slots = slots;
+        }
+    }
+    place_layout(db, best_records, best_slots);
+}
+
+size_t mmap_db_file_size(uint32_t records)
+{
+    uint64_t slots = 4;
+    while (slots * DB_INDEX_MAX_LOAD / 4 < records)
+    {
+        slots <<= 1;
+    }
+    mmap_database_t layout;
+    return place_layout(&layout, records, slots);
+}
+
+// Take a fresh node from the tree's region
+static uint32_t tree_alloc(mmap_db_t *handle, int leaf)
+{
+    mmap_database_t *db = handle->db;
+    if (db->tree_nodes >= db->tree_capacity)
+    {
+        return 0; // Can't happen: the region holds the worst case
+    }
+
+    uint32_t index = db->tree_nodes++;
+    db_tree_node_t *node = db_tree_node(db, index);
+    memset(node, 0, sizeof(*node));
+    node->leaf = leaf;
+    shm_dirty_mark(&handle->dirty, &db->tree_nodes, sizeof(db->tree_nodes));
+    return index;
+}
+
+// Keys in node that are <= key: where key goes after its equals
+static uint32_t upper_bound(const db_tree_node_t *node, double key)
+{
+    uint32_t low = 0, high = node->count;
+    while (low < high)
+    {
+        uint32_t middle = (low + high) / 2;
+        if (node->keys[middle] <= key)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+// Keys in node that are < key: where the first of its equals is
+static uint32_t lower_bound(const db_tree_node_t *node, double key)
+{
+    uint32_t low = 0, high = node->count;
+    while (low < high)
+    {
+        uint32_t middle = (low + high) / 2;
+        if (node->keys[middle] < key)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+// Insert key -> value into the subtree at index. If the node splits, its
+// new right sibling goes to *split and that sibling's first key to
+// *split_key; otherwise *split is 0.
+static int tree_insert_at(mmap_db_t *handle, uint32_t index, double key, uint32_t value, uint32_t *split,
+                          double *split_key)
+{
+    mmap_database_t *db = handle->db;
+    db_tree_node_t *node = db_tree_node(db, index);
+    *split = 0;
+
+    // Find where the key goes; inner nodes pass it down first
+    uint32_t position = upper_bound(node, key);
+    if (!node->leaf)
+    {
+        uint32_t child_split;
+        double child_key;
+        if (tree_insert_at(handle, node->children[position], key, value, &child_split, &child_key) != 0)
+        {
+            return -1;
+        }
+        if (child_split == 0)
+        {
+            return 0;
+        }
+
+        // The child split: its new sibling goes in right after it
+        key = child_key;
+        value = child_split;
+    }
+
+    // Build the node with the new entry in a scratch copy; inner nodes keep
+    // child i to the left of key i, so the new child sits after its key
+    double keys[DB_TREE_ORDER + 1];
+    uint32_t children[DB_TREE_ORDER + 2];
+    uint32_t count = node->count;
+    uint32_t offset = node->leaf ? 0 : 1;
+    memcpy(keys, node->keys, position * sizeof(double));
+    memcpy(children, node->children, (position + offset) * sizeof(uint32_t));
+    keys[position] = key;
+    children[position + offset] = value;
+    memcpy(keys + position + 1, node->keys + position, (count - position) * sizeof(double));
+    memcpy(children + position + offset + 1, node->children + position + offset,
+           (count - position) * sizeof(uint32_t));
+    count++;
+
+    if (count <= DB_TREE_ORDER)
+    {
+        memcpy(node->keys, keys, count * sizeof(double));
+        memcpy(node->children, children, (count + offset) * sizeof(uint32_t));
+        node->count = count;
+        shm_dirty_mark(&handle->dirty, node, sizeof(*node));
+        return 0;
+    }
+
+    // Full: split in two. A leaf keeps its keys in both halves and the
+    // right one's first key is copied up; an inner node moves its middle
+    // key up instead.
+    uint32_t right_index = tree_alloc(handle, node->leaf);
+    if (right_index == 0)
+    {
+        return -1;
+    }
+    node = db_tree_node(db, index);
+    db_tree_node_t *right = db_tree_node(db, right_index);
+
+    uint32_t left_count = count / 2;
+    uint32_t right_start = node->leaf ? left_count : left_count + 1;
+    right->count = count - right_start;
+    memcpy(right->keys, keys + right_start, right->count * sizeof(double));
+    memcpy(right->children, children + right_start, (right->count + offset) * sizeof(uint32_t));
+    *split_key = keys[left_count];
+
+    node->count = left_count;
+    memcpy(node->keys, keys, left_count * sizeof(double));
+    memcpy(node->children, children, (left_count + offset) * sizeof(uint32_t));
+    if (node->leaf)
+    {
+        right->next = node->next;
+        node->next = right_index;
+    }
+
+    shm_dirty_mark(&handle->dirty, node, sizeof(*node));
+    shm_dirty_mark(&handle->dirty, right, sizeof(*right));
+    *split = right_index;
+    return 0;
+}
+
+// Add records[index] to the value tree, or return -1 if it runs out of nodes
+static int tree_add(mmap_db_t *handle, uint32_t index)
+{
+    mmap_database_t *db = handle->db;
+    double key = db->records[index].value;
+
+    if (db->tree_root == 0)
+    {
+        db->tree_root = tree_alloc(handle, 1);
+        if (db->tree_root == 0)
+        {
+            return -1;
+        }
+    }
+
+    uint32_t split;
+    double split_key;
+    if (tree_insert_at(handle, db->tree_root, key, index, &split, &split_key) != 0)
+    {
+        return -1;
+    }
+
+    // The root split: grow the tree by a level
+    if (split != 0)
+    {
+        uint32_t root = tree_alloc(handle, 0);
+        if (root == 0)
+        {
+            return -1;
+        }
+        db_tree_node_t *node = db_tree_node(db, root);
+        node->count = 1;
+        node->keys[0] = split_key;
+        node->children[0] = db->tree_root;
+        node->children[1] = split;
+        shm_dirty_mark(&handle->dirty, node, sizeof(*node));
+        db->tree_root = root;
+    }
+    shm_dirty_mark(&handle->dirty, &db->tree_root, sizeof(db->tree_root));
+    return 0;
+}
+
+// Build the value tree over all records again. Called under the mutex
+// after replaying the log, since the crash may have left a split half
+// written, and when updates have left it out of nodes.
+static int tree_rebuild(mmap_db_t *handle)
+{
+    mmap_database_t *db = handle->db;
+    db->tree_root = 0;
+    db->tree_nodes = 1;
+    uint32_t count = mmap_db_record_count(db);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (tree_add(handle, i) != 0)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Add records[index] to the value tree. Called under the mutex.
+static int tree_insert(mmap_db_t *handle, uint32_t index)
+{
+    if (tree_add(handle, index) == 0)
+    {
+        return 0;
+    }
+
+    // Removals leave nodes under half full, so the worst case the region
+    // was sized for no longer holds; packing the tree again restores it.
+    // A record being inserted isn't counted yet, so the rebuild leaves it out.
+    if (tree_rebuild(handle) != 0)
+    {
+        return -1;
+    }
+    if (index >= mmap_db_record_count(handle->db))
+    {
+        return tree_add(handle, index);
+    }
+    return 0;
+}
+
+// Take the entry for records[index] under key out of the value tree.
+// Called under the mutex. Nodes are not merged, a leaf may even be left
+// empty; range queries step over it.
+static void tree_remove(mmap_db_t *handle, double key, uint32_t index)
+{
+    mmap_database_t *db = handle->db;
+    if (db->tree_root == 0)
+    {
+        return;
+    }
+
+    // The entry is among the run of keys equal to key, which may span leaves
+    db_tree_node_t *node = db_tree_node(db, db->tree_root);
+    while (!node->leaf)
+    {
+        node = db_tree_node(db, node->children[lower_bound(node, key)]);
+    }
+    uint32_t slot = lower_bound(node, key);
+    for (;;)
+    {
+        if (slot >= node->count)
+        {
+            if (node->next == 0)
+            {
+                return;
+            }
+            node = db_tree_node(db, node->next);
+            slot = 0;
+            continue;
+        }
+        if (node->keys[slot] != key)
+        {
+            return;
+        }
+        if (node->children[slot] == index)
+        {
+            break;
+        }
+        slot++;
+    }
+
+    uint32_t after = node->count - slot - 1;
+    memmove(&node->keys[slot], &node->keys[slot + 1], after * sizeof(double));
+    memmove(&node->children[slot], &node->children[slot + 1], after * sizeof(uint32_t));
+    node->count--;
+    shm_dirty_mark(&handle->dirty, node, sizeof(*node));
+}
+
+void mmap_db_range_begin(mmap_db_range_t *range, const mmap_database_t *db, double low, double high)
+{
+    range->db = db;
+    range->high = high;
+    range->node = db->tree_root;
+    range->slot = 0;
+    if (range->node == 0)
+    {
+        return;
+    }
+
+    // Go down the leftmost path that can hold low
+    const db_tree_node_t *node = db_tree_node(db, range->node);
+    while (!node->leaf)
+    {
+        range->node = node->children[lower_bound(node, low)];
+        node = db_tree_node(db, range->node);
+    }
+    range->slot = lower_bound(node, low);
+}
+
+const record_t *mmap_db_range_next(mmap_db_range_t *range)
+{
+    while (range->node != 0)
+    {
+        const db_tree_node_t *node = db_tree_node(range->db, range->node);
+        if (range->slot >= node->count)
+        {
+            range->node = node->next;
+            range->slot = 0;
+            continue;
+        }
+        if (node->keys[range->slot] > range->high)
+        {
+            range->node = 0;
+            break;
+        }
+        return &range->db->records[node->children[range->slot++]];
+    }
+    return NULL;
+}
+
+// Replace records[index] and its slot as of epoch. Called under the
+// mutex; snapshot readers retry while the sequence is odd.
+static void write_record(mmap_db_t *handle, uint32_t index, const record_t *record, uint64_t epoch, uint32_t older)
+{
+    mmap_database_t *db = handle->db;
+    db_record_slot_t *slot = db_record_slot(db, index);
+
+    uint32_t sequence = atomic_load_explicit(&slot->sequence, memory_order_relaxed);
+    atomic_store_explicit(&slot->sequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    db->records[index] = *record;
+    slot->epoch = epoch;
+    slot->older = older;
+    atomic_store_explicit(&slot->sequence, sequence + 2, memory_order_release);
+
+    shm_dirty_mark(&handle->dirty, &db->records[index], sizeof(record_t));
+    shm_dirty_mark(&handle->dirty, slot, sizeof(*slot));
+}
+
+// Copy out records[index] with its slot's epoch and history, without the
+// mutex. Gives up if the layout moves while the slot looks busy.
+static void read_record(const mmap_database_t *db, uint32_t index, record_t *record, uint64_t *epoch,
+                        uint32_t *older, uint32_t layout)
+{
+    const db_record_slot_t *slot = db_record_slot(db, index);
+    for (;;)
+    {
+        uint32_t before = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        if (before & 1)
+        {
+            if (layout_moved(db, layout))
+            {
+                *epoch = 0;
+                *older = 0;
+                return;
+            }
+            shm_cpu_relax();
+            continue;
+        }
+
+        *record = db->records[index];
+        *epoch = slot->epoch;
+        *older = slot->older;
+
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&slot->sequence, memory_order_relaxed) == before)
+        {
+            return;
+        }
+    }
+}
+
+// Epoch the next change commits in. Called under the mutex.
+static uint64_t next_epoch(mmap_database_t *db)
+{
+    return atomic_load_explicit(&db->commit_epoch, memory_order_relaxed) + 1;
+}
+
+// Make everything written in epoch visible to new snapshots
+static void publish_epoch(mmap_db_t *handle, uint64_t epoch)
+{
+    mmap_database_t *db = handle->db;
+    atomic_store_explicit(&db->commit_epoch, epoch, memory_order_seq_cst);
+    shm_dirty_mark(&handle->dirty, &db->commit_epoch, sizeof(db->commit_epoch));
+}
+
+// Append a change to the feed. Called under the mutex, after the epoch
+// it committed in is published, so a snapshot taken on seeing the change
+// includes it. Waiters are woken once the mutex is released.
+static void publish_change(mmap_db_t *handle, uint32_t index, db_change_kind_t kind, uint64_t epoch)
+{
+    mmap_database_t *db = handle->db;
+    uint64_t sequence = atomic_load_explicit(&db->change_sequence, memory_order_relaxed) + 1;
+    db_change_t *change = db_change(db, sequence);
+
+    atomic_store_explicit(&change->sequence, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    change->epoch = epoch;
+    change->index = index;
+    change->kind = kind;
+    atomic_store_explicit(&change->sequence, sequence, memory_order_release);
+    atomic_store_explicit(&db->change_sequence, sequence, memory_order_release);
+
+    shm_dirty_mark(&handle->dirty, change, sizeof(*change));
+    shm_dirty_mark(&handle->dirty, &db->change_sequence, sizeof(db->change_sequence));
+}
+
+// Take the database mutex and catch up with growth by other processes,
+// so this handle can mark writes anywhere in the file. Returns 0, or -1
+// (without the mutex) if it can't track the larger file.
+static int lock_database(mmap_db_t *handle)
+{
+    mmap_database_t *db = handle->db;
+    pthread_mutex_lock(&db->mutex);
+    if (db->file_size > handle->size)
+    {
+        if (shm_dirty_resize(&handle->dirty, db->file_size) != 0)
+        {
+            pthread_mutex_unlock(&db->mutex);
+            return -1;
+        }
+        handle->size = db->file_size;
+    }
+    return 0;
+}
+
+// Old pool entry -> new entry + 1 for the live versions, 0 for freed ones
+static uint32_t moved_version(const uint32_t *moved, uint32_t older)
+{
+    return older != 0 ? moved[older - 1] : 0;
+}
+
+// Double the file and lay it out again for the records that now fit.
+// Records stay where they are; the slots, the tree and the live versions
+// are copied out, then written back at their new offsets, and the indexes
+// are rebuilt at the new size. The file grows before anything moves, and
+// every handle reserved MMAP_DB_MAX_SIZE of address space up front, so
+// attached processes see the new pages without remapping; readers that
+// take no mutex wait while the layout sequence is odd, and retry reads it
+// moved under. The first slots slots move, at least record_count of them:
+// replay may have filled some past it. Called under the mutex.
+static int grow_file(mmap_db_t *handle, uint32_t slots)
+{
+    mmap_database_t *db = handle->db;
+    uint64_t size = db->file_size * 2;
+    if (size > MMAP_DB_MAX_SIZE)
+    {
+        size = MMAP_DB_MAX_SIZE;
+    }
+    mmap_database_t layout; // Only the layout fields are used
+    plan_layout(&layout, size);
+    if (layout.max_records <= db->max_records)
+    {
+        fprintf(stderr, "mmap_db: the file can't grow past %llu bytes\n", (unsigned long long)db->file_size);
+        return -1;
+    }
+
+    // Copy out what moves
+    uint32_t count = mmap_db_record_count(db);
+    uint64_t live = db->version_tail - db->version_head;
+    db_record_slot_t *saved = malloc((slots + 1) * sizeof(db_record_slot_t));
+    db_tree_node_t *nodes = malloc(db->tree_nodes * sizeof(db_tree_node_t));
+    db_version_t *versions = malloc((live + 1) * sizeof(db_version_t));
+    uint32_t *moved = calloc(db->version_capacity, sizeof(uint32_t));
+    if (saved == NULL || nodes == NULL || versions == NULL || moved == NULL)
+    {
+        fprintf(stderr, "mmap_db: out of memory growing the file\n");
+        free(saved);
+        free(nodes);
+        free(versions);
+        free(moved);
+        return -1;
+    }
+    memcpy(saved, db_record_slot(db, 0), slots * sizeof(db_record_slot_t));
+    memcpy(nodes, db_tree_node(db, 0), db->tree_nodes * sizeof(db_tree_node_t));
+    for (uint64_t n = db->version_head; n < db->version_tail; n++)
+    {
+        versions[n - db->version_head] = *db_version(db, n % db->version_capacity);
+        moved[n % db->version_capacity] = (uint32_t)(n % layout.version_capacity) + 1;
+    }
+
+    // Extend the file, then track writes to all of it
+    int result = -1;
+    if (ftruncate(handle->fd, size) == -1)
+    {
+        perror("Failed to grow file");
+        goto done;
+    }
+    if (shm_dirty_resize(&handle->dirty, size) != 0)
+    {
+        goto done;
+    }
+    handle->size = size;
+
+    uint32_t sequence = atomic_load_explicit(&db->layout, memory_order_relaxed);
+    atomic_store_explicit(&db->layout, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    // Clear the old regions (the new part of the file is already zero) and
+    // switch to the new layout
+    memset((char *)db + db->slots_offset, 0, db->file_size - db->slots_offset);
+    db->max_records = layout.max_records;
+    db->index_slots = layout.index_slots;
+    db->slots_offset = layout.slots_offset;
+    db->index_offset = layout.index_offset;
+    db->tree_offset = layout.tree_offset;
+    db->tree_capacity = layout.tree_capacity;
+    db->versions_offset = layout.versions_offset;
+    db->version_capacity = layout.version_capacity;
+    db->file_size = size;
+
+    // Put everything back, with links into the pool following the entries
+    for (uint32_t i = 0; i < slots; i++)
+    {
+        saved[i].older = moved_version(moved, saved[i].older);
+    }
+    memcpy(db_record_slot(db, 0), saved, slots * sizeof(db_record_slot_t));
+    memcpy(db_tree_node(db, 0), nodes, db->tree_nodes * sizeof(db_tree_node_t));
+    for (uint64_t n = db->version_head; n < db->version_tail; n++)
+    {
+        db_version_t *version = &versions[n - db->version_head];
+        version->older = moved_version(moved, version->older);
+        *db_version(db, n % db->version_capacity) = *version;
+    }
+    for (uint32_t i = 0; i < count; i++)
+    {
+        index_record(handle, i);
+    }
+
+    atomic_store_explicit(&db->layout, sequence + 2, memory_order_release);
+
+    // Nearly every page changed; write them all back now rather than leave
+    // a torn layout for a crash to find
+    result = shm_dirty_sync_all(&handle->dirty);
+
+done:
+    free(saved);
+    free(nodes);
+    free(versions);
+    free(moved);
+    return result;
+}
+
+// Where a replay of the log has got to
+typedef struct
+{
+    mmap_db_t *handle;
+    uint32_t end; // One past the last slot written; those past record_count wait for earlier inserts
+} db_replay_t;
+
+// Count the replayed records up to the first slot whose insert hasn't
+// turned up. Processes flush their log buffers in their own time, so an
+// insert can come before the one for the slot below it, or outlive it if
+// the other process never flushed.
+static void count_replayed(db_replay_t *replay)
+{
+    mmap_db_t *handle = replay->handle;
+    mmap_database_t *db = handle->db;
+    uint32_t count = mmap_db_record_count(db);
+    uint32_t end = count;
+    while (end < replay->end && atomic_load_explicit(&db_record_slot(db, end)->created, memory_order_relaxed) != 0)
+    {
+        index_record(handle, end);
+        end++;
+    }
+    if (end == count)
+    {
+        return;
+    }
+
+    atomic_store_explicit(&db->record_count, end, memory_order_release);
+    for (uint32_t i = count; i < end; i++)
+    {
+        uint64_t created = atomic_load_explicit(&db_record_slot(db, i)->created, memory_order_relaxed);
+        publish_change(handle, i, DB_CHANGE_INSERT, created);
+    }
+}
+
+// Whether two versions of a record hold the same fields
+static bool same_record(const record_t *a, const record_t *b)
+{
+    return a->id == b->id && a->value == b->value && a->is_active == b->is_active &&
+           strncmp(a->name, b->name, sizeof(a->name)) == 0;
+}
+
+// Put a logged insert, update or delete back into the records
+static void apply_log_entry(void *context, const void *data, uint32_t length)
+{
+    db_replay_t *replay = context;
+    mmap_db_t *handle = replay->handle;
+    mmap_database_t *db = handle->db;
+    const db_log_entry_t *entry = data;
+    if (length != sizeof(db_log_entry_t))
+    {
+        return;
+    }
+
+    // The log may run past the size the file was last synced at
+    while (entry->index >= db->max_records)
+    {
+        if (grow_file(handle, replay->end) != 0)
+        {
+            return;
+        }
+    }
+    if (entry->index >= replay->end)
+    {
+        replay->end = entry->index + 1;
+    }
+
+    // The insert marks the slot as logged, even if a later version of the
+    // record was replayed before it
+    db_record_slot_t *slot = db_record_slot(db, entry->index);
+    if (entry->kind == DB_CHANGE_INSERT && atomic_load_explicit(&slot->created, memory_order_relaxed) == 0)
+    {
+        atomic_store_explicit(&slot->created, entry->epoch, memory_order_relaxed);
+    }
+
+    // A later version of the record may already have been replayed, or
+    // reached the file. An entry from the slot's own epoch goes in again
+    // if the record differs: the slot's page may have been written back
+    // without the record's. Entries the file already holds are no change,
+    // so a replay over a live database leaves it and its feed alone.
+    // History isn't logged, so a newer version goes in with no older ones;
+    // one from the slot's own epoch keeps the slot's, for pinned snapshots.
+    if (entry->epoch > slot->epoch ||
+        (entry->epoch == slot->epoch && !same_record(&db->records[entry->index], &entry->record)))
+    {
+        uint32_t older = entry->epoch == slot->epoch ? slot->older : 0;
+        write_record(handle, entry->index, &entry->record, entry->epoch, older);
+
+        // Commits after the replay come after every replayed one
+        if (entry->epoch > atomic_load_explicit(&db->commit_epoch, memory_order_relaxed))
+        {
+            publish_epoch(handle, entry->epoch);
+        }
+        if (entry->index < mmap_db_record_count(db))
+        {
+            index_record(handle, entry->index);
+            publish_change(handle, entry->index, entry->kind, entry->epoch);
+        }
+    }
+    count_replayed(replay);
+}
+
+// Drop what replay left past record_count: versions of records whose
+// insert never reached the log. Called under the mutex.
+static void discard_uncounted(db_replay_t *replay)
+{
+    mmap_db_t *handle = replay->handle;
+    mmap_database_t *db = handle->db;
+    record_t empty;
+    memset(&empty, 0, sizeof(empty));
+    for (uint32_t i = mmap_db_record_count(db); i < replay->end; i++)
+    {
+        atomic_store_explicit(&db_record_slot(db, i)->created, 0, memory_order_relaxed);
+        write_record(handle, i, &empty, 0, 0);
+    }
+}
+
+// Identity of the running boot, empty where there is none to read
+static void read_boot_id(char *boot_id)
+{
+    memset(boot_id, 0, DB_BOOT_ID_LENGTH);
+#ifdef __linux__
+    FILE *file = fopen("/proc/sys/kernel/random/boot_id", "r");
+    if (file != NULL)
+    {
+        if (fgets(boot_id, DB_BOOT_ID_LENGTH, file) == NULL)
+        {
+            boot_id[0] = '\0';
+        }
+        fclose(file);
+    }
+#elif defined(__APPLE__)
+    size_t length = DB_BOOT_ID_LENGTH - 1;
+    if (sysctlbyname("kern.bootsessionuuid", boot_id, &length, NULL, 0) != 0)
+    {
+        boot_id[0] = '\0';
+    }
+#endif
+}
+
+// Whether the log may hold commits the file lacks: no process that had it
+// open is still running in this boot. Forgets the ones that are gone.
+// Called under the mutex.
+static bool needs_recovery(mmap_database_t *db, const char *boot_id)
+{
+    bool same_boot = boot_id[0] != '\0' && strncmp(db->boot_id, boot_id, DB_BOOT_ID_LENGTH) == 0;
+    bool live = false;
+    for (int i = 0; i < DB_MAX_WRITERS; i++)
+    {
+        int pid = atomic_load_explicit(&db->writers[i], memory_order_relaxed);
+        if (pid == 0)
+        {
+            continue;
+        }
+        if (same_boot && (kill(pid, 0) == 0 || errno == EPERM))
+        {
+            live = true;
+        }
+        else
+        {
+            atomic_store_explicit(&db->writers[i], 0, memory_order_relaxed);
+        }
+    }
+    return !live;
+}
+
+// Record this process as having the log open, so later opens skip the
+// replay. Without a free slot they replay it, which changes nothing.
+// Called under the mutex.
+static void register_writer(mmap_db_t *handle, const char *boot_id)
+{
+    mmap_database_t *db = handle->db;
+    memcpy(db->boot_id, boot_id, DB_BOOT_ID_LENGTH);
+    for (int i = 0; i < DB_MAX_WRITERS && handle->writer < 0; i++)
+    {
+        int expected = 0;
+        if (atomic_compare_exchange_strong(&db->writers[i], &expected, (int)getpid()))
+        {
+            handle->writer = i;
+        }
+    }
+}
+
+// Map the file at fd, size bytes now, in address space for the largest it
+// can grow to. Pages past the end of the file fault until it grows.
+static int map_file(mmap_db_t *handle, int fd, size_t size)
+{
+    if (size > MMAP_DB_MAX_SIZE)
+    {
+        fprintf(stderr, "mmap_db: the file is larger than %llu bytes\n", (unsigned long long)MMAP_DB_MAX_SIZE);
+        return -1;
+    }
+    void *addr = mmap(NULL, MMAP_DB_MAX_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        perror("Failed to map file");
+        return -1;
+    }
+    if (shm_dirty_init(&handle->dirty, addr, size) != 0)
+    {
+        munmap(addr, MMAP_DB_MAX_SIZE);
+        return -1;
+    }
+    handle->fd = fd;
+    handle->size = size;
+    handle->db = (mmap_database_t *)addr;
+    handle->sync_mode = MMAP_DB_SYNC_RANGE;
+    handle->reader = -1;
+    handle->writer = -1;
+    return 0;
+}
+
+// Undo map_file
+static void unmap_file(mmap_db_t *handle)
+{
+    shm_dirty_destroy(&handle->dirty);
+    munmap(handle->db, MMAP_DB_MAX_SIZE);
+    handle->db = NULL;
+}
+
+int mmap_db_create(mmap_db_t *handle, const char *path, size_t size, const char *wal_path,
+                   unsigned commit_delay_us)
+{
+    memset(handle, 0, sizeof(*handle));
+
+    // Create or truncate the file
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    if (fd == -1)
+    {
+        perror("Failed to open file");
+        return -1;
+    }
+
+    // Set the file size
+    if (ftruncate(fd, size) == -1)
+    {
+        perror("Failed to set file size");
+        close(fd);
+        return -1;
+    }
+
+    if (map_file(handle, fd, size) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    // Initialize mutex with process-shared attribute
+    mmap_database_t *db = handle->db;
+    pthread_mutexattr_t mutex_attr;
+    pthread_mutexattr_init(&mutex_attr);
+    pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutex_init(&db->mutex, &mutex_attr);
+    pthread_mutexattr_destroy(&mutex_attr);
+
+    // Initialize database metadata; the file is fresh, so every bucket is empty
+    atomic_init(&db->record_count, 0);
+    plan_layout(db, size);
+    db->file_size = size;
+    atomic_init(&db->layout, 0);
+    db->tree_root = 0;
+    db->tree_nodes = 1;
+    db->version_head = 0;
+    db->version_tail = 0;
+    atomic_init(&db->commit_epoch, 1);
+    atomic_init(&db->change_sequence, 0);
+    shm_waitpoint_init(&db->changed);
+
+    if (wal_path != NULL)
+    {
+        // A fresh database starts with an empty log
+        if (shm_wal_open(&handle->wal, wal_path, commit_delay_us) != 0 || shm_wal_truncate(&handle->wal) != 0)
+        {
+            unmap_file(handle);
+            close(fd);
+            return -1;
+        }
+        handle->logging = 1;
+
+        char boot_id[DB_BOOT_ID_LENGTH];
+        read_boot_id(boot_id);
+        register_writer(handle, boot_id);
+    }
+
+    return 0;
+}
+
+int mmap_db_open(mmap_db_t *handle, const char *path, const char *wal_path, unsigned commit_delay_us)
+{
+    memset(handle, 0, sizeof(*handle));
+
+    int fd = open(path, O_RDWR);
+    if (fd == -1)
+    {
+        perror("Failed to open file");
+        return -1;
+    }
+
+    // Get file size
+    struct stat sb;
+    if (fstat(fd, &sb) == -1)
+    {
+        perror("Failed to get file size");
+        close(fd);
+        return -1;
+    }
+
+    if (map_file(handle, fd, sb.st_size) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    if (wal_path != NULL)
+    {
+        // Recover inserts that were committed to the log but may not have
+        // reached the record file. While a process that had the log open
+        // still runs, everything it committed is in the mapping already.
+        mmap_database_t *db = handle->db;
+        if (lock_database(handle) != 0)
+        {
+            unmap_file(handle);
+            close(fd);
+            return -1;
+        }
+        char boot_id[DB_BOOT_ID_LENGTH];
+        read_boot_id(boot_id);
+        uint32_t before = mmap_db_record_count(db);
+        long replayed = 0;
+        if (needs_recovery(db, boot_id))
+        {
+            db_replay_t replay = {handle, before};
+            replayed = shm_wal_replay(wal_path, apply_log_entry, &replay);
+            discard_uncounted(&replay);
+            if (replayed > 0 && tree_rebuild(handle) != 0)
+            {
+                replayed = -1;
+            }
+        }
+        uint32_t recovered = mmap_db_record_count(db) - before;
+        if (replayed >= 0)
+        {
+            register_writer(handle, boot_id);
+        }
+        pthread_mutex_unlock(&db->mutex);
+
+        if (replayed < 0 || shm_wal_open(&handle->wal, wal_path, commit_delay_us) != 0)
+        {
+            if (handle->writer >= 0)
+            {
+                atomic_store_explicit(&db->writers[handle->writer], 0, memory_order_relaxed);
+            }
+            unmap_file(handle);
+            close(fd);
+            return -1;
+        }
+        if (recovered > 0)
+        {
+            printf("Recovered %u records from the log\n", recovered);
+            shm_notify(&db->changed);
+        }
+        handle->logging = 1;
+    }
+
+    return 0;
+}
+
+int mmap_db_add_record(mmap_db_t *handle, const char *name, double value, uint64_t *lsn)
+{
+    mmap_database_t *db = handle->db;
+
+    // Lock the mutex
+    if (lock_database(handle) != 0)
+    {
+        return -1;
+    }
+
+    // Make room if the database is full
+    uint32_t index = mmap_db_record_count(db);
+    if (index >= db->max_records && grow_file(handle, index) != 0)
+    {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+
+    // Create a new record
+    uint64_t epoch = next_epoch(db);
+    db_log_entry_t entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.index = index;
+    entry.kind = DB_CHANGE_INSERT;
+    entry.epoch = epoch;
+    record_t *record = &entry.record;
+    record->id = index + 1;
+    strncpy(record->name, name, sizeof(record->name) - 1);
+    record->value = value;
+    record->is_active = true;
+
+    // Put it in the value tree first, the one step that can fail. Past
+    // record_count and unindexed, the record is invisible until it's counted.
+    write_record(handle, index, record, epoch, 0);
+    if (tree_insert(handle, index) != 0)
+    {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+
+    // Log it while still holding the mutex, so a checkpoint never falls
+    // between the record going in and its log entry
+    if (handle->logging && shm_wal_append(&handle->wal, &entry, sizeof(entry), lsn) != 0)
+    {
+        tree_remove(handle, value, index);
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+
+    // Index it before anyone can see it in record_count
+    atomic_store_explicit(&db_record_slot(db, index)->created, epoch, memory_order_relaxed);
+    index_record(handle, index);
+
+    // Count it; the release store makes the record complete for whoever sees it
+    atomic_store_explicit(&db->record_count, index + 1, memory_order_release);
+    shm_dirty_mark(&handle->dirty, &db->record_count, sizeof(db->record_count));
+    publish_epoch(handle, epoch);
+    publish_change(handle, index, DB_CHANGE_INSERT, epoch);
+
+    // Unlock the mutex
+    pthread_mutex_unlock(&db->mutex);
+
+    // Wake any reader waiting for changes
+    shm_notify(&db->changed);
+
+    return 0;
+}
+
+// Free the pool entries no snapshot can see any more: those replaced at or
+// before the oldest pinned epoch. Called under the mutex. Returns the
+// number of entries freed.
+static uint64_t reclaim_versions(mmap_db_t *handle)
+{
+    mmap_database_t *db = handle->db;
+
+    // Read the commit epoch before the pins: a reader pinning meanwhile
+    // checks afterwards that the epoch didn't move, or pins again
+    uint64_t oldest = atomic_load_explicit(&db->commit_epoch, memory_order_seq_cst);
+    for (int i = 0; i < DB_MAX_READERS; i++)
+    {
+        db_reader_slot_t *reader = &db->readers[i];
+        uint64_t epoch = atomic_load_explicit(&reader->epoch, memory_order_seq_cst);
+        if (epoch == 0)
+        {
+            continue;
+        }
+
+        // A reader that died holding a snapshot would pin its versions forever
+        int pid = atomic_load_explicit(&reader->pid, memory_order_relaxed);
+        if (pid != 0 && kill(pid, 0) == -1 && errno == ESRCH)
+        {
+            atomic_store_explicit(&reader->epoch, 0, memory_order_relaxed);
+            atomic_store_explicit(&reader->pid, 0, memory_order_release);
+            continue;
+        }
+        if (epoch < oldest)
+        {
+            oldest = epoch;
+        }
+    }
+
+    // Entries are replaced in epoch order, so the ring frees from its head.
+    // Links to a freed entry are left behind: whoever holds one is at an
+    // epoch the newer version already covers, so no reader follows it.
+    uint64_t freed = 0;
+    while (db->version_head < db->version_tail &&
+           db_version(db, db->version_head % db->version_capacity)->retired <= oldest)
+    {
+        db->version_head++;
+        freed++;
+    }
+    shm_dirty_mark(&handle->dirty, &db->version_head, sizeof(db->version_head));
+    return freed;
+}
+
+// Replace a record with a new version, as an update or a delete. A NULL
+// value keeps the current one.
+static int change_record(mmap_db_t *handle, uint32_t id, const double *value, bool is_active,
+                         db_change_kind_t kind, uint64_t *lsn)
+{
+    mmap_database_t *db = handle->db;
+    if (lock_database(handle) != 0)
+    {
+        return -1;
+    }
+
+    if (id == 0 || id > mmap_db_record_count(db))
+    {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    uint32_t index = id - 1;
+
+    // Room to keep the current version
+    if (db->version_tail - db->version_head == db->version_capacity && reclaim_versions(handle) == 0)
+    {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+
+    // The new version
+    uint64_t epoch = next_epoch(db);
+    db_log_entry_t entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.index = index;
+    entry.kind = kind;
+    entry.epoch = epoch;
+    entry.record = db->records[index];
+    if (value != NULL)
+    {
+        entry.record.value = *value;
+    }
+    entry.record.is_active = is_active;
+
+    if (handle->logging && shm_wal_append(&handle->wal, &entry, sizeof(entry), lsn) != 0)
+    {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+
+    // Move the current version to the pool; it stops being current at epoch
+    db_record_slot_t *slot = db_record_slot(db, index);
+    uint32_t entry_index = (uint32_t)(db->version_tail % db->version_capacity);
+    db_version_t *old = db_version(db, entry_index);
+    old->record = db->records[index];
+    old->epoch = slot->epoch;
+    old->retired = epoch;
+    old->older = slot->older;
+    db->version_tail++;
+    shm_dirty_mark(&handle->dirty, old, sizeof(*old));
+    shm_dirty_mark(&handle->dirty, &db->version_tail, sizeof(db->version_tail));
+
+    double old_value = old->record.value;
+    write_record(handle, index, &entry.record, epoch, entry_index + 1);
+
+    // Range queries hold the mutex and see the newest values
+    int result = 0;
+    if (old_value != entry.record.value)
+    {
+        tree_remove(handle, old_value, index);
+        result = tree_insert(handle, index);
+    }
+
+    publish_epoch(handle, epoch);
+    publish_change(handle, index, kind, epoch);
+    pthread_mutex_unlock(&db->mutex);
+
+    shm_notify(&db->changed);
+    return result;
+}
+
+int mmap_db_update_record(mmap_db_t *handle, uint32_t id, double value, bool is_active, uint64_t *lsn)
+{
+    return change_record(handle, id, &value, is_active, DB_CHANGE_UPDATE, lsn);
+}
+
+int mmap_db_delete_record(mmap_db_t *handle, uint32_t id, uint64_t *lsn)
+{
+    return change_record(handle, id, NULL, false, DB_CHANGE_DELETE, lsn);
+}
+
+void mmap_db_feed_init(mmap_db_feed_t *feed, mmap_database_t *db)
+{
+    feed->db = db;
+    feed->next = atomic_load_explicit(&db->change_sequence, memory_order_acquire) + 1;
+}
+
+int mmap_db_feed_next(mmap_db_feed_t *feed, db_change_t *change)
+{
+    mmap_database_t *db = feed->db;
+    uint64_t latest = atomic_load_explicit(&db->change_sequence, memory_order_acquire);
+    if (feed->next > latest)
+    {
+        return 0;
+    }
+
+    // Copy the entry, then check the writer didn't reuse it meanwhile
+    const db_change_t *entry = db_change(db, feed->next);
+    uint64_t sequence = atomic_load_explicit(&entry->sequence, memory_order_acquire);
+    change->epoch = entry->epoch;
+    change->index = entry->index;
+    change->kind = entry->kind;
+    atomic_thread_fence(memory_order_acquire);
+    if (sequence != feed->next || atomic_load_explicit(&entry->sequence, memory_order_relaxed) != sequence)
+    {
+        // Lapped: skip to the oldest change that can't be overwritten yet
+        latest = atomic_load_explicit(&db->change_sequence, memory_order_acquire);
+        feed->next = latest > DB_CHANGE_CAPACITY / 2 ? latest - DB_CHANGE_CAPACITY / 2 + 1 : 1;
+        return -1;
+    }
+    atomic_init(&change->sequence, sequence);
+    feed->next++;
+    return 1;
+}
+
+int mmap_db_feed_wait(mmap_db_feed_t *feed, shm_wait_strategy_t strategy, int timeout_ms)
+{
+    mmap_database_t *db = feed->db;
+    if (atomic_load_explicit(&db->change_sequence, memory_order_acquire) >= feed->next)
+    {
+        return 0;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    int64_t deadline_ms = (int64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000 + timeout_ms;
+
+    shm_waiter_t waiter;
+    shm_waiter_init(&waiter, &db->changed, strategy);
+    int result = 0;
+    while (atomic_load_explicit(&db->change_sequence, memory_order_acquire) < feed->next)
+    {
+        int remaining = -1;
+        if (timeout_ms >= 0)
+        {
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            int64_t left = deadline_ms - ((int64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000);
+            if (left <= 0)
+            {
+                result = -1;
+                break;
+            }
+            remaining = (int)left;
+        }
+        shm_wait(&waiter, remaining);
+    }
+    shm_wait_done(&waiter);
+    return result;
+}
+
+const char *mmap_db_change_kind_name(db_change_kind_t kind)
+{
+    switch (kind)
+    {
+    case DB_CHANGE_INSERT:
+        return "insert";
+    case DB_CHANGE_UPDATE:
+        return "update";
+    case DB_CHANGE_DELETE:
+        return "delete";
+    }
+    return "unknown";
+}
+
+int mmap_db_snapshot_begin(mmap_db_t *handle, mmap_db_snapshot_t *snapshot)
+{
+    mmap_database_t *db = handle->db;
+
+    // Claim a reader slot the first time
+    if (handle->reader < 0)
+    {
+        for (int i = 0; i < DB_MAX_READERS && handle->reader < 0; i++)
+        {
+            int expected = 0;
+            if (atomic_compare_exchange_strong(&db->readers[i].pid, &expected, (int)getpid()))
+            {
+                handle->reader = i;
+            }
+        }
+        if (handle->reader < 0)
+        {
+            fprintf(stderr, "mmap_db_snapshot_begin: all %d reader slots are in use\n", DB_MAX_READERS);
+            return -1;
+        }
+    }
+    db_reader_slot_t *reader = &db->readers[handle->reader];
+
+    // Pin the epoch, then make sure it was still current once the pin was
+    // visible, so a writer reclaiming versions can't have missed it
+    uint64_t epoch;
+    do
+    {
+        epoch = atomic_load_explicit(&db->commit_epoch, memory_order_seq_cst);
+        atomic_store_explicit(&reader->epoch, epoch, memory_order_seq_cst);
+    } while (atomic_load_explicit(&db->commit_epoch, memory_order_seq_cst) != epoch);
+
+    // record_count may already include inserts from later epochs
+    uint32_t count, layout;
+    do
+    {
+        layout = layout_begin(db);
+        count = mmap_db_record_count(db);
+        while (count > 0 && atomic_load_explicit(&db_record_slot(db, count - 1)->created, memory_order_relaxed) > epoch)
+        {
+            count--;
+        }
+    } while (layout_moved(db, layout));
+
+    snapshot->db = db;
+    snapshot->reader = reader;
+    snapshot->epoch = epoch;
+    snapshot->record_count = count;
+    return 0;
+}
+
+void mmap_db_snapshot_end(mmap_db_snapshot_t *snapshot)
+{
+    atomic_store_explicit(&snapshot->reader->epoch, 0, memory_order_release);
+    snapshot->reader = NULL;
+}
+
+// Find the version of records[index] a snapshot at epoch sees. While the
+// file grows the links may be half rewritten, so the walk is bounded and
+// checks them; the caller retries if the layout moved.
+static int read_version(const mmap_database_t *db, uint32_t index, uint64_t snapshot_epoch, record_t *record,
+                        uint32_t layout)
+{
+    // Start at the current version and go back to the newest one the
+    // snapshot can see; the pin keeps every version on the way in the pool
+    uint64_t epoch;
+    uint32_t older;
+    read_record(db, index, record, &epoch, &older, layout);
+    uint32_t capacity = db->version_capacity;
+    for (uint32_t steps = 0; epoch > snapshot_epoch; steps++)
+    {
+        if (older == 0 || older > capacity || steps >= capacity)
+        {
+            return -1;
+        }
+        const db_version_t *version = db_version(db, older - 1);
+        *record = version->record;
+        epoch = version->epoch;
+        older = version->older;
+    }
+    return 0;
+}
+
+int mmap_db_snapshot_read(const mmap_db_snapshot_t *snapshot, uint32_t index, record_t *record)
+{
+    if (index >= snapshot->record_count)
+    {
+        return -1;
+    }
+
+    for (;;)
+    {
+        uint32_t layout = layout_begin(snapshot->db);
+        int result = read_version(snapshot->db, index, snapshot->epoch, record, layout);
+        if (!layout_moved(snapshot->db, layout))
+        {
+            return result;
+        }
+    }
+}
+
+int mmap_db_commit(mmap_db_t *handle, uint64_t lsn)
+{
+    if (handle->logging)
+    {
+        return shm_wal_wait(&handle->wal, lsn);
+    }
+
+    // No log: write the record pages themselves back
+    switch (handle->sync_mode)
+    {
+    case MMAP_DB_SYNC_FILE:
+        return shm_dirty_sync_all(&handle->dirty);
+    case MMAP_DB_SYNC_RANGE:
+        return shm_dirty_flush(&handle->dirty, MS_SYNC);
+    case MMAP_DB_SYNC_ASYNC:
+        return shm_dirty_flush(&handle->dirty, MS_ASYNC);
+    case MMAP_DB_SYNC_BACKGROUND:
+        return 0;
+    }
+    return -1;
+}
+
+int mmap_db_set_sync_mode(mmap_db_t *handle, mmap_db_sync_mode_t mode, unsigned interval_ms)
+{
+    if (mode == MMAP_DB_SYNC_BACKGROUND)
+    {
+        if (shm_dirty_start_flusher(&handle->dirty, interval_ms) != 0)
+        {
+            return -1;
+        }
+    }
+    else
+    {
+        shm_dirty_stop_flusher(&handle->dirty);
+    }
+    handle->sync_mode = mode;
+    return 0;
+}
+
+const char *mmap_db_sync_mode_name(mmap_db_sync_mode_t mode)
+{
+    switch (mode)
+    {
+    case MMAP_DB_SYNC_FILE:
+        return "file";
+    case MMAP_DB_SYNC_RANGE:
+        return "range";
+    case MMAP_DB_SYNC_ASYNC:
+        return "async";
+    case MMAP_DB_SYNC_BACKGROUND:
+        return "background";
+    }
+    return "unknown";
+}
+
+int mmap_db_parse_sync_mode(const char *name, mmap_db_sync_mode_t *mode)
+{
+    for (int m = MMAP_DB_SYNC_FILE; m <= MMAP_DB_SYNC_BACKGROUND; m++)
+    {
+        if (strcmp(name, mmap_db_sync_mode_name((mmap_db_sync_mode_t)m)) == 0)
+        {
+            *mode = (mmap_db_sync_mode_t)m;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int mmap_db_checkpoint(mmap_db_t *handle)
+{
+    // Hold the mutex so no insert lands between the sync and the truncate.
+    // The log holds other processes' inserts too, and only they know which
+    // pages those dirtied, so this syncs the whole file.
+    if (lock_database(handle) != 0)
+    {
+        return -1;
+    }
+    int result = shm_dirty_sync_all(&handle->dirty);
+    if (result == 0 && handle->logging)
+    {
+        result = shm_wal_truncate(&handle->wal);
+    }
+    pthread_mutex_unlock(&handle->db->mutex);
+    return result;
+}
+
+void mmap_db_close(mmap_db_t *handle)
+{
+    // Give up the reader slot
+    if (handle->reader >= 0)
+    {
+        db_reader_slot_t *reader = &handle->db->readers[handle->reader];
+        atomic_store_explicit(&reader->epoch, 0, memory_order_relaxed);
+        atomic_store_explicit(&reader->pid, 0, memory_order_release);
+        handle->reader = -1;
+    }
+
+    if (handle->logging)
+    {
+        shm_wal_close(&handle->wal);
+        handle->logging = 0;
+    }
+
+    // Every commit of this handle is in the mapping; later opens needn't replay them
+    if (handle->writer >= 0)
+    {
+        atomic_store_explicit(&handle->db->writers[handle->writer], 0, memory_order_release);
+        handle->writer = -1;
+    }
+    unmap_file(handle);
+    close(handle->fd);
+}
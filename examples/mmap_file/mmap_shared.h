@@ -4,10 +4,25 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <pthread.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include "shared_memory.h"
+#include "shm_wait.h"
+#include "shm_wal.h"
+#include "shm_dirty.h"
 
 // File path for the memory-mapped file
 #define MMAP_FILE_PATH "/tmp/mmap_shared_example.dat"
-#define MMAP_FILE_SIZE (1024 * 1024) // 1MB
+#define MMAP_FILE_SIZE (1024 * 1024) // 1MB to start with; the file grows as records are added
+
+// Address space every handle reserves for the file, so the mapping never
+// has to move when the file grows; the file can't grow past it
+#define MMAP_DB_MAX_SIZE (1ULL << 36) // 64GB
+
+// Write-ahead log kept next to the record file
+#define MMAP_WAL_PATH "/tmp/mmap_shared_example.wal"
+#define MMAP_COMMIT_DELAY_US 200 // Longest an insert waits for others to share its fsync
+#define MMAP_FLUSH_INTERVAL_MS 10 // How often the background flusher writes dirty pages back
 
 // Structure for a record in our database
 typedef struct
@@ -18,16 +33,332 @@ typedef struct
     bool is_active;
 } record_t;
 
+// One bucket of an open-addressing hash index (4 per cache line). Writers
+// change it under the database mutex, seqlock style; readers take it
+// without the mutex and retry if the version moved.
+typedef struct
+{
+    atomic_uint_least32_t version; // Odd while a writer is changing the bucket
+    uint32_t hash;                 // Full hash of the key, to skip most compares
+    uint32_t record;               // Record index + 1, 0 for an empty bucket
+    uint32_t reserved;
+} db_index_bucket_t;
+
+// Most buckets in use per bucket in a table, as a fraction of 4
+#define DB_INDEX_MAX_LOAD 3
+
+// Keys in a node of the value tree
+#define DB_TREE_ORDER 20
+
+// Node of the B+tree over record values: four cache lines, with the keys a
+// search compares packed at the front. Splits leave every node but the
+// root at least half full.
+typedef struct
+{
+    _Alignas(SHM_CACHE_LINE) uint16_t count; // Keys in use
+    uint16_t leaf;
+    uint32_t next;              // Leaves: the next leaf in value order, 0 after the last
+    double keys[DB_TREE_ORDER]; // Ascending; inner nodes: first key of each child after the first
+    uint32_t children[DB_TREE_ORDER + 1]; // Leaves: record index for each key; inner nodes: count + 1 child nodes
+} db_tree_node_t;
+
+// Reader processes (or handles) that can hold snapshots at once
+#define DB_MAX_READERS 64
+
+// Handles with the log open that the file keeps track of
+#define DB_MAX_WRITERS 16
+#define DB_BOOT_ID_LENGTH 40
+
+// Version pool size: an entry per this many records, and at least the minimum
+#define DB_RECORDS_PER_VERSION 8
+#define DB_MIN_VERSIONS 64
+
+// Where each record's current version was committed, and its history.
+// Writers rewrite a record and its slot seqlock style; readers copy them
+// out and retry if the sequence moved.
+typedef struct
+{
+    atomic_uint_least32_t sequence; // Odd while a writer is changing the record
+    uint32_t older;                 // Version pool entry + 1 with the version before, 0 if none
+    uint64_t epoch;                 // Commit epoch of the current version
+    atomic_uint_least64_t created;  // Commit epoch of the insert, never changes
+} db_record_slot_t;
+
+// A replaced version of a record, kept while a snapshot may still need it.
+// Entries never change once written, until they are reused.
+typedef struct
+{
+    record_t record;
+    uint64_t epoch;   // Commit epoch of this version
+    uint64_t retired; // Epoch of the version that replaced it
+    uint32_t older;   // Entry + 1 with the version before this one, 0 if none
+    uint32_t reserved;
+} db_version_t;
+
+// A reader's pinned epoch, on its own line
+typedef struct
+{
+    _Alignas(SHM_CACHE_LINE) atomic_uint_least64_t epoch; // Snapshot epoch, 0 while not reading
+    atomic_int pid;                                       // Process that owns the slot, 0 if free
+} db_reader_slot_t;
+
+// Changes the feed remembers; a reader further behind than this misses some
+#define DB_CHANGE_CAPACITY 1024
+
+// What happened to a record
+typedef enum
+{
+    DB_CHANGE_INSERT = 1,
+    DB_CHANGE_UPDATE,
+    DB_CHANGE_DELETE,
+} db_change_kind_t;
+
+// One entry of the change feed, a ring in the file. The writer clears the
+// sequence while it rewrites an entry, so a reader copying one out knows
+// it got a whole entry for the change it wanted.
+typedef struct
+{
+    atomic_uint_least64_t sequence; // Number of the change, from 1; 0 while being written
+    uint64_t epoch;                 // Commit epoch of the change; snapshots from it on see it
+    uint32_t index;                 // Record changed
+    uint32_t kind;                  // db_change_kind_t
+} db_change_t;
+
 // Structure for our memory-mapped database
 typedef struct
 {
     pthread_mutex_t mutex; // For synchronization between processes
-    uint32_t record_count; // Number of records in the database
+    atomic_uint_least32_t record_count; // Number of records in the database
     uint32_t max_records;  // Maximum number of records that can be stored
+    uint32_t index_slots;  // Buckets in each hash index, a power of 2
+    uint32_t tree_root;    // Root node of the value tree, 0 while it is empty
+    uint64_t index_offset; // Id index, from the start of the file; the name index follows it
+    uint64_t tree_offset;  // Value tree nodes, numbered from 1 (node 0 is never used)
+    uint32_t tree_nodes;   // Nodes in use, node 0 included
+    uint32_t tree_capacity; // Nodes that fit in the file
+    uint64_t slots_offset;    // A db_record_slot_t for each record
+    uint64_t versions_offset; // Pool of replaced versions, used as a ring
+    uint32_t version_capacity;
+    uint32_t reserved;
+    uint64_t version_head; // Oldest entry still in use; entries are used and freed in order
+    uint64_t version_tail; // Next entry to use
+    uint64_t file_size;    // Bytes of the file the layout uses; it only grows
+    shm_waitpoint_t changed; // Feed readers sleep here until a writer publishes a change
+
+    // Processes with the log open, and the boot they run in. Their writes
+    // to the mapping outlive them, so the log only needs replaying once
+    // none is left or the machine has restarted since.
+    char boot_id[DB_BOOT_ID_LENGTH];
+    atomic_int writers[DB_MAX_WRITERS]; // Pid of each, 0 for a free slot
+
+    // Odd while the file grows and the regions after the records move.
+    // Readers that take no mutex check it around every read.
+    _Alignas(SHM_CACHE_LINE) atomic_uint_least32_t layout;
+
+    // Number of the last change published
+    _Alignas(SHM_CACHE_LINE) atomic_uint_least64_t change_sequence;
+
+    // Last committed epoch: a snapshot at it sees every change up to here
+    _Alignas(SHM_CACHE_LINE) atomic_uint_least64_t commit_epoch;
+    db_reader_slot_t readers[DB_MAX_READERS];
+    db_change_t changes[DB_CHANGE_CAPACITY]; // Change feed ring; never moves
     record_t records[];    // Flexible array member for records
 } mmap_database_t;
 
-// Helper functions
-#define MAX_RECORDS(size) ((size - sizeof(mmap_database_t)) / sizeof(record_t))
+// Records in the database. Writers publish the count with a release store
+// once a record is written and indexed, so every record below it is complete.
+static inline uint32_t mmap_db_record_count(const mmap_database_t *db)
+{
+    return atomic_load_explicit(&db->record_count, memory_order_acquire);
+}
+
+// Hash indexes on id and name, after the records
+static inline db_index_bucket_t *db_id_index(const mmap_database_t *db)
+{
+    return (db_index_bucket_t *)((char *)db + db->index_offset);
+}
+
+static inline db_index_bucket_t *db_name_index(const mmap_database_t *db)
+{
+    return db_id_index(db) + db->index_slots;
+}
+
+static inline db_tree_node_t *db_tree_node(const mmap_database_t *db, uint32_t node)
+{
+    return (db_tree_node_t *)((char *)db + db->tree_offset) + node;
+}
+
+static inline db_record_slot_t *db_record_slot(const mmap_database_t *db, uint32_t index)
+{
+    return (db_record_slot_t *)((char *)db + db->slots_offset) + index;
+}
+
+static inline db_version_t *db_version(const mmap_database_t *db, uint32_t entry)
+{
+    return (db_version_t *)((char *)db + db->versions_offset) + entry;
+}
+
+static inline db_change_t *db_change(const mmap_database_t *db, uint64_t sequence)
+{
+    return (db_change_t *)&db->changes[sequence % DB_CHANGE_CAPACITY];
+}
+
+// What the log holds for each insert, update or delete: the record, the
+// slot it went to, the kind of change, for the feed, and the epoch it
+// committed in. Each process flushes its own log buffer, so entries reach
+// the log in flush order rather than commit order; replay goes by the
+// epoch, and replaying an entry twice leaves the same database.
+typedef struct
+{
+    uint32_t index;
+    uint32_t kind;  // db_change_kind_t
+    uint64_t epoch; // Commit epoch of the change
+    record_t record;
+} db_log_entry_t;
+
+// How a commit makes inserts durable when there is no log to wait for
+typedef enum
+{
+    MMAP_DB_SYNC_FILE = 0,   // msync the whole mapping after every insert
+    MMAP_DB_SYNC_RANGE,      // msync only the pages the inserts dirtied
+    MMAP_DB_SYNC_ASYNC,      // Start writing the dirtied pages with MS_ASYNC and return
+    MMAP_DB_SYNC_BACKGROUND, // Return at once; a flusher thread syncs dirty pages every interval
+} mmap_db_sync_mode_t;
+
+// Per-process handle on the database file and its log
+typedef struct
+{
+    int fd;
+    size_t size; // Bytes of the file this handle tracks writes to; catches up with growth under the mutex
+    mmap_database_t *db; // Start of MMAP_DB_MAX_SIZE bytes of address space
+    shm_wal_t wal;
+    int logging; // Inserts are appended to the write-ahead log
+    shm_dirty_t dirty; // Pages this process changed since they were last flushed
+    mmap_db_sync_mode_t sync_mode;
+    int reader; // This handle's slot in db->readers, -1 until its first snapshot
+    int writer; // This handle's slot in db->writers, -1 if it has none
+} mmap_db_t;
+
+// A consistent view of the database as of one commit epoch. Records
+// added or changed after it are invisible, and versions it can see are
+// kept until it ends.
+typedef struct
+{
+    const mmap_database_t *db;
+    db_reader_slot_t *reader;
+    uint64_t epoch;
+    uint32_t record_count; // Records that existed at the epoch
+} mmap_db_snapshot_t;
+
+// Smallest file size mmap_db_create fits records records in
+size_t mmap_db_file_size(uint32_t records);
+
+// Create (or truncate) the database file with size bytes to start with
+// and start an empty log at wal_path. With wal_path NULL nothing is logged.
+int mmap_db_create(mmap_db_t *handle, const char *path, size_t size, const char *wal_path,
+                   unsigned commit_delay_us);
+
+// Map an existing database file. With a wal_path, first replay the log
+// into the records if no process has it open since the last restart,
+// then log inserts to it.
+int mmap_db_open(mmap_db_t *handle, const char *path, const char *wal_path, unsigned commit_delay_us);
+
+// Insert a record; once mmap_db_commit returns for *lsn it survives a
+// crash. A full database first grows the file to about twice the size,
+// moving everything after the records while handles stay attached.
+// Returns 0, or -1 if the file can't grow past MMAP_DB_MAX_SIZE.
+int mmap_db_add_record(mmap_db_t *handle, const char *name, double value, uint64_t *lsn);
+
+// Position of one reader in the change feed
+typedef struct
+{
+    mmap_database_t *db;
+    uint64_t next; // Number of the next change to read
+} mmap_db_feed_t;
+
+// Change a record's value and active flag, keeping the old version for
+// snapshots that still see it. Returns 0, or -1 if there is no record with
+// that id or the version pool is full of versions open snapshots hold.
+int mmap_db_update_record(mmap_db_t *handle, uint32_t id, double value, bool is_active, uint64_t *lsn);
+
+// Mark a record inactive; it keeps its slot and stays in the indexes.
+// Returns 0, or -1 as for mmap_db_update_record.
+int mmap_db_delete_record(mmap_db_t *handle, uint32_t id, uint64_t *lsn);
+
+// Start reading the change feed after the latest change
+void mmap_db_feed_init(mmap_db_feed_t *feed, mmap_database_t *db);
+
+// Copy out the next change. Returns 1 if there was one, 0 if the reader
+// has seen every change, or -1 if the change it was due to read next is
+// gone: it fell DB_CHANGE_CAPACITY behind. It then skips ahead to changes
+// still in the feed, and should re-read what it tracks from a snapshot.
+int mmap_db_feed_next(mmap_db_feed_t *feed, db_change_t *change);
+
+// Block until there is a change the reader hasn't seen, waiting with the
+// given strategy for at most timeout_ms (negative waits forever). Returns
+// 0 once there is one, -1 on timeout.
+int mmap_db_feed_wait(mmap_db_feed_t *feed, shm_wait_strategy_t strategy, int timeout_ms);
+
+// Name of a change kind, for output
+const char *mmap_db_change_kind_name(db_change_kind_t kind);
+
+// Pin the current commit epoch and take a snapshot at it, without the
+// mutex. A handle holds one snapshot at a time. Returns 0, or -1 if every
+// reader slot is taken.
+int mmap_db_snapshot_begin(mmap_db_t *handle, mmap_db_snapshot_t *snapshot);
+
+// Unpin the snapshot, so the versions only it needed can be reused
+void mmap_db_snapshot_end(mmap_db_snapshot_t *snapshot);
+
+// Copy records[index] as the snapshot sees it. Returns 0, or -1 if the
+// record didn't exist yet at the snapshot's epoch.
+int mmap_db_snapshot_read(const mmap_db_snapshot_t *snapshot, uint32_t index, record_t *record);
+
+// Block until the insert with this LSN is durable. Without a log, flush
+// the record file according to the sync mode (ASYNC and BACKGROUND return
+// before the data is on disk).
+int mmap_db_commit(mmap_db_t *handle, uint64_t lsn);
+
+// Choose how commits without a log reach the disk (RANGE by default).
+// BACKGROUND starts a flusher thread every interval_ms, with or without a
+// log, which also keeps replay after a crash short.
+int mmap_db_set_sync_mode(mmap_db_t *handle, mmap_db_sync_mode_t mode, unsigned interval_ms);
+
+// Name of a sync mode, for output
+const char *mmap_db_sync_mode_name(mmap_db_sync_mode_t mode);
+
+// Parse "file", "range", "async" or "background". Returns 0 on success, -1 if unknown.
+int mmap_db_parse_sync_mode(const char *name, mmap_db_sync_mode_t *mode);
+
+// Find a record by id or by name (the first one added, if several share
+// it) through the hash indexes, without taking the mutex. NULL if there is
+// no such record. Records never move once added, not even when the file
+// grows, and their id and name never change; read the rest through a
+// snapshot while writers are active.
+const record_t *mmap_db_find_by_id(const mmap_database_t *db, uint32_t id);
+const record_t *mmap_db_find_by_name(const mmap_database_t *db, const char *name);
+
+// Cursor over the records with value in [low, high], in value order
+typedef struct
+{
+    const mmap_database_t *db;
+    uint32_t node; // Current leaf, 0 once past the end
+    uint32_t slot;
+    double high;
+} mmap_db_range_t;
+
+// Start a range query in O(log n); each record then costs O(1). Hold the
+// database mutex from here until the last mmap_db_range_next, or make
+// sure nobody is inserting or updating.
+void mmap_db_range_begin(mmap_db_range_t *range, const mmap_database_t *db, double low, double high);
+
+// Next record in the range, NULL at the end
+const record_t *mmap_db_range_next(mmap_db_range_t *range);
+
+// Write the record file back and empty the log
+int mmap_db_checkpoint(mmap_db_t *handle);
+
+// Unmap, stopping the log's commit thread after a last commit
+void mmap_db_close(mmap_db_t *handle);
 
 #endif // MMAP_SHARED_H
\ No newline at end of file
@@ -0,0 +1,250 @@
+#ifndef MPMC_QUEUE_SHARED_H
+#define MPMC_QUEUE_SHARED_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include "shared_memory.h"
+#include "shm_wait.h"
+
+#define MPMC_QUEUE_SHM_NAME "/mpmc_queue_shared_memory"
+#define MPMC_QUEUE_DEFAULT_CELLS 4096 // Any power of 2 works, set at creation
+#define MPMC_CELL_DATA_SIZE 48
+
+// A unit of work as the examples queue it
+typedef struct
+{
+    uint32_t producer;
+    uint32_t id;
+    uint32_t values[8]; // The worker sums these
+} job_t;
+
+// One queued item. The sequence number hands the cell back and forth:
+// position when it is free for the producer at that position, position + 1
+// once filled for the consumer at that position, position + capacity once
+// that consumer has emptied it again.
+typedef struct
+{
+    atomic_uint_least64_t sequence;
+    uint32_t length; // Bytes used in data
+    uint32_t reserved;
+    uint8_t data[MPMC_CELL_DATA_SIZE];
+} mpmc_cell_t;
+
+// Bounded multi-producer, multi-consumer queue (Dmitry Vyukov's design).
+// Producers and consumers each race for positions with a CAS on their own
+// index, and never touch the other side's index.
+typedef struct
+{
+    _Alignas(SHM_CACHE_LINE) atomic_uint_least64_t enqueue_pos; // Next position producers claim
+    _Alignas(SHM_CACHE_LINE) atomic_uint_least64_t dequeue_pos; // Next position consumers claim
+
+    _Alignas(SHM_CACHE_LINE) shm_waitpoint_t data_ready; // Consumers wait here when empty
+    shm_waitpoint_t space_ready;                         // Producers wait here when full
+
+    // Read-only after creation
+    _Alignas(SHM_CACHE_LINE) uint64_t capacity;
+    uint64_t mask;
+    atomic_bool shutdown_flag;
+
+    _Alignas(SHM_CACHE_LINE) mpmc_cell_t cells[];
+} mpmc_queue_t;
+
+// Bytes of shared memory needed for a queue of the given number of cells
+static inline size_t mpmc_queue_shm_size(size_t capacity)
+{
+    return sizeof(mpmc_queue_t) + capacity * sizeof(mpmc_cell_t);
+}
+
+// Set up an empty queue; capacity must be a power of 2 (at least 2)
+static inline int mpmc_queue_init(mpmc_queue_t *queue, size_t capacity)
+{
+    if (capacity < 2 || (capacity & (capacity - 1)) != 0)
+    {
+        return -1;
+    }
+
+    atomic_init(&queue->enqueue_pos, 0);
+    atomic_init(&queue->dequeue_pos, 0);
+    shm_waitpoint_init(&queue->data_ready);
+    shm_waitpoint_init(&queue->space_ready);
+    queue->capacity = capacity;
+    queue->mask = capacity - 1;
+    atomic_init(&queue->shutdown_flag, false);
+    for (size_t i = 0; i < capacity; i++)
+    {
+        atomic_init(&queue->cells[i].sequence, i);
+    }
+    return 0;
+}
+
+// Cell for a position, for walking a run claimed in one call
+static inline mpmc_cell_t *mpmc_queue_cell(mpmc_queue_t *queue, uint64_t position)
+{
+    return &queue->cells[position & queue->mask];
+}
+
+// Claim up to max consecutive positions on one side of the queue with a
+// single CAS. `ready` is the offset from the position each cell's sequence
+// must show (0 for producers, 1 for consumers). Returns how many were
+// claimed, starting at *position; 0 if the queue is full/empty.
+static inline size_t mpmc_queue_claim_run(mpmc_queue_t *queue, atomic_uint_least64_t *index,
+                                          uint64_t ready, size_t max, uint64_t *position)
+{
+    uint64_t pos = atomic_load_explicit(index, memory_order_relaxed);
+    for (;;)
+    {
+        // Cells are handed back out of order, so check every one in the run
+        size_t count = 0;
+        int64_t diff = 0;
+        while (count < max)
+        {
+            uint64_t seq = atomic_load_explicit(&mpmc_queue_cell(queue, pos + count)->sequence, memory_order_acquire);
+            diff = (int64_t)(seq - (pos + count + ready));
+            if (diff != 0)
+            {
+                break;
+            }
+            count++;
+        }
+
+        if (count > 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(index, &pos, pos + count,
+                                                      memory_order_relaxed, memory_order_relaxed))
+            {
+                *position = pos;
+                return count;
+            }
+            // Lost the race, pos now holds the current index
+        }
+        else if (diff < 0)
+        {
+            // The other side hasn't finished with this cell: full or empty
+            return 0;
+        }
+        else
+        {
+            // Someone on our side claimed it first
+            pos = atomic_load_explicit(index, memory_order_relaxed);
+        }
+    }
+}
+
+// Claim the cell for the next position on one side of the queue, or NULL
+// if the queue is full/empty
+static inline mpmc_cell_t *mpmc_queue_claim(mpmc_queue_t *queue, atomic_uint_least64_t *index,
+                                            uint64_t ready, uint64_t *position)
+{
+    if (mpmc_queue_claim_run(queue, index, ready, 1, position) == 0)
+    {
+        return NULL;
+    }
+    return mpmc_queue_cell(queue, *position);
+}
+
+// Producer: claim a free cell to fill in place, or NULL if the queue is full
+static inline mpmc_cell_t *mpmc_queue_begin_push(mpmc_queue_t *queue, uint64_t *position)
+{
+    return mpmc_queue_claim(queue, &queue->enqueue_pos, 0, position);
+}
+
+// Producer: hand a filled cell to the consumers
+static inline void mpmc_queue_end_push(mpmc_queue_t *queue, mpmc_cell_t *cell, uint64_t position)
+{
+    atomic_store_explicit(&cell->sequence, position + 1, memory_order_release);
+    shm_notify(&queue->data_ready);
+}
+
+// Consumer: claim the oldest filled cell to read in place, or NULL if the queue is empty
+static inline mpmc_cell_t *mpmc_queue_begin_pop(mpmc_queue_t *queue, uint64_t *position)
+{
+    return mpmc_queue_claim(queue, &queue->dequeue_pos, 1, position);
+}
+
+// Consumer: give an emptied cell back to the producers for the next lap
+static inline void mpmc_queue_end_pop(mpmc_queue_t *queue, mpmc_cell_t *cell, uint64_t position)
+{
+    atomic_store_explicit(&cell->sequence, position + queue->capacity, memory_order_release);
+    shm_notify(&queue->space_ready);
+}
+
+// Copy an item in. Returns false if the queue is full.
+static inline bool mpmc_queue_push(mpmc_queue_t *queue, const void *data, uint32_t length)
+{
+    uint64_t position;
+    mpmc_cell_t *cell = mpmc_queue_begin_push(queue, &position);
+    if (cell == NULL)
+    {
+        return false;
+    }
+
+    cell->length = length < MPMC_CELL_DATA_SIZE ? length : MPMC_CELL_DATA_SIZE;
+    memcpy(cell->data, data, cell->length);
+    mpmc_queue_end_push(queue, cell, position);
+    return true;
+}
+
+// Copy an item out (data needs MPMC_CELL_DATA_SIZE bytes). Returns false if the queue is empty.
+static inline bool mpmc_queue_pop(mpmc_queue_t *queue, void *data, uint32_t *length)
+{
+    uint64_t position;
+    mpmc_cell_t *cell = mpmc_queue_begin_pop(queue, &position);
+    if (cell == NULL)
+    {
+        return false;
+    }
+
+    *length = cell->length;
+    memcpy(data, cell->data, cell->length);
+    mpmc_queue_end_pop(queue, cell, position);
+    return true;
+}
+
+// Copy up to count items in from consecutive MPMC_CELL_DATA_SIZE-byte slots
+// of data, claiming all their cells with one CAS. Returns how many went in.
+static inline size_t mpmc_queue_push_batch(mpmc_queue_t *queue, const void *data, const uint32_t *lengths, size_t count)
+{
+    uint64_t first;
+    count = mpmc_queue_claim_run(queue, &queue->enqueue_pos, 0, count, &first);
+    for (size_t i = 0; i < count; i++)
+    {
+        mpmc_cell_t *cell = mpmc_queue_cell(queue, first + i);
+        cell->length = lengths[i] < MPMC_CELL_DATA_SIZE ? lengths[i] : MPMC_CELL_DATA_SIZE;
+        memcpy(cell->data, (const uint8_t *)data + i * MPMC_CELL_DATA_SIZE, cell->length);
+        atomic_store_explicit(&cell->sequence, first + i + 1, memory_order_release);
+    }
+
+    // One wake-up for the whole run
+    if (count > 0)
+    {
+        shm_notify(&queue->data_ready);
+    }
+    return count;
+}
+
+// Pull up to max items into consecutive MPMC_CELL_DATA_SIZE-byte slots of
+// data, their lengths into lengths, claiming all their cells with one CAS.
+// Returns how many were taken.
+static inline size_t mpmc_queue_pop_batch(mpmc_queue_t *queue, void *data, uint32_t *lengths, size_t max)
+{
+    uint64_t first;
+    size_t count = mpmc_queue_claim_run(queue, &queue->dequeue_pos, 1, max, &first);
+    for (size_t i = 0; i < count; i++)
+    {
+        mpmc_cell_t *cell = mpmc_queue_cell(queue, first + i);
+        lengths[i] = cell->length;
+        memcpy((uint8_t *)data + i * MPMC_CELL_DATA_SIZE, cell->data, cell->length);
+        atomic_store_explicit(&cell->sequence, first + i + queue->capacity, memory_order_release);
+    }
+
+    // One wake-up for the whole run
+    if (count > 0)
+    {
+        shm_notify(&queue->space_ready);
+    }
+    return count;
+}
+
+#endif // MPMC_QUEUE_SHARED_H
@@ -0,0 +1,120 @@
+#include "shared_memory.h"
+#include "mpmc_queue_shared.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/wait.h>
+
+#define MAX_PRODUCERS 16
+#define WAIT_TIMEOUT_MS 100 // Wake at least this often to notice Ctrl+C
+
+// Flag for clean shutdown
+volatile sig_atomic_t running = 1;
+
+// Signal handler for Ctrl+C
+void handle_sigint(int sig)
+{
+    (void)sig; // Suppress unused parameter warning
+    running = 0;
+}
+
+// Body of each forked producer process
+static void produce(mpmc_queue_t *queue, uint32_t producer)
+{
+    srand(time(NULL) ^ (producer * 7919));
+
+    job_t job = {.producer = producer};
+    shm_waiter_t waiter;
+    shm_waiter_init(&waiter, &queue->space_ready, SHM_WAIT_HYBRID);
+    while (running && !atomic_load(&queue->shutdown_flag))
+    {
+        for (int i = 0; i < 8; i++)
+        {
+            job.values[i] = rand() % 100;
+        }
+
+        // Jobs go to whichever worker claims them first
+        if (!mpmc_queue_push(queue, &job, sizeof(job)))
+        {
+            // Queue full, wait for a worker to take a job
+            shm_wait(&waiter, WAIT_TIMEOUT_MS);
+            continue;
+        }
+        shm_wait_done(&waiter);
+        job.id++;
+
+        // Slow down a bit to make it easier to observe
+        usleep(5000); // 5ms
+    }
+    _exit(0);
+}
+
+int main(int argc, char *argv[])
+{
+    int producers = argc > 1 ? atoi(argv[1]) : 4;
+    if (producers < 1 || producers > MAX_PRODUCERS)
+    {
+        printf("Usage: %s [producers 1-%d]\n", argv[0], MAX_PRODUCERS);
+        return 1;
+    }
+    printf("Starting MPMC queue with %d producer processes\n", producers);
+
+    // Set up signal handler for clean shutdown (inherited by the children)
+    signal(SIGINT, handle_sigint);
+
+    // Create shared memory
+    shared_memory_t shm = {0};
+    if (shared_memory_create(&shm, MPMC_QUEUE_SHM_NAME, mpmc_queue_shm_size(MPMC_QUEUE_DEFAULT_CELLS)) != 0)
+    {
+        printf("Failed to create shared memory\n");
+        return 1;
+    }
+
+    mpmc_queue_t *queue = (mpmc_queue_t *)shm.addr;
+    mpmc_queue_init(queue, MPMC_QUEUE_DEFAULT_CELLS);
+
+    printf("Queue of %d cells ready, start workers with ./worker <count>\n", MPMC_QUEUE_DEFAULT_CELLS);
+    printf("Press Ctrl+C to exit\n");
+
+    fflush(stdout); // Don't let the children inherit buffered output
+    pid_t pids[MAX_PRODUCERS];
+    for (int p = 0; p < producers; p++)
+    {
+        pids[p] = fork();
+        if (pids[p] == 0)
+        {
+            produce(queue, p);
+        }
+    }
+
+    // Report how much work is queued up
+    while (running)
+    {
+        uint64_t queued = atomic_load(&queue->enqueue_pos);
+        uint64_t taken = atomic_load(&queue->dequeue_pos);
+        printf("\rSubmitted %llu jobs, %llu waiting", (unsigned long long)queued,
+               (unsigned long long)(queued - taken));
+        fflush(stdout);
+        usleep(100000); // 100ms
+    }
+
+    printf("\nShutting down...\n");
+
+    // Tell the workers we're done, and wait for our producers
+    atomic_store(&queue->shutdown_flag, true);
+    shm_notify(&queue->data_ready);
+    for (int p = 0; p < producers; p++)
+    {
+        waitpid(pids[p], NULL, 0);
+    }
+    usleep(100000); // Give the workers time to notice
+
+    // Clean up
+    shared_memory_destroy(&shm, 1);
+
+    printf("Producer process completed\n");
+
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include "shared_memory.h"
+#include "mpmc_queue_shared.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+
+#define MAX_WORKERS 16
+#define BATCH_SIZE 8
+#define WAIT_TIMEOUT_MS 100 // Wake at least this often to notice Ctrl+C
+
+// Flag for clean shutdown
+volatile sig_atomic_t running = 1;
+
+// Signal handler for Ctrl+C
+void handle_sigint(int sig)
+{
+    (void)sig; // Suppress unused parameter warning
+    running = 0;
+}
+
+// Body of each forked worker process
+static void work(mpmc_queue_t *queue, int worker, shm_wait_strategy_t strategy)
+{
+    uint8_t batch[BATCH_SIZE][MPMC_CELL_DATA_SIZE];
+    uint32_t lengths[BATCH_SIZE];
+    uint64_t jobs = 0;
+    uint64_t total = 0;
+    shm_waiter_t waiter;
+    shm_waiter_init(&waiter, &queue->data_ready, strategy);
+
+    while (running && !atomic_load(&queue->shutdown_flag))
+    {
+        // Take whatever is there, up to a batch, competing with the other workers
+        size_t count = mpmc_queue_pop_batch(queue, batch, lengths, BATCH_SIZE);
+        if (count == 0)
+        {
+            // No work available, wait for a producer to push some
+            shm_wait(&waiter, WAIT_TIMEOUT_MS);
+            continue;
+        }
+        shm_wait_done(&waiter);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            const job_t *job = (const job_t *)batch[i];
+            for (int v = 0; v < 8; v++)
+            {
+                total += job->values[v];
+            }
+        }
+        jobs += count;
+    }
+
+    printf("Worker %d processed %llu jobs (sum %llu)\n", worker, (unsigned long long)jobs,
+           (unsigned long long)total);
+    fflush(stdout);
+    _exit(0);
+}
+
+int main(int argc, char *argv[])
+{
+    // How many workers, and how they wait when the queue is empty
+    int workers = argc > 1 ? atoi(argv[1]) : 4;
+    shm_wait_strategy_t strategy = SHM_WAIT_HYBRID;
+    if (workers < 1 || workers > MAX_WORKERS || (argc > 2 && shm_wait_parse_strategy(argv[2], &strategy) != 0))
+    {
+        printf("Usage: %s [workers 1-%d] [spin|pause|hybrid|futex]\n", argv[0], MAX_WORKERS);
+        return 1;
+    }
+    printf("Starting %d MPMC queue worker processes (%s wait)\n", workers, shm_wait_strategy_name(strategy));
+
+    // Set up signal handler for clean shutdown (inherited by the children)
+    signal(SIGINT, handle_sigint);
+
+    // Open shared memory
+    shared_memory_t shm = {0};
+    if (shared_memory_open(&shm, MPMC_QUEUE_SHM_NAME) != 0)
+    {
+        printf("Failed to open shared memory. Make sure producer is running first.\n");
+        return 1;
+    }
+
+    mpmc_queue_t *queue = (mpmc_queue_t *)shm.addr;
+    printf("Press Ctrl+C to exit\n");
+
+    fflush(stdout); // Don't let the children inherit buffered output
+    pid_t pids[MAX_WORKERS];
+    for (int w = 0; w < workers; w++)
+    {
+        pids[w] = fork();
+        if (pids[w] == 0)
+        {
+            work(queue, w, strategy);
+        }
+    }
+
+    for (int w = 0; w < workers; w++)
+    {
+        waitpid(pids[w], NULL, 0);
+    }
+
+    // Clean up
+    shared_memory_destroy(&shm, 0); // Don't unlink, let producer do it
+
+    printf("Worker processes completed\n");
+
+    return 0;
+}
@@ -0,0 +1,108 @@
+#include "shared_memory.h"
+#include "mpsc_ring_shared.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <signal.h>
+
+#define MAX_PRODUCERS 64
+#define MAX_BATCH 64 // Most messages taken per peek
+#define WAIT_TIMEOUT_MS 100 // Wake at least this often to notice Ctrl+C
+
+// Flag for clean shutdown
+volatile sig_atomic_t running = 1;
+
+// Signal handler for Ctrl+C
+void handle_sigint(int sig)
+{
+    (void)sig; // Suppress unused parameter warning
+    running = 0;
+}
+
+int main(int argc, char *argv[])
+{
+    printf("Starting MPSC ring aggregator\n");
+
+    // How to wait when the ring is empty
+    shm_wait_strategy_t strategy = SHM_WAIT_HYBRID;
+    if (argc > 1 && shm_wait_parse_strategy(argv[1], &strategy) != 0)
+    {
+        printf("Usage: %s [spin|pause|hybrid|futex]\n", argv[0]);
+        return 1;
+    }
+
+    // Set up signal handler for clean shutdown
+    signal(SIGINT, handle_sigint);
+
+    // The single consumer owns the ring; workers attach to it
+    shared_memory_t shm = {0};
+    if (shared_memory_create(&shm, MPSC_RING_SHM_NAME, mpsc_ring_shm_size(MPSC_RING_DEFAULT_SLOTS)) != 0)
+    {
+        printf("Failed to create shared memory\n");
+        return 1;
+    }
+
+    mpsc_ring_t *ring = (mpsc_ring_t *)shm.addr;
+    mpsc_ring_init(ring, MPSC_RING_DEFAULT_SLOTS);
+
+    printf("Ring of %d slots ready (%s wait), start producers with ./producer <id>\n", MPSC_RING_DEFAULT_SLOTS,
+           shm_wait_strategy_name(strategy));
+    printf("Press Ctrl+C to exit\n");
+
+    uint64_t per_producer[MAX_PRODUCERS] = {0};
+    uint64_t total = 0;
+    shm_waiter_t waiter;
+    shm_waiter_init(&waiter, &ring->data_ready, strategy);
+    while (running)
+    {
+        // Take every message that is ready in one call
+        uint64_t first;
+        size_t count = mpsc_ring_peek_batch(ring, MAX_BATCH, &first);
+        if (count == 0)
+        {
+            // No data available, wait for a producer to publish some
+            shm_wait(&waiter, WAIT_TIMEOUT_MS);
+            continue;
+        }
+        shm_wait_done(&waiter);
+
+        // Read the messages in place, then free the whole run
+        for (size_t i = 0; i < count; i++)
+        {
+            mpsc_slot_t *slot = mpsc_ring_slot(ring, first + i);
+            if (slot->producer < MAX_PRODUCERS)
+            {
+                per_producer[slot->producer]++;
+            }
+            total++;
+            if (total % 1000 == 0)
+            {
+                printf("\nLatest from producer %u: %.*s\n", slot->producer, (int)slot->length, (const char *)slot->data);
+            }
+        }
+        mpsc_ring_release_batch(ring, count);
+
+        printf("\rAggregated %llu messages:", (unsigned long long)total);
+        for (int i = 0; i < MAX_PRODUCERS; i++)
+        {
+            if (per_producer[i] > 0)
+            {
+                printf(" [%d] %llu", i, (unsigned long long)per_producer[i]);
+            }
+        }
+        fflush(stdout);
+    }
+
+    printf("\nShutting down...\n");
+
+    // Tell the producers we're done
+    atomic_store(&ring->shutdown_flag, true);
+    usleep(100000); // Give the producers time to notice
+
+    // Clean up
+    shared_memory_destroy(&shm, 1);
+
+    printf("Aggregator process completed\n");
+
+    return 0;
+}
@@ -0,0 +1,247 @@
+#ifndef MPSC_RING_SHARED_H
+#define MPSC_RING_SHARED_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include "shared_memory.h"
+#include "shm_wait.h"
+
+#define MPSC_RING_SHM_NAME "/mpsc_ring_shared_memory"
+#define MPSC_RING_DEFAULT_SLOTS 4096 // Any power of 2 works, set at creation
+#define MPSC_SLOT_DATA_SIZE 48
+
+// One message. The sequence number says who owns the slot: position when
+// it is free for the producer claiming that position, position + 1 once
+// that producer has published it.
+typedef struct
+{
+    atomic_uint_least64_t sequence;
+    uint32_t producer; // Sender's id, for the consumer's bookkeeping
+    uint32_t length;   // Bytes used in data
+    uint8_t data[MPSC_SLOT_DATA_SIZE];
+} mpsc_slot_t;
+
+// Multi-producer, single-consumer ring of fixed-size slots. Producers race
+// for positions with a CAS on tail; the consumer alone advances head.
+typedef struct
+{
+    _Alignas(SHM_CACHE_LINE) atomic_uint_least64_t tail; // Next position producers claim
+    _Alignas(SHM_CACHE_LINE) atomic_uint_least64_t head; // Next position the consumer reads
+
+    _Alignas(SHM_CACHE_LINE) shm_waitpoint_t data_ready; // Consumer waits here when empty
+    shm_waitpoint_t space_ready;                         // Producers wait here when full
+
+    // Read-only after creation
+    _Alignas(SHM_CACHE_LINE) uint64_t capacity;
+    uint64_t mask;
+    atomic_bool shutdown_flag;
+
+    _Alignas(SHM_CACHE_LINE) mpsc_slot_t slots[];
+} mpsc_ring_t;
+
+// Bytes of shared memory needed for a ring of the given number of slots
+static inline size_t mpsc_ring_shm_size(size_t capacity)
+{
+    return sizeof(mpsc_ring_t) + capacity * sizeof(mpsc_slot_t);
+}
+
+// Set up an empty ring; capacity must be a power of 2
+static inline int mpsc_ring_init(mpsc_ring_t *ring, size_t capacity)
+{
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0)
+    {
+        return -1;
+    }
+
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->head, 0);
+    shm_waitpoint_init(&ring->data_ready);
+    shm_waitpoint_init(&ring->space_ready);
+    ring->capacity = capacity;
+    ring->mask = capacity - 1;
+    atomic_init(&ring->shutdown_flag, false);
+    for (size_t i = 0; i < capacity; i++)
+    {
+        atomic_init(&ring->slots[i].sequence, i);
+    }
+    return 0;
+}
+
+// Producer: claim the next free slot to fill in place, or NULL if the ring
+// is full. *position must be handed to mpsc_ring_publish.
+static inline mpsc_slot_t *mpsc_ring_claim(mpsc_ring_t *ring, uint64_t *position)
+{
+    uint64_t pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    for (;;)
+    {
+        mpsc_slot_t *slot = &ring->slots[pos & ring->mask];
+        uint64_t seq = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        int64_t diff = (int64_t)(seq - pos);
+
+        if (diff == 0)
+        {
+            // The slot is free for this position, try to take it
+            if (atomic_compare_exchange_weak_explicit(&ring->tail, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed))
+            {
+                *position = pos;
+                return slot;
+            }
+            // Lost the race, pos now holds the current tail
+        }
+        else if (diff < 0)
+        {
+            // The consumer hasn't freed this slot from the previous lap yet
+            return NULL;
+        }
+        else
+        {
+            // Another producer claimed it first
+            pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        }
+    }
+}
+
+// Producer: hand a filled slot to the consumer
+static inline void mpsc_ring_publish(mpsc_ring_t *ring, mpsc_slot_t *slot, uint64_t position)
+{
+    // The release store orders the payload writes before the slot turns ready
+    atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+    shm_notify(&ring->data_ready);
+}
+
+// Slot for a position, for walking a run claimed or peeked in one call
+static inline mpsc_slot_t *mpsc_ring_slot(mpsc_ring_t *ring, uint64_t position)
+{
+    return &ring->slots[position & ring->mask];
+}
+
+// Producer: claim up to max consecutive free slots with a single CAS.
+// Returns how many (0 if full); they start at *first and are published
+// with mpsc_ring_publish_batch.
+static inline size_t mpsc_ring_claim_batch(mpsc_ring_t *ring, size_t max, uint64_t *first)
+{
+    uint64_t pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    for (;;)
+    {
+        // Measure the run of slots free for positions pos, pos + 1, ...
+        size_t count = 0;
+        int64_t diff = 0;
+        while (count < max)
+        {
+            uint64_t seq = atomic_load_explicit(&mpsc_ring_slot(ring, pos + count)->sequence, memory_order_acquire);
+            diff = (int64_t)(seq - (pos + count));
+            if (diff != 0)
+            {
+                break;
+            }
+            count++;
+        }
+
+        if (count > 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&ring->tail, &pos, pos + count,
+                                                      memory_order_relaxed, memory_order_relaxed))
+            {
+                *first = pos;
+                return count;
+            }
+            // Lost the race, pos now holds the current tail
+        }
+        else if (diff < 0)
+        {
+            return 0; // Full
+        }
+        else
+        {
+            pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        }
+    }
+}
+
+// Producer: hand count filled slots from mpsc_ring_claim_batch to the consumer
+static inline void mpsc_ring_publish_batch(mpsc_ring_t *ring, uint64_t first, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        atomic_store_explicit(&mpsc_ring_slot(ring, first + i)->sequence, first + i + 1, memory_order_release);
+    }
+
+    // One wake-up for the whole run
+    shm_notify(&ring->data_ready);
+}
+
+// Producer: copy a message into the ring. Returns false if it is full.
+static inline bool mpsc_ring_send(mpsc_ring_t *ring, uint32_t producer, const void *data, uint32_t length)
+{
+    uint64_t position;
+    mpsc_slot_t *slot = mpsc_ring_claim(ring, &position);
+    if (slot == NULL)
+    {
+        return false;
+    }
+
+    slot->producer = producer;
+    slot->length = length < MPSC_SLOT_DATA_SIZE ? length : MPSC_SLOT_DATA_SIZE;
+    memcpy(slot->data, data, slot->length);
+    mpsc_ring_publish(ring, slot, position);
+    return true;
+}
+
+// Consumer: the next message in order, or NULL if it isn't published yet.
+// Slots are read in claim order, so a slow producer holds back later ones.
+static inline mpsc_slot_t *mpsc_ring_peek(mpsc_ring_t *ring)
+{
+    uint64_t pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    mpsc_slot_t *slot = &ring->slots[pos & ring->mask];
+    if (atomic_load_explicit(&slot->sequence, memory_order_acquire) != pos + 1)
+    {
+        return NULL;
+    }
+    return slot;
+}
+
+// Consumer: free the slot returned by mpsc_ring_peek for the next lap
+static inline void mpsc_ring_release(mpsc_ring_t *ring, mpsc_slot_t *slot)
+{
+    uint64_t pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+    // The release store keeps our reads of the payload before producers reuse it
+    atomic_store_explicit(&slot->sequence, pos + ring->capacity, memory_order_release);
+    atomic_store_explicit(&ring->head, pos + 1, memory_order_relaxed);
+    shm_notify(&ring->space_ready);
+}
+
+// Consumer: how many messages in a row are published, up to max, starting
+// at *first. Read them through mpsc_ring_slot, free them with mpsc_ring_release_batch.
+static inline size_t mpsc_ring_peek_batch(mpsc_ring_t *ring, size_t max, uint64_t *first)
+{
+    uint64_t pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t count = 0;
+    while (count < max &&
+           atomic_load_explicit(&mpsc_ring_slot(ring, pos + count)->sequence, memory_order_acquire) == pos + count + 1)
+    {
+        count++;
+    }
+    *first = pos;
+    return count;
+}
+
+// Consumer: free the first count slots of the last mpsc_ring_peek_batch
+static inline void mpsc_ring_release_batch(mpsc_ring_t *ring, size_t count)
+{
+    uint64_t pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    for (size_t i = 0; i < count; i++)
+    {
+        // Producers watch each slot's sequence, so every slot still gets its own store
+        atomic_store_explicit(&mpsc_ring_slot(ring, pos + i)->sequence, pos + i + ring->capacity, memory_order_release);
+    }
+    atomic_store_explicit(&ring->head, pos + count, memory_order_relaxed);
+
+    // One wake-up for the whole run
+    shm_notify(&ring->space_ready);
+}
+
+#endif // MPSC_RING_SHARED_H
@@ -0,0 +1,86 @@
+#include "shared_memory.h"
+#include "mpsc_ring_shared.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+
+#define WAIT_TIMEOUT_MS 100 // Wake at least this often to notice Ctrl+C
+
+// Flag for clean shutdown
+volatile sig_atomic_t running = 1;
+
+// Signal handler for Ctrl+C
+void handle_sigint(int sig)
+{
+    (void)sig; // Suppress unused parameter warning
+    running = 0;
+}
+
+int main(int argc, char *argv[])
+{
+    // Any number of producers can run at once, each with its own id
+    uint32_t id = argc > 1 ? (uint32_t)atoi(argv[1]) : (uint32_t)getpid() % 64;
+    printf("Starting MPSC ring producer %u\n", id);
+
+    // Set up signal handler for clean shutdown
+    signal(SIGINT, handle_sigint);
+
+    // Open the aggregator's ring
+    shared_memory_t shm = {0};
+    if (shared_memory_open(&shm, MPSC_RING_SHM_NAME) != 0)
+    {
+        printf("Failed to open shared memory. Make sure the consumer is running first.\n");
+        return 1;
+    }
+
+    mpsc_ring_t *ring = (mpsc_ring_t *)shm.addr;
+
+    printf("Connected to ring of %llu slots\n", (unsigned long long)ring->capacity);
+    printf("Press Ctrl+C to exit\n");
+
+    // Seed random number generator
+    srand(time(NULL) ^ id);
+
+    uint32_t sent = 0;
+    shm_waiter_t waiter;
+    shm_waiter_init(&waiter, &ring->space_ready, SHM_WAIT_HYBRID);
+    while (running && !atomic_load(&ring->shutdown_flag))
+    {
+        // Claim a slot and write the message straight into it
+        uint64_t position;
+        mpsc_slot_t *slot = mpsc_ring_claim(ring, &position);
+        if (slot == NULL)
+        {
+            // Ring full, wait for the consumer to free slots
+            shm_wait(&waiter, WAIT_TIMEOUT_MS);
+            continue;
+        }
+        shm_wait_done(&waiter);
+
+        slot->producer = id;
+        slot->length = snprintf((char *)slot->data, MPSC_SLOT_DATA_SIZE, "sample %u value %d", sent, rand() % 1000);
+        if (slot->length >= MPSC_SLOT_DATA_SIZE)
+        {
+            slot->length = MPSC_SLOT_DATA_SIZE - 1; // Truncated
+        }
+        mpsc_ring_publish(ring, slot, position);
+
+        sent++;
+        printf("\rProduced %u messages", sent);
+        fflush(stdout);
+
+        // Slow down a bit to make it easier to observe
+        usleep(10000); // 10ms
+    }
+
+    printf("\nShutting down...\n");
+
+    // Clean up
+    shared_memory_destroy(&shm, 0); // Don't unlink, the consumer owns the ring
+
+    printf("Producer process completed\n");
+
+    return 0;
+}
@@ -15,39 +15,21 @@ void handle_sigint(int sig)
     running = 0;
 }
 
-// Function to read data from the ring buffer without blocking
-int read_from_buffer(ring_buffer_t *rb, uint8_t *data, uint32_t max_size)
-{
-    // Check if there's data to read
-    uint32_t available = buffer_size(rb);
-    if (available == 0)
-    {
-        return 0; // Buffer empty, can't read
-    }
+#define MAX_READ 4096 // Take everything ready, up to this much, per peek
+#define WAIT_TIMEOUT_MS 100 // Wake at least this often to notice Ctrl+C
 
-    // Read at most max_size bytes
-    uint32_t to_read = (available < max_size) ? available : max_size;
-    uint64_t read_idx = atomic_load_explicit(&rb->read_index, memory_order_relaxed);
+int main(int argc, char *argv[])
+{
+    printf("Starting lock-free ring buffer consumer\n");
 
-    // Copy data from buffer
-    for (uint32_t i = 0; i < to_read; i++)
+    // How to wait when the ring is empty
+    shm_wait_strategy_t strategy = SHM_WAIT_HYBRID;
+    if (argc > 1 && shm_wait_parse_strategy(argv[1], &strategy) != 0)
     {
-        data[i] = rb->data[buffer_mask(read_idx + i)];
+        printf("Usage: %s [spin|pause|hybrid|futex]\n", argv[0]);
+        return 1;
     }
 
-    // Ensure all reads from the buffer are complete before updating read_index
-    atomic_thread_fence(memory_order_acquire);
-
-    // Update read index
-    atomic_store_explicit(&rb->read_index, read_idx + to_read, memory_order_release);
-
-    return to_read;
-}
-
-int main()
-{
-    printf("Starting lock-free ring buffer consumer\n");
-
     // Set up signal handler for clean shutdown
     signal(SIGINT, handle_sigint);
 
@@ -62,42 +44,51 @@ int main()
     // Get ring buffer from shared memory
     ring_buffer_t *rb = (ring_buffer_t *)shm.addr;
 
-    printf("Connected to ring buffer\n");
+    printf("Connected to ring buffer of %llu bytes (%s wait)\n", (unsigned long long)rb->capacity,
+           shm_wait_strategy_name(strategy));
     printf("Press Ctrl+C to exit\n");
 
     // Process data
-    uint8_t data[128];
     uint32_t counter = 0;
     uint64_t total_bytes = 0;
+    shm_waiter_t waiter;
+    shm_waiter_init(&waiter, &rb->data_ready, strategy);
 
     while (running)
     {
-        // Try to read from buffer (non-blocking)
-        int bytes_read = read_from_buffer(rb, data, sizeof(data));
+        // Look at the available data in place (non-blocking)
+        ring_span_t spans[2];
+        size_t bytes_read = ring_peek(rb, MAX_READ, spans);
 
         if (bytes_read > 0)
         {
+            shm_wait_done(&waiter);
             counter++;
             total_bytes += bytes_read;
 
-            printf("\rConsumed %u packets, %llu total bytes", counter, total_bytes);
+            printf("\rConsumed %u bursts, %llu total bytes", counter, (unsigned long long)total_bytes);
             fflush(stdout);
 
             // Process the data (in this example, we just print the first few bytes)
             if (counter % 100 == 0)
             {
                 printf("\nSample data: ");
-                for (int i = 0; i < 8 && i < bytes_read; i++)
+                for (size_t i = 0; i < 8 && i < bytes_read; i++)
                 {
-                    printf("%02X ", data[i]);
+                    // The sample may straddle the wrap-around point
+                    uint8_t byte = i < spans[0].length ? spans[0].data[i] : spans[1].data[i - spans[0].length];
+                    printf("%02X ", byte);
                 }
                 printf("\n");
             }
+
+            // Done with the bytes, hand the space back to the producer
+            ring_release(rb, bytes_read);
         }
         else
         {
-            // No data available, wait a bit
-            usleep(1000); // 1ms
+            // No data available, wait for the producer to commit some
+            shm_wait(&waiter, WAIT_TIMEOUT_MS);
         }
     }
 
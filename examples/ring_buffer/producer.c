@@ -5,39 +5,31 @@
 #include <unistd.h>
 #include <time.h>
 
-// Function to write data to the ring buffer without blocking
-int write_to_buffer(ring_buffer_t *rb, const uint8_t *data, uint32_t size)
-{
-    // Check if there's enough space
-    if (buffer_free_space(rb) < size)
-    {
-        return 0; // Buffer full, can't write
-    }
-
-    uint64_t write_idx = atomic_load_explicit(&rb->write_index, memory_order_relaxed);
+#define PACKET_SIZE 64
+#define MAX_BURST 16 // Packets generated per wake-up, published with one commit
 
-    // Copy data to buffer
-    for (uint32_t i = 0; i < size; i++)
+// Fill the first n bytes of a reserved region in place with random bytes
+static void fill_random(ring_span_t spans[2], size_t n)
+{
+    for (int s = 0; s < 2 && n > 0; s++)
     {
-        rb->data[buffer_mask(write_idx + i)] = data[i];
+        for (size_t i = 0; i < spans[s].length && n > 0; i++, n--)
+        {
+            spans[s].data[i] = rand() % 256;
+        }
     }
-
-    // Ensure all writes to the buffer are visible before updating write_index
-    atomic_thread_fence(memory_order_release);
-
-    // Update write index
-    atomic_store_explicit(&rb->write_index, write_idx + size, memory_order_release);
-
-    return size;
 }
 
-int main()
+int main(int argc, char *argv[])
 {
     printf("Starting lock-free ring buffer producer\n");
 
+    // The capacity is picked at creation time
+    size_t capacity = argc > 1 ? strtoull(argv[1], NULL, 0) : RING_BUFFER_DEFAULT_CAPACITY;
+
     // Create shared memory
     shared_memory_t shm = {0};
-    if (shared_memory_create(&shm, RING_BUFFER_SHM_NAME, sizeof(ring_buffer_t)) != 0)
+    if (shared_memory_create(&shm, RING_BUFFER_SHM_NAME, ring_buffer_shm_size(capacity)) != 0)
     {
         printf("Failed to create shared memory\n");
         return 1;
@@ -45,10 +37,14 @@ int main()
 
     // Initialize ring buffer
     ring_buffer_t *rb = (ring_buffer_t *)shm.addr;
-    atomic_init(&rb->write_index, 0);
-    atomic_init(&rb->read_index, 0);
+    if (ring_buffer_init(rb, capacity) != 0)
+    {
+        printf("Capacity must be a power of 2, got %zu\n", capacity);
+        shared_memory_destroy(&shm, 1);
+        return 1;
+    }
 
-    printf("Ring buffer initialized, waiting for consumer...\n");
+    printf("Ring buffer of %zu bytes initialized, waiting for consumer...\n", capacity);
     printf("Press Ctrl+C to exit\n");
 
     // Seed random number generator
@@ -56,28 +52,31 @@ int main()
 
     // Generate and send random data
     uint32_t counter = 0;
+    shm_waiter_t waiter;
+    shm_waiter_init(&waiter, &rb->space_ready, SHM_WAIT_HYBRID);
     while (1)
     {
-        // Create some test data (random bytes)
-        uint8_t data[64];
-        for (int i = 0; i < 64; i++)
+        // Data arrives in bursts; reserve room for as much of one as fits (non-blocking)
+        size_t burst = 1 + rand() % MAX_BURST;
+        ring_span_t spans[2];
+        size_t packets = ring_reserve_up_to(rb, burst * PACKET_SIZE, spans) / PACKET_SIZE;
+        if (packets > 0)
         {
-            data[i] = rand() % 256;
-        }
+            shm_wait_done(&waiter);
 
-        // Try to write to buffer (non-blocking)
-        int bytes_written = write_to_buffer(rb, data, 64);
+            // Generate the test data directly in the ring, then publish the whole burst at once
+            fill_random(spans, packets * PACKET_SIZE);
+            ring_commit(rb, packets * PACKET_SIZE);
 
-        if (bytes_written > 0)
-        {
-            counter++;
+            counter += packets;
             printf("\rProduced %u packets of data", counter);
             fflush(stdout);
         }
         else
         {
-            // Buffer is full, wait a bit
-            usleep(1000); // 1ms
+            // Buffer is full, wait for the consumer to release space
+            shm_wait(&waiter, -1);
+            continue;
         }
 
         // Slow down a bit to make it easier to observe
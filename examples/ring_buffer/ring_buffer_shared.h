@@ -1,35 +1,82 @@
 #ifndef RING_BUFFER_SHARED_H
 #define RING_BUFFER_SHARED_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdatomic.h>
 #include <stdbool.h>
+#include "shared_memory.h"
+#include "shm_wait.h"
 
 #define RING_BUFFER_SHM_NAME "/ring_buffer_shared_memory"
-#define BUFFER_SIZE 1024 // Must be power of 2 for efficient masking
+#define RING_BUFFER_DEFAULT_CAPACITY (64 * 1024) // Any power of 2 works, set at creation
 
+// Single-producer, single-consumer ring. Each side owns one cache line and
+// keeps a cached copy of the other side's index there, so the shared
+// indices only move between cores when a side looks full or empty.
 typedef struct
 {
-    uint8_t data[BUFFER_SIZE];
-    atomic_uint_least64_t write_index; // Producer writes here
-    atomic_uint_least64_t read_index;  // Consumer reads here
+    // Producer's line
+    _Alignas(SHM_CACHE_LINE) atomic_uint_least64_t write_index; // Producer writes here
+    uint64_t cached_read_index;                                  // Producer's last view of read_index
+
+    // Consumer's line
+    _Alignas(SHM_CACHE_LINE) atomic_uint_least64_t read_index; // Consumer reads here
+    uint64_t cached_write_index;                                // Consumer's last view of write_index
+
+    // Read-only after creation
+    _Alignas(SHM_CACHE_LINE) uint64_t capacity;
+    uint64_t mask;
+
+    // Where each side sleeps, away from the index lines
+    _Alignas(SHM_CACHE_LINE) shm_waitpoint_t data_ready; // Consumer waits here when empty
+    shm_waitpoint_t space_ready;                         // Producer waits here when full
+
+    _Alignas(SHM_CACHE_LINE) uint8_t data[];
 } ring_buffer_t;
 
+// Bytes of shared memory needed for a ring of the given capacity
+static inline size_t ring_buffer_shm_size(size_t capacity)
+{
+    return sizeof(ring_buffer_t) + capacity;
+}
+
+// Set up an empty ring; capacity must be a power of 2
+static inline int ring_buffer_init(ring_buffer_t *rb, size_t capacity)
+{
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0)
+    {
+        return -1;
+    }
+
+    atomic_init(&rb->write_index, 0);
+    atomic_init(&rb->read_index, 0);
+    rb->cached_read_index = 0;
+    rb->cached_write_index = 0;
+    rb->capacity = capacity;
+    rb->mask = capacity - 1;
+    shm_waitpoint_init(&rb->data_ready);
+    shm_waitpoint_init(&rb->space_ready);
+    return 0;
+}
+
 // Helper functions for lock-free operations
-static inline uint32_t buffer_mask(uint64_t val)
+static inline uint64_t buffer_mask(ring_buffer_t *rb, uint64_t val)
 {
-    return val & (BUFFER_SIZE - 1); // Efficient modulo for power of 2
+    return val & rb->mask; // Efficient modulo for power of 2
 }
 
-static inline uint32_t buffer_size(ring_buffer_t *rb)
+// Snapshot of the bytes in the ring, for either side or an observer.
+// The fast paths below use the cached indices instead.
+static inline uint64_t buffer_size(ring_buffer_t *rb)
 {
-    return atomic_load_explicit(&rb->write_index, memory_order_acquire) -
-           atomic_load_explicit(&rb->read_index, memory_order_acquire);
+    uint64_t read_idx = atomic_load_explicit(&rb->read_index, memory_order_relaxed);
+    return atomic_load_explicit(&rb->write_index, memory_order_relaxed) - read_idx;
 }
 
-static inline uint32_t buffer_free_space(ring_buffer_t *rb)
+static inline uint64_t buffer_free_space(ring_buffer_t *rb)
 {
-    return BUFFER_SIZE - buffer_size(rb);
+    return rb->capacity - buffer_size(rb);
 }
 
 static inline bool buffer_is_empty(ring_buffer_t *rb)
@@ -39,7 +86,116 @@ static inline bool buffer_is_empty(ring_buffer_t *rb)
 
 static inline bool buffer_is_full(ring_buffer_t *rb)
 {
-    return buffer_size(rb) == BUFFER_SIZE;
+    return buffer_size(rb) == rb->capacity;
+}
+
+// A contiguous run of bytes inside rb->data. A range that wraps around the
+// end of the buffer is described by two spans, the second starting at data[0].
+typedef struct
+{
+    uint8_t *data;
+    size_t length;
+} ring_span_t;
+
+// Describe `n` bytes starting at index as (up to) two spans; unused spans get length 0
+static inline void ring_spans(ring_buffer_t *rb, uint64_t index, size_t n, ring_span_t spans[2])
+{
+    uint64_t start = buffer_mask(rb, index);
+    size_t first = rb->capacity - start;
+    if (first > n)
+    {
+        first = n;
+    }
+
+    spans[0].data = &rb->data[start];
+    spans[0].length = first;
+    spans[1].data = rb->data;
+    spans[1].length = n - first;
+}
+
+// Producer: reserve n bytes of free space to write in place. Returns false
+// (and touches nothing) if fewer than n bytes are free. Publish with ring_commit.
+static inline bool ring_reserve(ring_buffer_t *rb, size_t n, ring_span_t spans[2])
+{
+    uint64_t write_idx = atomic_load_explicit(&rb->write_index, memory_order_relaxed);
+
+    // Only look at the consumer's line when the cached view says we're full
+    if (rb->capacity - (write_idx - rb->cached_read_index) < n)
+    {
+        rb->cached_read_index = atomic_load_explicit(&rb->read_index, memory_order_acquire);
+        if (rb->capacity - (write_idx - rb->cached_read_index) < n)
+        {
+            return false;
+        }
+    }
+
+    ring_spans(rb, write_idx, n, spans);
+    return true;
+}
+
+// Producer: reserve as much free space as there is, up to max bytes, to
+// fill a whole burst with one commit. Returns how many bytes the spans
+// cover (0 if full); commit any prefix of them with ring_commit.
+static inline size_t ring_reserve_up_to(ring_buffer_t *rb, size_t max, ring_span_t spans[2])
+{
+    uint64_t write_idx = atomic_load_explicit(&rb->write_index, memory_order_relaxed);
+
+    uint64_t free_space = rb->capacity - (write_idx - rb->cached_read_index);
+    if (free_space < max)
+    {
+        rb->cached_read_index = atomic_load_explicit(&rb->read_index, memory_order_acquire);
+        free_space = rb->capacity - (write_idx - rb->cached_read_index);
+    }
+    if (free_space > max)
+    {
+        free_space = max;
+    }
+
+    ring_spans(rb, write_idx, free_space, spans);
+    return free_space;
+}
+
+// Producer: make the first n reserved bytes visible to the consumer
+static inline void ring_commit(ring_buffer_t *rb, size_t n)
+{
+    uint64_t write_idx = atomic_load_explicit(&rb->write_index, memory_order_relaxed);
+
+    // The release store orders the payload writes before the new index
+    atomic_store_explicit(&rb->write_index, write_idx + n, memory_order_release);
+    shm_notify(&rb->data_ready);
+}
+
+// Consumer: look at up to max readable bytes in place, everything that is
+// ready in one call. Returns how many bytes the spans cover (0 if empty).
+// The producer's index is only reloaded once everything seen so far has
+// been consumed. Free them with ring_release.
+static inline size_t ring_peek(ring_buffer_t *rb, size_t max, ring_span_t spans[2])
+{
+    uint64_t read_idx = atomic_load_explicit(&rb->read_index, memory_order_relaxed);
+
+    uint64_t available = rb->cached_write_index - read_idx;
+    if (available == 0)
+    {
+        rb->cached_write_index = atomic_load_explicit(&rb->write_index, memory_order_acquire);
+        available = rb->cached_write_index - read_idx;
+    }
+    if (available > max)
+    {
+        available = max;
+    }
+
+    ring_spans(rb, read_idx, available, spans);
+    return available;
+}
+
+// Consumer: hand n peeked bytes back to the producer (never more than the last peek returned)
+static inline void ring_release(ring_buffer_t *rb, size_t n)
+{
+    uint64_t read_idx = atomic_load_explicit(&rb->read_index, memory_order_relaxed);
+
+    // The release store keeps our reads of the payload before the producer reuses it
+    atomic_store_explicit(&rb->read_index, read_idx + n, memory_order_release);
+    shm_notify(&rb->space_ready);
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,64 @@
+#ifndef ARENA_SHARED_H
+#define ARENA_SHARED_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include "shm_alloc.h"
+#include "shm_wait.h"
+
+#define ARENA_SHM_NAME "/arena_shared_memory"
+#define ARENA_SHM_SIZE (16 * 1024 * 1024) // 16MB arena
+#define MAX_MESSAGE_LENGTH 200
+
+// A variable-length message, linked to the next one by offset
+typedef struct
+{
+    shm_offset_t next;
+    uint32_t sequence;
+    uint32_t length;
+    char text[]; // length bytes, not null-terminated
+} message_t;
+
+// Root object of the arena: a lock-free stack of pending messages
+typedef struct
+{
+    atomic_uint_least64_t head; // Offset of the newest message
+    atomic_uint_least64_t messages_sent;
+    atomic_bool shutdown_flag;
+    shm_waitpoint_t data_ready;  // Consumer waits here when the stack is empty
+    shm_waitpoint_t space_ready; // Producer waits here when the arena is full
+} message_queue_t;
+
+// Push a message (producer side); safe with several producers
+static inline void queue_push(shm_arena_t *arena, message_queue_t *queue, shm_offset_t offset)
+{
+    message_t *message = (message_t *)shm_ptr(arena, offset);
+    uint64_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    do
+    {
+        message->next = head;
+    } while (!atomic_compare_exchange_weak_explicit(&queue->head, &head, offset,
+                                                    memory_order_release, memory_order_relaxed));
+    shm_notify(&queue->data_ready);
+}
+
+// Take every pending message at once, oldest first (consumer side)
+static inline shm_offset_t queue_take_all(shm_arena_t *arena, message_queue_t *queue)
+{
+    shm_offset_t offset = atomic_exchange_explicit(&queue->head, 0, memory_order_acquire);
+
+    // The stack is newest first, reverse it
+    shm_offset_t reversed = 0;
+    while (offset != 0)
+    {
+        message_t *message = (message_t *)shm_ptr(arena, offset);
+        shm_offset_t next = message->next;
+        message->next = reversed;
+        reversed = offset;
+        offset = next;
+    }
+    return reversed;
+}
+
+#endif // ARENA_SHARED_H
@@ -0,0 +1,107 @@
+#include "shared_memory.h"
+#include "arena_shared.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <signal.h>
+
+// Flag for clean shutdown
+volatile sig_atomic_t running = 1;
+
+// Signal handler for Ctrl+C
+void handle_sigint(int sig)
+{
+    (void)sig; // Suppress unused parameter warning
+    running = 0;
+}
+
+#define WAIT_TIMEOUT_MS 100 // Wake at least this often to notice Ctrl+C
+
+int main(int argc, char *argv[])
+{
+    printf("Starting shared arena consumer\n");
+
+    // How to wait when no messages are pending
+    shm_wait_strategy_t strategy = SHM_WAIT_HYBRID;
+    if (argc > 1 && shm_wait_parse_strategy(argv[1], &strategy) != 0)
+    {
+        printf("Usage: %s [spin|pause|hybrid|futex]\n", argv[0]);
+        return 1;
+    }
+
+    // Set up signal handler for clean shutdown
+    signal(SIGINT, handle_sigint);
+
+    // Open shared memory
+    shared_memory_t shm = {0};
+    if (shared_memory_open(&shm, ARENA_SHM_NAME) != 0)
+    {
+        printf("Failed to open shared memory. Make sure producer is running first.\n");
+        return 1;
+    }
+
+    // Find the queue through the arena root; our mapping address differs from
+    // the producer's, but offsets are the same in both
+    shm_arena_t *arena = shm_arena_open(&shm);
+    if (arena == NULL || shm_arena_root(arena) == 0)
+    {
+        printf("Arena not initialized yet\n");
+        shared_memory_destroy(&shm, 0);
+        return 1;
+    }
+    message_queue_t *queue = (message_queue_t *)shm_ptr(arena, shm_arena_root(arena));
+
+    printf("Connected to arena at %p (%s wait)\n", (void *)arena, shm_wait_strategy_name(strategy));
+    printf("Press Ctrl+C to exit\n");
+
+    uint32_t received = 0;
+    uint64_t total_bytes = 0;
+    shm_waiter_t waiter;
+    shm_waiter_init(&waiter, &queue->data_ready, strategy);
+
+    while (running)
+    {
+        shm_offset_t offset = queue_take_all(arena, queue);
+        if (offset == 0)
+        {
+            if (atomic_load_explicit(&queue->shutdown_flag, memory_order_acquire))
+            {
+                printf("\nProducer has shut down, exiting...\n");
+                break;
+            }
+
+            // No messages, wait for the producer to push some
+            shm_wait(&waiter, WAIT_TIMEOUT_MS);
+            continue;
+        }
+        shm_wait_done(&waiter);
+
+        while (offset != 0)
+        {
+            // Read the message in place, then hand its block back to the arena
+            message_t *message = (message_t *)shm_ptr(arena, offset);
+            shm_offset_t next = message->next;
+
+            received++;
+            total_bytes += message->length;
+            printf("\rConsumed %u messages, %llu text bytes, last #%u: %-20.*s",
+                   received, (unsigned long long)total_bytes, message->sequence,
+                   message->length < 20 ? (int)message->length : 20, message->text);
+            fflush(stdout);
+
+            shm_free(arena, offset);
+            offset = next;
+        }
+
+        // The freed blocks may be what a producer on a full arena is waiting for
+        shm_notify(&queue->space_ready);
+    }
+
+    printf("\nShutting down...\n");
+
+    shared_memory_destroy(&shm, 1);
+
+    printf("Consumer process completed\n");
+
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include "shared_memory.h"
+#include "arena_shared.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+
+#define WAIT_TIMEOUT_MS 100 // Wake at least this often to notice Ctrl+C
+
+// Flag for clean shutdown
+volatile sig_atomic_t running = 1;
+
+// Signal handler for Ctrl+C
+void handle_sigint(int sig)
+{
+    (void)sig; // Suppress unused parameter warning
+    running = 0;
+}
+
+int main()
+{
+    printf("Starting shared arena producer (variable-length messages)\n");
+
+    // Set up signal handler for clean shutdown
+    signal(SIGINT, handle_sigint);
+
+    // Create shared memory
+    shared_memory_t shm = {0};
+    if (shared_memory_create(&shm, ARENA_SHM_NAME, ARENA_SHM_SIZE) != 0)
+    {
+        printf("Failed to create shared memory\n");
+        return 1;
+    }
+
+    // Format it as an arena and allocate the queue as its root object
+    shm_arena_t *arena = shm_arena_create(&shm);
+    shm_offset_t queue_offset = arena != NULL ? shm_alloc(arena, sizeof(message_queue_t)) : 0;
+    if (queue_offset == 0)
+    {
+        printf("Failed to set up the arena\n");
+        shared_memory_destroy(&shm, 1);
+        return 1;
+    }
+
+    message_queue_t *queue = (message_queue_t *)shm_ptr(arena, queue_offset);
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->messages_sent, 0);
+    atomic_init(&queue->shutdown_flag, false);
+    shm_waitpoint_init(&queue->data_ready);
+    shm_waitpoint_init(&queue->space_ready);
+    shm_arena_set_root(arena, queue_offset);
+
+    printf("Arena initialized with %u slabs, waiting for consumer...\n", arena->slab_count);
+    printf("Press Ctrl+C to exit\n");
+
+    // Seed random number generator
+    srand(time(NULL));
+
+    uint32_t sequence = 0;
+    shm_waiter_t waiter;
+    shm_waiter_init(&waiter, &queue->space_ready, SHM_WAIT_HYBRID);
+    while (running)
+    {
+        // Each message gets exactly as much space as its text needs
+        uint32_t length = 1 + rand() % MAX_MESSAGE_LENGTH;
+        shm_offset_t offset = shm_alloc(arena, sizeof(message_t) + length);
+        if (offset == 0)
+        {
+            // Arena full, wait for the consumer to free some messages
+            shm_wait(&waiter, WAIT_TIMEOUT_MS);
+            continue;
+        }
+        shm_wait_done(&waiter);
+
+        message_t *message = (message_t *)shm_ptr(arena, offset);
+        message->sequence = sequence++;
+        message->length = length;
+        for (uint32_t i = 0; i < length; i++)
+        {
+            message->text[i] = 'a' + rand() % 26;
+        }
+
+        queue_push(arena, queue, offset);
+        atomic_fetch_add_explicit(&queue->messages_sent, 1, memory_order_relaxed);
+
+        printf("\rProduced %u messages", sequence);
+        fflush(stdout);
+
+        // Slow down a bit to make it easier to observe
+        usleep(10000); // 10ms
+    }
+
+    printf("\nShutting down...\n");
+
+    // Tell the consumer we're done, it unlinks the segment
+    atomic_store_explicit(&queue->shutdown_flag, true, memory_order_release);
+    shm_notify(&queue->data_ready);
+    shared_memory_destroy(&shm, 0);
+
+    return 0;
+}
@@ -2,10 +2,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
-#include <fcntl.h>
-#include <sys/mman.h>
 #include <signal.h>
 #include <mach/mach_time.h> // For high-precision timing on macOS
+#include "shared_memory.h"
 #include "simd_shared.h"
 
 // Flag for clean shutdown
@@ -59,28 +58,23 @@ int main()
     // Set up signal handler for clean shutdown
     signal(SIGINT, handle_sigint);
 
-    // Open shared memory
-    int fd = shm_open(SIMD_SHM_NAME, O_RDWR, 0);
-    if (fd == -1)
+    // Open shared memory, mapping it for huge pages if the producer got them
+    // and faulting in our own page tables before the first batch arrives
+    shared_memory_t segment = {0};
+    if (shared_memory_open_ex(&segment, SIMD_SHM_NAME, SHM_HUGE_PAGES | SHM_PREFAULT | SHM_LOCK) != 0)
     {
-        perror("shm_open");
         printf("Make sure producer is running first\n");
         return 1;
     }
+    void *addr = segment.addr;
 
     // Get the size
-    size_t shm_size = HUGE_PAGE_SIZE;
+    size_t shm_size = segment.size;
 
-    // Map the shared memory (macOS doesn't support MAP_ALIGNED_SUPER)
-    void *addr = mmap(NULL, shm_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-    if (addr == MAP_FAILED)
-    {
-        perror("mmap");
-        close(fd);
-        return 1;
-    }
-
-    printf("Shared memory mapped successfully\n");
+    printf("Shared memory mapped successfully (%s)\n",
+           shared_memory_backing_name(segment.backing));
+    printf("Pre-faulted%s in %.2f ms\n",
+           segment.locked ? " and locked" : "", segment.warmup_ns / 1e6);
 
     // Get shared memory pointer
     simd_shared_t *shm = (simd_shared_t *)addr;
@@ -93,13 +87,18 @@ int main()
     uint32_t batch_counter = 0;
     uint64_t total_ns = 0;
     uint64_t total_batches = 0;
+    uint32_t next_report = 1000;
 
     printf("Consuming data batches. Press Ctrl+C to exit.\n");
 
+    shm_waiter_t waiter;
+    shm_waiter_init(&waiter, &shm->batch_ready, SHM_WAIT_HYBRID);
+
     while (running)
     {
-        // Check if there's data to process
-        if (buffer_is_empty(shm))
+        // Take every batch that is ready in one go
+        uint32_t ready = buffer_size(shm);
+        if (ready == 0)
         {
             // Check if producer has signaled shutdown
             if (atomic_load_explicit(&shm->shutdown_flag, memory_order_acquire))
@@ -108,44 +107,47 @@ int main()
                 break;
             }
 
-            // No data, wait a bit
-            usleep(100);
+            // No data, wait for the producer (waking now and then to see Ctrl+C)
+            shm_wait(&waiter, 100);
             continue;
         }
+        shm_wait_done(&waiter);
 
         // Get current read position
         uint64_t read_idx = atomic_load_explicit(&shm->read_index, memory_order_relaxed);
-        uint32_t buffer_idx = read_idx % max_batches;
 
         // Start timing
         uint64_t start_time = get_time_ns();
 
-        // Process the batch with SIMD
-        simd_batch_t *batch = &shm->batches[buffer_idx];
-        process_batch_simd(batch);
+        // Process the whole run of batches with SIMD
+        for (uint32_t i = 0; i < ready; i++)
+        {
+            process_batch_simd(&shm->batches[(read_idx + i) % max_batches]);
+        }
 
-        // Ensure all reads from the batch are complete before updating read_index
+        // Ensure all reads from the batches are complete before updating read_index
         atomic_thread_fence(memory_order_acquire);
 
-        // Update read index
-        atomic_store_explicit(&shm->read_index, read_idx + 1, memory_order_release);
-
-        // Update statistics
-        atomic_fetch_add_explicit(&shm->total_batches_consumed, 1, memory_order_relaxed);
-        batch_counter++;
+        // Hand the run back with one index update, one wake-up check and one stats update
+        atomic_store_explicit(&shm->read_index, read_idx + ready, memory_order_release);
+        shm_notify(&shm->space_ready);
+        atomic_fetch_add_explicit(&shm->total_batches_consumed, ready, memory_order_relaxed);
+        batch_counter += ready;
 
         // End timing
         uint64_t end_time = get_time_ns();
-        uint64_t batch_ns = end_time - start_time;
-        total_ns += batch_ns;
-        total_batches++;
+        uint64_t batch_ns = (end_time - start_time) / ready;
+        total_ns += end_time - start_time;
+        total_batches += ready;
 
         // Update performance metrics
         atomic_store_explicit(&shm->consumer_cycles, batch_ns, memory_order_relaxed);
 
         // Print statistics every 1000 batches
-        if (batch_counter % 1000 == 0)
+        if (batch_counter >= next_report)
         {
+            next_report += 1000;
+
             // Calculate producer-consumer ratio
             uint64_t producer_ns = atomic_load_explicit(&shm->producer_cycles, memory_order_relaxed);
             double ratio = producer_ns > 0 ? (double)batch_ns / producer_ns : 0;
@@ -159,9 +161,7 @@ int main()
     printf("\nShutting down...\n");
 
     // Clean up
-    munmap(addr, shm_size);
-    close(fd);
-    shm_unlink(SIMD_SHM_NAME);
+    shared_memory_destroy(&segment, 1);
 
     printf("Consumer completed. Processed %u batches at %.2f µs/batch\n",
            batch_counter, (double)total_ns / total_batches / 1000.0);
@@ -2,13 +2,14 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
-#include <fcntl.h>
-#include <sys/mman.h>
 #include <time.h>
 #include <signal.h>
 #include <mach/mach_time.h> // For high-precision timing on macOS
+#include "shared_memory.h"
 #include "simd_shared.h"
 
+#define PUBLISH_BURST 8 // Batches filled per index update
+
 // Flag for clean shutdown
 volatile sig_atomic_t running = 1;
 
@@ -32,6 +33,30 @@ uint64_t get_time_ns()
     return time * timebase_info.numer / timebase_info.denom;
 }
 
+// Fill a batch with random data, pre-processed with SIMD
+static void fill_batch(simd_batch_t *batch, uint32_t batch_id)
+{
+    batch->batch_id = batch_id;
+
+    for (int i = 0; i < 1024; i += 4)
+    {
+        // Generate 4 random values at once (fix float conversion)
+        float32x4_t random_data = {
+            ((float)rand() / (float)RAND_MAX) * 2.0f - 1.0f,
+            ((float)rand() / (float)RAND_MAX) * 2.0f - 1.0f,
+            ((float)rand() / (float)RAND_MAX) * 2.0f - 1.0f,
+            ((float)rand() / (float)RAND_MAX) * 2.0f - 1.0f};
+
+        // Apply SIMD processing (tanh activation)
+        float32x4_t processed = vector_tanh(random_data);
+
+        // Store the result
+        vst1q_f32(&batch->data[i], processed);
+    }
+
+    batch->processed = 0; // Mark as not processed by consumer
+}
+
 int main()
 {
     printf("Starting SIMD-accelerated shared memory producer\n");
@@ -42,35 +67,20 @@ int main()
     // Calculate the size we need (use a huge page)
     size_t shm_size = HUGE_PAGE_SIZE;
 
-    // Create shared memory
-    shm_unlink(SIMD_SHM_NAME);
-    int fd = shm_open(SIMD_SHM_NAME, O_CREAT | O_RDWR, S_IRUSR | S_IWUSR);
-    if (fd == -1)
-    {
-        perror("shm_open");
-        return 1;
-    }
-
-    // Set the size
-    if (ftruncate(fd, shm_size) == -1)
-    {
-        perror("ftruncate");
-        close(fd);
-        shm_unlink(SIMD_SHM_NAME);
-        return 1;
-    }
-
-    // Try to use huge pages for better performance (macOS doesn't support MAP_ALIGNED_SUPER)
-    void *addr = mmap(NULL, shm_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-    if (addr == MAP_FAILED)
+    // Create shared memory, backed by huge pages where the OS allows it and
+    // faulted in up front so the first pass over the ring has no page faults
+    shared_memory_t segment = {0};
+    if (shared_memory_create_ex(&segment, SIMD_SHM_NAME, shm_size, SHM_HUGE_PAGES | SHM_PREFAULT | SHM_LOCK) != 0)
     {
-        perror("mmap");
-        close(fd);
-        shm_unlink(SIMD_SHM_NAME);
+        printf("Failed to create shared memory\n");
         return 1;
     }
+    void *addr = segment.addr;
 
-    printf("Shared memory mapped successfully\n");
+    printf("Shared memory mapped successfully (%s)\n",
+           shared_memory_backing_name(segment.backing));
+    printf("Pre-faulted%s in %.2f ms\n",
+           segment.locked ? " and locked" : "", segment.warmup_ns / 1e6);
 
     // Initialize shared memory
     simd_shared_t *shm = (simd_shared_t *)addr;
@@ -81,6 +91,8 @@ int main()
     atomic_init(&shm->producer_cycles, 0);
     atomic_init(&shm->consumer_cycles, 0);
     atomic_init(&shm->shutdown_flag, false);
+    shm_waitpoint_init(&shm->batch_ready);
+    shm_waitpoint_init(&shm->space_ready);
 
     // Calculate how many batches we can fit
     uint32_t max_batches = MAX_BATCHES(shm_size);
@@ -93,70 +105,59 @@ int main()
     uint32_t batch_counter = 0;
     uint64_t total_ns = 0;
     uint64_t total_batches = 0;
+    uint32_t next_report = 1000;
 
     printf("Producing data batches. Press Ctrl+C to exit.\n");
 
+    shm_waiter_t waiter;
+    shm_waiter_init(&waiter, &shm->space_ready, SHM_WAIT_HYBRID);
+
     while (running)
     {
-        // Check if buffer is full
-        if (buffer_is_full(shm, max_batches))
+        // Fill as much of a burst as there is room for
+        uint32_t free_batches = max_batches - buffer_size(shm);
+        if (free_batches == 0)
         {
-            // Buffer full, wait a bit
-            usleep(100);
+            // Buffer full, wait for the consumer (waking now and then to see Ctrl+C)
+            shm_wait(&waiter, 100);
             continue;
         }
+        shm_wait_done(&waiter);
+        uint32_t burst = free_batches < PUBLISH_BURST ? free_batches : PUBLISH_BURST;
 
         // Get current write position
         uint64_t write_idx = atomic_load_explicit(&shm->write_index, memory_order_relaxed);
-        uint32_t buffer_idx = write_idx % max_batches;
 
         // Start timing
         uint64_t start_time = get_time_ns();
 
-        // Fill the batch with random data and process it with SIMD
-        simd_batch_t *batch = &shm->batches[buffer_idx];
-        batch->batch_id = batch_counter++;
-
-        // Generate random data and pre-process it with SIMD
-        for (int i = 0; i < 1024; i += 4)
+        // Fill the batches with random data and process them with SIMD
+        for (uint32_t b = 0; b < burst; b++)
         {
-            // Generate 4 random values at once (fix float conversion)
-            float32x4_t random_data = {
-                ((float)rand() / (float)RAND_MAX) * 2.0f - 1.0f,
-                ((float)rand() / (float)RAND_MAX) * 2.0f - 1.0f,
-                ((float)rand() / (float)RAND_MAX) * 2.0f - 1.0f,
-                ((float)rand() / (float)RAND_MAX) * 2.0f - 1.0f};
-
-            // Apply SIMD processing (tanh activation)
-            float32x4_t processed = vector_tanh(random_data);
-
-            // Store the result
-            vst1q_f32(&batch->data[i], processed);
+            fill_batch(&shm->batches[(write_idx + b) % max_batches], batch_counter++);
         }
 
-        batch->processed = 0; // Mark as not processed by consumer
-
-        // Ensure all writes to the batch are visible before updating write_index
+        // Ensure all writes to the batches are visible before updating write_index
         atomic_thread_fence(memory_order_release);
 
-        // Update write index
-        atomic_store_explicit(&shm->write_index, write_idx + 1, memory_order_release);
-
-        // Update statistics
-        atomic_fetch_add_explicit(&shm->total_batches_produced, 1, memory_order_relaxed);
+        // Publish the burst with one index update, one wake-up check and one stats update
+        atomic_store_explicit(&shm->write_index, write_idx + burst, memory_order_release);
+        shm_notify(&shm->batch_ready);
+        atomic_fetch_add_explicit(&shm->total_batches_produced, burst, memory_order_relaxed);
 
         // End timing
         uint64_t end_time = get_time_ns();
-        uint64_t batch_ns = end_time - start_time;
-        total_ns += batch_ns;
-        total_batches++;
+        uint64_t batch_ns = (end_time - start_time) / burst;
+        total_ns += end_time - start_time;
+        total_batches += burst;
 
         // Update performance metrics
         atomic_store_explicit(&shm->producer_cycles, batch_ns, memory_order_relaxed);
 
         // Print statistics every 1000 batches
-        if (batch_counter % 1000 == 0)
+        if (batch_counter >= next_report)
         {
+            next_report += 1000;
             printf("\rProduced %u batches, Avg time: %.2f µs/batch",
                    batch_counter, (double)total_ns / total_batches / 1000.0);
             fflush(stdout);
@@ -170,14 +171,13 @@ int main()
 
     // Signal consumer to shut down
     atomic_store_explicit(&shm->shutdown_flag, true, memory_order_release);
+    shm_notify(&shm->batch_ready);
 
     // Wait a bit for consumer to notice
     usleep(100000);
 
     // Clean up
-    munmap(addr, shm_size);
-    close(fd);
-    // Don't unlink, let consumer do it
+    shared_memory_destroy(&segment, 0); // Don't unlink, let consumer do it
 
     printf("Producer completed. Processed %u batches at %.2f µs/batch\n",
            batch_counter, (double)total_ns / total_batches / 1000.0);
@@ -8,6 +8,7 @@
 #include <arm_sve.h>
 #include <math.h>
 #include "math_intrinsics.h"
+#include "shm_wait.h"
 
 // Use 2MB huge pages for better TLB efficiency
 #define HUGE_PAGE_SIZE (2 * 1024 * 1024)
@@ -43,6 +44,10 @@ typedef struct
     // Flags
     atomic_bool shutdown_flag ALIGN_TO_CACHE;
 
+    // Where each side sleeps when the ring is empty or full
+    shm_waitpoint_t batch_ready ALIGN_TO_CACHE;
+    shm_waitpoint_t space_ready;
+
     // Padding to ensure batches start at a cache line boundary
     uint8_t padding[CACHE_LINE_SIZE];
 
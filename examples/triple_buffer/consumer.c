@@ -0,0 +1,84 @@
+#include "shared_memory.h"
+#include "triple_buffer_shared.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <signal.h>
+
+// Flag for clean shutdown
+volatile sig_atomic_t running = 1;
+
+// Signal handler for Ctrl+C
+void handle_sigint(int sig)
+{
+    (void)sig; // Suppress unused parameter warning
+    running = 0;
+}
+
+int main()
+{
+    printf("Starting triple buffer consumer (30 FPS renderer)\n");
+
+    // Set up signal handler for clean shutdown
+    signal(SIGINT, handle_sigint);
+
+    // Open shared memory
+    shm_triple_t tb = {0};
+    if (shm_triple_open(&tb, TRIPLE_BUFFER_SHM_NAME, SHM_PREFAULT) != 0)
+    {
+        printf("Failed to open shared memory. Make sure producer is running first.\n");
+        return 1;
+    }
+
+    printf("Connected to triple buffer of %llu-byte frames\n", (unsigned long long)tb.header->frame_size);
+    printf("Press Ctrl+C to exit\n");
+
+    uint64_t last_frame = 0;
+    uint64_t rendered = 0;
+    uint64_t skipped = 0;
+    uint64_t torn = 0;
+    while (running)
+    {
+        // Take the newest complete frame and read it in place
+        uint64_t frame_number;
+        const state_frame_t *frame = shm_triple_acquire(&tb, &frame_number);
+        if (frame_number != 0 && frame_number != last_frame)
+        {
+            // "Render": the centroid of every particle
+            double cx = 0, cy = 0;
+            for (int i = 0; i < PARTICLE_COUNT; i++)
+            {
+                cx += frame->particles[i].x;
+                cy += frame->particles[i].y;
+            }
+
+            if (frame->frame_number != frame_number || frame->trailer != frame_number)
+            {
+                torn++;
+            }
+            if (last_frame != 0)
+            {
+                skipped += frame_number - last_frame - 1;
+            }
+            last_frame = frame_number;
+            rendered++;
+
+            printf("\rFrame %llu at t=%.2fs, centroid (%.4f, %.4f), rendered %llu, skipped %llu, torn %llu",
+                   (unsigned long long)frame_number, frame->sim_time, cx / PARTICLE_COUNT, cy / PARTICLE_COUNT,
+                   (unsigned long long)rendered, (unsigned long long)skipped, (unsigned long long)torn);
+            fflush(stdout);
+        }
+
+        // Render at our own pace, the producer never waits for us
+        usleep(33333); // ~30 FPS
+    }
+
+    printf("\nShutting down...\n");
+
+    // Clean up
+    shm_triple_close(&tb, 0); // Don't unlink, let producer do it
+
+    printf("Consumer process completed\n");
+
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include "shared_memory.h"
+#include "triple_buffer_shared.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <signal.h>
+
+// Flag for clean shutdown
+volatile sig_atomic_t running = 1;
+
+// Signal handler for Ctrl+C
+void handle_sigint(int sig)
+{
+    (void)sig; // Suppress unused parameter warning
+    running = 0;
+}
+
+// Advance the simulation: particles drift at their own speed
+static void simulate(state_frame_t *frame, uint64_t frame_number, double t)
+{
+    frame->frame_number = frame_number;
+    frame->sim_time = t;
+    for (int i = 0; i < PARTICLE_COUNT; i++)
+    {
+        frame->particles[i].x = (i % 1000) * 0.001f + (float)t * (1 + i % 7) * 0.01f;
+        frame->particles[i].y = (i / 1000) * 0.001f - (float)t * (1 + i % 5) * 0.01f;
+    }
+    frame->trailer = frame_number;
+}
+
+int main(int argc, char *argv[])
+{
+    // The writer runs at its own rate, independent of the reader
+    int rate_hz = argc > 1 ? atoi(argv[1]) : 120;
+    printf("Starting triple buffer producer at %d frames/s\n", rate_hz);
+
+    // Set up signal handler for clean shutdown
+    signal(SIGINT, handle_sigint);
+
+    // Three 2MB frames; prefault so the first frames don't pay for page faults
+    shm_triple_t tb = {0};
+    if (shm_triple_create(&tb, TRIPLE_BUFFER_SHM_NAME, sizeof(state_frame_t), SHM_PREFAULT) != 0)
+    {
+        printf("Failed to create shared memory\n");
+        return 1;
+    }
+
+    printf("Triple buffer of %zu-byte frames ready, start the consumer\n", sizeof(state_frame_t));
+    printf("Press Ctrl+C to exit\n");
+
+    double t = 0;
+    while (running)
+    {
+        // Write the next frame straight into the back buffer, then swap it in
+        state_frame_t *frame = shm_triple_back(&tb);
+        uint64_t frame_number = tb.header->published + 1;
+        simulate(frame, frame_number, t);
+        shm_triple_publish(&tb);
+
+        if (frame_number % 100 == 0)
+        {
+            printf("\rPublished %llu frames", (unsigned long long)frame_number);
+            fflush(stdout);
+        }
+
+        t += 1.0 / rate_hz;
+        usleep(1000000 / rate_hz);
+    }
+
+    printf("\nShutting down...\n");
+
+    // Clean up
+    shm_triple_close(&tb, 1);
+
+    printf("Producer process completed\n");
+
+    return 0;
+}
@@ -0,0 +1,26 @@
+#ifndef TRIPLE_BUFFER_SHARED_H
+#define TRIPLE_BUFFER_SHARED_H
+
+#include <stdint.h>
+#include "shm_triple.h"
+
+#define TRIPLE_BUFFER_SHM_NAME "/triple_buffer_shared_memory"
+#define PARTICLE_COUNT (256 * 1024) // 2MB of positions per frame
+
+typedef struct
+{
+    float x;
+    float y;
+} particle_t;
+
+// One full simulation state. The frame number is written first and again
+// last, so a reader can prove it never saw a frame being written.
+typedef struct
+{
+    uint64_t frame_number;
+    double sim_time;
+    particle_t particles[PARTICLE_COUNT];
+    uint64_t trailer;
+} state_frame_t;
+
+#endif // TRIPLE_BUFFER_SHARED_H
@@ -1,7 +1,542 @@
+#ifdef __linux__
+#define _GNU_SOURCE // For mremap
+#endif
 #include "shared_memory.h"
+#include <errno.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+// Sent alongside a segment's fd by shared_memory_send
+typedef struct
+{
+    uint64_t size;
+    uint32_t flags;
+    uint32_t backing;
+} segment_message_t;
+
+// Map fd at an address aligned to `align`, so the kernel can use huge pages for it
+static void *map_aligned(int fd, size_t size, size_t align)
+{
+    // Reserve enough address space to contain an aligned start
+    size_t span = size + align;
+    void *reserve = mmap(NULL, span, PROT_NONE, MAP_PRIVATE | MAP_ANON, -1, 0);
+    if (reserve == MAP_FAILED)
+    {
+        return MAP_FAILED;
+    }
+
+    uintptr_t start = shm_round_up((uintptr_t)reserve, align);
+    void *addr = mmap((void *)start, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        munmap(reserve, span);
+        return MAP_FAILED;
+    }
+
+    // Give back the unused head and tail of the reservation
+    size_t head = start - (uintptr_t)reserve;
+    size_t tail = span - head - size;
+    if (head > 0)
+    {
+        munmap(reserve, head);
+    }
+    if (tail > 0)
+    {
+        munmap((char *)addr + size, tail);
+    }
+
+    return addr;
+}
+
+// Map header_size + data_size bytes of fd, then the data region a second
+// time directly behind it. Both sizes must be page multiples.
+static void *map_mirrored(int fd, size_t header_size, size_t data_size)
+{
+    // Reserve the whole range first so nothing else can land in the gap
+    size_t span = header_size + 2 * data_size;
+    void *reserve = mmap(NULL, span, PROT_NONE, MAP_PRIVATE | MAP_ANON, -1, 0);
+    if (reserve == MAP_FAILED)
+    {
+        return MAP_FAILED;
+    }
+
+    char *base = reserve;
+    if (mmap(base, header_size + data_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+        mmap(base + header_size + data_size, data_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+             fd, header_size) == MAP_FAILED)
+    {
+        munmap(reserve, span);
+        return MAP_FAILED;
+    }
+
+    return base;
+}
+
+// Check that a mirrored layout only uses whole pages
+static int mirrored_sizes_valid(size_t header_size, size_t data_size)
+{
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    if (data_size == 0 || header_size % page != 0 || data_size % page != 0)
+    {
+        fprintf(stderr, "shared_memory: mirrored sizes must be multiples of the %zu byte page size\n", page);
+        return 0;
+    }
+    return 1;
+}
+
+#ifdef __linux__
+// Path of a named segment on the hugetlbfs mount
+static void hugetlbfs_path(char *path, size_t len, const char *name)
+{
+    // Shared memory names start with a '/'
+    snprintf(path, len, "%s/%s", SHM_HUGETLBFS_DIR, name[0] == '/' ? name + 1 : name);
+}
+
+// Check whether the kernel will back shmem mappings with transparent huge pages
+static int thp_shmem_enabled(void)
+{
+    // The active mode is the bracketed one, e.g. "always within_size [advise] never deny force"
+    FILE *f = fopen("/sys/kernel/mm/transparent_hugepage/shmem_enabled", "r");
+    if (f == NULL)
+    {
+        return 0;
+    }
+
+    char line[128] = {0};
+    int enabled = fgets(line, sizeof(line), f) != NULL &&
+                  strstr(line, "[never]") == NULL &&
+                  strstr(line, "[deny]") == NULL;
+    fclose(f);
+
+    return enabled;
+}
+
+// Size and map a hugetlbfs-backed fd; fails quietly (closing fd) so the caller can fall back
+static int hugetlb_map(shared_memory_t *shm, int fd, size_t size)
+{
+    // hugetlbfs files must be a whole number of huge pages
+    size = shm_round_up(size, SHM_HUGE_PAGE_SIZE);
+    if (ftruncate(fd, size) == -1)
+    {
+        close(fd);
+        return -1;
+    }
+
+    // Fails with ENOMEM when not enough huge pages are reserved
+    void *addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        close(fd);
+        return -1;
+    }
+
+    shm->addr = addr;
+    shm->size = size;
+    shm->fd = fd;
+    shm->backing = SHM_BACKING_HUGETLB;
+
+    return 0;
+}
+
+// Try to create the segment on hugetlbfs
+static int hugetlb_create(shared_memory_t *shm, const char *name, size_t size)
+{
+    char path[256];
+    hugetlbfs_path(path, sizeof(path), name);
+    unlink(path);
+
+    // Peers look in /dev/shm first, so a regular object left by an earlier
+    // run under this name would hide the new segment from them
+    shm_unlink(name);
+
+    // No hugetlbfs mount means no explicit huge pages
+    int fd = open(path, O_CREAT | O_RDWR, S_IRUSR | S_IWUSR);
+    if (fd == -1)
+    {
+        return -1;
+    }
+
+    if (hugetlb_map(shm, fd, size) != 0)
+    {
+        unlink(path);
+        return -1;
+    }
+    shm->name = name;
+
+    return 0;
+}
+#endif
+
+// Whether a regular shm object should be mapped for transparent huge pages
+static int want_thp(unsigned flags)
+{
+#ifdef __linux__
+    return (flags & SHM_HUGE_PAGES) && thp_shmem_enabled();
+#else
+    // macOS only supports superpages for private anonymous memory
+    (void)flags;
+    return 0;
+#endif
+}
+
+// Map a regular shm object, asking for transparent huge pages if wanted
+static void *map_segment(int fd, size_t size, int thp, shm_backing_t *backing)
+{
+    *backing = SHM_BACKING_REGULAR;
+
+    if (!thp)
+    {
+        return mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+
+    void *addr = map_aligned(fd, size, SHM_HUGE_PAGE_SIZE);
+#ifdef __linux__
+    if (addr != MAP_FAILED && madvise(addr, size, MADV_HUGEPAGE) == 0)
+    {
+        *backing = SHM_BACKING_THP;
+    }
+#endif
+    return addr;
+}
+
+// Get current time in nanoseconds
+static uint64_t get_time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Populate and/or lock the mapping so the first pass over it doesn't take page faults
+static void warm_up(shared_memory_t *shm)
+{
+    shm->locked = 0;
+    shm->warmup_ns = 0;
+
+    if (!(shm->flags & (SHM_PREFAULT | SHM_LOCK)))
+    {
+        return;
+    }
+
+    uint64_t start_time = get_time_ns();
+
+    if (shm->flags & SHM_PREFAULT)
+    {
+#if defined(__linux__) && defined(MADV_POPULATE_WRITE)
+        // Let the kernel fault in the whole range writable in one call
+        if (madvise(shm->addr, shm->size, MADV_POPULATE_WRITE) != 0)
+#endif
+        {
+            // Write-fault each page with an atomic no-op, which is safe even
+            // while a peer is already using the segment
+            long page_size = sysconf(_SC_PAGESIZE);
+            for (size_t offset = 0; offset < shm->size; offset += page_size)
+            {
+                __atomic_fetch_or((char *)shm->addr + offset, 0, __ATOMIC_RELAXED);
+            }
+        }
+    }
+
+    if (shm->flags & SHM_LOCK)
+    {
+        // Usually fails because of RLIMIT_MEMLOCK; the mapping still works
+        if (mlock(shm->addr, shm->size) == 0)
+        {
+            shm->locked = 1;
+        }
+        else
+        {
+            perror("mlock");
+        }
+    }
+
+    shm->warmup_ns = get_time_ns() - start_time;
+}
+
+// Write the header of a freshly created SHM_GROWABLE segment
+static void init_header(shared_memory_t *shm)
+{
+    shm->generation = 0;
+
+    if (!(shm->flags & SHM_GROWABLE))
+    {
+        return;
+    }
+
+    shared_memory_header_t *header = (shared_memory_header_t *)shm->addr;
+    header->magic = SHM_HEADER_MAGIC;
+    atomic_init(&header->generation, 0);
+    atomic_init(&header->size, shm->size);
+}
+
+// Move this process's mapping to new_size bytes, keeping its contents
+static void *remap_segment(shared_memory_t *shm, size_t new_size)
+{
+#ifdef __linux__
+    void *addr = mremap(shm->addr, shm->size, new_size, MREMAP_MAYMOVE);
+    if (addr != MAP_FAILED && shm->backing == SHM_BACKING_THP)
+    {
+        madvise(addr, new_size, MADV_HUGEPAGE);
+    }
+    return addr;
+#else
+    // No mremap on macOS: map the grown object first so a failure leaves the old mapping intact
+    void *addr = mmap(NULL, new_size, PROT_READ | PROT_WRITE, MAP_SHARED, shm->fd, 0);
+    if (addr != MAP_FAILED)
+    {
+        munmap(shm->addr, shm->size);
+    }
+    return addr;
+#endif
+}
+
+// macOS only lets a POSIX shm object be sized once, so there a growable
+// segment moves to a new object for each generation instead
+#ifdef __APPLE__
+#define SHM_RESIZE_IN_PLACE 0
+#else
+#define SHM_RESIZE_IN_PLACE 1
+#endif
+
+// Name of the object holding a generation other than the first
+static void generation_name(char *buffer, size_t length, const char *name, uint64_t generation)
+{
+    snprintf(buffer, length, "%s.%llu", name, (unsigned long long)generation);
+}
+
+// Switch this process's mapping to the object holding generation; on
+// failure the old mapping is left untouched
+static int open_generation(shared_memory_t *shm, uint64_t generation)
+{
+    if (shm->name == NULL)
+    {
+        fprintf(stderr, "shared_memory: received segments can't follow a resize on this platform\n");
+        return -1;
+    }
+
+    char name[256];
+    generation_name(name, sizeof(name), shm->name, generation);
+
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd == -1)
+    {
+        perror("shm_open");
+        return -1;
+    }
+
+    struct stat sb;
+    if (fstat(fd, &sb) == -1)
+    {
+        perror("fstat");
+        close(fd);
+        return -1;
+    }
+
+    void *addr = mmap(NULL, sb.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        perror("mmap");
+        close(fd);
+        return -1;
+    }
+
+    munmap(shm->addr, shm->size);
+    close(shm->fd);
+    shm->addr = addr;
+    shm->size = sb.st_size;
+    shm->fd = fd;
+    shm->generation = generation;
+    return 0;
+}
+
+// Grow by copying the contents into a new object for the next generation,
+// then point peers at it through the old object's header
+static int move_to_generation(shared_memory_t *shm, size_t new_size)
+{
+    if (shm->name == NULL)
+    {
+        fprintf(stderr, "shared_memory_resize: received segments can't grow on this platform\n");
+        return -1;
+    }
+
+    shared_memory_header_t *old_header = (shared_memory_header_t *)shm->addr;
+    uint64_t generation = atomic_load_explicit(&old_header->generation, memory_order_relaxed) + 1;
+
+    char name[256];
+    generation_name(name, sizeof(name), shm->name, generation);
+
+    // A crashed owner may have left this generation behind
+    shm_unlink(name);
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+    if (fd == -1)
+    {
+        perror("shm_open");
+        return -1;
+    }
+    if (ftruncate(fd, new_size) == -1)
+    {
+        perror("ftruncate");
+        close(fd);
+        shm_unlink(name);
+        return -1;
+    }
+
+    void *addr = mmap(NULL, new_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        perror("mmap");
+        close(fd);
+        shm_unlink(name);
+        return -1;
+    }
+
+    // Carry the contents over and make the new header current before anyone can see it
+    memcpy(addr, shm->addr, shm->size);
+    shared_memory_header_t *header = (shared_memory_header_t *)addr;
+    atomic_store_explicit(&header->size, new_size, memory_order_relaxed);
+    atomic_store_explicit(&header->generation, generation, memory_order_relaxed);
+
+    // Peers still on the old object find the new one through its generation
+    atomic_store_explicit(&old_header->generation, generation, memory_order_release);
+
+    munmap(shm->addr, shm->size);
+    close(shm->fd);
+    shm->addr = addr;
+    shm->size = new_size;
+    shm->fd = fd;
+    shm->generation = generation;
+    warm_up(shm);
+
+    return 0;
+}
+
+// Bring the mapping up to the size and generation published in the header
+static int follow_header(shared_memory_t *shm)
+{
+    shared_memory_header_t *header = (shared_memory_header_t *)shm->addr;
+
+    if (!SHM_RESIZE_IN_PLACE)
+    {
+        // Walk the chain of objects until one's header names itself
+        uint64_t generation = atomic_load_explicit(&header->generation, memory_order_acquire);
+        while (generation != shm->generation)
+        {
+            if (open_generation(shm, generation) != 0)
+            {
+                return -1;
+            }
+            header = (shared_memory_header_t *)shm->addr;
+            generation = atomic_load_explicit(&header->generation, memory_order_acquire);
+        }
+        return 0;
+    }
+
+    // Read the generation before the size so we never record a newer generation than we mapped
+    uint64_t generation = atomic_load_explicit(&header->generation, memory_order_acquire);
+    size_t new_size = atomic_load_explicit(&header->size, memory_order_acquire);
+
+    if (new_size != shm->size)
+    {
+        void *addr = remap_segment(shm, new_size);
+        if (addr == MAP_FAILED)
+        {
+            perror("mremap");
+            return -1;
+        }
+        shm->addr = addr;
+        shm->size = new_size;
+    }
+
+    shm->generation = generation;
+    return 0;
+}
+
+// Map an existing object and fill in shm; closes fd on failure
+static int attach_fd(shared_memory_t *shm, int fd, size_t size, shm_backing_t backing,
+                     unsigned flags, const char *name)
+{
+    // Map the shared memory object into this process's address space
+    void *addr;
+    if (backing == SHM_BACKING_HUGETLB)
+    {
+        addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    else
+    {
+        addr = map_segment(fd, size, want_thp(flags), &backing);
+    }
+    if (addr == MAP_FAILED)
+    {
+        perror("mmap");
+        close(fd);
+        return -1;
+    }
+
+    // Initialize the shared memory struct
+    shm->addr = addr;
+    shm->size = size;
+    shm->fd = fd;
+    shm->name = name;
+    shm->flags = flags;
+    shm->backing = backing;
+    shm->generation = 0;
+    shm->sealed = 0;
+    shm->mirror_size = 0;
+
+    if (flags & SHM_GROWABLE)
+    {
+        shared_memory_header_t *header = (shared_memory_header_t *)addr;
+        if (shm->size < SHM_HEADER_SIZE || header->magic != SHM_HEADER_MAGIC)
+        {
+            fprintf(stderr, "shared_memory_open: %s is not a growable segment\n",
+                    name != NULL ? name : "received segment");
+            munmap(addr, shm->size);
+            close(fd);
+            return -1;
+        }
+
+        // A resize may have landed since the size was read; catch up right away
+        if (follow_header(shm) != 0)
+        {
+            munmap(shm->addr, shm->size);
+            close(shm->fd);
+            return -1;
+        }
+    }
+
+    warm_up(shm);
+
+    return 0;
+}
 
 int shared_memory_create(shared_memory_t *shm, const char *name, size_t size)
 {
+    return shared_memory_create_ex(shm, name, size, 0);
+}
+
+int shared_memory_create_ex(shared_memory_t *shm, const char *name, size_t size, unsigned flags)
+{
+    shm->flags = flags;
+    shm->sealed = 0;
+    shm->mirror_size = 0;
+
+    if ((flags & SHM_GROWABLE) && size < SHM_HEADER_SIZE)
+    {
+        fprintf(stderr, "shared_memory_create: %zu bytes is too small for a growable segment\n", size);
+        return -1;
+    }
+
+#ifdef __linux__
+    // Explicit huge pages first, they are guaranteed 2MB once mapped
+    if ((flags & SHM_HUGE_PAGES) && hugetlb_create(shm, name, size) == 0)
+    {
+        init_header(shm);
+        warm_up(shm);
+        return 0;
+    }
+#endif
+
     // First, try to unlink any existing shared memory with this name
     shm_unlink(name);
 
@@ -13,6 +548,13 @@ int shared_memory_create(shared_memory_t *shm, const char *name, size_t size)
         return -1;
     }
 
+    // Transparent huge pages only cover whole, aligned 2MB extents
+    int thp = want_thp(flags);
+    if (thp)
+    {
+        size = shm_round_up(size, SHM_HUGE_PAGE_SIZE);
+    }
+
     // Set the size of the shared memory object
     if (ftruncate(fd, size) == -1)
     {
@@ -23,7 +565,8 @@ int shared_memory_create(shared_memory_t *shm, const char *name, size_t size)
     }
 
     // Map the shared memory object into this process's address space
-    void *addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    shm_backing_t backing;
+    void *addr = map_segment(fd, size, thp, &backing);
     if (addr == MAP_FAILED)
     {
         perror("mmap");
@@ -37,14 +580,41 @@ int shared_memory_create(shared_memory_t *shm, const char *name, size_t size)
     shm->size = size;
     shm->fd = fd;
     shm->name = name;
+    shm->backing = backing;
+    init_header(shm);
+    warm_up(shm);
 
     return 0;
 }
 
 int shared_memory_open(shared_memory_t *shm, const char *name)
 {
+    return shared_memory_open_ex(shm, name, 0);
+}
+
+int shared_memory_open_ex(shared_memory_t *shm, const char *name, unsigned flags)
+{
+    shm_backing_t backing = SHM_BACKING_REGULAR;
+
     // Open the shared memory object
     int fd = shm_open(name, O_RDWR, 0);
+#ifdef __linux__
+    if (fd == -1 && errno == ENOENT)
+    {
+        // The creator may have put the segment on hugetlbfs
+        char path[256];
+        hugetlbfs_path(path, sizeof(path), name);
+        fd = open(path, O_RDWR);
+        if (fd != -1)
+        {
+            backing = SHM_BACKING_HUGETLB;
+        }
+        else
+        {
+            errno = ENOENT;
+        }
+    }
+#endif
     if (fd == -1)
     {
         perror("shm_open");
@@ -60,8 +630,84 @@ int shared_memory_open(shared_memory_t *shm, const char *name)
         return -1;
     }
 
-    // Map the shared memory object into this process's address space
-    void *addr = mmap(NULL, sb.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    return attach_fd(shm, fd, sb.st_size, backing, flags, name);
+}
+
+int shared_memory_create_mirrored(shared_memory_t *shm, const char *name, size_t header_size, size_t data_size)
+{
+    if (!mirrored_sizes_valid(header_size, data_size))
+    {
+        return -1;
+    }
+
+    // First, try to unlink any existing shared memory with this name
+    shm_unlink(name);
+
+    // Create the shared memory object
+    int fd = shm_open(name, O_CREAT | O_RDWR, S_IRUSR | S_IWUSR);
+    if (fd == -1)
+    {
+        perror("shm_open");
+        return -1;
+    }
+
+    // Set the size of the shared memory object (the mirror takes no extra memory)
+    size_t size = header_size + data_size;
+    if (ftruncate(fd, size) == -1)
+    {
+        perror("ftruncate");
+        close(fd);
+        shm_unlink(name);
+        return -1;
+    }
+
+    void *addr = map_mirrored(fd, header_size, data_size);
+    if (addr == MAP_FAILED)
+    {
+        perror("mmap");
+        close(fd);
+        shm_unlink(name);
+        return -1;
+    }
+
+    // Initialize the shared memory struct
+    memset(shm, 0, sizeof(*shm));
+    shm->addr = addr;
+    shm->size = size;
+    shm->fd = fd;
+    shm->name = name;
+    shm->backing = SHM_BACKING_REGULAR;
+    shm->mirror_size = data_size;
+
+    return 0;
+}
+
+int shared_memory_open_mirrored(shared_memory_t *shm, const char *name, size_t header_size)
+{
+    // Open the shared memory object
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd == -1)
+    {
+        perror("shm_open");
+        return -1;
+    }
+
+    // The data region is whatever follows the header
+    struct stat sb;
+    if (fstat(fd, &sb) == -1)
+    {
+        perror("fstat");
+        close(fd);
+        return -1;
+    }
+    if ((size_t)sb.st_size <= header_size || !mirrored_sizes_valid(header_size, sb.st_size - header_size))
+    {
+        close(fd);
+        return -1;
+    }
+
+    size_t data_size = sb.st_size - header_size;
+    void *addr = map_mirrored(fd, header_size, data_size);
     if (addr == MAP_FAILED)
     {
         perror("mmap");
@@ -70,10 +716,293 @@ int shared_memory_open(shared_memory_t *shm, const char *name)
     }
 
     // Initialize the shared memory struct
+    memset(shm, 0, sizeof(*shm));
     shm->addr = addr;
     shm->size = sb.st_size;
     shm->fd = fd;
     shm->name = name;
+    shm->backing = SHM_BACKING_REGULAR;
+    shm->mirror_size = data_size;
+
+    return 0;
+}
+
+int shared_memory_create_anonymous(shared_memory_t *shm, size_t size, unsigned flags)
+{
+    if ((flags & SHM_GROWABLE) && ((flags & SHM_SEALED) || size < SHM_HEADER_SIZE))
+    {
+        fprintf(stderr, "shared_memory_create_anonymous: growable segments need a header and can't be sealed\n");
+        return -1;
+    }
+
+    shm->addr = NULL;
+    shm->flags = flags;
+    shm->name = NULL;
+    shm->sealed = 0;
+    shm->mirror_size = 0;
+
+    int thp = 0;
+    int fd;
+#ifdef __linux__
+    // Sealing needs MFD_ALLOW_SEALING; hugetlb memfds support seals too
+    if (flags & SHM_HUGE_PAGES)
+    {
+        fd = memfd_create("shm_anonymous", MFD_CLOEXEC | MFD_ALLOW_SEALING | MFD_HUGETLB);
+        if (fd != -1)
+        {
+            hugetlb_map(shm, fd, size); // Leaves shm->addr NULL on failure
+        }
+    }
+
+    if (shm->addr == NULL)
+    {
+        fd = memfd_create("shm_anonymous", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+        if (fd == -1)
+        {
+            perror("memfd_create");
+            return -1;
+        }
+
+        thp = want_thp(flags);
+        if (thp)
+        {
+            size = shm_round_up(size, SHM_HUGE_PAGE_SIZE);
+        }
+        if (ftruncate(fd, size) == -1)
+        {
+            perror("ftruncate");
+            close(fd);
+            return -1;
+        }
+    }
+#else
+    // No memfd on macOS: create a uniquely named object and unlink it straight away
+    static atomic_uint counter;
+    char name[64];
+    snprintf(name, sizeof(name), "/shm_anon_%d_%u", (int)getpid(), atomic_fetch_add(&counter, 1));
+
+    fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+    if (fd == -1)
+    {
+        perror("shm_open");
+        return -1;
+    }
+    shm_unlink(name);
+
+    if (ftruncate(fd, size) == -1)
+    {
+        perror("ftruncate");
+        close(fd);
+        return -1;
+    }
+#endif
+
+#ifdef __linux__
+    // Once sealed, no holder of the fd can shrink the object under a peer (SIGBUS)
+    // or grow it, so receivers can trust the size for the segment's lifetime
+    if ((flags & SHM_SEALED) && fcntl(fd, F_ADD_SEALS, F_SEAL_GROW | F_SEAL_SHRINK | F_SEAL_SEAL) == 0)
+    {
+        shm->sealed = 1;
+    }
+#endif
+
+    // Hugetlb memfds were mapped above
+    if (shm->addr == NULL)
+    {
+        shm_backing_t backing;
+        void *addr = map_segment(fd, size, thp, &backing);
+        if (addr == MAP_FAILED)
+        {
+            perror("mmap");
+            close(fd);
+            return -1;
+        }
+        shm->addr = addr;
+        shm->size = size;
+        shm->fd = fd;
+        shm->backing = backing;
+    }
+
+    init_header(shm);
+    warm_up(shm);
+
+    return 0;
+}
+
+int shared_memory_send(int sock, const shared_memory_t *shm)
+{
+    segment_message_t message = {
+        .size = shm->size,
+        .flags = shm->flags & (SHM_GROWABLE | SHM_SEALED),
+        .backing = shm->backing};
+    struct iovec iov = {.iov_base = &message, .iov_len = sizeof(message)};
+
+    // Control buffer aligned for a cmsghdr, with room for one fd
+    union
+    {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } control;
+    memset(&control, 0, sizeof(control));
+
+    struct msghdr msg = {0};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &shm->fd, sizeof(int));
+
+    if (sendmsg(sock, &msg, 0) != (ssize_t)sizeof(message))
+    {
+        perror("sendmsg");
+        return -1;
+    }
+
+    return 0;
+}
+
+int shared_memory_receive(shared_memory_t *shm, int sock, unsigned flags)
+{
+    segment_message_t message;
+    struct iovec iov = {.iov_base = &message, .iov_len = sizeof(message)};
+
+    union
+    {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } control;
+
+    struct msghdr msg = {0};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+
+    ssize_t received = recvmsg(sock, &msg, 0);
+    if (received != (ssize_t)sizeof(message))
+    {
+        if (received == -1)
+        {
+            perror("recvmsg");
+        }
+        else
+        {
+            fprintf(stderr, "shared_memory_receive: short message\n");
+        }
+        return -1;
+    }
+
+    int fd = -1;
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    if (cmsg != NULL && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+    {
+        memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+    }
+    if (fd == -1)
+    {
+        fprintf(stderr, "shared_memory_receive: no segment fd in message\n");
+        return -1;
+    }
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+    int sealed = 0;
+#ifdef __linux__
+    int seals = fcntl(fd, F_GET_SEALS);
+    sealed = seals != -1 && (seals & (F_SEAL_GROW | F_SEAL_SHRINK)) == (F_SEAL_GROW | F_SEAL_SHRINK);
+#endif
+
+    // An unsealed object may have been resized by anyone holding the fd, so
+    // ask the kernel; a sealed one is exactly the size the sender reported
+    size_t size = message.size;
+    if (!sealed)
+    {
+        struct stat sb;
+        if (fstat(fd, &sb) == -1)
+        {
+            perror("fstat");
+            close(fd);
+            return -1;
+        }
+        size = sb.st_size;
+    }
+
+    if (attach_fd(shm, fd, size, (shm_backing_t)message.backing,
+                  flags | (message.flags & (SHM_GROWABLE | SHM_SEALED)), NULL) != 0)
+    {
+        return -1;
+    }
+    shm->sealed = sealed;
+
+    return 0;
+}
+
+int shared_memory_resize(shared_memory_t *shm, size_t new_size)
+{
+    if (!(shm->flags & SHM_GROWABLE) || new_size < shm->size)
+    {
+        fprintf(stderr, "shared_memory_resize: only growing SHM_GROWABLE segments is supported\n");
+        return -1;
+    }
+
+    // Huge page backed objects grow in whole huge pages
+    if (shm->backing != SHM_BACKING_REGULAR)
+    {
+        new_size = shm_round_up(new_size, SHM_HUGE_PAGE_SIZE);
+    }
+    if (new_size == shm->size)
+    {
+        return 0;
+    }
+
+    if (!SHM_RESIZE_IN_PLACE)
+    {
+        return move_to_generation(shm, new_size);
+    }
+
+    // Grow the object first; peers' existing mappings stay valid
+    if (ftruncate(shm->fd, new_size) == -1)
+    {
+        perror("ftruncate");
+        return -1;
+    }
+
+    void *addr = remap_segment(shm, new_size);
+    if (addr == MAP_FAILED)
+    {
+        perror("mremap");
+        return -1;
+    }
+    shm->addr = addr;
+    shm->size = new_size;
+    warm_up(shm);
+
+    // Publish the new size, then the generation peers poll
+    shared_memory_header_t *header = (shared_memory_header_t *)addr;
+    atomic_store_explicit(&header->size, new_size, memory_order_release);
+    shm->generation = atomic_fetch_add_explicit(&header->generation, 1, memory_order_acq_rel) + 1;
+
+    return 0;
+}
+
+int shared_memory_remap(shared_memory_t *shm)
+{
+    size_t old_size = shm->size;
+
+    if (follow_header(shm) != 0)
+    {
+        return -1;
+    }
+
+    // Newly mapped pages need the same warm-up as the rest
+    if (shm->size != old_size)
+    {
+        warm_up(shm);
+    }
 
     return 0;
 }
@@ -82,8 +1011,13 @@ void shared_memory_destroy(shared_memory_t *shm, int unlink_shm)
 {
     if (shm->addr != NULL && shm->addr != MAP_FAILED)
     {
-        // Unmap the shared memory
-        munmap(shm->addr, shm->size);
+        if (shm->locked)
+        {
+            munlock(shm->addr, shm->size);
+        }
+
+        // Unmap the shared memory, including a mirror of its tail
+        munmap(shm->addr, shm->size + shm->mirror_size);
     }
 
     if (shm->fd != -1)
@@ -95,7 +1029,29 @@ void shared_memory_destroy(shared_memory_t *shm, int unlink_shm)
     if (unlink_shm && shm->name != NULL)
     {
         // Remove the shared memory object
-        shm_unlink(shm->name);
+#ifdef __linux__
+        if (shm->backing == SHM_BACKING_HUGETLB)
+        {
+            char path[256];
+            hugetlbfs_path(path, sizeof(path), shm->name);
+            unlink(path);
+        }
+        else
+#endif
+        {
+            shm_unlink(shm->name);
+        }
+
+        // Objects holding later generations of a segment grown by copying
+        if (!SHM_RESIZE_IN_PLACE && (shm->flags & SHM_GROWABLE))
+        {
+            for (uint64_t generation = 1; generation <= shm->generation; generation++)
+            {
+                char name[256];
+                generation_name(name, sizeof(name), shm->name, generation);
+                shm_unlink(name);
+            }
+        }
     }
 
     // Reset the struct
@@ -103,4 +1059,24 @@ void shared_memory_destroy(shared_memory_t *shm, int unlink_shm)
     shm->size = 0;
     shm->fd = -1;
     shm->name = NULL;
-}
\ No newline at end of file
+    shm->flags = 0;
+    shm->backing = SHM_BACKING_REGULAR;
+    shm->locked = 0;
+    shm->warmup_ns = 0;
+    shm->generation = 0;
+    shm->sealed = 0;
+    shm->mirror_size = 0;
+}
+
+const char *shared_memory_backing_name(shm_backing_t backing)
+{
+    switch (backing)
+    {
+    case SHM_BACKING_HUGETLB:
+        return "hugetlb (2MB pages)";
+    case SHM_BACKING_THP:
+        return "transparent huge pages";
+    default:
+        return "regular pages";
+    }
+}
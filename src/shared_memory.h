@@ -2,18 +2,64 @@
 #define SHARED_MEMORY_H
 
 #include <stdio.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <stdatomic.h>
 #include <string.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
-#include <semaphore.h>
 
 #define SHARED_MEM_SIZE 4096
 #define SHM_NAME "/my_shared_memory"
-#define SEM_READY_NAME "/sem_ready"
-#define SEM_DONE_NAME "/sem_done"
+
+// Huge page size used for SHM_HUGE_PAGES segments
+#define SHM_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+// Size to pad shared indices to so each sits alone on a cache line.
+// Apple Silicon moves memory between cores in 128-byte lines.
+#if defined(__APPLE__) && defined(__aarch64__)
+#define SHM_CACHE_LINE 128
+#else
+#define SHM_CACHE_LINE 64
+#endif
+
+// Round size up to a multiple of align (align must be a power of 2)
+static inline size_t shm_round_up(size_t size, size_t align)
+{
+    return (size + align - 1) & ~(align - 1);
+}
+
+// Mount point searched for explicit huge pages (Linux only)
+#define SHM_HUGETLBFS_DIR "/dev/hugepages"
+
+// Flags for shared_memory_create_ex / shared_memory_open_ex
+#define SHM_HUGE_PAGES (1u << 0) // Back the segment with 2MB pages when available
+#define SHM_PREFAULT (1u << 1)   // Fault every page in before returning
+#define SHM_LOCK (1u << 2)       // mlock the mapping so it is never paged out
+#define SHM_GROWABLE (1u << 3)   // Segment starts with a header and can be resized
+#define SHM_SEALED (1u << 4)     // Seal anonymous segments against resizing (Linux memfd)
+
+// Header at the start of SHM_GROWABLE segments (one cache line)
+#define SHM_HEADER_MAGIC 0x53484d47 // "SHMG"
+#define SHM_HEADER_SIZE 64
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t reserved;
+    atomic_uint_least64_t generation; // Bumped after every resize
+    atomic_uint_least64_t size;       // Current size of the object
+} shared_memory_header_t;
+
+// Page backing a segment actually got
+typedef enum
+{
+    SHM_BACKING_REGULAR = 0, // Base pages (4KB, 16KB on Apple Silicon)
+    SHM_BACKING_HUGETLB,     // Explicit 2MB pages from hugetlbfs
+    SHM_BACKING_THP,         // Transparent huge pages requested with madvise
+} shm_backing_t;
 
 typedef struct
 {
@@ -21,15 +67,94 @@ typedef struct
     size_t size;
     int fd;
     const char *name;
+    unsigned flags;        // SHM_* flags the segment was mapped with
+    shm_backing_t backing; // Page backing that was actually obtained
+    int locked;            // Whether SHM_LOCK managed to mlock the mapping
+    uint64_t warmup_ns;    // Time spent pre-faulting and locking
+    uint64_t generation;   // Generation of a SHM_GROWABLE segment this mapping covers
+    int sealed;            // Size can never change, no need to revalidate it
+    size_t mirror_size;    // Tail of the segment mapped again right after it (0 if none)
 } shared_memory_t;
 
 // Create and map shared memory
 int shared_memory_create(shared_memory_t *shm, const char *name, size_t size);
 
+// Create and map shared memory with SHM_* flags. Huge pages fall back to
+// transparent huge pages and then to regular pages; check shm->backing.
+int shared_memory_create_ex(shared_memory_t *shm, const char *name, size_t size, unsigned flags);
+
 // Open and map existing shared memory
 int shared_memory_open(shared_memory_t *shm, const char *name);
 
+// Open and map existing shared memory with SHM_* flags. SHM_PREFAULT and
+// SHM_LOCK apply to this process's mapping, so each peer passes its own.
+int shared_memory_open_ex(shared_memory_t *shm, const char *name, unsigned flags);
+
+// Create a segment with no name in /dev/shm (a memfd on Linux, an
+// immediately unlinked shm object on macOS). It disappears with the last
+// fd and mapping, so nothing leaks; share it with shared_memory_send.
+int shared_memory_create_anonymous(shared_memory_t *shm, size_t size, unsigned flags);
+
+// Create a segment of header_size + data_size bytes whose data region is
+// mapped twice, back to back, so reads and writes that run off its end
+// continue at its start. Both sizes must be multiples of the page size.
+int shared_memory_create_mirrored(shared_memory_t *shm, const char *name, size_t header_size, size_t data_size);
+
+// Open a segment made with shared_memory_create_mirrored
+int shared_memory_open_mirrored(shared_memory_t *shm, const char *name, size_t header_size);
+
+// Pass a segment's fd to the peer on a connected Unix-domain socket
+int shared_memory_send(int sock, const shared_memory_t *shm);
+
+// Receive and map a segment sent with shared_memory_send
+int shared_memory_receive(shared_memory_t *shm, int sock, unsigned flags);
+
+// Grow a SHM_GROWABLE segment to new_size bytes (only the creator should
+// resize). Peers keep using their old mapping until shared_memory_refresh
+// sees the new generation. Pointers into the segment must be re-derived.
+// macOS only lets a POSIX shm object be sized once, so there each resize
+// copies the contents into a new object named "<name>.<generation>"; peers
+// must refresh before writing again, as writes to the old object are lost.
+// Only named segments can grow there, and destroy unlinks every generation.
+int shared_memory_resize(shared_memory_t *shm, size_t new_size);
+
+// Remap a SHM_GROWABLE segment after another process resized it
+int shared_memory_remap(shared_memory_t *shm);
+
+// Cheap check to call before touching a SHM_GROWABLE segment. Returns 1 if
+// the mapping moved (re-derive pointers), 0 if unchanged, -1 on error.
+static inline int shared_memory_refresh(shared_memory_t *shm)
+{
+    if (!(shm->flags & SHM_GROWABLE))
+    {
+        return 0;
+    }
+
+    shared_memory_header_t *header = (shared_memory_header_t *)shm->addr;
+    if (atomic_load_explicit(&header->generation, memory_order_acquire) == shm->generation)
+    {
+        return 0;
+    }
+
+    return shared_memory_remap(shm) == 0 ? 1 : -1;
+}
+
+// Start of the usable area (after the header of SHM_GROWABLE segments)
+static inline void *shared_memory_data(const shared_memory_t *shm)
+{
+    return (char *)shm->addr + ((shm->flags & SHM_GROWABLE) ? SHM_HEADER_SIZE : 0);
+}
+
+// Size of the usable area
+static inline size_t shared_memory_data_size(const shared_memory_t *shm)
+{
+    return shm->size - ((shm->flags & SHM_GROWABLE) ? SHM_HEADER_SIZE : 0);
+}
+
 // Unmap and close/unlink shared memory
 void shared_memory_destroy(shared_memory_t *shm, int unlink_shm);
 
-#endif
\ No newline at end of file
+// Human-readable name of a page backing
+const char *shared_memory_backing_name(shm_backing_t backing);
+
+#endif
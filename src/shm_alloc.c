@@ -0,0 +1,193 @@
+#include "shm_alloc.h"
+#include <stdio.h>
+
+// Free list heads pack a tag in the high half and an offset in the low half
+#define HEAD_OFFSET(head) (((head) & 0xffffffffULL) * SHM_MIN_BLOCK)
+#define HEAD_TAG(head) ((head) >> 32)
+#define MAKE_HEAD(offset, tag) (((uint64_t)(tag) << 32) | ((offset) / SHM_MIN_BLOCK))
+
+// Index of the smallest size class that fits `size`
+static int size_class(size_t size)
+{
+    int cls = 0;
+    while (cls < SHM_NUM_CLASSES && ((size_t)SHM_MIN_BLOCK << cls) < size)
+    {
+        cls++;
+    }
+    return cls;
+}
+
+// Free blocks keep the offset of the next free block in their first 8 bytes
+static uint64_t *next_link(shm_arena_t *arena, shm_offset_t offset)
+{
+    return (uint64_t *)shm_ptr(arena, offset);
+}
+
+// Push the chain first..last (already linked together) onto a free list
+static void push_chain(shm_arena_t *arena, shm_free_list_t *list, shm_offset_t first, shm_offset_t last)
+{
+    uint64_t head = atomic_load_explicit(&list->head, memory_order_relaxed);
+    uint64_t new_head;
+    do
+    {
+        __atomic_store_n(next_link(arena, last), HEAD_OFFSET(head), __ATOMIC_RELAXED);
+        new_head = MAKE_HEAD(first, HEAD_TAG(head) + 1);
+    } while (!atomic_compare_exchange_weak_explicit(&list->head, &head, new_head,
+                                                    memory_order_release, memory_order_relaxed));
+}
+
+// Pop one block from a free list, 0 if it is empty
+static shm_offset_t pop(shm_arena_t *arena, shm_free_list_t *list)
+{
+    uint64_t head = atomic_load_explicit(&list->head, memory_order_acquire);
+    while (HEAD_OFFSET(head) != 0)
+    {
+        // The block may be popped and reused under us; the tag makes the CAS
+        // fail in that case, so a stale link is never installed
+        uint64_t next = __atomic_load_n(next_link(arena, HEAD_OFFSET(head)), __ATOMIC_RELAXED);
+        uint64_t new_head = MAKE_HEAD(next, HEAD_TAG(head) + 1);
+        if (atomic_compare_exchange_weak_explicit(&list->head, &head, new_head,
+                                                  memory_order_acquire, memory_order_acquire))
+        {
+            return HEAD_OFFSET(head);
+        }
+    }
+    return 0;
+}
+
+// Carve fresh slabs into blocks of class `cls`; returns one block and frees the rest
+static shm_offset_t refill(shm_arena_t *arena, int cls)
+{
+    size_t block_size = (size_t)SHM_MIN_BLOCK << cls;
+    uint32_t slabs = block_size > SHM_SLAB_SIZE ? block_size / SHM_SLAB_SIZE : 1;
+
+    // Claim slabs from the bump pointer
+    uint32_t first = atomic_load_explicit(&arena->next_slab, memory_order_relaxed);
+    do
+    {
+        if (first + slabs > arena->slab_count)
+        {
+            return 0; // Arena exhausted
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&arena->next_slab, &first, first + slabs,
+                                                    memory_order_relaxed, memory_order_relaxed));
+
+    // Record the class before any block is published, shm_free looks it up
+    for (uint32_t i = 0; i < slabs; i++)
+    {
+        arena->slab_class[first + i] = (uint8_t)cls;
+    }
+
+    shm_offset_t start = arena->slabs_offset + (shm_offset_t)first * SHM_SLAB_SIZE;
+    size_t count = (size_t)slabs * SHM_SLAB_SIZE / block_size;
+
+    // Keep the first block, link the others into a chain and free it in one CAS
+    if (count > 1)
+    {
+        for (size_t i = 1; i < count - 1; i++)
+        {
+            *next_link(arena, start + i * block_size) = start + (i + 1) * block_size;
+        }
+        push_chain(arena, &arena->classes[cls], start + block_size, start + (count - 1) * block_size);
+    }
+
+    return start;
+}
+
+shm_arena_t *shm_arena_init(void *base, size_t size)
+{
+    shm_arena_t *arena = (shm_arena_t *)base;
+
+    // Offsets are stored in 32 bits of SHM_MIN_BLOCK units
+    if (size > (size_t)UINT32_MAX * SHM_MIN_BLOCK)
+    {
+        size = (size_t)UINT32_MAX * SHM_MIN_BLOCK;
+    }
+
+    // Metadata is the header plus one class byte per slab, page aligned
+    size_t slab_count = size / SHM_SLAB_SIZE;
+    size_t slabs_offset = shm_round_up(sizeof(shm_arena_t) + slab_count, 4096);
+    while (slab_count > 0 && slabs_offset + slab_count * SHM_SLAB_SIZE > size)
+    {
+        slab_count--;
+    }
+    if (slab_count == 0)
+    {
+        fprintf(stderr, "shm_arena_init: %zu bytes is too small for an arena\n", size);
+        return NULL;
+    }
+
+    arena->slab_count = (uint32_t)slab_count;
+    arena->slabs_offset = slabs_offset;
+    arena->size = size;
+    atomic_init(&arena->root, 0);
+    atomic_init(&arena->next_slab, 0);
+    for (int cls = 0; cls < SHM_NUM_CLASSES; cls++)
+    {
+        atomic_init(&arena->classes[cls].head, 0);
+    }
+    memset(arena->slab_class, 0, slab_count);
+
+    // Publish the magic last so attachers never see a half-formatted arena
+    atomic_thread_fence(memory_order_release);
+    arena->magic = SHM_ARENA_MAGIC;
+
+    return arena;
+}
+
+shm_arena_t *shm_arena_attach(void *base)
+{
+    shm_arena_t *arena = (shm_arena_t *)base;
+    if (arena->magic != SHM_ARENA_MAGIC)
+    {
+        fprintf(stderr, "shm_arena_attach: no arena at %p\n", base);
+        return NULL;
+    }
+    atomic_thread_fence(memory_order_acquire);
+    return arena;
+}
+
+shm_arena_t *shm_arena_create(shared_memory_t *shm)
+{
+    return shm_arena_init(shared_memory_data(shm), shared_memory_data_size(shm));
+}
+
+shm_arena_t *shm_arena_open(shared_memory_t *shm)
+{
+    return shm_arena_attach(shared_memory_data(shm));
+}
+
+shm_offset_t shm_alloc(shm_arena_t *arena, size_t size)
+{
+    int cls = size_class(size);
+    if (cls >= SHM_NUM_CLASSES)
+    {
+        return 0;
+    }
+
+    // Reuse a freed block before carving a new slab
+    shm_offset_t offset = pop(arena, &arena->classes[cls]);
+    if (offset != 0)
+    {
+        return offset;
+    }
+
+    return refill(arena, cls);
+}
+
+void shm_free(shm_arena_t *arena, shm_offset_t offset)
+{
+    if (offset < arena->slabs_offset || offset >= arena->size)
+    {
+        return;
+    }
+
+    int cls = arena->slab_class[(offset - arena->slabs_offset) / SHM_SLAB_SIZE];
+    push_chain(arena, &arena->classes[cls], offset, offset);
+}
+
+size_t shm_block_size(shm_arena_t *arena, shm_offset_t offset)
+{
+    int cls = arena->slab_class[(offset - arena->slabs_offset) / SHM_SLAB_SIZE];
+    return (size_t)SHM_MIN_BLOCK << cls;
+}
@@ -0,0 +1,87 @@
+#ifndef SHM_ALLOC_H
+#define SHM_ALLOC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include "shared_memory.h"
+
+// Slab allocator that lives entirely inside a shared memory segment.
+// Blocks are handed out as offsets from the arena so they are valid in
+// every process's mapping, wherever the segment ended up.
+
+#define SHM_ARENA_MAGIC 0x53484d41 // "SHMA"
+#define SHM_SLAB_SIZE (64 * 1024)  // Unit the arena is carved into
+#define SHM_MIN_BLOCK 16           // Smallest size class, also the alignment
+#define SHM_NUM_CLASSES 21         // 16 bytes .. 16MB, powers of 2
+#define SHM_MAX_BLOCK (SHM_MIN_BLOCK << (SHM_NUM_CLASSES - 1))
+
+// Offset of a block from the start of the arena; 0 means no block
+typedef uint64_t shm_offset_t;
+
+// Per-class free list. The head packs a block offset (in SHM_MIN_BLOCK
+// units) with an ABA tag that changes on every successful pop/push.
+typedef struct
+{
+    atomic_uint_least64_t head;
+    uint8_t padding[56]; // One class per cache line
+} shm_free_list_t;
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t slab_count;             // Slabs available after the metadata
+    uint64_t slabs_offset;           // Offset of the first slab
+    uint64_t size;                   // Bytes covered by the arena
+    atomic_uint_least64_t root;      // Offset of the application's top-level object
+    atomic_uint_least32_t next_slab; // Bump pointer over the slabs
+    uint8_t padding[28];
+    shm_free_list_t classes[SHM_NUM_CLASSES];
+    uint8_t slab_class[]; // Size class of each slab, for shm_free
+} shm_arena_t;
+
+// Format `size` bytes at `base` as an empty arena
+shm_arena_t *shm_arena_init(void *base, size_t size);
+
+// Use an arena another process already formatted at `base`
+shm_arena_t *shm_arena_attach(void *base);
+
+// Format the usable area of a segment as an arena
+shm_arena_t *shm_arena_create(shared_memory_t *shm);
+
+// Attach to the arena in a segment created with shm_arena_create
+shm_arena_t *shm_arena_open(shared_memory_t *shm);
+
+// Allocate `size` bytes (rounded up to a power of 2). Returns 0 when the
+// arena is out of slabs or size exceeds SHM_MAX_BLOCK.
+shm_offset_t shm_alloc(shm_arena_t *arena, size_t size);
+
+// Return a block to its size class
+void shm_free(shm_arena_t *arena, shm_offset_t offset);
+
+// Usable size of an allocated block
+size_t shm_block_size(shm_arena_t *arena, shm_offset_t offset);
+
+// Publish/look up the application's top-level object so peers can find it
+static inline void shm_arena_set_root(shm_arena_t *arena, shm_offset_t offset)
+{
+    atomic_store_explicit(&arena->root, offset, memory_order_release);
+}
+
+static inline shm_offset_t shm_arena_root(shm_arena_t *arena)
+{
+    return atomic_load_explicit(&arena->root, memory_order_acquire);
+}
+
+// Translate between offsets and pointers in this process's mapping
+static inline void *shm_ptr(shm_arena_t *arena, shm_offset_t offset)
+{
+    return offset == 0 ? NULL : (char *)arena + offset;
+}
+
+static inline shm_offset_t shm_offset(shm_arena_t *arena, const void *ptr)
+{
+    return ptr == NULL ? 0 : (shm_offset_t)((const char *)ptr - (const char *)arena);
+}
+
+#endif // SHM_ALLOC_H
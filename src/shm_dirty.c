@@ -0,0 +1,284 @@
+#include "shm_dirty.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+static uint64_t monotonic_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Add one flush to the counters
+static void record_flush(shm_dirty_t *tracker, uint64_t ranges, uint64_t bytes, uint64_t elapsed)
+{
+    pthread_mutex_lock(&tracker->lock);
+    tracker->stats.flushes++;
+    tracker->stats.ranges += ranges;
+    tracker->stats.bytes += bytes;
+    tracker->stats.total_ns += elapsed;
+    if (elapsed > tracker->stats.max_ns)
+    {
+        tracker->stats.max_ns = elapsed;
+    }
+    pthread_mutex_unlock(&tracker->lock);
+}
+
+int shm_dirty_init(shm_dirty_t *tracker, void *base, size_t size)
+{
+    memset(tracker, 0, sizeof(*tracker));
+    tracker->base = base;
+    tracker->size = size;
+    tracker->page_size = (size_t)sysconf(_SC_PAGESIZE);
+
+    size_t pages = (size + tracker->page_size - 1) / tracker->page_size;
+    tracker->words = (pages + 63) / 64;
+    tracker->bitmap = calloc(tracker->words, sizeof(uint64_t));
+    tracker->flush_bitmap = calloc(tracker->words, sizeof(uint64_t));
+    if (tracker->bitmap == NULL || tracker->flush_bitmap == NULL)
+    {
+        fprintf(stderr, "shm_dirty_init: out of memory\n");
+        free(tracker->bitmap);
+        free(tracker->flush_bitmap);
+        return -1;
+    }
+
+    pthread_mutex_init(&tracker->lock, NULL);
+    pthread_mutex_init(&tracker->flush_lock, NULL);
+    pthread_cond_init(&tracker->wake, NULL);
+    return 0;
+}
+
+int shm_dirty_resize(shm_dirty_t *tracker, size_t size)
+{
+    // No flush may walk the bitmaps while they move
+    pthread_mutex_lock(&tracker->flush_lock);
+    pthread_mutex_lock(&tracker->lock);
+
+    size_t pages = (size + tracker->page_size - 1) / tracker->page_size;
+    size_t words = (pages + 63) / 64;
+    int result = 0;
+    if (words > tracker->words)
+    {
+        uint64_t *bitmap = realloc(tracker->bitmap, words * sizeof(uint64_t));
+        if (bitmap != NULL)
+        {
+            tracker->bitmap = bitmap;
+        }
+        uint64_t *flush_bitmap = bitmap != NULL ? realloc(tracker->flush_bitmap, words * sizeof(uint64_t)) : NULL;
+        if (flush_bitmap != NULL)
+        {
+            tracker->flush_bitmap = flush_bitmap;
+        }
+
+        if (bitmap == NULL || flush_bitmap == NULL)
+        {
+            fprintf(stderr, "shm_dirty_resize: out of memory\n");
+            result = -1;
+        }
+        else
+        {
+            memset(bitmap + tracker->words, 0, (words - tracker->words) * sizeof(uint64_t));
+            memset(flush_bitmap + tracker->words, 0, (words - tracker->words) * sizeof(uint64_t));
+            tracker->words = words;
+        }
+    }
+    if (result == 0)
+    {
+        tracker->size = size;
+    }
+
+    pthread_mutex_unlock(&tracker->lock);
+    pthread_mutex_unlock(&tracker->flush_lock);
+    return result;
+}
+
+void shm_dirty_destroy(shm_dirty_t *tracker)
+{
+    shm_dirty_stop_flusher(tracker);
+    pthread_cond_destroy(&tracker->wake);
+    pthread_mutex_destroy(&tracker->flush_lock);
+    pthread_mutex_destroy(&tracker->lock);
+    free(tracker->bitmap);
+    free(tracker->flush_bitmap);
+    tracker->bitmap = NULL;
+    tracker->flush_bitmap = NULL;
+}
+
+void shm_dirty_mark(shm_dirty_t *tracker, const void *addr, size_t length)
+{
+    if (length == 0)
+    {
+        return;
+    }
+
+    size_t first = (size_t)((const char *)addr - tracker->base) / tracker->page_size;
+    size_t last = (size_t)((const char *)addr + length - 1 - tracker->base) / tracker->page_size;
+
+    pthread_mutex_lock(&tracker->lock);
+    for (size_t page = first; page <= last; page++)
+    {
+        tracker->bitmap[page / 64] |= 1ULL << (page % 64);
+    }
+    pthread_mutex_unlock(&tracker->lock);
+}
+
+int shm_dirty_flush(shm_dirty_t *tracker, int flags)
+{
+    pthread_mutex_lock(&tracker->flush_lock);
+
+    // Take the marks, so writers can keep marking while we sync
+    pthread_mutex_lock(&tracker->lock);
+    uint64_t *pages = tracker->bitmap;
+    tracker->bitmap = tracker->flush_bitmap;
+    tracker->flush_bitmap = pages;
+    pthread_mutex_unlock(&tracker->lock);
+
+    int result = 0;
+    uint64_t ranges = 0, bytes = 0;
+    uint64_t start = monotonic_ns();
+
+    // Walk the bitmap, turning nearby dirty pages into one msync each
+    size_t total_pages = tracker->words * 64;
+    size_t page = 0;
+    while (page < total_pages)
+    {
+        if (pages[page / 64] == 0)
+        {
+            page = (page / 64 + 1) * 64;
+            continue;
+        }
+        if (!(pages[page / 64] & (1ULL << (page % 64))))
+        {
+            page++;
+            continue;
+        }
+
+        // Extend the range over dirty pages and short clean gaps between them
+        size_t run = page + 1;
+        for (size_t next = run; next < total_pages && next - run <= SHM_DIRTY_MERGE_GAP; next++)
+        {
+            if (pages[next / 64] & (1ULL << (next % 64)))
+            {
+                run = next + 1;
+            }
+        }
+
+        size_t offset = page * tracker->page_size;
+        size_t length = (run - page) * tracker->page_size;
+        if (offset + length > tracker->size)
+        {
+            length = tracker->size - offset;
+        }
+        if (msync(tracker->base + offset, length, flags) == -1)
+        {
+            perror("shm_dirty_flush: msync");
+            result = -1;
+        }
+        ranges++;
+        bytes += length;
+        page = run;
+    }
+    memset(pages, 0, tracker->words * sizeof(uint64_t));
+
+    if (ranges > 0)
+    {
+        record_flush(tracker, ranges, bytes, monotonic_ns() - start);
+    }
+
+    pthread_mutex_unlock(&tracker->flush_lock);
+    return result;
+}
+
+int shm_dirty_sync_all(shm_dirty_t *tracker)
+{
+    pthread_mutex_lock(&tracker->flush_lock);
+
+    pthread_mutex_lock(&tracker->lock);
+    memset(tracker->bitmap, 0, tracker->words * sizeof(uint64_t));
+    pthread_mutex_unlock(&tracker->lock);
+
+    uint64_t start = monotonic_ns();
+    int result = msync(tracker->base, tracker->size, MS_SYNC);
+    if (result == -1)
+    {
+        perror("shm_dirty_sync_all: msync");
+    }
+    record_flush(tracker, 1, tracker->size, monotonic_ns() - start);
+
+    pthread_mutex_unlock(&tracker->flush_lock);
+    return result;
+}
+
+static void *flusher_thread(void *arg)
+{
+    shm_dirty_t *tracker = arg;
+
+    pthread_mutex_lock(&tracker->lock);
+    while (!tracker->stop)
+    {
+        // Sleep for the interval (wall clock, as pthread_cond_timedwait wants)
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        uint64_t deadline = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec + (uint64_t)tracker->interval_ms * 1000000;
+        ts.tv_sec = (time_t)(deadline / 1000000000ULL);
+        ts.tv_nsec = (long)(deadline % 1000000000ULL);
+        while (!tracker->stop && pthread_cond_timedwait(&tracker->wake, &tracker->lock, &ts) != ETIMEDOUT)
+        {
+        }
+
+        pthread_mutex_unlock(&tracker->lock);
+        shm_dirty_flush(tracker, MS_SYNC);
+        pthread_mutex_lock(&tracker->lock);
+    }
+    pthread_mutex_unlock(&tracker->lock);
+
+    return NULL;
+}
+
+int shm_dirty_start_flusher(shm_dirty_t *tracker, unsigned interval_ms)
+{
+    if (tracker->running)
+    {
+        return 0;
+    }
+
+    tracker->interval_ms = interval_ms;
+    tracker->stop = 0;
+    if (pthread_create(&tracker->thread, NULL, flusher_thread, tracker) != 0)
+    {
+        perror("shm_dirty_start_flusher: pthread_create");
+        return -1;
+    }
+    tracker->running = 1;
+    return 0;
+}
+
+void shm_dirty_stop_flusher(shm_dirty_t *tracker)
+{
+    if (!tracker->running)
+    {
+        return;
+    }
+
+    // The flusher does one last flush on its way out
+    pthread_mutex_lock(&tracker->lock);
+    tracker->stop = 1;
+    pthread_cond_signal(&tracker->wake);
+    pthread_mutex_unlock(&tracker->lock);
+    pthread_join(tracker->thread, NULL);
+    tracker->running = 0;
+}
+
+shm_dirty_stats_t shm_dirty_stats(shm_dirty_t *tracker)
+{
+    pthread_mutex_lock(&tracker->lock);
+    shm_dirty_stats_t stats = tracker->stats;
+    pthread_mutex_unlock(&tracker->lock);
+    return stats;
+}
@@ -0,0 +1,83 @@
+#ifndef SHM_DIRTY_H
+#define SHM_DIRTY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+// Dirty-page tracking for a file mapping. Writers mark the bytes they
+// change; a flush msyncs only the marked pages, merged into contiguous
+// ranges, instead of the whole mapping. Flushes can run on demand or from
+// a background thread every few milliseconds.
+//
+// Tracking is per process: it covers the writes this process marked. The
+// page cache is shared, so a whole-file sync is still the way to make
+// every process's writes durable at once.
+
+// Dirty runs at most this many clean pages apart are flushed with one
+// msync. Every MS_SYNC call pays a fixed filesystem commit, while clean
+// pages inside a range cost next to nothing.
+#define SHM_DIRTY_MERGE_GAP 64
+
+// Flush counters; read with shm_dirty_stats
+typedef struct
+{
+    uint64_t flushes;  // Flushes that found something to write
+    uint64_t ranges;   // msync calls they made
+    uint64_t bytes;    // Bytes they covered
+    uint64_t total_ns; // Time spent in msync
+    uint64_t max_ns;   // Slowest single flush
+} shm_dirty_stats_t;
+
+typedef struct
+{
+    char *base;
+    size_t size;
+    size_t page_size;
+    size_t words;           // 64-page words in each bitmap
+    uint64_t *bitmap;       // Pages marked since the last flush
+    uint64_t *flush_bitmap; // Pages the current flush is writing
+    pthread_mutex_t lock;       // Guards bitmap and stats
+    pthread_mutex_t flush_lock; // One flush at a time
+
+    // Background flusher
+    pthread_t thread;
+    pthread_cond_t wake;
+    unsigned interval_ms;
+    int running;
+    int stop;
+
+    shm_dirty_stats_t stats;
+} shm_dirty_t;
+
+// Track the mapping at base (page-aligned) of size bytes
+int shm_dirty_init(shm_dirty_t *tracker, void *base, size_t size);
+
+// Track size bytes from the same base, after the mapping behind it grew.
+// Marks made so far are kept. Returns 0, or -1 if out of memory.
+int shm_dirty_resize(shm_dirty_t *tracker, size_t size);
+
+// Stop the background flusher, if any, and free the tracker
+void shm_dirty_destroy(shm_dirty_t *tracker);
+
+// Note that length bytes at addr were changed
+void shm_dirty_mark(shm_dirty_t *tracker, const void *addr, size_t length);
+
+// msync every marked page with flags (MS_SYNC or MS_ASYNC), one call per
+// range of nearby dirty pages, and clear the marks. Returns 0, or -1 if an
+// msync failed.
+int shm_dirty_flush(shm_dirty_t *tracker, int flags);
+
+// msync the whole mapping with MS_SYNC and clear the marks
+int shm_dirty_sync_all(shm_dirty_t *tracker);
+
+// Flush with MS_SYNC every interval_ms on a background thread
+int shm_dirty_start_flusher(shm_dirty_t *tracker, unsigned interval_ms);
+
+// Stop the background flusher after a last flush
+void shm_dirty_stop_flusher(shm_dirty_t *tracker);
+
+// Copy of the counters
+shm_dirty_stats_t shm_dirty_stats(shm_dirty_t *tracker);
+
+#endif // SHM_DIRTY_H
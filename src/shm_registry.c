@@ -0,0 +1,274 @@
+#include "shm_registry.h"
+#include "shm_wait.h"
+#include <errno.h>
+
+// FNV-1a hash of a channel name
+static uint32_t hash_name(const char *name)
+{
+    uint32_t hash = 2166136261u;
+    for (const char *p = name; *p != '\0'; p++)
+    {
+        hash ^= (uint8_t)*p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Wait for an adder or remover to finish with a descriptor and return its
+// final state. They only copy a name in or free storage, so a descriptor
+// still CLAIMED after SHM_CHANNEL_SETTLE_MS belongs to a process that died
+// holding it. Its name can't be trusted, so callers fail with EBUSY.
+static uint32_t settled_state(shm_channel_desc_t *desc)
+{
+    uint32_t state = atomic_load_explicit(&desc->state, memory_order_acquire);
+    for (int waited_ms = 0; state == SHM_CHANNEL_CLAIMED && waited_ms < SHM_CHANNEL_SETTLE_MS; waited_ms += 10)
+    {
+        shm_futex_wait(&desc->state, SHM_CHANNEL_CLAIMED, 10);
+        state = atomic_load_explicit(&desc->state, memory_order_acquire);
+    }
+    return state;
+}
+
+// Move a descriptor out of CLAIMED and wake anyone settling on it
+static void release_slot(shm_channel_desc_t *desc, uint32_t state)
+{
+    atomic_store_explicit(&desc->state, state, memory_order_release);
+    shm_futex_wake(&desc->state, 1);
+}
+
+int shm_registry_create(shm_registry_t *reg, const char *name, size_t size, uint32_t max_channels)
+{
+    // Power-of-2 directory so probing can mask instead of divide
+    uint32_t slots = 1;
+    while (slots < max_channels)
+    {
+        slots <<= 1;
+    }
+
+    if (shared_memory_create(&reg->shm, name, size) != 0)
+    {
+        return -1;
+    }
+
+    shm_directory_t *directory = (shm_directory_t *)reg->shm.addr;
+    size_t arena_offset = shm_round_up(sizeof(shm_directory_t) + slots * sizeof(shm_channel_desc_t), 4096);
+    if (arena_offset >= size)
+    {
+        fprintf(stderr, "shm_registry_create: %zu bytes cannot hold %u channels\n", size, slots);
+        shared_memory_destroy(&reg->shm, 1);
+        return -1;
+    }
+
+    // Fresh shm objects are zero-filled, so every descriptor starts FREE
+    directory->max_channels = slots;
+    directory->arena_offset = arena_offset;
+    atomic_init(&directory->channel_count, 0);
+
+    reg->arena = shm_arena_init((char *)directory + arena_offset, size - arena_offset);
+    if (reg->arena == NULL)
+    {
+        shared_memory_destroy(&reg->shm, 1);
+        return -1;
+    }
+
+    // Publish the magic last so openers never see a half-built directory
+    atomic_thread_fence(memory_order_release);
+    directory->magic = SHM_REGISTRY_MAGIC;
+    reg->directory = directory;
+
+    return 0;
+}
+
+int shm_registry_open(shm_registry_t *reg, const char *name)
+{
+    if (shared_memory_open(&reg->shm, name) != 0)
+    {
+        return -1;
+    }
+
+    shm_directory_t *directory = (shm_directory_t *)reg->shm.addr;
+    if (directory->magic != SHM_REGISTRY_MAGIC)
+    {
+        fprintf(stderr, "shm_registry_open: %s is not a registry\n", name);
+        shared_memory_destroy(&reg->shm, 0);
+        return -1;
+    }
+    atomic_thread_fence(memory_order_acquire);
+
+    reg->arena = shm_arena_attach((char *)directory + directory->arena_offset);
+    if (reg->arena == NULL)
+    {
+        shared_memory_destroy(&reg->shm, 0);
+        return -1;
+    }
+    reg->directory = directory;
+
+    return 0;
+}
+
+void shm_registry_close(shm_registry_t *reg, int unlink_shm)
+{
+    shared_memory_destroy(&reg->shm, unlink_shm);
+    reg->directory = NULL;
+    reg->arena = NULL;
+}
+
+const shm_channel_desc_t *shm_registry_add(shm_registry_t *reg, const char *channel,
+                                           uint32_t type, size_t capacity)
+{
+    shm_directory_t *directory = reg->directory;
+    if (strlen(channel) >= SHM_CHANNEL_NAME_LENGTH)
+    {
+        errno = ENAMETOOLONG;
+        return NULL;
+    }
+
+    // Allocate before claiming a slot: a claimed slot can never go back to
+    // FREE, or lookups would stop probing short of channels placed after it
+    shm_offset_t offset = shm_alloc(reg->arena, capacity);
+    if (offset == 0)
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+    memset(shm_ptr(reg->arena, offset), 0, capacity);
+
+    uint32_t mask = directory->max_channels - 1;
+    uint32_t slot = hash_name(channel) & mask;
+
+    // Linear probing: stop at the first free slot, or at an existing channel with our name
+    for (uint32_t probe = 0; probe <= mask; probe++, slot = (slot + 1) & mask)
+    {
+        shm_channel_desc_t *desc = &directory->channels[slot];
+        uint32_t state = SHM_CHANNEL_FREE;
+
+        int claimed;
+        while (!(claimed = atomic_compare_exchange_strong_explicit(&desc->state, &state, SHM_CHANNEL_CLAIMED,
+                                                                   memory_order_acquire, memory_order_acquire)))
+        {
+            state = settled_state(desc);
+            if (state == SHM_CHANNEL_CLAIMED)
+            {
+                // Might be our name; adding past it could duplicate the channel
+                shm_free(reg->arena, offset);
+                errno = EBUSY;
+                return NULL;
+            }
+            if (strcmp(desc->name, channel) != 0)
+            {
+                break;
+            }
+            if (state == SHM_CHANNEL_READY)
+            {
+                shm_free(reg->arena, offset);
+                errno = EEXIST;
+                return NULL;
+            }
+            // Our channel was removed from this slot; try to take it back
+        }
+        if (!claimed)
+        {
+            continue;
+        }
+
+        // The slot is ours; fill it in, then publish it
+        strcpy(desc->name, channel);
+        desc->type = type;
+        desc->offset = offset;
+        desc->capacity = capacity;
+        atomic_fetch_add_explicit(&desc->generation, 1, memory_order_relaxed);
+
+        release_slot(desc, SHM_CHANNEL_READY);
+        atomic_fetch_add_explicit(&directory->channel_count, 1, memory_order_relaxed);
+        return desc;
+    }
+
+    shm_free(reg->arena, offset);
+    errno = ENOSPC;
+    return NULL;
+}
+
+int shm_registry_remove(shm_registry_t *reg, const char *channel)
+{
+    shm_directory_t *directory = reg->directory;
+    uint32_t mask = directory->max_channels - 1;
+    uint32_t slot = hash_name(channel) & mask;
+
+    // A name only ever lives in the first slot that carries it
+    for (uint32_t probe = 0; probe <= mask; probe++, slot = (slot + 1) & mask)
+    {
+        shm_channel_desc_t *desc = &directory->channels[slot];
+        uint32_t state = settled_state(desc);
+        if (state == SHM_CHANNEL_FREE)
+        {
+            break;
+        }
+        if (state == SHM_CHANNEL_CLAIMED)
+        {
+            errno = EBUSY;
+            return -1;
+        }
+        if (strcmp(desc->name, channel) != 0)
+        {
+            continue;
+        }
+
+        // Hold the slot while the storage goes back, so a re-add waits for us
+        if (state != SHM_CHANNEL_READY ||
+            !atomic_compare_exchange_strong_explicit(&desc->state, &state, SHM_CHANNEL_CLAIMED,
+                                                     memory_order_acquire, memory_order_relaxed))
+        {
+            break;
+        }
+        atomic_fetch_add_explicit(&desc->generation, 1, memory_order_relaxed);
+        shm_free(reg->arena, desc->offset);
+
+        // The slot is never FREE again, or lookups would stop probing short of channels after it
+        release_slot(desc, SHM_CHANNEL_REMOVED);
+        atomic_fetch_sub_explicit(&directory->channel_count, 1, memory_order_relaxed);
+        return 0;
+    }
+
+    errno = ENOENT;
+    return -1;
+}
+
+const shm_channel_desc_t *shm_registry_lookup(shm_registry_t *reg, const char *channel,
+                                              uint64_t *generation)
+{
+    shm_directory_t *directory = reg->directory;
+    uint32_t mask = directory->max_channels - 1;
+    uint32_t slot = hash_name(channel) & mask;
+
+    // Slots never go back to FREE, so a free slot ends the probe sequence
+    for (uint32_t probe = 0; probe <= mask; probe++, slot = (slot + 1) & mask)
+    {
+        shm_channel_desc_t *desc = &directory->channels[slot];
+        uint32_t state = settled_state(desc);
+        if (state == SHM_CHANNEL_FREE)
+        {
+            break;
+        }
+        if (state == SHM_CHANNEL_CLAIMED)
+        {
+            errno = EBUSY;
+            return NULL;
+        }
+        if (strcmp(desc->name, channel) != 0)
+        {
+            continue;
+        }
+        if (state != SHM_CHANNEL_READY)
+        {
+            break;
+        }
+        if (generation != NULL)
+        {
+            *generation = atomic_load_explicit(&desc->generation, memory_order_relaxed);
+        }
+        return desc;
+    }
+
+    errno = ENOENT;
+    return NULL;
+}
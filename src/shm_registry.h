@@ -0,0 +1,98 @@
+#ifndef SHM_REGISTRY_H
+#define SHM_REGISTRY_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "shared_memory.h"
+#include "shm_alloc.h"
+
+// A registry keeps many named channels in one well-known segment: a
+// directory of channel descriptors followed by an arena holding each
+// channel's storage. Attaching to N channels costs one shm_open/mmap and
+// N directory lookups instead of N of each.
+
+#define SHM_REGISTRY_NAME "/shm_registry"
+#define SHM_REGISTRY_MAGIC 0x53484d52 // "SHMR"
+#define SHM_CHANNEL_NAME_LENGTH 32
+
+// Descriptor states, moved forward with CAS so adders never collide
+#define SHM_CHANNEL_FREE 0
+#define SHM_CHANNEL_CLAIMED 1 // Being filled in by an adder
+#define SHM_CHANNEL_READY 2
+#define SHM_CHANNEL_REMOVED 3 // Storage freed; the slot keeps the name for a re-add
+
+// How long to sleep on a descriptor still being filled in before its
+// adder is taken for dead and the call fails with EBUSY
+#define SHM_CHANNEL_SETTLE_MS 1000
+
+// One directory entry (one cache line)
+typedef struct
+{
+    atomic_uint_least32_t state;
+    uint32_t type;                     // Application-defined channel type
+    uint64_t offset;                   // Storage offset within the registry arena
+    uint64_t capacity;                 // Bytes of storage
+    atomic_uint_least64_t generation;  // Bumped whenever the channel is added or removed
+    char name[SHM_CHANNEL_NAME_LENGTH];
+} shm_channel_desc_t;
+
+// Layout at the start of the registry segment
+typedef struct
+{
+    uint32_t magic;
+    uint32_t max_channels;                // Directory slots, a power of 2
+    uint64_t arena_offset;                // Arena start, from the directory
+    atomic_uint_least32_t channel_count;  // Channels in READY state
+    uint8_t padding[44];
+    shm_channel_desc_t channels[];
+} shm_directory_t;
+
+// Per-process handle on a registry
+typedef struct
+{
+    shared_memory_t shm;
+    shm_directory_t *directory;
+    shm_arena_t *arena;
+} shm_registry_t;
+
+// Create the registry segment with room for max_channels (rounded up to a power of 2)
+int shm_registry_create(shm_registry_t *reg, const char *name, size_t size, uint32_t max_channels);
+
+// Attach to an existing registry with a single mapping
+int shm_registry_open(shm_registry_t *reg, const char *name);
+
+// Detach, unlinking the segment if unlink_shm is set
+void shm_registry_close(shm_registry_t *reg, int unlink_shm);
+
+// Add a channel with `capacity` bytes of zeroed storage. Returns its
+// descriptor, or NULL with errno EEXIST if the name exists, ENOSPC if the
+// registry is full, or EBUSY if a slot on the way was left half-added. A
+// removed channel comes back in its old slot under a new generation.
+const shm_channel_desc_t *shm_registry_add(shm_registry_t *reg, const char *channel,
+                                           uint32_t type, size_t capacity);
+
+// Remove a channel and free its storage; -1 with errno ENOENT if it isn't
+// registered, or EBUSY as for shm_registry_add
+int shm_registry_remove(shm_registry_t *reg, const char *channel);
+
+// Find a channel by name: NULL with errno ENOENT if it isn't registered,
+// or EBUSY as for shm_registry_add. Stores the descriptor's generation in *generation
+// unless it is NULL, for later shm_registry_current checks.
+const shm_channel_desc_t *shm_registry_lookup(shm_registry_t *reg, const char *channel,
+                                              uint64_t *generation);
+
+// 1 while desc still holds the channel a lookup returned with generation,
+// 0 once it has been removed or re-added
+static inline int shm_registry_current(const shm_channel_desc_t *desc, uint64_t generation)
+{
+    return atomic_load_explicit(&desc->state, memory_order_acquire) == SHM_CHANNEL_READY &&
+           atomic_load_explicit(&desc->generation, memory_order_relaxed) == generation;
+}
+
+// Storage of a channel in this process's mapping
+static inline void *shm_registry_channel(shm_registry_t *reg, const shm_channel_desc_t *desc)
+{
+    return shm_ptr(reg->arena, desc->offset);
+}
+
+#endif // SHM_REGISTRY_H
@@ -0,0 +1,91 @@
+#include "shm_sem.h"
+#include "shm_wait.h"
+#include <time.h>
+#include <unistd.h>
+
+// Milliseconds on the monotonic clock
+static int64_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// Spinning only helps if the poster can run at the same time as us
+static int spin_limit(void)
+{
+    static int limit = -1;
+    if (limit < 0)
+    {
+        limit = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? SHM_SEM_SPIN_LIMIT : 0;
+    }
+    return limit;
+}
+
+int shm_sem_trywait(shm_sem_t *sem)
+{
+    uint32_t count = atomic_load_explicit(&sem->count, memory_order_relaxed);
+    while (count > 0)
+    {
+        // Taking a count acquires whatever was written before its post
+        if (atomic_compare_exchange_weak_explicit(&sem->count, &count, count - 1,
+                                                  memory_order_seq_cst, memory_order_relaxed))
+        {
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int shm_sem_wait(shm_sem_t *sem, int timeout_ms)
+{
+    // Fast path: a count is already there, or turns up while we spin
+    if (shm_sem_trywait(sem) == 0)
+    {
+        return 0;
+    }
+    for (int i = spin_limit(); i > 0; i--)
+    {
+        shm_cpu_relax();
+        if (shm_sem_trywait(sem) == 0)
+        {
+            return 0;
+        }
+    }
+
+    int64_t deadline = timeout_ms < 0 ? 0 : now_ms() + timeout_ms;
+
+    // Register before the last check, so a post either sees us or we see its count
+    atomic_fetch_add_explicit(&sem->waiters, 1, memory_order_seq_cst);
+    int result = 0;
+    while (shm_sem_trywait(sem) != 0)
+    {
+        int remaining = -1;
+        if (timeout_ms >= 0)
+        {
+            remaining = (int)(deadline - now_ms());
+            if (remaining <= 0)
+            {
+                result = -1;
+                break;
+            }
+        }
+
+        // Sleeps only while the count is still 0
+        shm_futex_wait(&sem->count, 0, remaining);
+    }
+    atomic_fetch_sub_explicit(&sem->waiters, 1, memory_order_relaxed);
+
+    return result;
+}
+
+void shm_sem_post(shm_sem_t *sem)
+{
+    atomic_fetch_add_explicit(&sem->count, 1, memory_order_seq_cst);
+
+    // Only enter the kernel if someone may be asleep
+    if (atomic_load_explicit(&sem->waiters, memory_order_seq_cst) != 0)
+    {
+        shm_futex_wake(&sem->count, 0);
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef SHM_SEM_H
+#define SHM_SEM_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+// Counting semaphore that lives inside a shared memory segment, in place of
+// a sem_open'd named semaphore. Posting and taking an available count are
+// one atomic each in userspace; the kernel is only entered to sleep on an
+// empty semaphore, or to wake a process that did.
+
+// Polls an empty wait makes before it goes to sleep, on machines with more
+// than one CPU. In a request/response handshake the answer often arrives
+// while we are still spinning.
+#define SHM_SEM_SPIN_LIMIT 1000
+
+// 8 bytes, zero-initialized is a semaphore with a count of 0
+typedef struct
+{
+    atomic_uint_least32_t count;   // Available posts; the futex word
+    atomic_uint_least32_t waiters; // Processes asleep or about to be
+} shm_sem_t;
+
+static inline void shm_sem_init(shm_sem_t *sem, uint32_t count)
+{
+    atomic_init(&sem->count, count);
+    atomic_init(&sem->waiters, 0);
+}
+
+// Take one count if there is one. Returns 0 on success, -1 if the count is 0.
+int shm_sem_trywait(shm_sem_t *sem);
+
+// Take one count, sleeping until there is one or timeout_ms has passed
+// (negative waits forever). Returns 0 on success, -1 on timeout.
+int shm_sem_wait(shm_sem_t *sem, int timeout_ms);
+
+// Add one count, waking one sleeper if there is any
+void shm_sem_post(shm_sem_t *sem);
+
+#endif // SHM_SEM_H
@@ -0,0 +1,66 @@
+#include "shm_seqlock.h"
+#include "shm_wait.h"
+#include <string.h>
+
+void shm_seqlock_init(shm_seqlock_t *lock, size_t capacity)
+{
+    atomic_init(&lock->sequence, 0);
+    atomic_init(&lock->length, 0);
+    lock->capacity = capacity;
+    lock->reserved = 0;
+}
+
+int shm_seqlock_write(shm_seqlock_t *lock, const void *value, size_t length)
+{
+    if (length > lock->capacity)
+    {
+        return -1;
+    }
+
+    uint64_t seq = atomic_load_explicit(&lock->sequence, memory_order_relaxed);
+
+    // Go odd before touching the payload, so overlapping readers retry
+    atomic_store_explicit(&lock->sequence, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    memcpy(lock->data, value, length);
+    atomic_store_explicit(&lock->length, length, memory_order_relaxed);
+
+    // The release store orders the payload before the sequence turns even
+    atomic_store_explicit(&lock->sequence, seq + 2, memory_order_release);
+    return 0;
+}
+
+size_t shm_seqlock_read(shm_seqlock_t *lock, void *buffer, size_t max, uint64_t *version)
+{
+    for (;;)
+    {
+        uint64_t before = atomic_load_explicit(&lock->sequence, memory_order_acquire);
+        if (before & 1)
+        {
+            // A write is in progress; it is a single memcpy, so wait it out
+            shm_cpu_relax();
+            continue;
+        }
+
+        // Only copy what the value actually holds, never the whole capacity
+        size_t length = atomic_load_explicit(&lock->length, memory_order_relaxed);
+        size_t n = length < max ? length : max;
+        if (n > lock->capacity)
+        {
+            n = lock->capacity;
+        }
+        memcpy(buffer, lock->data, n);
+
+        // If the sequence didn't move while we copied, the copy is intact
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&lock->sequence, memory_order_relaxed) == before)
+        {
+            if (version != NULL)
+            {
+                *version = before / 2;
+            }
+            return length;
+        }
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef SHM_SEQLOCK_H
+#define SHM_SEQLOCK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+// A "latest value" cell: one writer keeps replacing a length-prefixed
+// payload, any number of readers copy out whatever is current. The writer
+// never waits for readers; a reader that overlaps a write notices through
+// the sequence number and copies again, so it never returns a torn value.
+
+typedef struct
+{
+    atomic_uint_least64_t sequence; // Odd while a write is in progress, +2 per value
+    atomic_uint_least64_t length;   // Bytes of the current value
+    uint64_t capacity;              // Largest value that fits, fixed at init
+    uint64_t reserved;
+    uint8_t data[]; // Payload, capacity bytes
+} shm_seqlock_t;
+
+// Bytes of shared memory needed for values of up to capacity bytes
+static inline size_t shm_seqlock_size(size_t capacity)
+{
+    return sizeof(shm_seqlock_t) + capacity;
+}
+
+// Set up an empty cell (length 0, version 0) in shared memory
+void shm_seqlock_init(shm_seqlock_t *lock, size_t capacity);
+
+// Writer: replace the value. Only one process may write to a cell.
+// Returns -1 if length exceeds the capacity, 0 otherwise.
+int shm_seqlock_write(shm_seqlock_t *lock, const void *value, size_t length);
+
+// Reader: copy the current value into buffer, at most max bytes of it, and
+// its version into *version (may be NULL). Returns the value's full length.
+size_t shm_seqlock_read(shm_seqlock_t *lock, void *buffer, size_t max, uint64_t *version);
+
+// Number of values written so far; cheap to poll for a change before reading
+static inline uint64_t shm_seqlock_version(shm_seqlock_t *lock)
+{
+    return atomic_load_explicit(&lock->sequence, memory_order_acquire) / 2;
+}
+
+#endif // SHM_SEQLOCK_H
@@ -0,0 +1,99 @@
+#include "shm_triple.h"
+
+int shm_triple_create(shm_triple_t *tb, const char *name, size_t frame_size, unsigned flags)
+{
+    if (frame_size == 0)
+    {
+        fprintf(stderr, "shm_triple_create: frame size must be positive\n");
+        return -1;
+    }
+
+    // Page-aligned frames, so each starts on its own pages
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t frames_offset = shm_round_up(sizeof(shm_triple_header_t), page);
+    size_t frame_stride = shm_round_up(frame_size, page);
+
+    if (shared_memory_create_ex(&tb->shm, name, frames_offset + 3 * frame_stride, flags) != 0)
+    {
+        return -1;
+    }
+
+    // Writer starts on buffer 0, the reader on buffer 2, nothing published in 1
+    shm_triple_header_t *header = (shm_triple_header_t *)tb->shm.addr;
+    header->frame_size = frame_size;
+    header->frame_stride = frame_stride;
+    header->frames_offset = frames_offset;
+    atomic_init(&header->middle, 1);
+    header->back = 0;
+    header->published = 0;
+    header->front = 2;
+    for (int i = 0; i < 3; i++)
+    {
+        header->sequence[i] = 0;
+    }
+
+    // Publish the magic last so openers never see a half-built header
+    atomic_thread_fence(memory_order_release);
+    header->magic = SHM_TRIPLE_MAGIC;
+    tb->header = header;
+
+    return 0;
+}
+
+int shm_triple_open(shm_triple_t *tb, const char *name, unsigned flags)
+{
+    if (shared_memory_open_ex(&tb->shm, name, flags) != 0)
+    {
+        return -1;
+    }
+
+    shm_triple_header_t *header = (shm_triple_header_t *)tb->shm.addr;
+    if (header->magic != SHM_TRIPLE_MAGIC)
+    {
+        fprintf(stderr, "shm_triple_open: %s is not a triple buffer\n", name);
+        shared_memory_destroy(&tb->shm, 0);
+        return -1;
+    }
+    atomic_thread_fence(memory_order_acquire);
+    tb->header = header;
+
+    return 0;
+}
+
+void shm_triple_close(shm_triple_t *tb, int unlink_shm)
+{
+    shared_memory_destroy(&tb->shm, unlink_shm);
+    tb->header = NULL;
+}
+
+uint64_t shm_triple_publish(shm_triple_t *tb)
+{
+    shm_triple_header_t *header = tb->header;
+    uint64_t sequence = ++header->published;
+    header->sequence[header->back] = sequence;
+
+    // Release hands the finished frame over; acquire makes sure the reader
+    // is done with the buffer we get back
+    uint32_t old = atomic_exchange_explicit(&header->middle, header->back | SHM_TRIPLE_FRESH, memory_order_acq_rel);
+    header->back = old & SHM_TRIPLE_INDEX;
+
+    return sequence;
+}
+
+const void *shm_triple_acquire(shm_triple_t *tb, uint64_t *sequence)
+{
+    shm_triple_header_t *header = tb->header;
+
+    // Only the reader clears FRESH, so once seen it stays set until we swap
+    if (shm_triple_fresh(tb))
+    {
+        uint32_t old = atomic_exchange_explicit(&header->middle, header->front, memory_order_acq_rel);
+        header->front = old & SHM_TRIPLE_INDEX;
+    }
+
+    if (sequence != NULL)
+    {
+        *sequence = header->sequence[header->front];
+    }
+    return shm_triple_frame(tb, header->front);
+}
@@ -0,0 +1,87 @@
+#ifndef SHM_TRIPLE_H
+#define SHM_TRIPLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "shared_memory.h"
+
+// Triple-buffered snapshot channel for one writer and one reader of large
+// frames. Of three frame buffers the writer owns one (back), the reader
+// owns one (front) and the third (middle) holds the newest complete frame.
+// Publishing and picking up a frame are a single atomic exchange of the
+// middle index, so neither side ever waits, retries or copies a frame.
+
+#define SHM_TRIPLE_MAGIC 0x53484d54 // "SHMT"
+#define SHM_TRIPLE_FRESH 0x4u       // Set in middle while it holds a frame the reader hasn't taken
+#define SHM_TRIPLE_INDEX 0x3u       // Buffer index bits of middle
+
+// Layout at the start of the segment; frames follow at frames_offset
+typedef struct
+{
+    uint32_t magic;
+    uint32_t reserved;
+    uint64_t frame_size;    // Bytes in a frame
+    uint64_t frame_stride;  // Distance between frames
+    uint64_t frames_offset; // First frame, from the start of the segment
+
+    // The only word both sides write
+    _Alignas(SHM_CACHE_LINE) atomic_uint_least32_t middle;
+
+    // Writer's line
+    _Alignas(SHM_CACHE_LINE) uint32_t back;
+    uint64_t published; // Frames published so far
+
+    // Reader's line
+    _Alignas(SHM_CACHE_LINE) uint32_t front;
+
+    // Frame number held by each buffer, written with the frame
+    _Alignas(SHM_CACHE_LINE) uint64_t sequence[3];
+} shm_triple_header_t;
+
+// Per-process handle on a triple buffer
+typedef struct
+{
+    shared_memory_t shm;
+    shm_triple_header_t *header;
+} shm_triple_t;
+
+// Create the channel with three frames of frame_size bytes. flags are
+// passed to shared_memory_create_ex (SHM_HUGE_PAGES, SHM_PREFAULT, ...).
+int shm_triple_create(shm_triple_t *tb, const char *name, size_t frame_size, unsigned flags);
+
+// Attach to an existing channel; flags are passed to shared_memory_open_ex
+int shm_triple_open(shm_triple_t *tb, const char *name, unsigned flags);
+
+// Detach, unlinking the segment if unlink_shm is set
+void shm_triple_close(shm_triple_t *tb, int unlink_shm);
+
+static inline void *shm_triple_frame(shm_triple_t *tb, uint32_t index)
+{
+    shm_triple_header_t *header = tb->header;
+    return (char *)header + header->frames_offset + index * header->frame_stride;
+}
+
+// Writer: the frame to fill in place. It holds an older frame, not
+// necessarily the last one written, so write the whole frame.
+static inline void *shm_triple_back(shm_triple_t *tb)
+{
+    return shm_triple_frame(tb, tb->header->back);
+}
+
+// Writer: make the back frame the newest one and get a free back frame.
+// Returns the published frame's number (1 for the first).
+uint64_t shm_triple_publish(shm_triple_t *tb);
+
+// Reader: is there a frame newer than the one at the front?
+static inline bool shm_triple_fresh(shm_triple_t *tb)
+{
+    return atomic_load_explicit(&tb->header->middle, memory_order_relaxed) & SHM_TRIPLE_FRESH;
+}
+
+// Reader: swap in the newest complete frame if there is one, and return
+// the front frame to read in place until the next call. Its number goes to
+// *sequence (0 until the writer publishes the first frame).
+const void *shm_triple_acquire(shm_triple_t *tb, uint64_t *sequence);
+
+#endif // SHM_TRIPLE_H
@@ -0,0 +1,170 @@
+#include "shm_wait.h"
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#elif defined(__APPLE__)
+// Private but stable libSystem entry points behind os_sync_wait_on_address
+#define UL_COMPARE_AND_WAIT_SHARED 3 // Word may be mapped in other processes
+#define ULF_WAKE_ALL 0x00000100
+extern int __ulock_wait(uint32_t operation, void *addr, uint64_t value, uint32_t timeout_us);
+extern int __ulock_wake(uint32_t operation, void *addr, uint64_t wake_value);
+#endif
+
+void shm_futex_wait(atomic_uint_least32_t *word, uint32_t expected, int timeout_ms)
+{
+    // A zero timeout never sleeps; __ulock_wait would take it as no limit
+    if (timeout_ms == 0)
+    {
+        return;
+    }
+
+#ifdef __linux__
+    struct timespec ts = {timeout_ms / 1000, (long)(timeout_ms % 1000) * 1000000};
+
+    // Not FUTEX_PRIVATE_FLAG: the word is shared between processes
+    if (syscall(SYS_futex, word, FUTEX_WAIT, expected, timeout_ms < 0 ? NULL : &ts, NULL, 0) == -1 &&
+        errno != EAGAIN && errno != ETIMEDOUT && errno != EINTR)
+    {
+        perror("futex wait");
+    }
+#elif defined(__APPLE__)
+    uint32_t timeout_us = timeout_ms < 0 ? 0 : (uint32_t)timeout_ms * 1000; // 0 waits forever
+    if (__ulock_wait(UL_COMPARE_AND_WAIT_SHARED, (void *)word, expected, timeout_us) == -1 &&
+        errno != ETIMEDOUT && errno != EINTR && errno != EFAULT)
+    {
+        perror("ulock wait");
+    }
+#else
+    // No futex: poll the word with short sleeps
+    for (int slept_us = 0; timeout_ms < 0 || slept_us < timeout_ms * 1000; slept_us += 100)
+    {
+        if (atomic_load_explicit(word, memory_order_acquire) != expected)
+        {
+            break;
+        }
+        usleep(100);
+    }
+#endif
+}
+
+void shm_futex_wake(atomic_uint_least32_t *word, int wake_all)
+{
+#ifdef __linux__
+    if (syscall(SYS_futex, word, FUTEX_WAKE, wake_all ? __INT_MAX__ : 1, NULL, NULL, 0) == -1)
+    {
+        perror("futex wake");
+    }
+#elif defined(__APPLE__)
+    // ENOENT just means nobody was asleep yet
+    uint32_t operation = UL_COMPARE_AND_WAIT_SHARED | (wake_all ? ULF_WAKE_ALL : 0);
+    if (__ulock_wake(operation, (void *)word, 0) == -1 && errno != ENOENT)
+    {
+        perror("ulock wake");
+    }
+#else
+    (void)word;
+    (void)wake_all;
+#endif
+}
+
+void shm_waiter_init(shm_waiter_t *waiter, shm_waitpoint_t *point, shm_wait_strategy_t strategy)
+{
+    waiter->point = point;
+    waiter->strategy = strategy;
+    waiter->spins = 0;
+    waiter->key = 0;
+    waiter->armed = 0;
+}
+
+void shm_wait(shm_waiter_t *waiter, int timeout_ms)
+{
+    switch (waiter->strategy)
+    {
+    case SHM_WAIT_SPIN:
+        return;
+
+    case SHM_WAIT_PAUSE:
+        shm_cpu_relax();
+        return;
+
+    case SHM_WAIT_HYBRID:
+        if (waiter->spins < SHM_WAIT_SPIN_LIMIT)
+        {
+            waiter->spins++;
+            shm_cpu_relax();
+            return;
+        }
+        break;
+
+    case SHM_WAIT_FUTEX:
+        break;
+    }
+
+    if (!waiter->armed)
+    {
+        // Register first and return, so the caller re-checks the condition
+        // after notifiers can see us. Anything published before the notifier
+        // read our count is visible to that re-check.
+        atomic_fetch_add_explicit(&waiter->point->waiters, 1, memory_order_seq_cst);
+        atomic_thread_fence(memory_order_seq_cst);
+        waiter->key = atomic_load_explicit(&waiter->point->sequence, memory_order_acquire);
+        waiter->armed = 1;
+        return;
+    }
+
+    // Sleeps only if no notify has bumped the sequence since we last looked
+    shm_futex_wait(&waiter->point->sequence, waiter->key, timeout_ms);
+    waiter->key = atomic_load_explicit(&waiter->point->sequence, memory_order_acquire);
+}
+
+void shm_wait_done(shm_waiter_t *waiter)
+{
+    if (waiter->armed)
+    {
+        atomic_fetch_sub_explicit(&waiter->point->waiters, 1, memory_order_relaxed);
+        waiter->armed = 0;
+    }
+    waiter->spins = 0;
+}
+
+void shm_wake(shm_waitpoint_t *point)
+{
+    // The bump makes a waiter that is just about to sleep return at once
+    atomic_fetch_add_explicit(&point->sequence, 1, memory_order_release);
+    shm_futex_wake(&point->sequence, 1);
+}
+
+const char *shm_wait_strategy_name(shm_wait_strategy_t strategy)
+{
+    switch (strategy)
+    {
+    case SHM_WAIT_SPIN:
+        return "spin";
+    case SHM_WAIT_PAUSE:
+        return "pause";
+    case SHM_WAIT_HYBRID:
+        return "hybrid";
+    case SHM_WAIT_FUTEX:
+        return "futex";
+    }
+    return "unknown";
+}
+
+int shm_wait_parse_strategy(const char *name, shm_wait_strategy_t *strategy)
+{
+    for (int s = SHM_WAIT_SPIN; s <= SHM_WAIT_FUTEX; s++)
+    {
+        if (strcmp(name, shm_wait_strategy_name((shm_wait_strategy_t)s)) == 0)
+        {
+            *strategy = (shm_wait_strategy_t)s;
+            return 0;
+        }
+    }
+    return -1;
+}
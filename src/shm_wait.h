@@ -0,0 +1,104 @@
+#ifndef SHM_WAIT_H
+#define SHM_WAIT_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+// Wait strategies for a process that finds its channel empty (or full).
+// The waiter polls its own condition; a waitpoint in shared memory gives it
+// somewhere to sleep, and the other side pokes the waitpoint after every
+// change. The poke is a fence and a load unless someone is actually asleep.
+
+typedef enum
+{
+    SHM_WAIT_SPIN = 0, // Re-check in a tight loop, lowest latency, burns a core
+    SHM_WAIT_PAUSE,    // Re-check with a CPU relax hint between polls
+    SHM_WAIT_HYBRID,   // Relax-spin for SHM_WAIT_SPIN_LIMIT polls, then sleep on the futex
+    SHM_WAIT_FUTEX,    // Sleep on the futex straight away
+} shm_wait_strategy_t;
+
+// Polls a hybrid waiter spins before it goes to sleep
+#define SHM_WAIT_SPIN_LIMIT 2000
+
+// Word pair in shared memory that waiters sleep on (8 bytes, zero-initialized is valid)
+typedef struct
+{
+    atomic_uint_least32_t sequence; // Bumped by every notify that found a waiter; the futex word
+    atomic_uint_least32_t waiters;  // Waiters that are asleep or about to be
+} shm_waitpoint_t;
+
+// One process's wait on a waitpoint, kept on its stack across polls
+typedef struct
+{
+    shm_waitpoint_t *point;
+    shm_wait_strategy_t strategy;
+    uint32_t spins; // Polls since the condition last held
+    uint32_t key;   // Sequence seen when we registered as a waiter
+    int armed;      // Counted in point->waiters
+} shm_waiter_t;
+
+// Hint to the core that we're in a spin loop
+static inline void shm_cpu_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __asm__ volatile("pause");
+#elif defined(__aarch64__)
+    // isb stalls for a few dozen cycles on Apple cores, where yield is a no-op
+    __asm__ volatile("isb" ::: "memory");
+#endif
+}
+
+static inline void shm_waitpoint_init(shm_waitpoint_t *point)
+{
+    atomic_init(&point->sequence, 0);
+    atomic_init(&point->waiters, 0);
+}
+
+// Start waiting on point with the given strategy
+void shm_waiter_init(shm_waiter_t *waiter, shm_waitpoint_t *point, shm_wait_strategy_t strategy);
+
+// Call each time the condition is found false, then check it again:
+//
+//     while (!condition)
+//         shm_wait(&waiter, timeout_ms);
+//     shm_wait_done(&waiter);
+//
+// Spins or sleeps according to the strategy. A sleep ends on a notify, a
+// spurious wake, or after timeout_ms (negative waits forever), so callers
+// can also check for shutdown between polls.
+void shm_wait(shm_waiter_t *waiter, int timeout_ms);
+
+// Call once the condition holds (or the caller gives up waiting)
+void shm_wait_done(shm_waiter_t *waiter);
+
+// Wake everyone sleeping on point. Out of line; use shm_notify.
+void shm_wake(shm_waitpoint_t *point);
+
+// Call after every change a waiter could be waiting for. Costs a fence and
+// a load; the wake syscall only happens if a waiter has registered.
+static inline void shm_notify(shm_waitpoint_t *point)
+{
+    // Pairs with the fence in shm_wait: either we see the waiter, or the
+    // waiter's re-check sees our change
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&point->waiters, memory_order_relaxed) != 0)
+    {
+        shm_wake(point);
+    }
+}
+
+// Sleep while *word == expected, for at most timeout_ms (negative means no
+// limit, 0 returns at once). The word may be mapped in several processes. Returns on a wake,
+// a timeout, a signal or a spurious wake-up, so callers re-check.
+void shm_futex_wait(atomic_uint_least32_t *word, uint32_t expected, int timeout_ms);
+
+// Wake one process sleeping on word, or all of them if wake_all is set
+void shm_futex_wake(atomic_uint_least32_t *word, int wake_all);
+
+// Name of a strategy, for output
+const char *shm_wait_strategy_name(shm_wait_strategy_t strategy);
+
+// Parse "spin", "pause", "hybrid" or "futex". Returns 0 on success, -1 if unknown.
+int shm_wait_parse_strategy(const char *name, shm_wait_strategy_t *strategy);
+
+#endif // SHM_WAIT_H
@@ -0,0 +1,328 @@
+#include "shm_wal.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Frames larger than this are treated as corruption on replay
+#define SHM_WAL_MAX_RECORD (SHM_WAL_BUFFER_SIZE - sizeof(shm_wal_frame_t))
+
+// FNV-1a over a payload
+static uint32_t checksum(const void *data, size_t length)
+{
+    const uint8_t *bytes = data;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Wall-clock time, the clock pthread_cond_timedwait measures deadlines on
+static uint64_t wall_time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint64_t monotonic_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Make written data durable. fsync on macOS only reaches the drive's cache.
+static int sync_file(int fd)
+{
+#if defined(__APPLE__)
+    if (fcntl(fd, F_FULLFSYNC) == 0)
+    {
+        return 0;
+    }
+    return fsync(fd);
+#else
+    return fdatasync(fd);
+#endif
+}
+
+static int write_all(int fd, const char *data, size_t size)
+{
+    while (size > 0)
+    {
+        ssize_t n = write(fd, data, size);
+        if (n == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        data += n;
+        size -= n;
+    }
+    return 0;
+}
+
+// One commit thread per log: take everything appended so far, write it in
+// one go and fsync it, then release the writers it covered
+static void *commit_thread(void *arg)
+{
+    shm_wal_t *wal = arg;
+
+    pthread_mutex_lock(&wal->lock);
+    for (;;)
+    {
+        while (wal->used == 0 && !wal->stop)
+        {
+            pthread_cond_wait(&wal->pending, &wal->lock);
+        }
+        if (wal->used == 0)
+        {
+            break;
+        }
+
+        // Give other writers until the latency bound to join this commit,
+        // unless the buffer is already half full
+        uint64_t deadline = wal->first_pending_ns + (uint64_t)wal->max_delay_us * 1000;
+        while (!wal->stop && wal->used < SHM_WAL_BUFFER_SIZE / 2 && wall_time_ns() < deadline)
+        {
+            struct timespec ts = {(time_t)(deadline / 1000000000ULL), (long)(deadline % 1000000000ULL)};
+            pthread_cond_timedwait(&wal->pending, &wal->lock, &ts);
+        }
+
+        // Swap buffers so writers keep appending while we sync
+        char *batch = wal->buffer;
+        size_t size = wal->used;
+        uint64_t batch_lsn = wal->appended_lsn;
+        wal->buffer = wal->flush_buffer;
+        wal->flush_buffer = batch;
+        wal->used = 0;
+        pthread_cond_broadcast(&wal->durable); // Writers waiting for space
+        pthread_mutex_unlock(&wal->lock);
+
+        uint64_t start = monotonic_ns();
+        int result = write_all(wal->fd, batch, size);
+        if (result == 0)
+        {
+            result = sync_file(wal->fd);
+        }
+        if (result != 0)
+        {
+            perror("shm_wal commit");
+        }
+        uint64_t elapsed = monotonic_ns() - start;
+
+        pthread_mutex_lock(&wal->lock);
+        if (result != 0)
+        {
+            wal->failed = 1;
+        }
+        else
+        {
+            wal->durable_lsn = batch_lsn;
+        }
+        wal->stats.commits++;
+        wal->stats.bytes += size;
+        wal->stats.sync_ns += elapsed;
+        pthread_cond_broadcast(&wal->durable);
+    }
+    pthread_mutex_unlock(&wal->lock);
+
+    return NULL;
+}
+
+int shm_wal_open(shm_wal_t *wal, const char *path, unsigned max_delay_us)
+{
+    memset(wal, 0, sizeof(*wal));
+    wal->max_delay_us = max_delay_us;
+
+    // O_APPEND so batches from several processes never overwrite each other
+    wal->fd = open(path, O_WRONLY | O_CREAT | O_APPEND, S_IRUSR | S_IWUSR);
+    if (wal->fd == -1)
+    {
+        perror("shm_wal_open: open");
+        return -1;
+    }
+
+    wal->buffer = malloc(SHM_WAL_BUFFER_SIZE);
+    wal->flush_buffer = malloc(SHM_WAL_BUFFER_SIZE);
+    if (wal->buffer == NULL || wal->flush_buffer == NULL)
+    {
+        fprintf(stderr, "shm_wal_open: out of memory\n");
+        free(wal->buffer);
+        free(wal->flush_buffer);
+        close(wal->fd);
+        return -1;
+    }
+
+    pthread_mutex_init(&wal->lock, NULL);
+    pthread_cond_init(&wal->pending, NULL);
+    pthread_cond_init(&wal->durable, NULL);
+
+    if (pthread_create(&wal->thread, NULL, commit_thread, wal) != 0)
+    {
+        perror("shm_wal_open: pthread_create");
+        pthread_cond_destroy(&wal->durable);
+        pthread_cond_destroy(&wal->pending);
+        pthread_mutex_destroy(&wal->lock);
+        free(wal->buffer);
+        free(wal->flush_buffer);
+        close(wal->fd);
+        return -1;
+    }
+
+    return 0;
+}
+
+void shm_wal_close(shm_wal_t *wal)
+{
+    // The commit thread drains what is left before it exits
+    pthread_mutex_lock(&wal->lock);
+    wal->stop = 1;
+    pthread_cond_signal(&wal->pending);
+    pthread_mutex_unlock(&wal->lock);
+    pthread_join(wal->thread, NULL);
+
+    pthread_cond_destroy(&wal->durable);
+    pthread_cond_destroy(&wal->pending);
+    pthread_mutex_destroy(&wal->lock);
+    free(wal->buffer);
+    free(wal->flush_buffer);
+    close(wal->fd);
+    wal->fd = -1;
+}
+
+int shm_wal_append(shm_wal_t *wal, const void *data, uint32_t length, uint64_t *lsn)
+{
+    size_t size = sizeof(shm_wal_frame_t) + length;
+    if (length > SHM_WAL_MAX_RECORD)
+    {
+        fprintf(stderr, "shm_wal_append: %u byte record is larger than the log buffer\n", length);
+        return -1;
+    }
+
+    pthread_mutex_lock(&wal->lock);
+
+    // Wait for the commit thread to take the buffer if this doesn't fit
+    while (wal->used + size > SHM_WAL_BUFFER_SIZE)
+    {
+        pthread_cond_wait(&wal->durable, &wal->lock);
+    }
+
+    shm_wal_frame_t frame = {SHM_WAL_MAGIC, length, checksum(data, length), 0};
+    memcpy(wal->buffer + wal->used, &frame, sizeof(frame));
+    memcpy(wal->buffer + wal->used + sizeof(frame), data, length);
+
+    // Wake the commit thread for the first record of a batch, and early for a big one
+    int was_empty = wal->used == 0;
+    wal->used += size;
+    if (was_empty)
+    {
+        wal->first_pending_ns = wall_time_ns();
+    }
+    if (was_empty || (wal->used >= SHM_WAL_BUFFER_SIZE / 2 && wal->used - size < SHM_WAL_BUFFER_SIZE / 2))
+    {
+        pthread_cond_signal(&wal->pending);
+    }
+
+    wal->appended_lsn += size;
+    wal->stats.records++;
+    if (lsn != NULL)
+    {
+        *lsn = wal->appended_lsn;
+    }
+
+    pthread_mutex_unlock(&wal->lock);
+    return 0;
+}
+
+int shm_wal_wait(shm_wal_t *wal, uint64_t lsn)
+{
+    pthread_mutex_lock(&wal->lock);
+    while (wal->durable_lsn < lsn && !wal->failed)
+    {
+        pthread_cond_wait(&wal->durable, &wal->lock);
+    }
+    int result = wal->durable_lsn >= lsn ? 0 : -1;
+    pthread_mutex_unlock(&wal->lock);
+    return result;
+}
+
+int shm_wal_truncate(shm_wal_t *wal)
+{
+    pthread_mutex_lock(&wal->lock);
+
+    // Let anything already appended reach the file first
+    while (wal->durable_lsn < wal->appended_lsn && !wal->failed)
+    {
+        pthread_cond_wait(&wal->durable, &wal->lock);
+    }
+
+    int result = 0;
+    if (ftruncate(wal->fd, 0) == -1 || sync_file(wal->fd) == -1)
+    {
+        perror("shm_wal_truncate");
+        result = -1;
+    }
+
+    pthread_mutex_unlock(&wal->lock);
+    return result;
+}
+
+long shm_wal_replay(const char *path, void (*apply)(void *context, const void *data, uint32_t length),
+                    void *context)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        if (errno == ENOENT)
+        {
+            return 0;
+        }
+        perror("shm_wal_replay: fopen");
+        return -1;
+    }
+
+    char *payload = malloc(SHM_WAL_MAX_RECORD);
+    if (payload == NULL)
+    {
+        fprintf(stderr, "shm_wal_replay: out of memory\n");
+        fclose(file);
+        return -1;
+    }
+
+    long records = 0;
+    shm_wal_frame_t frame;
+    while (fread(&frame, sizeof(frame), 1, file) == 1)
+    {
+        // A bad header or short payload is where a crash cut the log off
+        if (frame.magic != SHM_WAL_MAGIC || frame.length > SHM_WAL_MAX_RECORD ||
+            fread(payload, 1, frame.length, file) != frame.length ||
+            checksum(payload, frame.length) != frame.checksum)
+        {
+            break;
+        }
+        apply(context, payload, frame.length);
+        records++;
+    }
+
+    free(payload);
+    fclose(file);
+    return records;
+}
+
+shm_wal_stats_t shm_wal_stats(shm_wal_t *wal)
+{
+    pthread_mutex_lock(&wal->lock);
+    shm_wal_stats_t stats = wal->stats;
+    pthread_mutex_unlock(&wal->lock);
+    return stats;
+}
@@ -0,0 +1,87 @@
+#ifndef SHM_WAL_H
+#define SHM_WAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+// Append-only write-ahead log with group commit. Writers append records to
+// an in-memory buffer and get back a log sequence number (LSN); one commit
+// thread per process writes out whatever has accumulated and makes it
+// durable with a single fsync, then wakes every writer whose LSN it covered.
+// The more writers there are, the more records share each fsync.
+//
+// Records are framed with their length and a checksum, so replay stops
+// cleanly at a torn tail. Several processes may append to the same log:
+// the file is opened O_APPEND and every batch goes out in one write.
+
+#define SHM_WAL_MAGIC 0x57414c52       // "WALR", starts every frame
+#define SHM_WAL_BUFFER_SIZE (1 << 20) // Bytes buffered per batch
+
+// Frame header in the file, followed by length bytes of payload
+typedef struct
+{
+    uint32_t magic;
+    uint32_t length;
+    uint32_t checksum; // FNV-1a of the payload
+    uint32_t reserved;
+} shm_wal_frame_t;
+
+// Counters for the stats line; read under the log's lock
+typedef struct
+{
+    uint64_t records; // Records appended
+    uint64_t commits; // Batches written and synced
+    uint64_t bytes;   // Bytes written, frames included
+    uint64_t sync_ns; // Time spent in write + fsync
+} shm_wal_stats_t;
+
+typedef struct
+{
+    int fd;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t pending; // The commit thread waits here for records
+    pthread_cond_t durable; // Writers wait here for their LSN
+    char *buffer;           // Filled by writers
+    char *flush_buffer;     // Being written by the commit thread
+    size_t used;
+    uint64_t appended_lsn; // Bytes appended by this process, the LSN of the last record
+    uint64_t durable_lsn;  // Bytes this process has synced
+    uint64_t first_pending_ns; // Wall-clock time the oldest unsynced record was appended
+    unsigned max_delay_us;     // Longest a record waits for company before a commit
+    int stop;
+    int failed; // A write or fsync failed; nothing after it is durable
+    shm_wal_stats_t stats;
+} shm_wal_t;
+
+// Open (creating if needed) the log at path and start its commit thread.
+// A commit waits up to max_delay_us after its first record for others to
+// join it; 0 commits as soon as the previous fsync is done.
+int shm_wal_open(shm_wal_t *wal, const char *path, unsigned max_delay_us);
+
+// Stop the commit thread after a last commit and close the log
+void shm_wal_close(shm_wal_t *wal);
+
+// Append a record. Its LSN goes to *lsn; it is durable once
+// shm_wal_wait returns for that LSN. Returns 0, or -1 if it can never fit.
+int shm_wal_append(shm_wal_t *wal, const void *data, uint32_t length, uint64_t *lsn);
+
+// Block until everything up to lsn is on disk. Returns 0, or -1 if the
+// commit thread failed to write the log.
+int shm_wal_wait(shm_wal_t *wal, uint64_t lsn);
+
+// Discard the log's contents, once everything it holds is durable elsewhere.
+// The caller keeps appends out while this runs.
+int shm_wal_truncate(shm_wal_t *wal);
+
+// Call apply for each intact record in the log at path, in order, stopping
+// at the first torn or corrupt frame. Returns the number of records
+// applied, or -1 if the log can't be read. A missing log holds no records.
+long shm_wal_replay(const char *path, void (*apply)(void *context, const void *data, uint32_t length),
+                    void *context);
+
+// Copy of the counters
+shm_wal_stats_t shm_wal_stats(shm_wal_t *wal);
+
+#endif // SHM_WAL_H
@@ -0,0 +1,952 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "mmap_shared.h"
+
+#define TEST_DB_PATH "/tmp/test_mmap_db.dat"
+#define TEST_WAL_PATH "/tmp/test_mmap_db.wal"
+#define TEST_DB_SIZE (1024 * 1024)
+#define WRITER_THREADS 8
+#define INSERTS_PER_WRITER 50
+#define SNAPSHOT_UPDATES 20000
+#define GROWTH_STEPS 4
+
+static void count_record(void *context, const void *data, uint32_t length)
+{
+    (void)data;
+    assert(length == sizeof(db_log_entry_t));
+    (*(long *)context)++;
+}
+
+// Test that committed inserts come back from the log after the record
+// file lost them, and that replay stops at a torn tail
+void test_recovery()
+{
+    printf("Testing recovery from the log...\n");
+
+    mmap_db_t handle;
+    assert(mmap_db_create(&handle, TEST_DB_PATH, TEST_DB_SIZE, TEST_WAL_PATH, 0) == 0);
+    assert(mmap_db_checkpoint(&handle) == 0);
+
+    for (int i = 0; i < 10; i++)
+    {
+        char name[64];
+        snprintf(name, sizeof(name), "Record %d", i);
+        uint64_t lsn;
+        assert(mmap_db_add_record(&handle, name, i * 1.5, &lsn) == 0);
+        assert(mmap_db_commit(&handle, lsn) == 0);
+    }
+    assert(mmap_db_record_count(handle.db) == 10);
+
+    // Lose everything since the checkpoint, as if the pages never made it to disk
+    memset(handle.db->records, 0, 10 * sizeof(record_t));
+    atomic_store(&handle.db->record_count, 0);
+    mmap_db_close(&handle);
+
+    // A crash in the middle of a later batch leaves half a frame behind
+    int fd = open(TEST_WAL_PATH, O_WRONLY | O_APPEND);
+    assert(fd != -1);
+    shm_wal_frame_t torn = {SHM_WAL_MAGIC, sizeof(db_log_entry_t), 0, 0};
+    assert(write(fd, &torn, sizeof(torn)) == sizeof(torn));
+    close(fd);
+
+    long logged = 0;
+    assert(shm_wal_replay(TEST_WAL_PATH, count_record, &logged) == 10 && logged == 10);
+
+    assert(mmap_db_open(&handle, TEST_DB_PATH, TEST_WAL_PATH, 0) == 0);
+    assert(mmap_db_record_count(handle.db) == 10);
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        char name[64];
+        snprintf(name, sizeof(name), "Record %u", i);
+        assert(handle.db->records[i].id == i + 1);
+        assert(strcmp(handle.db->records[i].name, name) == 0);
+        assert(handle.db->records[i].value == i * 1.5);
+        assert(mmap_db_find_by_id(handle.db, i + 1) == &handle.db->records[i]);
+        assert(mmap_db_find_by_name(handle.db, name) == &handle.db->records[i]);
+    }
+
+    // The value tree was rebuilt over the recovered records
+    mmap_db_range_t range;
+    mmap_db_range_begin(&range, handle.db, 3.0, 9.0);
+    for (uint32_t i = 2; i <= 6; i++)
+    {
+        assert(mmap_db_range_next(&range) == &handle.db->records[i]);
+    }
+    assert(mmap_db_range_next(&range) == NULL);
+
+    // A checkpoint leaves nothing to replay
+    assert(mmap_db_checkpoint(&handle) == 0);
+    logged = 0;
+    assert(shm_wal_replay(TEST_WAL_PATH, count_record, &logged) == 0);
+    mmap_db_close(&handle);
+
+    printf("recovery test passed!\n\n");
+}
+
+// Copy each entry of the log into an array, in log order
+static void collect_entry(void *context, const void *data, uint32_t length)
+{
+    assert(length == sizeof(db_log_entry_t));
+    db_log_entry_t **next = context;
+    memcpy(*next, data, length);
+    (*next)++;
+}
+
+// Write entries to a fresh log at TEST_WAL_PATH in the given order, as
+// processes flushing their buffers in turn would
+static void write_log(const db_log_entry_t *entries, const int *order, int count)
+{
+    shm_wal_t wal;
+    assert(shm_wal_open(&wal, TEST_WAL_PATH, 0) == 0);
+    assert(shm_wal_truncate(&wal) == 0);
+    uint64_t lsn = 0;
+    for (int i = 0; i < count; i++)
+    {
+        assert(shm_wal_append(&wal, &entries[order[i]], sizeof(db_log_entry_t), &lsn) == 0);
+    }
+    assert(shm_wal_wait(&wal, lsn) == 0);
+    shm_wal_close(&wal);
+}
+
+// Test that replay keeps the newest version of a record when processes
+// flushed their log buffers out of commit order
+void test_replay_order()
+{
+    printf("Testing replay of a log out of commit order...\n");
+
+    mmap_db_t handle;
+    assert(mmap_db_create(&handle, TEST_DB_PATH, TEST_DB_SIZE, TEST_WAL_PATH, 0) == 0);
+    uint64_t lsn;
+    assert(mmap_db_add_record(&handle, "Reordered", 1.0, &lsn) == 0);
+    assert(mmap_db_update_record(&handle, 1, 2.0, true, &lsn) == 0);
+    assert(mmap_db_update_record(&handle, 1, 3.0, true, &lsn) == 0);
+    assert(mmap_db_commit(&handle, lsn) == 0);
+    mmap_db_close(&handle);
+
+    db_log_entry_t entries[3];
+    db_log_entry_t *next = entries;
+    assert(shm_wal_replay(TEST_WAL_PATH, collect_entry, &next) == 3);
+    assert(entries[0].epoch < entries[1].epoch && entries[1].epoch < entries[2].epoch);
+    write_log(entries, (const int[]){2, 1, 0}, 3);
+
+    // The file already has the newest version; older entries leave it alone
+    assert(mmap_db_open(&handle, TEST_DB_PATH, TEST_WAL_PATH, 0) == 0);
+    assert(mmap_db_record_count(handle.db) == 1);
+    assert(handle.db->records[0].value == 3.0);
+    assert(mmap_db_find_by_id(handle.db, 1) == &handle.db->records[0]);
+
+    // Without the record pages, the newest entry wins wherever it is in the log
+    memset(handle.db->records, 0, sizeof(record_t));
+    memset(db_record_slot(handle.db, 0), 0, sizeof(db_record_slot_t));
+    atomic_store(&handle.db->record_count, 0);
+    mmap_db_close(&handle);
+    assert(mmap_db_open(&handle, TEST_DB_PATH, TEST_WAL_PATH, 0) == 0);
+    assert(mmap_db_record_count(handle.db) == 1);
+    assert(handle.db->records[0].value == 3.0);
+    assert(strcmp(handle.db->records[0].name, "Reordered") == 0);
+
+    // Commits after replay come after every logged one
+    assert(mmap_db_update_record(&handle, 1, 4.0, true, NULL) == 0);
+    assert(db_record_slot(handle.db, 0)->epoch > entries[2].epoch);
+    mmap_db_close(&handle);
+
+    printf("replay order test passed!\n\n");
+}
+
+// Test that replay only counts inserts up to the first one missing from
+// the log, and drops the entries stranded behind it
+void test_replay_gaps()
+{
+    printf("Testing replay with inserts missing from the log...\n");
+
+    mmap_db_t handle;
+    assert(mmap_db_create(&handle, TEST_DB_PATH, TEST_DB_SIZE, TEST_WAL_PATH, 0) == 0);
+    uint64_t lsn;
+    for (int i = 0; i < 3; i++)
+    {
+        assert(mmap_db_add_record(&handle, "Gapped", i, &lsn) == 0);
+    }
+    assert(mmap_db_update_record(&handle, 3, 20, true, &lsn) == 0);
+    assert(mmap_db_commit(&handle, lsn) == 0);
+    mmap_db_close(&handle);
+
+    db_log_entry_t entries[4];
+    db_log_entry_t *next = entries;
+    assert(shm_wal_replay(TEST_WAL_PATH, collect_entry, &next) == 4);
+
+    // The process holding the second insert never flushed it
+    assert(mmap_db_create(&handle, TEST_DB_PATH, TEST_DB_SIZE, NULL, 0) == 0);
+    mmap_db_close(&handle);
+    write_log(entries, (const int[]){3, 2, 0}, 3);
+    assert(mmap_db_open(&handle, TEST_DB_PATH, TEST_WAL_PATH, 0) == 0);
+    assert(mmap_db_record_count(handle.db) == 1);
+    assert(handle.db->records[0].id == 1 && handle.db->records[0].value == 0);
+    assert(mmap_db_find_by_id(handle.db, 3) == NULL);
+    assert(atomic_load(&db_record_slot(handle.db, 2)->created) == 0);
+    assert(handle.db->records[2].id == 0);
+
+    // The next inserts take the slots over
+    assert(mmap_db_add_record(&handle, "Taken over", 5, NULL) == 0);
+    assert(mmap_db_add_record(&handle, "Taken over", 6, NULL) == 0);
+    assert(mmap_db_find_by_id(handle.db, 3)->value == 6);
+    mmap_db_range_t range;
+    mmap_db_range_begin(&range, handle.db, -1e9, 1e9);
+    int found = 0;
+    while (mmap_db_range_next(&range) != NULL)
+    {
+        found++;
+    }
+    assert(found == 3);
+    mmap_db_close(&handle);
+
+    // Flushed last, it lets everything after it count
+    assert(mmap_db_create(&handle, TEST_DB_PATH, TEST_DB_SIZE, NULL, 0) == 0);
+    mmap_db_close(&handle);
+    write_log(entries, (const int[]){3, 2, 0, 1}, 4);
+    assert(mmap_db_open(&handle, TEST_DB_PATH, TEST_WAL_PATH, 0) == 0);
+    assert(mmap_db_record_count(handle.db) == 3);
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        assert(mmap_db_find_by_id(handle.db, i + 1) == &handle.db->records[i]);
+    }
+    assert(handle.db->records[2].value == 20);
+
+    // Snapshots see the inserts at the epochs they committed in
+    mmap_db_snapshot_t snapshot;
+    assert(mmap_db_snapshot_begin(&handle, &snapshot) == 0);
+    assert(snapshot.record_count == 3);
+    mmap_db_snapshot_end(&snapshot);
+    assert(atomic_load(&db_record_slot(handle.db, 2)->created) == entries[2].epoch);
+    mmap_db_close(&handle);
+
+    printf("replay gaps test passed!\n\n");
+}
+
+// Test that opening a live database again puts nothing new into its feed
+void test_replay_live()
+{
+    printf("Testing a second open of a live database...\n");
+
+    mmap_db_t handle;
+    assert(mmap_db_create(&handle, TEST_DB_PATH, TEST_DB_SIZE, TEST_WAL_PATH, 0) == 0);
+    uint64_t lsn;
+    for (int i = 0; i < 5; i++)
+    {
+        char name[64];
+        snprintf(name, sizeof(name), "Live %d", i);
+        assert(mmap_db_add_record(&handle, name, i, &lsn) == 0);
+    }
+    assert(mmap_db_update_record(&handle, 2, 42, true, &lsn) == 0);
+    assert(mmap_db_delete_record(&handle, 4, &lsn) == 0);
+    assert(mmap_db_commit(&handle, lsn) == 0);
+
+    mmap_db_feed_t feed;
+    mmap_db_feed_init(&feed, handle.db);
+    uint64_t sequence = atomic_load(&handle.db->change_sequence);
+    uint64_t epoch = atomic_load(&handle.db->commit_epoch);
+
+    // Every logged change is already in the file
+    mmap_db_t second;
+    assert(mmap_db_open(&second, TEST_DB_PATH, TEST_WAL_PATH, 0) == 0);
+    assert(mmap_db_record_count(second.db) == 5);
+    assert(atomic_load(&second.db->change_sequence) == sequence);
+    assert(atomic_load(&second.db->commit_epoch) == epoch);
+    db_change_t change;
+    assert(mmap_db_feed_next(&feed, &change) == 0);
+    assert(second.db->records[1].value == 42 && !second.db->records[3].is_active);
+
+    // Both handles count as writers that have the log open
+    int writers = 0;
+    for (int i = 0; i < DB_MAX_WRITERS; i++)
+    {
+        writers += atomic_load(&second.db->writers[i]) == getpid();
+    }
+    assert(writers == 2 && second.writer >= 0 && second.writer != handle.writer);
+
+    // Changes from the second handle go into the same feed
+    assert(mmap_db_add_record(&second, "After", 7, NULL) == 0);
+    assert(mmap_db_feed_next(&feed, &change) == 1);
+    assert(change.kind == DB_CHANGE_INSERT && change.index == 5 && change.sequence == sequence + 1);
+    assert(mmap_db_feed_next(&feed, &change) == 0);
+
+    mmap_db_close(&second);
+    mmap_db_close(&handle);
+
+    printf("live reopen test passed!\n\n");
+}
+
+// Test that a replay leaves the versions a pinned snapshot reads alone
+void test_replay_snapshot()
+{
+    printf("Testing a replay under a pinned snapshot...\n");
+
+    mmap_db_t writer, reader;
+    assert(mmap_db_create(&writer, TEST_DB_PATH, TEST_DB_SIZE, TEST_WAL_PATH, 0) == 0);
+    assert(mmap_db_open(&reader, TEST_DB_PATH, NULL, 0) == 0);
+    uint64_t lsn;
+    for (int i = 0; i < 3; i++)
+    {
+        assert(mmap_db_add_record(&writer, "Pinned", i, &lsn) == 0);
+    }
+
+    mmap_db_snapshot_t snapshot;
+    assert(mmap_db_snapshot_begin(&reader, &snapshot) == 0);
+    assert(mmap_db_update_record(&writer, 2, 100, true, &lsn) == 0);
+    assert(mmap_db_commit(&writer, lsn) == 0);
+
+    // A second writer while the first is live has nothing to replay
+    mmap_db_t second;
+    assert(mmap_db_open(&second, TEST_DB_PATH, TEST_WAL_PATH, 0) == 0);
+    record_t record;
+    assert(mmap_db_snapshot_read(&snapshot, 1, &record) == 0 && record.value == 1);
+    mmap_db_close(&second);
+
+    // With no writer left the log is replayed, over versions the file already has
+    mmap_db_close(&writer);
+    assert(mmap_db_open(&second, TEST_DB_PATH, TEST_WAL_PATH, 0) == 0);
+    assert(mmap_db_record_count(second.db) == 3);
+    assert(mmap_db_snapshot_read(&snapshot, 1, &record) == 0 && record.value == 1);
+    mmap_db_snapshot_end(&snapshot);
+
+    assert(mmap_db_snapshot_begin(&reader, &snapshot) == 0);
+    assert(mmap_db_snapshot_read(&snapshot, 1, &record) == 0 && record.value == 100);
+    mmap_db_snapshot_end(&snapshot);
+
+    mmap_db_close(&second);
+    mmap_db_close(&reader);
+
+    printf("replay under snapshot test passed!\n\n");
+}
+
+static void *insert_and_commit(void *arg)
+{
+    mmap_db_t *handle = arg;
+    for (int i = 0; i < INSERTS_PER_WRITER; i++)
+    {
+        uint64_t lsn;
+        assert(mmap_db_add_record(handle, "Concurrent", i, &lsn) == 0);
+        assert(mmap_db_commit(handle, lsn) == 0);
+    }
+    return NULL;
+}
+
+// Test that concurrent writers share fsyncs, and every insert is logged once
+void test_group_commit()
+{
+    printf("Testing group commit with %d writers...\n", WRITER_THREADS);
+
+    mmap_db_t handle;
+    assert(mmap_db_create(&handle, TEST_DB_PATH, TEST_DB_SIZE, TEST_WAL_PATH, 1000) == 0);
+
+    pthread_t threads[WRITER_THREADS];
+    for (int t = 0; t < WRITER_THREADS; t++)
+    {
+        assert(pthread_create(&threads[t], NULL, insert_and_commit, &handle) == 0);
+    }
+    for (int t = 0; t < WRITER_THREADS; t++)
+    {
+        pthread_join(threads[t], NULL);
+    }
+
+    shm_wal_stats_t stats = shm_wal_stats(&handle.wal);
+    assert(mmap_db_record_count(handle.db) == WRITER_THREADS * INSERTS_PER_WRITER);
+    assert(stats.records == WRITER_THREADS * INSERTS_PER_WRITER);
+    assert(stats.commits < stats.records);
+    printf("%llu inserts in %llu commits\n", (unsigned long long)stats.records, (unsigned long long)stats.commits);
+
+    long logged = 0;
+    assert(shm_wal_replay(TEST_WAL_PATH, count_record, &logged) == WRITER_THREADS * INSERTS_PER_WRITER);
+    mmap_db_close(&handle);
+
+    printf("group commit test passed!\n\n");
+}
+
+// Test that a flush only covers the pages that changed
+void test_dirty_ranges()
+{
+    printf("Testing dirty range flushing...\n");
+
+    // A file big enough that the regions an insert touches lie far apart
+    size_t size = 16 * TEST_DB_SIZE;
+    mmap_db_t handle;
+    assert(mmap_db_create(&handle, TEST_DB_PATH, size, NULL, 0) == 0);
+    assert(mmap_db_checkpoint(&handle) == 0);
+    shm_dirty_stats_t before = shm_dirty_stats(&handle.dirty);
+    assert(before.bytes == size);
+
+    // One insert dirties the header page and the page holding the record,
+    // which merge, and its slot, a bucket in each index, a tree leaf and a
+    // change feed entry further on
+    assert(mmap_db_add_record(&handle, "Dirty", 1.0, NULL) == 0);
+    assert(mmap_db_commit(&handle, 0) == 0);
+    shm_dirty_stats_t after = shm_dirty_stats(&handle.dirty);
+    assert(after.flushes == before.flushes + 1);
+    assert(after.ranges >= before.ranges + 2 && after.ranges <= before.ranges + 6);
+    assert(after.bytes - before.bytes < size / 4);
+
+    // Nothing changed, nothing to flush
+    assert(shm_dirty_flush(&handle.dirty, MS_SYNC) == 0);
+    assert(shm_dirty_stats(&handle.dirty).flushes == after.flushes);
+
+    // Pages far apart are flushed separately
+    size_t page = handle.dirty.page_size;
+    shm_dirty_mark(&handle.dirty, (char *)handle.db + page, 1);
+    shm_dirty_mark(&handle.dirty, (char *)handle.db + (SHM_DIRTY_MERGE_GAP + 10) * page, 2 * page);
+    assert(shm_dirty_flush(&handle.dirty, MS_SYNC) == 0);
+    shm_dirty_stats_t split = shm_dirty_stats(&handle.dirty);
+    assert(split.ranges == after.ranges + 2);
+    assert(split.bytes == after.bytes + 3 * page);
+
+    // The background flusher picks up inserts on its own
+    assert(mmap_db_set_sync_mode(&handle, MMAP_DB_SYNC_BACKGROUND, 1) == 0);
+    assert(mmap_db_add_record(&handle, "Background", 2.0, NULL) == 0);
+    assert(mmap_db_commit(&handle, 0) == 0);
+    for (int i = 0; i < 1000 && shm_dirty_stats(&handle.dirty).flushes == split.flushes; i++)
+    {
+        usleep(1000);
+    }
+    assert(shm_dirty_stats(&handle.dirty).flushes > split.flushes);
+    mmap_db_close(&handle);
+
+    printf("dirty range test passed!\n\n");
+}
+
+// Test lookups by id and name, straight after the inserts and after a
+// reopen, which finds the indexes in the file as they were
+void test_hash_index()
+{
+    printf("Testing the hash indexes...\n");
+
+    mmap_db_t handle;
+    assert(mmap_db_create(&handle, TEST_DB_PATH, TEST_DB_SIZE, NULL, 0) == 0);
+    mmap_database_t *db = handle.db;
+    assert(db->max_records > 0 && db->max_records <= db->index_slots * DB_INDEX_MAX_LOAD / 4);
+    assert((db->index_slots & (db->index_slots - 1)) == 0);
+    assert(db->index_offset >= offsetof(mmap_database_t, records) + db->max_records * sizeof(record_t));
+    assert(db->index_offset + 2 * db->index_slots * sizeof(db_index_bucket_t) <= TEST_DB_SIZE);
+
+    // Fill the database, so every probe sequence is as long as it gets
+    uint32_t count = db->max_records;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        char name[64];
+        snprintf(name, sizeof(name), "Indexed %u", i);
+        assert(mmap_db_add_record(&handle, name, i, NULL) == 0);
+    }
+    assert(mmap_db_record_count(db) == db->max_records);
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            char name[64];
+            snprintf(name, sizeof(name), "Indexed %u", i);
+            const record_t *by_id = mmap_db_find_by_id(db, i + 1);
+            const record_t *by_name = mmap_db_find_by_name(db, name);
+            assert(by_id != NULL && by_id == by_name);
+            assert(by_id == &db->records[i] && by_id->value == i);
+        }
+        assert(mmap_db_find_by_id(db, 0) == NULL);
+        assert(mmap_db_find_by_id(db, count + 1) == NULL);
+        assert(mmap_db_find_by_name(db, "Missing") == NULL);
+
+        // Reopen: the indexes are part of the file
+        assert(mmap_db_checkpoint(&handle) == 0);
+        mmap_db_close(&handle);
+        assert(mmap_db_open(&handle, TEST_DB_PATH, NULL, 0) == 0);
+        db = handle.db;
+    }
+    mmap_db_close(&handle);
+
+    // A name added twice finds the first record with it
+    assert(mmap_db_create(&handle, TEST_DB_PATH, TEST_DB_SIZE, NULL, 0) == 0);
+    assert(mmap_db_add_record(&handle, "Twice", 1.0, NULL) == 0);
+    assert(mmap_db_add_record(&handle, "Twice", 2.0, NULL) == 0);
+    assert(mmap_db_find_by_name(handle.db, "Twice")->id == 1);
+    assert(mmap_db_find_by_id(handle.db, 2)->value == 2.0);
+    mmap_db_close(&handle);
+
+    printf("hash index test passed!\n\n");
+}
+
+// Count the records with value in [low, high] through the tree, checking
+// they come in value order, and compare with a scan
+static void check_range(const mmap_database_t *db, double low, double high)
+{
+    uint32_t expected = 0;
+    for (uint32_t i = 0; i < mmap_db_record_count(db); i++)
+    {
+        expected += db->records[i].value >= low && db->records[i].value <= high;
+    }
+
+    mmap_db_range_t range;
+    mmap_db_range_begin(&range, db, low, high);
+    const record_t *record;
+    uint32_t found = 0;
+    double last = low;
+    while ((record = mmap_db_range_next(&range)) != NULL)
+    {
+        assert(record->value >= last && record->value <= high);
+        last = record->value;
+        found++;
+    }
+    assert(found == expected);
+}
+
+// Test range queries on the value tree against scanning the records
+void test_value_tree()
+{
+    printf("Testing the value tree...\n");
+
+    mmap_db_t handle;
+    assert(mmap_db_create(&handle, TEST_DB_PATH, 4 * TEST_DB_SIZE, NULL, 0) == 0);
+    mmap_database_t *db = handle.db;
+    assert(db->tree_offset % sizeof(db_tree_node_t) == 0);
+    assert(db->tree_offset + (uint64_t)db->tree_capacity * sizeof(db_tree_node_t) <= 4 * TEST_DB_SIZE);
+
+    // Nothing to find in an empty tree
+    mmap_db_range_t range;
+    mmap_db_range_begin(&range, db, -1e9, 1e9);
+    assert(mmap_db_range_next(&range) == NULL);
+
+    // Fill it with values full of duplicates, so runs of equal keys span leaves
+    srand(7);
+    uint32_t count = db->max_records;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        assert(mmap_db_add_record(&handle, "Ranged", rand() % 1000 / 4.0, NULL) == 0);
+    }
+    assert(db->tree_nodes <= db->tree_capacity);
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        check_range(db, -1e9, 1e9);
+        check_range(db, 0, 0);
+        check_range(db, 100, 100);
+        check_range(db, 10.25, 20.5);
+        check_range(db, 249.75, 1e9);
+        check_range(db, 300, 400);
+        check_range(db, 20, 10);
+        for (int i = 0; i < 100; i++)
+        {
+            double low = rand() % 1000 / 4.0;
+            check_range(db, low, low + rand() % 100);
+        }
+
+        // Reopen: the tree is part of the file
+        mmap_db_close(&handle);
+        assert(mmap_db_open(&handle, TEST_DB_PATH, NULL, 0) == 0);
+        db = handle.db;
+    }
+    mmap_db_close(&handle);
+
+    // Updates leave nodes part empty until the tree runs out of them; an
+    // insert that has to pack the tree again must still end up in it
+    assert(mmap_db_create(&handle, TEST_DB_PATH, TEST_DB_SIZE, NULL, 0) == 0);
+    db = handle.db;
+    count = db->max_records / 2;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        assert(mmap_db_add_record(&handle, "Churned", rand() % 1000 / 4.0, NULL) == 0);
+    }
+    int repacked = 0;
+    while (!repacked && mmap_db_record_count(db) < db->max_records)
+    {
+        while (db->tree_nodes < db->tree_capacity - 1)
+        {
+            assert(mmap_db_update_record(&handle, rand() % count + 1, rand() % 1000 / 4.0, true, NULL) == 0);
+        }
+        uint32_t nodes = db->tree_nodes;
+        assert(mmap_db_add_record(&handle, "Churned", rand() % 1000 / 4.0, NULL) == 0);
+        repacked = db->tree_nodes < nodes;
+    }
+    assert(repacked);
+    check_range(db, -1e9, 1e9);
+    mmap_db_close(&handle);
+
+    printf("value tree test passed!\n\n");
+}
+
+// Test that a snapshot keeps seeing the records as they were when it
+// started, and that old versions are reused once no snapshot needs them
+void test_snapshots()
+{
+    printf("Testing snapshot reads...\n");
+
+    mmap_db_t handle, reader;
+    assert(mmap_db_create(&handle, TEST_DB_PATH, TEST_DB_SIZE, NULL, 0) == 0);
+    assert(mmap_db_open(&reader, TEST_DB_PATH, NULL, 0) == 0);
+    for (int i = 0; i < 10; i++)
+    {
+        assert(mmap_db_add_record(&handle, "Versioned", i, NULL) == 0);
+    }
+
+    mmap_db_snapshot_t before;
+    assert(mmap_db_snapshot_begin(&reader, &before) == 0);
+    assert(before.record_count == 10);
+
+    // Change record 3 twice, deactivate record 4 and add an 11th
+    assert(mmap_db_update_record(&handle, 3, 100, true, NULL) == 0);
+    assert(mmap_db_update_record(&handle, 3, 200, true, NULL) == 0);
+    assert(mmap_db_update_record(&handle, 4, 3, false, NULL) == 0);
+    assert(mmap_db_add_record(&handle, "Versioned", 10, NULL) == 0);
+    assert(mmap_db_update_record(&handle, 12, 0, true, NULL) == -1);
+
+    // The old snapshot sees none of it
+    record_t record;
+    assert(mmap_db_snapshot_read(&before, 2, &record) == 0 && record.value == 2 && record.id == 3);
+    assert(mmap_db_snapshot_read(&before, 3, &record) == 0 && record.is_active);
+    assert(mmap_db_snapshot_read(&before, 10, &record) == -1);
+    mmap_db_snapshot_end(&before);
+
+    // A new one sees all of it
+    mmap_db_snapshot_t after;
+    assert(mmap_db_snapshot_begin(&reader, &after) == 0);
+    assert(after.record_count == 11 && after.epoch > before.epoch);
+    assert(mmap_db_snapshot_read(&after, 2, &record) == 0 && record.value == 200);
+    assert(mmap_db_snapshot_read(&after, 3, &record) == 0 && !record.is_active);
+    assert(mmap_db_snapshot_read(&after, 10, &record) == 0 && record.value == 10);
+
+    // The value tree follows the updates
+    mmap_db_range_t range;
+    mmap_db_range_begin(&range, handle.db, 150, 250);
+    assert(mmap_db_range_next(&range) == &handle.db->records[2]);
+    assert(mmap_db_range_next(&range) == NULL);
+    mmap_db_range_begin(&range, handle.db, 2, 2);
+    assert(mmap_db_range_next(&range) == NULL);
+
+    // While the snapshot is open its versions stay, until the pool fills up
+    uint32_t capacity = handle.db->version_capacity;
+    uint32_t updates = 0;
+    while (mmap_db_update_record(&handle, 1, updates + 1000, true, NULL) == 0)
+    {
+        updates++;
+    }
+    assert(updates > 0 && updates <= capacity);
+    assert(mmap_db_snapshot_read(&after, 0, &record) == 0 && record.value == 0);
+    mmap_db_snapshot_end(&after);
+
+    // Without snapshots the pool is reused indefinitely
+    for (uint32_t i = 0; i < 3 * capacity; i++)
+    {
+        assert(mmap_db_update_record(&handle, 1 + i % 11, i, true, NULL) == 0);
+    }
+    check_range(handle.db, -1e9, 1e9);
+
+    mmap_db_close(&reader);
+    mmap_db_close(&handle);
+
+    printf("snapshot test passed!\n\n");
+}
+
+// Test that snapshots taken in another process while a writer keeps
+// changing two records in turn always see the pair from a single moment
+void test_snapshot_consistency()
+{
+    printf("Testing snapshot consistency across processes...\n");
+
+    mmap_db_t handle;
+    assert(mmap_db_create(&handle, TEST_DB_PATH, TEST_DB_SIZE, NULL, 0) == 0);
+    assert(mmap_db_add_record(&handle, "First", 0, NULL) == 0);
+    assert(mmap_db_add_record(&handle, "Second", 0, NULL) == 0);
+
+    pid_t pid = fork();
+    assert(pid >= 0);
+    if (pid == 0)
+    {
+        // Reader: first is always the value second has or is about to get
+        mmap_db_t reader;
+        if (mmap_db_open(&reader, TEST_DB_PATH, NULL, 0) != 0)
+        {
+            _exit(1);
+        }
+        double last = 0;
+        while (last < SNAPSHOT_UPDATES)
+        {
+            mmap_db_snapshot_t snapshot;
+            record_t first, second;
+            if (mmap_db_snapshot_begin(&reader, &snapshot) != 0 ||
+                mmap_db_snapshot_read(&snapshot, 0, &first) != 0 ||
+                mmap_db_snapshot_read(&snapshot, 1, &second) != 0)
+            {
+                _exit(2);
+            }
+            mmap_db_snapshot_end(&snapshot);
+            if ((first.value != second.value && first.value != second.value + 1) || second.value < last)
+            {
+                _exit(3);
+            }
+            last = second.value;
+        }
+        mmap_db_close(&reader);
+        _exit(0);
+    }
+
+    // Writer: step first, then second, to the next value
+    for (int i = 1; i <= SNAPSHOT_UPDATES; i++)
+    {
+        while (mmap_db_update_record(&handle, 1, i, true, NULL) != 0)
+        {
+            sched_yield(); // The pool is full of versions the reader still holds
+        }
+        while (mmap_db_update_record(&handle, 2, i, true, NULL) != 0)
+        {
+            sched_yield();
+        }
+    }
+
+    int status;
+    waitpid(pid, &status, 0);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    mmap_db_close(&handle);
+
+    printf("snapshot consistency test passed!\n\n");
+}
+
+// Test reading the change feed: kinds and order, waiting, falling behind
+void test_change_feed()
+{
+    printf("Testing the change feed...\n");
+
+    mmap_db_t handle;
+    assert(mmap_db_create(&handle, TEST_DB_PATH, TEST_DB_SIZE, NULL, 0) == 0);
+    mmap_database_t *db = handle.db;
+    assert(mmap_db_add_record(&handle, "Before", 1, NULL) == 0);
+
+    // A new reader starts after the latest change
+    mmap_db_feed_t feed;
+    mmap_db_feed_init(&feed, db);
+    db_change_t change;
+    assert(mmap_db_feed_next(&feed, &change) == 0);
+    assert(mmap_db_feed_wait(&feed, SHM_WAIT_FUTEX, 10) == -1);
+
+    assert(mmap_db_add_record(&handle, "Fed", 2, NULL) == 0);
+    assert(mmap_db_update_record(&handle, 1, 3, true, NULL) == 0);
+    assert(mmap_db_delete_record(&handle, 2, NULL) == 0);
+    assert(mmap_db_delete_record(&handle, 3, NULL) == -1);
+    assert(mmap_db_feed_wait(&feed, SHM_WAIT_FUTEX, 0) == 0);
+
+    const db_change_kind_t kinds[] = {DB_CHANGE_INSERT, DB_CHANGE_UPDATE, DB_CHANGE_DELETE};
+    const uint32_t indexes[] = {1, 0, 1};
+    uint64_t last_epoch = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        assert(mmap_db_feed_next(&feed, &change) == 1);
+        assert(change.kind == kinds[i] && change.index == indexes[i]);
+        assert(change.sequence == (uint64_t)i + 2 && change.epoch > last_epoch);
+        last_epoch = change.epoch;
+    }
+    assert(mmap_db_feed_next(&feed, &change) == 0);
+
+    // The delete kept the record, inactive
+    mmap_db_t reader;
+    assert(mmap_db_open(&reader, TEST_DB_PATH, NULL, 0) == 0);
+    mmap_db_snapshot_t snapshot;
+    record_t record;
+    assert(mmap_db_snapshot_begin(&reader, &snapshot) == 0 && snapshot.epoch >= last_epoch);
+    assert(mmap_db_snapshot_read(&snapshot, 1, &record) == 0 && !record.is_active && record.value == 2);
+    mmap_db_snapshot_end(&snapshot);
+    mmap_db_close(&reader);
+
+    // A reader that falls a whole ring behind is told, then carries on
+    for (int i = 0; i < DB_CHANGE_CAPACITY + 10; i++)
+    {
+        assert(mmap_db_update_record(&handle, 1, i, true, NULL) == 0);
+    }
+    assert(mmap_db_feed_next(&feed, &change) == -1);
+    uint64_t read = 0;
+    while (mmap_db_feed_next(&feed, &change) == 1)
+    {
+        read++;
+    }
+    assert(read > 0 && change.sequence == atomic_load(&db->change_sequence));
+
+    // A reader in another process sleeps until the next change
+    pid_t pid = fork();
+    assert(pid >= 0);
+    if (pid == 0)
+    {
+        mmap_db_t child;
+        if (mmap_db_open(&child, TEST_DB_PATH, NULL, 0) != 0)
+        {
+            _exit(1);
+        }
+        mmap_db_feed_t child_feed;
+        mmap_db_feed_init(&child_feed, child.db);
+        if (mmap_db_feed_wait(&child_feed, SHM_WAIT_FUTEX, -1) != 0 ||
+            mmap_db_feed_next(&child_feed, &change) != 1 || change.kind != DB_CHANGE_INSERT)
+        {
+            _exit(2);
+        }
+        mmap_db_close(&child);
+        _exit(0);
+    }
+    usleep(50000);
+    assert(mmap_db_add_record(&handle, "Wake", 4, NULL) == 0);
+
+    int status;
+    waitpid(pid, &status, 0);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    mmap_db_close(&handle);
+
+    printf("change feed test passed!\n\n");
+}
+
+// Test growing a full database while a second handle and a reader in
+// another process stay attached, and that nothing is lost on the way
+void test_growth()
+{
+    printf("Testing growth of the database file...\n");
+
+    mmap_db_t handle, other;
+    assert(mmap_db_create(&handle, TEST_DB_PATH, TEST_DB_SIZE, NULL, 0) == 0);
+    assert(mmap_db_open(&other, TEST_DB_PATH, NULL, 0) == 0);
+    mmap_database_t *db = handle.db;
+    mmap_database_t *other_db = other.db;
+
+    // A record with history, wrapped around the version pool, and a
+    // snapshot that still sees one of its versions
+    assert(mmap_db_add_record(&handle, "Growing 0", 0, NULL) == 0);
+    for (uint32_t i = 0; i <= db->version_capacity + 5; i++)
+    {
+        assert(mmap_db_update_record(&handle, 1, i, true, NULL) == 0);
+    }
+    double seen_value = db->records[0].value;
+    mmap_db_snapshot_t snapshot;
+    assert(mmap_db_snapshot_begin(&other, &snapshot) == 0);
+    assert(mmap_db_update_record(&handle, 1, -1.0, true, NULL) == 0);
+
+    // Reader: look up the records as they arrive, through every growth
+    uint32_t target = 0;
+    uint32_t capacity = db->max_records;
+    for (int step = 0; step < GROWTH_STEPS; step++)
+    {
+        target += capacity;
+        capacity *= 2;
+    }
+    pid_t pid = fork();
+    assert(pid >= 0);
+    if (pid == 0)
+    {
+        mmap_db_t reader;
+        if (mmap_db_open(&reader, TEST_DB_PATH, NULL, 0) != 0)
+        {
+            _exit(1);
+        }
+        uint32_t seen = 0;
+        while (seen < target)
+        {
+            mmap_db_snapshot_t view;
+            if (mmap_db_snapshot_begin(&reader, &view) != 0)
+            {
+                _exit(2);
+            }
+            seen = view.record_count;
+            if (seen > 1)
+            {
+                uint32_t index = (uint32_t)rand() % (seen - 1) + 1;
+                char name[64];
+                snprintf(name, sizeof(name), "Growing %u", index);
+                const record_t *by_id = mmap_db_find_by_id(reader.db, index + 1);
+                const record_t *by_name = mmap_db_find_by_name(reader.db, name);
+                record_t record;
+                if (by_id == NULL || by_id != by_name || by_id->value != index ||
+                    mmap_db_snapshot_read(&view, index, &record) != 0 || record.value != index)
+                {
+                    _exit(3);
+                }
+            }
+            mmap_db_snapshot_end(&view);
+        }
+        mmap_db_close(&reader);
+        _exit(0);
+    }
+
+    // Fill the file past several growth steps, alternating handles
+    uint32_t steps = 0;
+    for (uint32_t i = 1; i < target; i++)
+    {
+        mmap_db_t *writer = i % 2 ? &handle : &other;
+        uint32_t before = db->max_records;
+        char name[64];
+        snprintf(name, sizeof(name), "Growing %u", i);
+        assert(mmap_db_add_record(writer, name, i, NULL) == 0);
+        if (db->max_records != before)
+        {
+            assert(db->max_records > before && db->file_size > TEST_DB_SIZE);
+            steps++;
+        }
+    }
+    assert(steps >= GROWTH_STEPS);
+    assert(handle.db == db && other.db == other_db); // Neither mapping moved
+    assert(other_db->max_records == db->max_records);
+
+    int status;
+    waitpid(pid, &status, 0);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    // Both handles caught up with the size
+    assert(mmap_db_update_record(&other, 2, 1.5, true, NULL) == 0);
+    assert(other.size == db->file_size && handle.size == db->file_size);
+
+    // The old version survived the moves, and the tree and indexes hold everything
+    record_t record;
+    assert(mmap_db_snapshot_read(&snapshot, 0, &record) == 0 && record.value == seen_value);
+    mmap_db_snapshot_end(&snapshot);
+    assert(mmap_db_find_by_id(db, 1)->value == -1.0);
+    for (int pass = 0; pass < 2; pass++)
+    {
+        db = handle.db;
+        for (uint32_t i = 2; i < target; i++)
+        {
+            char name[64];
+            snprintf(name, sizeof(name), "Growing %u", i);
+            assert(mmap_db_find_by_name(db, name) == &db->records[i]);
+        }
+        check_range(db, 0, target);
+
+        // Reopen: the file keeps its new size and layout
+        assert(mmap_db_checkpoint(&handle) == 0);
+        mmap_db_close(&handle);
+        assert(mmap_db_open(&handle, TEST_DB_PATH, NULL, 0) == 0);
+        assert(handle.size == handle.db->file_size);
+    }
+    mmap_db_close(&handle);
+    mmap_db_close(&other);
+
+    printf("growth test passed!\n\n");
+}
+
+int main()
+{
+    printf("Running mapped database unit tests\n");
+    printf("==================================\n\n");
+
+    test_recovery();
+    test_replay_order();
+    test_replay_gaps();
+    test_replay_live();
+    test_replay_snapshot();
+    test_group_commit();
+    test_dirty_ranges();
+    test_hash_index();
+    test_value_tree();
+    test_snapshots();
+    test_snapshot_consistency();
+    test_change_feed();
+    test_growth();
+
+    unlink(TEST_DB_PATH);
+    unlink(TEST_WAL_PATH);
+
+    printf("All tests passed successfully!\n");
+    return 0;
+}
@@ -0,0 +1,267 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <sched.h>
+#include <sys/wait.h>
+#include "shared_memory.h"
+#include "ring_buffer_shared.h"
+
+#define TEST_SHM_NAME "/test_ring_buffer"
+#define TEST_CAPACITY 1024
+#define STREAM_BYTES (1024 * 1024)
+#define BLOCKING_BYTES (256 * 1024)
+
+// Copy bytes into the spans of a reservation
+static void spans_write(ring_span_t spans[2], const uint8_t *src)
+{
+    memcpy(spans[0].data, src, spans[0].length);
+    memcpy(spans[1].data, src + spans[0].length, spans[1].length);
+}
+
+// Copy bytes out of the spans of a peek
+static void spans_read(ring_span_t spans[2], uint8_t *dst)
+{
+    memcpy(dst, spans[0].data, spans[0].length);
+    memcpy(dst + spans[0].length, spans[1].data, spans[1].length);
+}
+
+// Test reserve/commit and peek/release on a single process
+void test_reserve_peek(ring_buffer_t *rb)
+{
+    printf("Testing reserve/commit and peek/release...\n");
+
+    ring_span_t spans[2];
+    assert(ring_peek(rb, TEST_CAPACITY, spans) == 0);
+
+    // Reserved bytes are not visible until committed
+    assert(ring_reserve(rb, 100, spans));
+    assert(spans[0].length == 100 && spans[1].length == 0);
+    memset(spans[0].data, 0xAB, 100);
+    assert(buffer_is_empty(rb));
+    ring_commit(rb, 100);
+
+    assert(ring_peek(rb, 64, spans) == 64);
+    assert(spans[0].data[63] == 0xAB);
+    assert(ring_peek(rb, TEST_CAPACITY, spans) == 100);
+    ring_release(rb, 100);
+    assert(buffer_is_empty(rb));
+
+    // Fill the buffer completely; one more byte does not fit
+    assert(ring_reserve(rb, TEST_CAPACITY, spans));
+    assert(!ring_reserve(rb, TEST_CAPACITY + 1, spans));
+    ring_commit(rb, TEST_CAPACITY);
+    assert(buffer_is_full(rb));
+    assert(!ring_reserve(rb, 1, spans));
+    assert(ring_peek(rb, TEST_CAPACITY, spans) == TEST_CAPACITY);
+    ring_release(rb, TEST_CAPACITY);
+
+    // A burst reservation gets whatever is free, and nothing when full
+    assert(ring_reserve_up_to(rb, TEST_CAPACITY - 24, spans) == TEST_CAPACITY - 24);
+    ring_commit(rb, TEST_CAPACITY - 24);
+    assert(ring_reserve_up_to(rb, 64, spans) == 24);
+    ring_commit(rb, 24);
+    assert(ring_reserve_up_to(rb, 64, spans) == 0);
+    assert(ring_peek(rb, 2 * TEST_CAPACITY, spans) == TEST_CAPACITY);
+    ring_release(rb, TEST_CAPACITY);
+
+    printf("reserve/peek test passed!\n\n");
+}
+
+// Test that a region crossing the end of the buffer is split into two spans
+void test_wrap_around(ring_buffer_t *rb)
+{
+    printf("Testing wrap-around spans...\n");
+
+    uint8_t in[200], out[200];
+    for (int i = 0; i < 200; i++)
+    {
+        in[i] = i;
+    }
+
+    // Move the indices to 100 bytes before the end
+    uint64_t start = atomic_load(&rb->write_index);
+    size_t skip = TEST_CAPACITY - buffer_mask(rb, start) - 100;
+    ring_span_t spans[2];
+    assert(ring_reserve(rb, skip, spans));
+    ring_commit(rb, skip);
+    assert(ring_peek(rb, skip, spans) == skip);
+    ring_release(rb, skip);
+
+    assert(ring_reserve(rb, 200, spans));
+    assert(spans[0].length == 100 && spans[1].length == 100);
+    assert(spans[1].data == rb->data);
+    spans_write(spans, in);
+    ring_commit(rb, 200);
+
+    assert(ring_peek(rb, 200, spans) == 200);
+    assert(spans[0].length == 100 && spans[1].length == 100);
+    spans_read(spans, out);
+    assert(memcmp(in, out, 200) == 0);
+    ring_release(rb, 200);
+
+    printf("wrap-around test passed!\n\n");
+}
+
+// Test streaming through the buffer between two processes
+void test_cross_process(ring_buffer_t *rb)
+{
+    printf("Testing cross-process stream...\n");
+
+    pid_t pid = fork();
+    assert(pid >= 0);
+    if (pid == 0)
+    {
+        // Producer: write a counting byte pattern in odd-sized chunks
+        uint64_t sent = 0;
+        while (sent < STREAM_BYTES)
+        {
+            size_t n = 1 + (sent % 97);
+            if (n > STREAM_BYTES - sent)
+            {
+                n = STREAM_BYTES - sent;
+            }
+
+            ring_span_t spans[2];
+            if (!ring_reserve(rb, n, spans))
+            {
+                sched_yield();
+                continue;
+            }
+            for (int s = 0; s < 2; s++)
+            {
+                for (size_t i = 0; i < spans[s].length; i++)
+                {
+                    spans[s].data[i] = (uint8_t)(sent++ * 7);
+                }
+            }
+            ring_commit(rb, n);
+        }
+        _exit(0);
+    }
+
+    // Consumer: verify every byte in place
+    uint64_t received = 0;
+    while (received < STREAM_BYTES)
+    {
+        ring_span_t spans[2];
+        size_t n = ring_peek(rb, 300, spans);
+        if (n == 0)
+        {
+            sched_yield();
+            continue;
+        }
+        for (int s = 0; s < 2; s++)
+        {
+            for (size_t i = 0; i < spans[s].length; i++)
+            {
+                assert(spans[s].data[i] == (uint8_t)(received++ * 7));
+            }
+        }
+        ring_release(rb, n);
+    }
+
+    int status;
+    waitpid(pid, &status, 0);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    assert(buffer_is_empty(rb));
+
+    printf("cross-process test passed!\n\n");
+}
+
+// Test that sleeping sides are always woken: both wait on the futex with
+// no timeout, so a lost wake-up hangs here
+void test_blocking_wait(ring_buffer_t *rb)
+{
+    printf("Testing futex waits on full and empty...\n");
+
+    pid_t pid = fork();
+    assert(pid >= 0);
+    if (pid == 0)
+    {
+        shm_waiter_t waiter;
+        shm_waiter_init(&waiter, &rb->space_ready, SHM_WAIT_FUTEX);
+        uint64_t sent = 0;
+        while (sent < BLOCKING_BYTES)
+        {
+            size_t n = 1 + (sent % 251);
+            if (n > BLOCKING_BYTES - sent)
+            {
+                n = BLOCKING_BYTES - sent;
+            }
+
+            ring_span_t spans[2];
+            if (!ring_reserve(rb, n, spans))
+            {
+                shm_wait(&waiter, -1);
+                continue;
+            }
+            shm_wait_done(&waiter);
+            for (int s = 0; s < 2; s++)
+            {
+                for (size_t i = 0; i < spans[s].length; i++)
+                {
+                    spans[s].data[i] = (uint8_t)(sent++ * 13);
+                }
+            }
+            ring_commit(rb, n);
+        }
+        _exit(0);
+    }
+
+    shm_waiter_t waiter;
+    shm_waiter_init(&waiter, &rb->data_ready, SHM_WAIT_FUTEX);
+    uint64_t received = 0;
+    while (received < BLOCKING_BYTES)
+    {
+        ring_span_t spans[2];
+        size_t n = ring_peek(rb, 100, spans);
+        if (n == 0)
+        {
+            shm_wait(&waiter, -1);
+            continue;
+        }
+        shm_wait_done(&waiter);
+        for (int s = 0; s < 2; s++)
+        {
+            for (size_t i = 0; i < spans[s].length; i++)
+            {
+                assert(spans[s].data[i] == (uint8_t)(received++ * 13));
+            }
+        }
+        ring_release(rb, n);
+    }
+
+    int status;
+    waitpid(pid, &status, 0);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    assert(atomic_load(&rb->data_ready.waiters) == 0);
+    assert(atomic_load(&rb->space_ready.waiters) == 0);
+
+    printf("futex wait test passed!\n\n");
+}
+
+int main()
+{
+    printf("Running ring buffer unit tests\n");
+    printf("==============================\n\n");
+
+    shared_memory_t shm = {0};
+    assert(shared_memory_create(&shm, TEST_SHM_NAME, ring_buffer_shm_size(TEST_CAPACITY)) == 0);
+    ring_buffer_t *rb = (ring_buffer_t *)shm.addr;
+    assert(ring_buffer_init(rb, 1000) != 0);
+    assert(ring_buffer_init(rb, TEST_CAPACITY) == 0);
+
+    // Each side's index sits on its own cache line, away from the data
+    assert(offsetof(ring_buffer_t, read_index) - offsetof(ring_buffer_t, write_index) >= SHM_CACHE_LINE);
+    assert(offsetof(ring_buffer_t, data) % SHM_CACHE_LINE == 0);
+
+    test_reserve_peek(rb);
+    test_wrap_around(rb);
+    test_cross_process(rb);
+    test_blocking_wait(rb);
+
+    shared_memory_destroy(&shm, 1);
+
+    printf("All tests passed successfully!\n");
+    return 0;
+}
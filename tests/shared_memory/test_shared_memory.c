@@ -0,0 +1,268 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <assert.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include "shared_memory.h"
+
+#define TEST_SHM_NAME "/test_shared_memory"
+
+// Test that a plain segment is created, shared and unlinked
+void test_create_open()
+{
+    printf("Testing create/open...\n");
+
+    shared_memory_t owner = {0};
+    assert(shared_memory_create(&owner, TEST_SHM_NAME, 8192) == 0);
+    assert(owner.size == 8192);
+    assert(owner.backing == SHM_BACKING_REGULAR);
+
+    shared_memory_t peer = {0};
+    assert(shared_memory_open(&peer, TEST_SHM_NAME) == 0);
+    assert(peer.size == owner.size);
+
+    // Writes through one mapping are visible through the other
+    strcpy((char *)owner.addr, "hello");
+    assert(strcmp((char *)peer.addr, "hello") == 0);
+
+    shared_memory_destroy(&peer, 0);
+    shared_memory_destroy(&owner, 1);
+
+    // The name is gone after the owner unlinks it
+    assert(shm_open(TEST_SHM_NAME, O_RDWR, 0) == -1);
+
+    printf("create/open test passed!\n\n");
+}
+
+// Test that huge page segments fall back cleanly and report their backing
+void test_huge_pages()
+{
+    printf("Testing huge page backing...\n");
+
+    shared_memory_t owner = {0};
+    assert(shared_memory_create_ex(&owner, TEST_SHM_NAME, 3 * 1024 * 1024, SHM_HUGE_PAGES) == 0);
+    printf("Got %s, %zu bytes\n", shared_memory_backing_name(owner.backing), owner.size);
+    assert(owner.size >= 3 * 1024 * 1024);
+
+    if (owner.backing != SHM_BACKING_REGULAR)
+    {
+        // Huge page segments are whole, aligned 2MB pages
+        assert(owner.size % SHM_HUGE_PAGE_SIZE == 0);
+        assert((uintptr_t)owner.addr % SHM_HUGE_PAGE_SIZE == 0);
+    }
+
+    // Peers find the segment whatever backing it got
+    shared_memory_t peer = {0};
+    assert(shared_memory_open_ex(&peer, TEST_SHM_NAME, SHM_HUGE_PAGES) == 0);
+    assert(peer.size == owner.size);
+    if (owner.backing == SHM_BACKING_HUGETLB)
+    {
+        assert(peer.backing == SHM_BACKING_HUGETLB);
+    }
+
+    ((char *)owner.addr)[owner.size - 1] = 42;
+    assert(((char *)peer.addr)[peer.size - 1] == 42);
+
+    shared_memory_destroy(&peer, 0);
+    shared_memory_destroy(&owner, 1);
+
+    printf("huge page test passed!\n\n");
+}
+
+// Test that pre-faulting and locking report their warm-up
+void test_prefault_lock()
+{
+    printf("Testing pre-fault and lock...\n");
+
+    shared_memory_t owner = {0};
+    assert(shared_memory_create_ex(&owner, TEST_SHM_NAME, 1024 * 1024, SHM_PREFAULT | SHM_LOCK) == 0);
+    printf("Warm-up took %llu ns, locked: %d\n", (unsigned long long)owner.warmup_ns, owner.locked);
+    assert(owner.warmup_ns > 0);
+
+    // Pre-faulting must not disturb the (zeroed) contents
+    for (size_t i = 0; i < owner.size; i += 4096)
+    {
+        assert(((char *)owner.addr)[i] == 0);
+    }
+
+    // A plain open does no warm-up
+    shared_memory_t peer = {0};
+    assert(shared_memory_open(&peer, TEST_SHM_NAME) == 0);
+    assert(peer.warmup_ns == 0 && peer.locked == 0);
+
+    shared_memory_destroy(&peer, 0);
+    shared_memory_destroy(&owner, 1);
+
+    printf("pre-fault and lock test passed!\n\n");
+}
+
+// Test that a peer process follows a resize through the generation counter
+void test_resize_generation()
+{
+    printf("Testing resize and generation remap...\n");
+
+    shared_memory_t owner = {0};
+    assert(shared_memory_create_ex(&owner, TEST_SHM_NAME, 4096, SHM_GROWABLE) == 0);
+    assert(shared_memory_data_size(&owner) == 4096 - SHM_HEADER_SIZE);
+    ((char *)shared_memory_data(&owner))[0] = 'a';
+
+    // The peer must be attached before the resize so it has to remap
+    shared_memory_t peer = {0};
+    assert(shared_memory_open_ex(&peer, TEST_SHM_NAME, SHM_GROWABLE) == 0);
+    assert(shared_memory_refresh(&peer) == 0);
+
+    // Opening a plain segment as growable is refused
+    shared_memory_t plain = {0};
+    assert(shared_memory_create(&plain, "/test_shared_memory_plain", 4096) == 0);
+    shared_memory_t bogus = {0};
+    assert(shared_memory_open_ex(&bogus, "/test_shared_memory_plain", SHM_GROWABLE) == -1);
+    shared_memory_destroy(&plain, 1);
+
+    pid_t pid = fork();
+    assert(pid >= 0);
+    if (pid == 0)
+    {
+        // Peer: wait for the owner to grow the segment, then read the new tail.
+        // Give up after a few seconds so a failed resize can't hang the run.
+        int polls = 0;
+        while (shared_memory_refresh(&peer) == 0 && ++polls < 50000)
+        {
+            usleep(100);
+        }
+        char *data = shared_memory_data(&peer);
+        while (peer.size == 1024 * 1024 && data[shared_memory_data_size(&peer) - 1] != 'z' &&
+               ++polls < 50000)
+        {
+            usleep(100);
+        }
+        int ok = peer.size == 1024 * 1024 && data[0] == 'a' &&
+                 data[shared_memory_data_size(&peer) - 1] == 'z';
+        _exit(ok ? 0 : 1);
+    }
+
+    // Owner: grow, write into the new range, then publish it
+    usleep(10000);
+    assert(shared_memory_resize(&owner, 1024 * 1024) == 0);
+    assert(owner.size == 1024 * 1024 && owner.generation == 1);
+    ((char *)shared_memory_data(&owner))[shared_memory_data_size(&owner) - 1] = 'z';
+
+    int status;
+    assert(waitpid(pid, &status, 0) == pid);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    // Shrinking is refused
+    assert(shared_memory_resize(&owner, 4096) == -1);
+
+    // A peer two generations behind catches up in one refresh, contents intact
+    assert(shared_memory_resize(&owner, 2 * 1024 * 1024) == 0);
+    assert(owner.generation == 2);
+    assert(shared_memory_refresh(&peer) == 1);
+    assert(peer.size == owner.size && peer.generation == 2);
+    char *data = shared_memory_data(&peer);
+    assert(data[0] == 'a' && data[1024 * 1024 - SHM_HEADER_SIZE - 1] == 'z');
+
+    // A late joiner sees the grown segment straight away
+    shared_memory_t late = {0};
+    assert(shared_memory_open_ex(&late, TEST_SHM_NAME, SHM_GROWABLE) == 0);
+    assert(late.size == owner.size && late.generation == owner.generation);
+
+    shared_memory_destroy(&late, 0);
+    shared_memory_destroy(&peer, 0);
+    shared_memory_destroy(&owner, 1);
+
+    printf("resize and generation test passed!\n\n");
+}
+
+// Test that an anonymous segment handed over a Unix socket is shared and sealed
+void test_anonymous_send()
+{
+    printf("Testing anonymous segments over a Unix socket...\n");
+
+    int socks[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, socks) == 0);
+
+    shared_memory_t owner = {0};
+    assert(shared_memory_create_anonymous(&owner, 65536, SHM_SEALED) == 0);
+    assert(owner.name == NULL);
+#ifdef __linux__
+    assert(owner.sealed);
+    // Sealed segments refuse to change size
+    assert(ftruncate(owner.fd, 4096) == -1);
+#endif
+    strcpy((char *)owner.addr, "anonymous");
+
+    pid_t pid = fork();
+    assert(pid >= 0);
+    if (pid == 0)
+    {
+        close(socks[0]);
+        shared_memory_t peer = {0};
+        if (shared_memory_receive(&peer, socks[1], 0) != 0)
+        {
+            _exit(1);
+        }
+        int ok = peer.size == 65536 && peer.sealed == owner.sealed &&
+                 strcmp((char *)peer.addr, "anonymous") == 0;
+
+        // Reply through the segment itself
+        strcpy((char *)peer.addr + 1024, "received");
+        shared_memory_destroy(&peer, 1);
+        _exit(ok ? 0 : 1);
+    }
+
+    close(socks[1]);
+    assert(shared_memory_send(socks[0], &owner) == 0);
+
+    int status;
+    assert(waitpid(pid, &status, 0) == pid);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    assert(strcmp((char *)owner.addr + 1024, "received") == 0);
+
+    close(socks[0]);
+    shared_memory_destroy(&owner, 1);
+
+    printf("anonymous segment test passed!\n\n");
+}
+
+// Test that the data region of a mirrored segment shows up twice in a row
+void test_mirrored()
+{
+    printf("Testing mirrored mapping...\n");
+
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    shared_memory_t owner = {0};
+    assert(shared_memory_create_mirrored(&owner, TEST_SHM_NAME, page, page / 2) != 0);
+    assert(shared_memory_create_mirrored(&owner, TEST_SHM_NAME, page, 4 * page) == 0);
+    assert(owner.size == 5 * page && owner.mirror_size == 4 * page);
+
+    // A write running off the end of the data region lands at its start
+    char *data = (char *)owner.addr + page;
+    memcpy(data + 4 * page - 4, "mirrored", 8);
+    assert(memcmp(data, "ored", 4) == 0);
+
+    shared_memory_t peer = {0};
+    assert(shared_memory_open_mirrored(&peer, TEST_SHM_NAME, page) == 0);
+    assert(peer.mirror_size == 4 * page);
+    assert(memcmp((char *)peer.addr + 5 * page - 4, "mirrored", 8) == 0);
+
+    shared_memory_destroy(&peer, 0);
+    shared_memory_destroy(&owner, 1);
+
+    printf("mirrored mapping test passed!\n\n");
+}
+
+int main()
+{
+    printf("Running shared memory unit tests\n");
+    printf("================================\n\n");
+
+    test_create_open();
+    test_huge_pages();
+    test_prefault_lock();
+    test_resize_generation();
+    test_anonymous_send();
+    test_mirrored();
+
+    printf("All tests passed successfully!\n");
+    return 0;
+}
@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <sys/wait.h>
+#include "shared_memory.h"
+#include "shm_alloc.h"
+
+#define TEST_SHM_NAME "/test_shm_alloc"
+#define TEST_SHM_SIZE (8 * 1024 * 1024)
+#define STRESS_PROCESSES 4
+#define STRESS_ROUNDS 200000
+
+// Test size classes, alignment and reuse of freed blocks
+void test_alloc_free(shm_arena_t *arena)
+{
+    printf("Testing alloc/free...\n");
+
+    size_t sizes[] = {1, 16, 17, 100, 4096, 5000, 64 * 1024, 1024 * 1024};
+    shm_offset_t offsets[8];
+    for (int i = 0; i < 8; i++)
+    {
+        offsets[i] = shm_alloc(arena, sizes[i]);
+        assert(offsets[i] != 0);
+        assert(offsets[i] % SHM_MIN_BLOCK == 0);
+        assert(shm_block_size(arena, offsets[i]) >= sizes[i]);
+        memset(shm_ptr(arena, offsets[i]), i, sizes[i]);
+    }
+
+    // Blocks never overlap
+    for (int i = 0; i < 8; i++)
+    {
+        assert(((unsigned char *)shm_ptr(arena, offsets[i]))[sizes[i] - 1] == i);
+    }
+
+    // Too large for any size class
+    assert(shm_alloc(arena, SHM_MAX_BLOCK + 1) == 0);
+
+    // A freed block is handed out again for its class
+    shm_free(arena, offsets[3]);
+    assert(shm_alloc(arena, 128) == offsets[3]);
+
+    printf("alloc/free test passed!\n\n");
+}
+
+// Test that offsets resolve in another process's mapping of the segment
+void test_cross_process(shm_arena_t *arena)
+{
+    printf("Testing offsets across processes...\n");
+
+    shm_offset_t offset = shm_alloc(arena, 64);
+    strcpy(shm_ptr(arena, offset), "shared");
+    shm_arena_set_root(arena, offset);
+
+    pid_t pid = fork();
+    assert(pid >= 0);
+    if (pid == 0)
+    {
+        // Map the segment again so it lands at a different address
+        shared_memory_t shm = {0};
+        if (shared_memory_open(&shm, TEST_SHM_NAME) != 0)
+        {
+            _exit(1);
+        }
+        shm_arena_t *peer = shm_arena_open(&shm);
+        int ok = peer != NULL && (void *)peer != (void *)arena &&
+                 strcmp(shm_ptr(peer, shm_arena_root(peer)), "shared") == 0;
+        _exit(ok ? 0 : 1);
+    }
+
+    int status;
+    assert(waitpid(pid, &status, 0) == pid);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    printf("cross-process test passed!\n\n");
+}
+
+// Hammer the free lists from several processes at once
+void test_concurrent(shm_arena_t *arena)
+{
+    printf("Testing %d concurrent processes...\n", STRESS_PROCESSES);
+
+    for (int p = 0; p < STRESS_PROCESSES; p++)
+    {
+        if (fork() == 0)
+        {
+            shm_offset_t held[32] = {0};
+            unsigned seed = p + 1;
+            for (int round = 0; round < STRESS_ROUNDS; round++)
+            {
+                int slot = rand_r(&seed) % 32;
+                if (held[slot] != 0)
+                {
+                    // The block must still hold our pattern, or someone else got it too
+                    unsigned char *data = shm_ptr(arena, held[slot]);
+                    if (data[0] != p + 1 || data[31] != p + 1)
+                    {
+                        _exit(1);
+                    }
+                    shm_free(arena, held[slot]);
+                    held[slot] = 0;
+                }
+                else
+                {
+                    held[slot] = shm_alloc(arena, 32 + rand_r(&seed) % 200);
+                    if (held[slot] == 0)
+                    {
+                        _exit(2);
+                    }
+                    memset(shm_ptr(arena, held[slot]), p + 1, 32);
+                }
+            }
+            _exit(0);
+        }
+    }
+
+    for (int p = 0; p < STRESS_PROCESSES; p++)
+    {
+        int status;
+        assert(wait(&status) > 0);
+        assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+
+    printf("concurrent test passed!\n\n");
+}
+
+// Test that an exhausted arena fails cleanly
+void test_exhaustion()
+{
+    printf("Testing exhaustion...\n");
+
+    static uint64_t small[4 * SHM_SLAB_SIZE / sizeof(uint64_t)];
+    shm_arena_t *arena = shm_arena_init(small, sizeof(small));
+    assert(arena != NULL);
+
+    int count = 0;
+    while (shm_alloc(arena, SHM_SLAB_SIZE) != 0)
+    {
+        count++;
+    }
+    assert(count == (int)arena->slab_count);
+
+    printf("exhaustion test passed!\n\n");
+}
+
+int main()
+{
+    printf("Running shared memory allocator unit tests\n");
+    printf("==========================================\n\n");
+
+    shared_memory_t shm = {0};
+    assert(shared_memory_create(&shm, TEST_SHM_NAME, TEST_SHM_SIZE) == 0);
+    shm_arena_t *arena = shm_arena_create(&shm);
+    assert(arena != NULL);
+
+    test_alloc_free(arena);
+    test_cross_process(arena);
+    test_concurrent(arena);
+    test_exhaustion();
+
+    shared_memory_destroy(&shm, 1);
+
+    printf("All tests passed successfully!\n");
+    return 0;
+}
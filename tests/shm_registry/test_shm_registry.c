@@ -0,0 +1,193 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <errno.h>
+#include <sys/wait.h>
+#include "shm_registry.h"
+
+#define TEST_SHM_NAME "/test_shm_registry"
+#define REGISTRY_SIZE (1024 * 1024)
+#define CHANNEL_SIZE 256
+
+// Test adding, finding and removing a channel, and the generation it carries
+void test_add_lookup_remove(shm_registry_t *reg)
+{
+    printf("Testing add, lookup and remove...\n");
+
+    const shm_channel_desc_t *added = shm_registry_add(reg, "alpha", 7, CHANNEL_SIZE);
+    assert(added != NULL);
+    assert(added->type == 7 && added->capacity == CHANNEL_SIZE);
+    assert(strcmp(added->name, "alpha") == 0);
+
+    // Storage starts zeroed and belongs to this channel only
+    char *storage = shm_registry_channel(reg, added);
+    for (int i = 0; i < CHANNEL_SIZE; i++)
+    {
+        assert(storage[i] == 0);
+    }
+    strcpy(storage, "hello");
+
+    uint64_t generation = 0;
+    assert(shm_registry_lookup(reg, "alpha", &generation) == added);
+    assert(generation == 1 && shm_registry_current(added, generation));
+    assert(shm_registry_lookup(reg, "beta", NULL) == NULL && errno == ENOENT);
+    assert(atomic_load(&reg->directory->channel_count) == 1);
+
+    // A removed channel is gone, and holders of its descriptor can tell
+    assert(shm_registry_remove(reg, "alpha") == 0);
+    assert(!shm_registry_current(added, generation));
+    assert(shm_registry_lookup(reg, "alpha", NULL) == NULL && errno == ENOENT);
+    assert(shm_registry_remove(reg, "alpha") == -1 && errno == ENOENT);
+    assert(atomic_load(&reg->directory->channel_count) == 0);
+
+    // Re-adding reuses the slot under a new generation, with fresh storage
+    const shm_channel_desc_t *readded = shm_registry_add(reg, "alpha", 8, CHANNEL_SIZE);
+    assert(readded == added);
+    uint64_t new_generation = 0;
+    assert(shm_registry_lookup(reg, "alpha", &new_generation) == readded);
+    assert(new_generation == 3 && readded->type == 8);
+    assert(!shm_registry_current(readded, generation) && shm_registry_current(readded, new_generation));
+    assert(((char *)shm_registry_channel(reg, readded))[0] == 0);
+
+    assert(shm_registry_remove(reg, "alpha") == 0);
+
+    printf("add, lookup and remove test passed!\n\n");
+}
+
+// Test that names are unique and bounded
+void test_duplicate_name(shm_registry_t *reg)
+{
+    printf("Testing duplicate names...\n");
+
+    assert(shm_registry_add(reg, "gamma", 0, CHANNEL_SIZE) != NULL);
+    assert(shm_registry_add(reg, "gamma", 0, CHANNEL_SIZE) == NULL && errno == EEXIST);
+
+    char long_name[SHM_CHANNEL_NAME_LENGTH + 1];
+    memset(long_name, 'x', SHM_CHANNEL_NAME_LENGTH);
+    long_name[SHM_CHANNEL_NAME_LENGTH] = '\0';
+    assert(shm_registry_add(reg, long_name, 0, CHANNEL_SIZE) == NULL && errno == ENAMETOOLONG);
+
+    assert(shm_registry_remove(reg, "gamma") == 0);
+
+    printf("duplicate name test passed!\n\n");
+}
+
+// Test a registry with every slot taken
+void test_full_table()
+{
+    printf("Testing a full directory...\n");
+
+    shm_registry_t small = {0};
+    assert(shm_registry_create(&small, "/test_shm_registry_small", REGISTRY_SIZE, 3) == 0);
+    assert(small.directory->max_channels == 4);
+
+    char name[SHM_CHANNEL_NAME_LENGTH];
+    for (int i = 0; i < 4; i++)
+    {
+        snprintf(name, sizeof(name), "channel_%d", i);
+        assert(shm_registry_add(&small, name, 0, CHANNEL_SIZE) != NULL);
+    }
+    assert(shm_registry_add(&small, "one_too_many", 0, CHANNEL_SIZE) == NULL && errno == ENOSPC);
+
+    // Every channel is still reachable through a full directory
+    for (int i = 0; i < 4; i++)
+    {
+        snprintf(name, sizeof(name), "channel_%d", i);
+        assert(shm_registry_lookup(&small, name, NULL) != NULL);
+    }
+    assert(shm_registry_lookup(&small, "one_too_many", NULL) == NULL && errno == ENOENT);
+
+    // A removed channel can come back into its own slot
+    assert(shm_registry_remove(&small, "channel_2") == 0);
+    assert(shm_registry_add(&small, "channel_2", 0, CHANNEL_SIZE) != NULL);
+
+    shm_registry_close(&small, 1);
+
+    printf("full directory test passed!\n\n");
+}
+
+// Test that a slot left CLAIMED by a dead adder fails calls instead of being skipped
+void test_half_added(shm_registry_t *reg)
+{
+    printf("Testing a channel left half-added...\n");
+
+    shm_channel_desc_t *desc = (shm_channel_desc_t *)shm_registry_add(reg, "delta", 0, CHANNEL_SIZE);
+    assert(desc != NULL);
+
+    // Pretend its adder died before publishing it
+    atomic_store(&desc->state, SHM_CHANNEL_CLAIMED);
+    assert(shm_registry_lookup(reg, "delta", NULL) == NULL && errno == EBUSY);
+    assert(shm_registry_add(reg, "delta", 0, CHANNEL_SIZE) == NULL && errno == EBUSY);
+    assert(shm_registry_remove(reg, "delta") == -1 && errno == EBUSY);
+
+    atomic_store(&desc->state, SHM_CHANNEL_READY);
+    assert(shm_registry_remove(reg, "delta") == 0);
+
+    printf("half-added channel test passed!\n\n");
+}
+
+// Test that another process sees channels through its own mapping, both ways
+void test_cross_process(shm_registry_t *reg)
+{
+    printf("Testing lookups from another process...\n");
+
+    const shm_channel_desc_t *desc = shm_registry_add(reg, "shared", 1, CHANNEL_SIZE);
+    assert(desc != NULL);
+    strcpy(shm_registry_channel(reg, desc), "from parent");
+
+    fflush(stdout);
+    pid_t pid = fork();
+    assert(pid >= 0);
+    if (pid == 0)
+    {
+        // Child: attach afresh, read the parent's channel, answer in a new one
+        shm_registry_t peer = {0};
+        if (shm_registry_open(&peer, TEST_SHM_NAME) != 0)
+        {
+            _exit(1);
+        }
+        const shm_channel_desc_t *found = shm_registry_lookup(&peer, "shared", NULL);
+        if (found == NULL || found->type != 1 || strcmp(shm_registry_channel(&peer, found), "from parent") != 0)
+        {
+            _exit(1);
+        }
+        const shm_channel_desc_t *reply = shm_registry_add(&peer, "reply", 2, CHANNEL_SIZE);
+        if (reply == NULL)
+        {
+            _exit(1);
+        }
+        strcpy(shm_registry_channel(&peer, reply), "from child");
+        shm_registry_close(&peer, 0);
+        _exit(0);
+    }
+
+    int status;
+    assert(waitpid(pid, &status, 0) == pid);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    const shm_channel_desc_t *reply = shm_registry_lookup(reg, "reply", NULL);
+    assert(reply != NULL && reply->type == 2);
+    assert(strcmp(shm_registry_channel(reg, reply), "from child") == 0);
+
+    printf("cross-process lookup test passed!\n\n");
+}
+
+int main()
+{
+    printf("Running channel registry unit tests\n");
+    printf("===================================\n\n");
+
+    shm_registry_t reg = {0};
+    assert(shm_registry_create(&reg, TEST_SHM_NAME, REGISTRY_SIZE, 64) == 0);
+
+    test_add_lookup_remove(&reg);
+    test_duplicate_name(&reg);
+    test_full_table();
+    test_half_added(&reg);
+    test_cross_process(&reg);
+
+    shm_registry_close(&reg, 1);
+
+    printf("All tests passed successfully!\n");
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <time.h>
+#include <sys/wait.h>
+#include "shared_memory.h"
+#include "shm_sem.h"
+
+#define TEST_SHM_NAME "/test_shm_sem"
+#define ROUND_TRIPS 20000
+
+// Request/response pair, laid out like the countdown example
+typedef struct
+{
+    int value;
+    shm_sem_t request;
+    shm_sem_t response;
+} exchange_t;
+
+uint64_t get_time_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Test counting and timeouts on a single process
+void test_counting(shm_sem_t *sem)
+{
+    printf("Testing post/wait counting...\n");
+
+    shm_sem_init(sem, 2);
+    assert(shm_sem_trywait(sem) == 0);
+    assert(shm_sem_wait(sem, 0) == 0);
+    assert(shm_sem_trywait(sem) == -1);
+
+    // An empty semaphore times out, and only after the timeout
+    uint64_t start = get_time_ns();
+    assert(shm_sem_wait(sem, 20) == -1);
+    assert(get_time_ns() - start >= 20 * 1000000ULL);
+    assert(atomic_load(&sem->waiters) == 0);
+
+    // Posts are counted, not merged
+    for (int i = 0; i < 3; i++)
+    {
+        shm_sem_post(sem);
+    }
+    for (int i = 0; i < 3; i++)
+    {
+        assert(shm_sem_wait(sem, -1) == 0);
+    }
+    assert(shm_sem_trywait(sem) == -1);
+
+    printf("counting test passed!\n\n");
+}
+
+// Test a synchronous request/response exchange with another process,
+// where every handoff has to wake a peer that may be asleep
+void test_ping_pong(exchange_t *exchange)
+{
+    printf("Testing request/response with another process...\n");
+
+    exchange->value = 0;
+    shm_sem_init(&exchange->request, 0);
+    shm_sem_init(&exchange->response, 0);
+
+    fflush(stdout);
+    pid_t pid = fork();
+    assert(pid >= 0);
+    if (pid == 0)
+    {
+        // Responder: answer each request with value + 1
+        for (int i = 0; i < ROUND_TRIPS; i++)
+        {
+            shm_sem_wait(&exchange->request, -1);
+            exchange->value++;
+            shm_sem_post(&exchange->response);
+        }
+        _exit(0);
+    }
+
+    uint64_t start = get_time_ns();
+    for (int i = 0; i < ROUND_TRIPS; i++)
+    {
+        exchange->value++;
+        shm_sem_post(&exchange->request);
+        assert(shm_sem_wait(&exchange->response, 5000) == 0);
+        assert(exchange->value == 2 * (i + 1));
+    }
+    uint64_t elapsed = get_time_ns() - start;
+
+    int status;
+    waitpid(pid, &status, 0);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    assert(atomic_load(&exchange->request.count) == 0);
+    assert(atomic_load(&exchange->response.count) == 0);
+    printf("%d round trips, %.2f us each\n", ROUND_TRIPS, elapsed / 1000.0 / ROUND_TRIPS);
+
+    printf("ping-pong test passed!\n\n");
+}
+
+int main()
+{
+    printf("Running shared semaphore unit tests\n");
+    printf("===================================\n\n");
+
+    shared_memory_t shm = {0};
+    assert(shared_memory_create(&shm, TEST_SHM_NAME, SHARED_MEM_SIZE) == 0);
+    exchange_t *exchange = (exchange_t *)shm.addr;
+
+    test_counting(&exchange->request);
+    test_ping_pong(exchange);
+
+    shared_memory_destroy(&shm, 1);
+
+    printf("All tests passed successfully!\n");
+    return 0;
+}
@@ -0,0 +1,122 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <sys/wait.h>
+#include "shared_memory.h"
+#include "shm_seqlock.h"
+
+#define TEST_SHM_NAME "/test_shm_seqlock"
+#define TEST_CAPACITY 1000
+#define READERS 3
+#define READS 500000 // Per reader, while the writer keeps going
+
+// Test writing, reading and versioning on a single process
+void test_read_write(shm_seqlock_t *lock)
+{
+    printf("Testing read/write...\n");
+
+    char buffer[TEST_CAPACITY];
+    uint64_t version = 99;
+    assert(shm_seqlock_read(lock, buffer, sizeof(buffer), &version) == 0);
+    assert(version == 0);
+
+    assert(shm_seqlock_write(lock, "hello", 5) == 0);
+    assert(shm_seqlock_version(lock) == 1);
+    assert(shm_seqlock_read(lock, buffer, sizeof(buffer), &version) == 5);
+    assert(version == 1 && memcmp(buffer, "hello", 5) == 0);
+
+    // A short buffer gets a prefix, and the full length says it was cut
+    memset(buffer, 0, sizeof(buffer));
+    assert(shm_seqlock_read(lock, buffer, 3, NULL) == 5);
+    assert(memcmp(buffer, "hel", 3) == 0 && buffer[3] == 0);
+
+    // Values larger than the cell are refused and leave it untouched
+    assert(shm_seqlock_write(lock, buffer, TEST_CAPACITY + 1) == -1);
+    assert(shm_seqlock_version(lock) == 1);
+
+    printf("read/write test passed!\n\n");
+}
+
+// Fill buffer with value i: its number followed by copies of its low byte
+static size_t make_value(uint8_t *buffer, uint32_t i)
+{
+    size_t length = sizeof(i) + i % (TEST_CAPACITY - sizeof(i));
+    memcpy(buffer, &i, sizeof(i));
+    memset(buffer + sizeof(i), (uint8_t)i, length - sizeof(i));
+    return length;
+}
+
+// Test that readers in other processes never see a torn value while the
+// writer keeps replacing it
+void test_concurrent(shm_seqlock_t *lock)
+{
+    printf("Testing %d readers against a writer...\n", READERS);
+
+    uint8_t value[TEST_CAPACITY];
+    shm_seqlock_write(lock, value, make_value(value, 0));
+
+    pid_t pids[READERS];
+    for (int r = 0; r < READERS; r++)
+    {
+        pids[r] = fork();
+        assert(pids[r] >= 0);
+        if (pids[r] == 0)
+        {
+            uint8_t copy[TEST_CAPACITY], expected[TEST_CAPACITY];
+            for (int n = 0; n < READS; n++)
+            {
+                size_t length = shm_seqlock_read(lock, copy, sizeof(copy), NULL);
+
+                uint32_t i;
+                memcpy(&i, copy, sizeof(i));
+                if (length != make_value(expected, i) || memcmp(copy, expected, length) != 0)
+                {
+                    _exit(1);
+                }
+            }
+            _exit(0);
+        }
+    }
+
+    // Keep writing until every reader is done, so reads and writes interleave
+    int running = READERS;
+    for (uint32_t i = 1; running > 0; i++)
+    {
+        shm_seqlock_write(lock, value, make_value(value, i));
+        if (i % 1024 != 0)
+        {
+            continue;
+        }
+        for (int r = 0; r < READERS; r++)
+        {
+            int status;
+            if (pids[r] > 0 && waitpid(pids[r], &status, WNOHANG) == pids[r])
+            {
+                assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+                pids[r] = 0;
+                running--;
+            }
+        }
+    }
+
+    printf("concurrent test passed!\n\n");
+}
+
+int main()
+{
+    printf("Running seqlock unit tests\n");
+    printf("==========================\n\n");
+
+    shared_memory_t shm = {0};
+    assert(shared_memory_create(&shm, TEST_SHM_NAME, shm_seqlock_size(TEST_CAPACITY)) == 0);
+    shm_seqlock_t *lock = (shm_seqlock_t *)shm.addr;
+    shm_seqlock_init(lock, TEST_CAPACITY);
+
+    test_read_write(lock);
+    test_concurrent(lock);
+
+    shared_memory_destroy(&shm, 1);
+
+    printf("All tests passed successfully!\n");
+    return 0;
+}